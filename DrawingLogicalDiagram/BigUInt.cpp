@@ -0,0 +1,216 @@
+#include "BigUInt.h"
+#include <algorithm>
+#include <cmath>
+
+// Константы.
+static constexpr quint32 DECIMAL_CHUNK = 1000000000;  // 10^9 — девять цифр за одно деление
+static constexpr int DECIMAL_CHUNK_DIGITS = 9;
+static constexpr int RATIO_BITS = 64;
+
+// Конструктор.
+BigUInt::BigUInt(quint64 value)
+{
+    while (value) {
+        limbs.push_back(static_cast<quint32>(value));
+        value >>= 32;
+    }
+}
+
+// Степень двойки.
+BigUInt BigUInt::powerOfTwo(int exponent)
+{
+    return BigUInt(1) << exponent;
+}
+
+// Сумма.
+BigUInt BigUInt::operator+(const BigUInt& other) const
+{
+    BigUInt result;
+    const size_t size = std::max(limbs.size(), other.limbs.size());
+    result.limbs.resize(size + 1);
+    quint64 carry = 0;
+    for (size_t i = 0; i < size; ++i) {
+        carry += i < limbs.size() ? limbs[i] : 0;
+        carry += i < other.limbs.size() ? other.limbs[i] : 0;
+        result.limbs[i] = static_cast<quint32>(carry);
+        carry >>= 32;
+    }
+    result.limbs[size] = static_cast<quint32>(carry);
+    result.normalize();
+    return result;
+}
+
+// Разность (уменьшаемое не меньше вычитаемого).
+BigUInt BigUInt::operator-(const BigUInt& other) const
+{
+    BigUInt result = *this;
+    qint64 borrow = 0;
+    for (size_t i = 0; i < result.limbs.size(); ++i) {
+        qint64 value = qint64(result.limbs[i]) - borrow - (i < other.limbs.size() ? qint64(other.limbs[i]) : 0);
+        borrow = value < 0 ? 1 : 0;
+        result.limbs[i] = static_cast<quint32>(value + (borrow << 32));
+    }
+    result.normalize();
+    return result;
+}
+
+// Произведение.
+BigUInt BigUInt::operator*(const BigUInt& other) const
+{
+    BigUInt result;
+    if (isZero() || other.isZero())
+        return result;
+
+    result.limbs.assign(limbs.size() + other.limbs.size(), 0);
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        quint64 carry = 0;
+        for (size_t j = 0; j < other.limbs.size(); ++j) {
+            carry += quint64(limbs[i]) * other.limbs[j] + result.limbs[i + j];
+            result.limbs[i + j] = static_cast<quint32>(carry);
+            carry >>= 32;
+        }
+        for (size_t k = i + other.limbs.size(); carry; ++k) {
+            carry += result.limbs[k];
+            result.limbs[k] = static_cast<quint32>(carry);
+            carry >>= 32;
+        }
+    }
+    result.normalize();
+    return result;
+}
+
+// Сдвиг влево.
+BigUInt BigUInt::operator<<(int bits) const
+{
+    if (isZero() || bits <= 0)
+        return *this;
+
+    const int words = bits / 32;
+    const int rest = bits % 32;
+    BigUInt result;
+    result.limbs.assign(limbs.size() + words + 1, 0);
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        const quint64 value = quint64(limbs[i]) << rest;
+        result.limbs[i + words] |= static_cast<quint32>(value);
+        result.limbs[i + words + 1] |= static_cast<quint32>(value >> 32);
+    }
+    result.normalize();
+    return result;
+}
+
+// Сдвиг вправо.
+BigUInt BigUInt::operator>>(int bits) const
+{
+    if (bits <= 0)
+        return *this;
+
+    const size_t words = static_cast<size_t>(bits / 32);
+    const int rest = bits % 32;
+    BigUInt result;
+    if (words >= limbs.size())
+        return result;
+
+    result.limbs.assign(limbs.size() - words, 0);
+    for (size_t i = 0; i < result.limbs.size(); ++i) {
+        quint64 value = limbs[i + words];
+        if (i + words + 1 < limbs.size())
+            value |= quint64(limbs[i + words + 1]) << 32;
+        result.limbs[i] = static_cast<quint32>(value >> rest);
+    }
+    result.normalize();
+    return result;
+}
+
+// Равенство.
+bool BigUInt::operator==(const BigUInt& other) const
+{
+    return limbs == other.limbs;
+}
+
+// Неравенство.
+bool BigUInt::operator!=(const BigUInt& other) const
+{
+    return limbs != other.limbs;
+}
+
+// Сравнение.
+bool BigUInt::operator<(const BigUInt& other) const
+{
+    if (limbs.size() != other.limbs.size())
+        return limbs.size() < other.limbs.size();
+    for (size_t i = limbs.size(); i-- > 0;) {
+        if (limbs[i] != other.limbs[i])
+            return limbs[i] < other.limbs[i];
+    }
+    return false;
+}
+
+// Равно ли число нулю.
+bool BigUInt::isZero() const
+{
+    return limbs.empty();
+}
+
+// Число значащих битов.
+int BigUInt::bitLength() const
+{
+    if (limbs.empty())
+        return 0;
+    int bits = static_cast<int>(limbs.size() - 1) * 32;
+    for (quint32 top = limbs.back(); top; top >>= 1)
+        ++bits;
+    return bits;
+}
+
+// Приближённое значение.
+double BigUInt::toDouble() const
+{
+    return ratioToPowerOfTwo(0);
+}
+
+// Отношение к степени двойки.
+double BigUInt::ratioToPowerOfTwo(int exponent) const
+{
+    // Берутся старшие 64 бита, порядок учитывается через ldexp,
+    // поэтому отношение двух огромных чисел не переполняется.
+    const int shift = std::max(0, bitLength() - RATIO_BITS);
+    const BigUInt top = *this >> shift;
+    quint64 mantissa = 0;
+    for (size_t i = top.limbs.size(); i-- > 0;)
+        mantissa = (mantissa << 32) | top.limbs[i];
+    return std::ldexp(static_cast<double>(mantissa), shift - exponent);
+}
+
+// Десятичная запись.
+QString BigUInt::toString() const
+{
+    if (isZero())
+        return "0";
+
+    // Повторное деление на 10^9 с остатком.
+    std::vector<quint32> value = limbs;
+    std::vector<quint32> chunks;
+    while (!value.empty()) {
+        quint64 remainder = 0;
+        for (size_t i = value.size(); i-- > 0;) {
+            const quint64 current = (remainder << 32) | value[i];
+            value[i] = static_cast<quint32>(current / DECIMAL_CHUNK);
+            remainder = current % DECIMAL_CHUNK;
+        }
+        while (!value.empty() && value.back() == 0)
+            value.pop_back();
+        chunks.push_back(static_cast<quint32>(remainder));
+    }
+
+    QString text = QString::number(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;)
+        text += QString::number(chunks[i]).rightJustified(DECIMAL_CHUNK_DIGITS, '0');
+    return text;
+}
+
+// Убрать старшие нулевые разряды.
+void BigUInt::normalize()
+{
+    while (!limbs.empty() && limbs.back() == 0)
+        limbs.pop_back();
+}
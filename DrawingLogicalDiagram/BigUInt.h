@@ -0,0 +1,99 @@
+#ifndef BIGUINT_H
+#define BIGUINT_H
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @class BigUInt
+ * @brief Беззнаковое целое произвольной длины
+ *
+ * Хранит число разрядами по 32 бита от младшего к старшему.
+ * Нужен для точного числа наборов входов: при n входах оно
+ * достигает 2^n и не помещается в машинное слово уже при n > 64.
+ *
+ * @details
+ * - Старших нулевых разрядов нет, ноль — пустой список.
+ * - Вычитание большего числа из меньшего не допускается.
+ */
+class BigUInt {
+public:
+    /**
+     * @brief Конструктор
+     * @param value Начальное значение
+     */
+    BigUInt(quint64 value = 0);
+
+    /**
+     * @brief Степень двойки
+     * @param exponent Показатель
+     * @return 2^exponent
+     */
+    static BigUInt powerOfTwo(int exponent);
+
+    /** @brief Сумма */
+    BigUInt operator+(const BigUInt& other) const;
+
+    /** @brief Разность; other не больше this */
+    BigUInt operator-(const BigUInt& other) const;
+
+    /** @brief Произведение */
+    BigUInt operator*(const BigUInt& other) const;
+
+    /** @brief Умножение на 2^bits */
+    BigUInt operator<<(int bits) const;
+
+    /** @brief Деление на 2^bits с отбрасыванием остатка */
+    BigUInt operator>>(int bits) const;
+
+    /** @brief Равенство */
+    bool operator==(const BigUInt& other) const;
+
+    /** @brief Неравенство */
+    bool operator!=(const BigUInt& other) const;
+
+    /** @brief Меньше */
+    bool operator<(const BigUInt& other) const;
+
+    /**
+     * @brief Равно ли число нулю
+     * @return true для нуля
+     */
+    bool isZero() const;
+
+    /**
+     * @brief Число значащих битов
+     * @return 0 для нуля
+     */
+    int bitLength() const;
+
+    /**
+     * @brief Приближённое значение
+     * @return Число с плавающей точкой (inf при переполнении double)
+     */
+    double toDouble() const;
+
+    /**
+     * @brief Отношение к степени двойки
+     * @param exponent Показатель знаменателя
+     * @return this / 2^exponent без переполнения при больших числах
+     */
+    double ratioToPowerOfTwo(int exponent) const;
+
+    /**
+     * @brief Десятичная запись
+     * @return Строка цифр
+     */
+    QString toString() const;
+
+private:
+    /**
+     * @brief Убрать старшие нулевые разряды
+     */
+    void normalize();
+
+    std::vector<quint32> limbs;  ///< Разряды по 32 бита, младший первым
+};
+
+#endif // BIGUINT_H
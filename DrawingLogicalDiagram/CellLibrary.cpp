@@ -0,0 +1,155 @@
+#include "CellLibrary.h"
+#include "LogicGraph.h"
+#include "SchemaTree.h"
+#include <QStringList>
+#include <QtAlgorithms>
+#include <algorithm>
+
+// Константы.
+static const quint64 VARIABLE_TRUTH[CellLibrary::MAX_INPUTS] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL,
+};
+static const char* const NAND_NOR_LIBRARY =
+    "INV    1  1.0  !a\n"
+    "NAND2  2  1.0  !(a & b)\n"
+    "NOR2   2  1.2  !(a | b)\n";
+static const char* const AOI_LIBRARY =
+    "INV    1  1.0  !a\n"
+    "NAND2  2  1.0  !(a & b)\n"
+    "NOR2   2  1.2  !(a | b)\n"
+    "NAND3  3  1.3  !(a & b & c)\n"
+    "NOR3   3  1.6  !(a | b | c)\n"
+    "AND2   3  1.6  a & b\n"
+    "OR2    3  1.8  a | b\n"
+    "XOR2   5  2.0  a ^ b\n"
+    "XNOR2  5  2.0  !(a ^ b)\n"
+    "AOI21  3  1.4  !((a & b) | c)\n"
+    "OAI21  3  1.4  !((a | b) & c)\n"
+    "AOI22  4  1.6  !((a & b) | (c & d))\n"
+    "OAI22  4  1.6  !((a | b) & (c | d))\n";
+
+// Разобрать библиотеку из текста.
+CellLibrary CellLibrary::fromText(const QString& text, QString* error)
+{
+    CellLibrary library;
+    const QStringList lines = text.split('\n');
+    for (int number = 1; number <= lines.size(); ++number) {
+        QString line = lines[number - 1];
+        const int comment = line.indexOf('#');
+        if (comment >= 0)
+            line.truncate(comment);
+        const QStringList parts = line.simplified().split(' ', Qt::SkipEmptyParts);
+        if (parts.isEmpty())
+            continue;
+
+        auto fail = [&](const QString& message) {
+            if (error)
+                *error = QString("Строка %1: %2").arg(number).arg(message);
+            return CellLibrary();
+        };
+
+        bool areaOk = false;
+        bool delayOk = false;
+        Cell cell;
+        if (parts.size() < 4)
+            return fail("ожидается \"имя площадь задержка функция\"");
+        cell.name = parts[0];
+        cell.area = parts[1].toDouble(&areaOk);
+        cell.delay = parts[2].toDouble(&delayOk);
+        if (!areaOk || !delayOk || cell.area < 0 || cell.delay < 0)
+            return fail("площадь и задержка — неотрицательные числа");
+
+        // Функция вычисляется по той же сети, что и схема, сразу
+        // на всех 2^MAX_INPUTS наборах входов.
+        SchemaTree tree(parts.mid(3).join(' '));
+        if (!tree.getRoot())
+            return fail(QString("пустая функция ячейки %1").arg(cell.name));
+        const LogicGraph graph = LogicGraph::fromTree(tree.getRoot());
+
+        std::vector<quint64> words(graph.inputs().size(), 0);
+        for (size_t i = 0; i < graph.inputs().size(); ++i) {
+            const QString pin = graph.inputName(graph.inputs()[i]);
+            const int index = pin.size() == 1 ? pin[0].unicode() - 'a' : -1;
+            if (index < 0 || index >= MAX_INPUTS)
+                return fail(QString("вход %1 ячейки %2: допустимы a…f").arg(pin, cell.name));
+            words[i] = VARIABLE_TRUTH[index];
+            cell.inputs = std::max(cell.inputs, index + 1);
+        }
+        if (static_cast<int>(graph.inputs().size()) != cell.inputs)
+            return fail(QString("входы ячейки %1 должны идти без пропусков").arg(cell.name));
+        cell.function = graph.evaluate(words).front();
+        library.cellList.push_back(cell);
+    }
+
+    if (!library.isComplete()) {
+        if (error)
+            *error = "В библиотеке нет инвертора или двухвходовой ячейки И/ИЛИ (NAND2, NOR2, AND2, OR2)";
+        return CellLibrary();
+    }
+    return library;
+}
+
+// Библиотека из инвертора, NAND2 и NOR2.
+CellLibrary CellLibrary::nandNor()
+{
+    return fromText(NAND_NOR_LIBRARY);
+}
+
+// Библиотека с многовходовыми И-НЕ/ИЛИ-НЕ, XOR и ячейками AOI/OAI.
+CellLibrary CellLibrary::aoi()
+{
+    return fromText(AOI_LIBRARY);
+}
+
+// Ячейки библиотеки.
+const std::vector<CellLibrary::Cell>& CellLibrary::cells() const
+{
+    return cellList;
+}
+
+// Инвертор библиотеки.
+int CellLibrary::inverter() const
+{
+    int best = -1;
+    for (int i = 0; i < static_cast<int>(cellList.size()); ++i) {
+        const Cell& cell = cellList[i];
+        if (cell.inputs == 1 && cell.function == ~VARIABLE_TRUTH[0]
+            && (best < 0 || cell.area < cellList[best].area))
+            best = i;
+    }
+    return best;
+}
+
+// Наибольшее число входов ячейки.
+int CellLibrary::maxInputs() const
+{
+    int inputs = 0;
+    for (const Cell& cell : cellList)
+        inputs = std::max(inputs, cell.inputs);
+    return inputs;
+}
+
+// Пуста ли библиотека.
+bool CellLibrary::isEmpty() const
+{
+    return cellList.empty();
+}
+
+// Достаточно ли ячеек, чтобы отобразить любую схему.
+bool CellLibrary::isComplete() const
+{
+    if (inverter() < 0)
+        return false;
+
+    // Функция двух входов, равная AND с точностью до инверсий,
+    // принимает значение 1 ровно на одном наборе или на трёх.
+    for (const Cell& cell : cellList) {
+        if (cell.inputs != 2)
+            continue;
+        const int ones = qPopulationCount(cell.function & 0xF);
+        if (ones == 1 || ones == 3)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,102 @@
+#ifndef CELLLIBRARY_H
+#define CELLLIBRARY_H
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @class CellLibrary
+ * @brief Библиотека логических ячеек для отображения схемы (TechMapper)
+ *
+ * Ячейка — вентиль с одним выходом Y и входами a, b, c, …;
+ * её функция задаётся выражением в синтаксисе поля ввода.
+ *
+ * @details Текст библиотеки — строка на ячейку:
+ * @code
+ * # имя  площадь  задержка  функция
+ * INV    1   1.0  !a
+ * NAND2  2   1.0  !(a & b)
+ * AOI21  3   1.4  !((a & b) | c)
+ * @endcode
+ * - Число входов ячейки — номер старшей буквы в выражении;
+ *   входы называются a, b, c, … без пропусков, не больше MAX_INPUTS.
+ * - Все операторы в выражении имеют одинаковый приоритет,
+ *   поэтому разные операторы разделяются скобками.
+ * - Библиотека должна содержать инвертор и двухвходовую ячейку,
+ *   которая с точностью до инверсий входов и выхода равна AND
+ *   (NAND2, NOR2, AND2, OR2): тогда любая схема отображается.
+ */
+class CellLibrary {
+public:
+    /// Наибольшее число входов ячейки.
+    static constexpr int MAX_INPUTS = 6;
+
+    /**
+     * @struct Cell
+     * @brief Ячейка библиотеки
+     */
+    struct Cell
+    {
+        QString name;          ///< Имя ячейки
+        int inputs = 0;        ///< Число входов
+        double area = 0.0;     ///< Площадь
+        double delay = 0.0;    ///< Задержка от любого входа до выхода
+        quint64 function = 0;  ///< Таблица истинности: бит m — значение на наборе m (вход a — младший бит)
+    };
+
+    /**
+     * @brief Разобрать библиотеку из текста
+     * @param text Строки "имя площадь задержка функция"; '#' начинает комментарий
+     * @param error Сюда записывается описание ошибки (может быть nullptr)
+     * @return Библиотека; при ошибке — пустая
+     */
+    static CellLibrary fromText(const QString& text, QString* error = nullptr);
+
+    /**
+     * @brief Библиотека из инвертора, NAND2 и NOR2
+     * @return Библиотека
+     */
+    static CellLibrary nandNor();
+
+    /**
+     * @brief Библиотека с многовходовыми И-НЕ/ИЛИ-НЕ, XOR и ячейками AOI/OAI
+     * @return Библиотека
+     */
+    static CellLibrary aoi();
+
+    /**
+     * @brief Ячейки библиотеки
+     * @return Ячейки в порядке описания
+     */
+    const std::vector<Cell>& cells() const;
+
+    /**
+     * @brief Инвертор библиотеки
+     * @return Номер ячейки с функцией !a наименьшей площади или -1
+     */
+    int inverter() const;
+
+    /**
+     * @brief Наибольшее число входов ячейки
+     * @return Число входов (0 для пустой библиотеки)
+     */
+    int maxInputs() const;
+
+    /**
+     * @brief Пуста ли библиотека
+     * @return true, если ячеек нет
+     */
+    bool isEmpty() const;
+
+private:
+    /**
+     * @brief Достаточно ли ячеек, чтобы отобразить любую схему
+     * @return true, если есть инвертор и двухвходовая ячейка типа AND
+     */
+    bool isComplete() const;
+
+    std::vector<Cell> cellList;   ///< Ячейки
+};
+
+#endif // CELLLIBRARY_H
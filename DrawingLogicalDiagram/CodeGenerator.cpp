@@ -0,0 +1,545 @@
+#include "CodeGenerator.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QProcess>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <algorithm>
+#include <memory>
+
+// Константы.
+static constexpr int OUTPUT_CHUNK_SIZE = 64 * 1024;
+static constexpr int MAX_INLINE_DEPTH = 8;
+static constexpr int OPERANDS_PER_LINE = 8;
+static constexpr int WORDS_PER_LINE = 4;
+static constexpr int MAX_PACKED_BITS = 64;
+static constexpr int EXHAUSTIVE_INPUTS = 16;
+static constexpr int RANDOM_TEST_BLOCKS = 16;
+static constexpr int MAX_REPORTED_ERRORS = 10;
+static constexpr int PROCESS_TIMEOUT_MS = 120000;
+static constexpr int MAX_LOG_SIZE = 4000;
+
+// Имя входа или выхода для комментария (без управляющих символов).
+static QByteArray commentName(const QString& name)
+{
+    QByteArray bytes;
+    for (char c : name.toUtf8())
+        bytes += static_cast<unsigned char>(c) < 0x20 ? '?' : c;
+    return bytes;
+}
+
+// Шестнадцатеричная константа uint64_t.
+static QByteArray hexWord(quint64 value)
+{
+    return "0x" + QByteArray::number(value, 16) + "ULL";
+}
+
+// Записать код в файл.
+bool CodeGenerator::write(const QString& path, const LogicGraph& graph)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = QString("Не удалось открыть файл %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    if (!write(&file, graph))
+        return false;
+
+    if (!file.commit()) {
+        error = QString("Не удалось записать файл %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+// Записать код в устройство.
+bool CodeGenerator::write(QIODevice* device, const LogicGraph& graph)
+{
+    error.clear();
+    if (graph.outputs().empty()) {
+        error = "В схеме нет выходов";
+        return false;
+    }
+
+    plan(graph);
+    const QByteArray name = functionName;
+    const int inputs = static_cast<int>(graph.inputs().size());
+    const int outputs = static_cast<int>(graph.outputs().size());
+
+    QByteArray out;
+    out.reserve(OUTPUT_CHUNK_SIZE + 1024);
+    out += "// Generated by DrawingLogicalDiagram.\n"
+           "// Each word holds 64 independent input vectors: bit k of in[i] is\n"
+           "// the value of input i in vector k; bit k of out[o] is output o.\n"
+           "//\n";
+    for (int i = 0; i < inputs; ++i)
+        out += "// in[" + QByteArray::number(i) + "]  " + commentName(graph.inputName(graph.inputs()[i])) + "\n";
+    for (int o = 0; o < outputs; ++o)
+        out += "// out[" + QByteArray::number(o) + "] " + commentName(graph.outputs()[o].name) + "\n";
+
+    out += "\n#include <stddef.h>\n#include <stdint.h>\n\n"
+           "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n";
+    out += "enum { " + name + "_INPUTS = " + QByteArray::number(inputs) + ", "
+           + name + "_OUTPUTS = " + QByteArray::number(outputs) + " };\n\n";
+
+    // Вычисление 64 наборов: локальные константы в топологическом
+    // порядке, затем выходы.
+    out += "void " + name + "_eval(const uint64_t* in, uint64_t* out)\n{\n";
+    const auto readsInput = [&](int id) { return live[id] && inputIndex[id] >= 0; };
+    if (std::none_of(graph.inputs().begin(), graph.inputs().end(), readsInput))
+        out += "    (void)in;\n";
+    for (int id = 0; id < graph.size(); ++id) {
+        if (!local[id])
+            continue;
+        out += "    const uint64_t g" + QByteArray::number(id) + " = ";
+        appendExpression(graph, id, out);
+        out += ";\n";
+        if (out.size() >= OUTPUT_CHUNK_SIZE && !flush(device, out))
+            return false;
+    }
+    for (int o = 0; o < outputs; ++o) {
+        const int gate = graph.outputs()[o].gate;
+        out += "    out[" + QByteArray::number(o) + "] = ";
+        if (local[gate])
+            out += "g" + QByteArray::number(gate);
+        else
+            appendExpression(graph, gate, out);
+        out += ";\n";
+        if (out.size() >= OUTPUT_CHUNK_SIZE && !flush(device, out))
+            return false;
+    }
+    out += "}\n\n";
+
+    out += "void " + name + "_eval_batch(const uint64_t* in, uint64_t* out, size_t blocks)\n{\n"
+           "    size_t b;\n"
+           "    for (b = 0; b < blocks; ++b)\n"
+           "        " + name + "_eval(in + b * " + name + "_INPUTS, out + b * " + name + "_OUTPUTS);\n"
+           "}\n";
+
+    // Один набор в битах слова: бит входа разворачивается
+    // в слово из нулей или единиц без ветвлений.
+    if (inputs <= MAX_PACKED_BITS && outputs <= MAX_PACKED_BITS) {
+        const QByteArray inputWords = QByteArray::number(std::max(inputs, 1));
+        out += "\nuint64_t " + name + "_eval_packed(uint64_t in)\n{\n"
+               "    uint64_t x[" + inputWords + "] = {0};\n"
+               "    uint64_t y[" + QByteArray::number(outputs) + "];\n"
+               "    uint64_t result = 0;\n"
+               "    int i;\n"
+               "    for (i = 0; i < " + name + "_INPUTS; ++i)\n"
+               "        x[i] = (uint64_t)0 - ((in >> i) & 1);\n"
+               "    " + name + "_eval(x, y);\n"
+               "    for (i = 0; i < " + name + "_OUTPUTS; ++i)\n"
+               "        result |= (y[i] & 1) << i;\n"
+               "    return result;\n"
+               "}\n";
+    }
+
+    out += "\n#ifdef __cplusplus\n}\n#endif\n";
+    return flush(device, out);
+}
+
+// Записать проверочную программу.
+bool CodeGenerator::writeTest(QIODevice* device, const LogicGraph& graph, const QString& sourceName)
+{
+    error.clear();
+    if (graph.outputs().empty()) {
+        error = "В схеме нет выходов";
+        return false;
+    }
+
+    const QByteArray name = functionName;
+    const int inputs = static_cast<int>(graph.inputs().size());
+    const int outputs = static_cast<int>(graph.outputs().size());
+    const bool exhaustive = inputs <= EXHAUSTIVE_INPUTS;
+    const int blocks = exhaustive ? std::max(1, (1 << inputs) / 64) : RANDOM_TEST_BLOCKS;
+
+    // Наборы: при полном переборе набор k блока b — номер строки
+    // b·64 + k таблицы истинности, иначе xorshift64* с постоянным зерном.
+    std::vector<std::vector<quint64>> inputWords(blocks, std::vector<quint64>(inputs, 0));
+    quint64 state = 0x9E3779B97F4A7C15ULL;
+    for (int b = 0; b < blocks; ++b) {
+        for (int i = 0; i < inputs; ++i) {
+            quint64 word = 0;
+            if (exhaustive) {
+                for (int k = 0; k < 64; ++k)
+                    word |= ((static_cast<quint64>(b * 64 + k) >> i) & 1) << k;
+            } else {
+                state ^= state >> 12;
+                state ^= state << 25;
+                state ^= state >> 27;
+                word = state * 0x2545F4914F6CDD1DULL;
+            }
+            inputWords[b][i] = word;
+        }
+    }
+
+    QByteArray out;
+    out += "// Test for " + sourceName.toUtf8() + ": outputs are compared with values\n"
+           "// precomputed by the reference evaluator (LogicGraph::evaluate).\n\n"
+           "#include <stdio.h>\n#include \"" + sourceName.toUtf8() + "\"\n\n"
+           "#define TEST_BLOCKS " + QByteArray::number(blocks) + "\n\n";
+
+    out += "static const uint64_t test_in[TEST_BLOCKS][" + QByteArray::number(std::max(inputs, 1)) + "] = {\n";
+    for (int b = 0; b < blocks; ++b) {
+        out += "    {";
+        for (int i = 0; i < inputs; ++i) {
+            out += (i % WORDS_PER_LINE == 0 && i > 0) ? ",\n     " : (i > 0 ? ", " : "");
+            out += hexWord(inputWords[b][i]);
+        }
+        out += inputs == 0 ? "0},\n" : "},\n";
+        if (out.size() >= OUTPUT_CHUNK_SIZE && !flush(device, out))
+            return false;
+    }
+    out += "};\n\n";
+
+    out += "static const uint64_t test_out[TEST_BLOCKS][" + QByteArray::number(outputs) + "] = {\n";
+    for (int b = 0; b < blocks; ++b) {
+        const std::vector<quint64> expected = graph.evaluate(inputWords[b]);
+        out += "    {";
+        for (int o = 0; o < outputs; ++o) {
+            out += (o % WORDS_PER_LINE == 0 && o > 0) ? ",\n     " : (o > 0 ? ", " : "");
+            out += hexWord(expected[o]);
+        }
+        out += "},\n";
+        if (out.size() >= OUTPUT_CHUNK_SIZE && !flush(device, out))
+            return false;
+    }
+    out += "};\n\n";
+
+    const QByteArray maxErrors = QByteArray::number(MAX_REPORTED_ERRORS);
+    out += "static uint64_t test_batch[TEST_BLOCKS][" + QByteArray::number(outputs) + "];\n\n"
+           "int main(void)\n{\n"
+           "    size_t b, o;\n"
+           "    int errors = 0;\n"
+           "    " + name + "_eval_batch(&test_in[0][0], &test_batch[0][0], TEST_BLOCKS);\n"
+           "    for (b = 0; b < TEST_BLOCKS; ++b) {\n"
+           "        uint64_t y[" + QByteArray::number(outputs) + "];\n"
+           "        " + name + "_eval(test_in[b], y);\n"
+           "        for (o = 0; o < " + name + "_OUTPUTS; ++o) {\n"
+           "            if (y[o] != test_out[b][o] || test_batch[b][o] != test_out[b][o]) {\n"
+           "                if (errors < " + maxErrors + ")\n"
+           "                    printf(\"mismatch: block %u, output %u\\n\", (unsigned)b, (unsigned)o);\n"
+           "                ++errors;\n"
+           "            }\n"
+           "        }\n"
+           "    }\n";
+
+    if (inputs <= MAX_PACKED_BITS && outputs <= MAX_PACKED_BITS) {
+        out += "    for (b = 0; b < TEST_BLOCKS; ++b) {\n"
+               "        int k, i;\n"
+               "        for (k = 0; k < 64; ++k) {\n"
+               "            uint64_t packed = 0, result;\n"
+               "            for (i = 0; i < " + name + "_INPUTS; ++i)\n"
+               "                packed |= ((test_in[b][i] >> k) & 1) << i;\n"
+               "            result = " + name + "_eval_packed(packed);\n"
+               "            for (o = 0; o < " + name + "_OUTPUTS; ++o) {\n"
+               "                if (((result >> o) & 1) != ((test_out[b][o] >> k) & 1)) {\n"
+               "                    if (errors < " + maxErrors + ")\n"
+               "                        printf(\"packed mismatch: block %u, vector %d, output %u\\n\", (unsigned)b, k, (unsigned)o);\n"
+               "                    ++errors;\n"
+               "                }\n"
+               "            }\n"
+               "        }\n"
+               "    }\n";
+    }
+
+    out += "    printf(\"%s: %u vectors, %d errors\\n\", errors ? \"FAIL\" : \"OK\", (unsigned)(TEST_BLOCKS * 64), errors);\n"
+           "    return errors != 0;\n"
+           "}\n";
+
+    if (!flush(device, out))
+        return false;
+    stats.vectors = static_cast<qint64>(blocks) * 64;
+    return true;
+}
+
+// Записать код и проверочную программу во временный каталог.
+bool CodeGenerator::writeCheck(const LogicGraph& graph, const QTemporaryDir& dir, QString& testPath, QString& program)
+{
+    if (!dir.isValid()) {
+        error = "Не удалось создать временный каталог";
+        return false;
+    }
+
+    const QString sourceName = QString::fromLatin1(functionName) + ".c";
+    testPath = dir.filePath(QString::fromLatin1(functionName) + "_test.c");
+    program = dir.filePath(QString::fromLatin1(functionName) + "_test");
+    if (!write(dir.filePath(sourceName), graph))
+        return false;
+
+    QSaveFile test(testPath);
+    if (!test.open(QIODevice::WriteOnly) || !writeTest(&test, graph, sourceName) || !test.commit()) {
+        if (error.isEmpty())
+            error = QString("Не удалось записать файл %1: %2").arg(testPath, test.errorString());
+        return false;
+    }
+    return true;
+}
+
+// Скомпилировать код с проверочной программой и запустить её.
+bool CodeGenerator::verify(const LogicGraph& graph, const QString& compiler)
+{
+    QTemporaryDir dir;
+    QString testPath;
+    QString program;
+    if (!writeCheck(graph, dir, testPath, program))
+        return false;
+
+    const QString command = compiler.isEmpty() ? qEnvironmentVariable("CC", "cc") : compiler;
+    QElapsedTimer timer;
+    timer.start();
+
+    QProcess build;
+    build.setProcessChannelMode(QProcess::MergedChannels);
+    build.start(command, {"-O1", "-o", program, testPath});
+    if (!build.waitForStarted(PROCESS_TIMEOUT_MS)) {
+        error = QString("Не удалось запустить компилятор %1").arg(command);
+        return false;
+    }
+    const bool built = build.waitForFinished(PROCESS_TIMEOUT_MS)
+                       && build.exitStatus() == QProcess::NormalExit && build.exitCode() == 0;
+    stats.compileMs = timer.elapsed();
+    if (!built) {
+        error = QString("Ошибка компиляции:\n%1").arg(QString::fromLocal8Bit(build.readAll().left(MAX_LOG_SIZE)));
+        return false;
+    }
+
+    timer.restart();
+    QProcess run;
+    run.setProcessChannelMode(QProcess::MergedChannels);
+    run.start(program, QStringList());
+    const bool passed = run.waitForFinished(PROCESS_TIMEOUT_MS)
+                        && run.exitStatus() == QProcess::NormalExit && run.exitCode() == 0;
+    stats.runMs = timer.elapsed();
+    if (!passed) {
+        error = QString("Проверка не пройдена:\n%1").arg(QString::fromLocal8Bit(run.readAll().left(MAX_LOG_SIZE)));
+        return false;
+    }
+    return true;
+}
+
+// Запустить процесс и сообщить его результат из цикла событий.
+static void startProcess(QObject* context, const QString& command, const QStringList& arguments,
+                         const std::function<void(bool started, bool ok, const QByteArray& output)>& done)
+{
+    // Процесс может сообщить и об ошибке, и о завершении (например,
+    // при аварийном завершении), поэтому результат передаётся один раз.
+    auto* process = new QProcess(context);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+    auto reported = std::make_shared<bool>(false);
+    auto report = [process, reported, done](bool started, bool ok) {
+        if (*reported)
+            return;
+        *reported = true;
+        const QByteArray output = process->readAll();
+        process->deleteLater();
+        done(started, ok, output);
+    };
+
+    QObject::connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), process,
+                     [report](int exitCode, QProcess::ExitStatus status) {
+                         report(true, status == QProcess::NormalExit && exitCode == 0);
+                     });
+    QObject::connect(process, &QProcess::errorOccurred, process, [report](QProcess::ProcessError failure) {
+        report(failure != QProcess::FailedToStart, false);
+    });
+    QTimer::singleShot(PROCESS_TIMEOUT_MS, process, [process]() { process->kill(); });
+    process->start(command, arguments);
+}
+
+// Проверить код без ожидания в вызывающем потоке.
+void CodeGenerator::verifyAsync(const LogicGraph& graph, QObject* context, const VerifyCallback& finished,
+                                const QString& compiler)
+{
+    // Каталог с файлами живёт, пока его держат обработчики процессов:
+    // он явно захвачен обоими, хотя в них не используется.
+    auto dir = std::make_shared<QTemporaryDir>();
+    QString testPath;
+    QString program;
+    const bool written = writeCheck(graph, *dir, testPath, program);
+    Statistics result = stats;
+    if (!written) {
+        const QString message = error;
+        QTimer::singleShot(0, context, [finished, result, message]() { finished(false, result, message); });
+        return;
+    }
+
+    const QString command = compiler.isEmpty() ? qEnvironmentVariable("CC", "cc") : compiler;
+    auto timer = std::make_shared<QElapsedTimer>();
+    timer->start();
+    startProcess(context, command, {"-O1", "-o", program, testPath},
+                 [context, finished, command, program, dir, timer, result](bool started, bool built,
+                                                                           const QByteArray& output) mutable {
+        result.compileMs = timer->elapsed();
+        if (!built) {
+            finished(false, result, started ? QString("Ошибка компиляции:\n%1").arg(QString::fromLocal8Bit(output.left(MAX_LOG_SIZE)))
+                                            : QString("Не удалось запустить компилятор %1").arg(command));
+            return;
+        }
+
+        timer->restart();
+        startProcess(context, program, QStringList(), [finished, dir, timer, result](bool, bool passed,
+                                                                                  const QByteArray& log) mutable {
+            result.runMs = timer->elapsed();
+            finished(passed, result, passed ? QString()
+                                            : QString("Проверка не пройдена:\n%1").arg(QString::fromLocal8Bit(log.left(MAX_LOG_SIZE))));
+        });
+    });
+}
+
+// Установить префикс имён функций.
+void CodeGenerator::setFunctionName(const QString& name)
+{
+    QByteArray identifier;
+    for (QChar c : name) {
+        const char16_t u = c.unicode();
+        const bool allowed = (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') || u == '_';
+        identifier += allowed ? static_cast<char>(u) : '_';
+    }
+    if (identifier.isEmpty() || (identifier[0] >= '0' && identifier[0] <= '9'))
+        identifier.prepend('_');
+    functionName = identifier;
+}
+
+// Описание последней ошибки.
+QString CodeGenerator::errorString() const
+{
+    return error;
+}
+
+// Размер кода и результат последней проверки.
+CodeGenerator::Statistics CodeGenerator::statistics() const
+{
+    return stats;
+}
+
+// Файл исходного кода по расширению.
+bool CodeGenerator::isSourcePath(const QString& path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == "c" || suffix == "h" || suffix == "cpp" || suffix == "cc" || suffix == "hpp";
+}
+
+// Выбрать вентили для локальных констант и подстановки.
+void CodeGenerator::plan(const LogicGraph& graph)
+{
+    using Kind = LogicGraph::GateKind;
+
+    const int size = graph.size();
+    inputIndex.assign(size, -1);
+    live.assign(size, 0);
+    local.assign(size, 0);
+    for (size_t i = 0; i < graph.inputs().size(); ++i)
+        inputIndex[graph.inputs()[i]] = static_cast<int>(i);
+
+    // Потребители считаются только среди вентилей, влияющих на выходы;
+    // выход тоже считается потребителем.
+    std::vector<int> fanout(size, 0);
+    for (const LogicGraph::Output& output : graph.outputs()) {
+        live[output.gate] = 1;
+        ++fanout[output.gate];
+    }
+    for (int id = size - 1; id >= 0; --id) {
+        if (!live[id])
+            continue;
+        for (int in : graph.gate(id).fanins) {
+            live[in] = 1;
+            ++fanout[in];
+        }
+    }
+
+    stats.gates = 0;
+    stats.locals = 0;
+    stats.inlined = 0;
+    std::vector<int> depth(size, 0);
+    for (int id = 0; id < size; ++id) {
+        const LogicGraph::Gate& gate = graph.gate(id);
+        if (!live[id] || gate.kind == Kind::INPUT || gate.kind == Kind::CONST0 || gate.kind == Kind::CONST1)
+            continue;
+
+        ++stats.gates;
+        int d = 1;
+        for (int in : gate.fanins)
+            d = std::max(d, depth[in] + 1);
+        if (fanout[id] > 1 || d >= MAX_INLINE_DEPTH) {
+            local[id] = 1;
+            ++stats.locals;
+        } else {
+            depth[id] = d;
+            ++stats.inlined;
+        }
+    }
+}
+
+// Выражение вентиля.
+void CodeGenerator::appendExpression(const LogicGraph& graph, int id, QByteArray& out) const
+{
+    using Kind = LogicGraph::GateKind;
+
+    const LogicGraph::Gate& gate = graph.gate(id);
+    const char* op = " & ";
+    switch (gate.kind) {
+    case Kind::CONST0:
+    case Kind::CONST1:
+    case Kind::INPUT:
+        appendOperand(graph, id, out);
+        return;
+    case Kind::NOT:
+        out += '~';
+        appendOperand(graph, gate.fanins.front(), out);
+        return;
+    case Kind::AND:
+        break;
+    case Kind::OR:
+        op = " | ";
+        break;
+    case Kind::XOR:
+        op = " ^ ";
+        break;
+    }
+
+    for (size_t k = 0; k < gate.fanins.size(); ++k) {
+        if (k > 0) {
+            out += op;
+            if (k % OPERANDS_PER_LINE == 0)
+                out += "\n        ";
+        }
+        appendOperand(graph, gate.fanins[k], out);
+    }
+}
+
+// Ссылка на вентиль из выражения потребителя.
+void CodeGenerator::appendOperand(const LogicGraph& graph, int id, QByteArray& out) const
+{
+    using Kind = LogicGraph::GateKind;
+
+    const Kind kind = graph.gate(id).kind;
+    if (kind == Kind::INPUT) {
+        out += "in[" + QByteArray::number(inputIndex[id]) + "]";
+    } else if (kind == Kind::CONST0) {
+        out += "(uint64_t)0";
+    } else if (kind == Kind::CONST1) {
+        out += "UINT64_MAX";
+    } else if (local[id]) {
+        out += "g" + QByteArray::number(id);
+    } else if (kind == Kind::NOT) {
+        appendExpression(graph, id, out);
+    } else {
+        out += '(';
+        appendExpression(graph, id, out);
+        out += ')';
+    }
+}
+
+// Записать блок в устройство.
+bool CodeGenerator::flush(QIODevice* device, QByteArray& buffer)
+{
+    const bool ok = buffer.isEmpty() || device->write(buffer) == buffer.size();
+    buffer.clear();
+    if (!ok)
+        error = QString("Ошибка записи: %1").arg(device->errorString());
+    return ok;
+}
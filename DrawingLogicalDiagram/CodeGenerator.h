@@ -0,0 +1,193 @@
+#ifndef CODEGENERATOR_H
+#define CODEGENERATOR_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QtGlobal>
+#include <functional>
+#include <vector>
+#include "LogicGraph.h"
+
+class QObject;
+class QTemporaryDir;
+
+/**
+ * @class CodeGenerator
+ * @brief Генерация исходного кода C/C++ для вычисления схемы без ветвлений
+ *
+ * Сеть записывается в самодостаточный файл, который компилируется
+ * и как C99, и как C++. В файле три функции с общим префиксом:
+ *
+ *  - `<имя>_eval(in, out)` — 64 набора входов сразу: слово in[i] хранит
+ *    значения входа i, бит k слова — набор k; только операции &, |, ^, ~;
+ *  - `<имя>_eval_batch(in, out, blocks)` — то же для массива блоков
+ *    по `<имя>_INPUTS` и `<имя>_OUTPUTS` слов;
+ *  - `<имя>_eval_packed(in)` — один набор, упакованный в биты слова
+ *    (если входов и выходов не больше 64).
+ *
+ * @details
+ * - Общие подвыражения берутся из структурного хэширования LogicGraph:
+ *   вентиль с несколькими потребителями вычисляется один раз
+ *   в локальную константу `g<индекс>`.
+ * - Вентили с одним потребителем подставляются в выражение потребителя,
+ *   но не глубже MAX_INLINE_DEPTH, чтобы строки оставались короткими.
+ * - Вентили, не влияющие на выходы, не записываются.
+ * - writeTest() пишет проверочную программу с ожидаемыми значениями
+ *   из LogicGraph::evaluate(), verify() компилирует её и запускает.
+ *   verify() ждёт компилятор и программу в вызывающем потоке;
+ *   verifyAsync() запускает те же процессы и сообщает результат
+ *   из цикла событий, не останавливая поток GUI.
+ */
+class CodeGenerator {
+public:
+    /**
+     * @struct Statistics
+     * @brief Размер кода и результат последней проверки
+     */
+    struct Statistics
+    {
+        int gates = 0;          ///< Вентилей, влияющих на выходы
+        int locals = 0;         ///< Локальных констант
+        int inlined = 0;        ///< Подставленных вентилей
+        qint64 vectors = 0;     ///< Проверено наборов входов
+        qint64 compileMs = 0;   ///< Время компиляции проверки, мс
+        qint64 runMs = 0;       ///< Время запуска проверки, мс
+    };
+
+    /**
+     * @brief Обработчик окончания проверки verifyAsync()
+     *
+     * Получает результат, статистику (vectors, compileMs, runMs)
+     * и текст ошибки, если проверка не пройдена.
+     */
+    using VerifyCallback = std::function<void(bool passed, const Statistics& stats, const QString& error)>;
+
+    /**
+     * @brief Записать код в файл
+     * @param path Путь к файлу
+     * @param graph Сеть
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool write(const QString& path, const LogicGraph& graph);
+
+    /**
+     * @brief Записать код в устройство
+     * @param device Открытое на запись устройство
+     * @param graph Сеть
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool write(QIODevice* device, const LogicGraph& graph);
+
+    /**
+     * @brief Записать проверочную программу
+     * @param device Открытое на запись устройство
+     * @param graph Сеть
+     * @param sourceName Имя файла с кодом для #include
+     * @return true при успехе; иначе см. errorString()
+     *
+     * До 16 входов перебираются все наборы, иначе — псевдослучайные.
+     */
+    bool writeTest(QIODevice* device, const LogicGraph& graph, const QString& sourceName);
+
+    /**
+     * @brief Скомпилировать код с проверочной программой и запустить её
+     * @param graph Сеть
+     * @param compiler Компилятор C или C++ (пустая строка — $CC или cc)
+     * @return true, если все наборы совпали с LogicGraph::evaluate()
+     *
+     * Файлы создаются во временном каталоге и удаляются после проверки.
+     */
+    bool verify(const LogicGraph& graph, const QString& compiler = QString());
+
+    /**
+     * @brief Проверить код без ожидания в вызывающем потоке
+     * @param graph Сеть
+     * @param context Владелец процессов: при его удалении проверка
+     *                прерывается и finished не вызывается
+     * @param finished Вызывается из цикла событий по окончании проверки
+     * @param compiler Компилятор C или C++ (пустая строка — $CC или cc)
+     *
+     * Файлы пишутся сразу; компиляция и запуск идут через сигналы
+     * QProcess, зависший процесс завершается по таймауту. Объект
+     * CodeGenerator можно удалить сразу после вызова. Ошибка записи
+     * файлов тоже сообщается через finished.
+     */
+    void verifyAsync(const LogicGraph& graph, QObject* context, const VerifyCallback& finished,
+                     const QString& compiler = QString());
+
+    /**
+     * @brief Установить префикс имён функций
+     * @param name Префикс; недопустимые в C символы заменяются на '_'
+     */
+    void setFunctionName(const QString& name);
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Размер кода и результат последней проверки
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief Файл исходного кода по расширению
+     * @param path Путь к файлу
+     * @return true для *.c, *.h, *.cpp, *.cc, *.hpp
+     */
+    static bool isSourcePath(const QString& path);
+
+private:
+    /**
+     * @brief Выбрать вентили для локальных констант и подстановки
+     * @param graph Сеть
+     */
+    void plan(const LogicGraph& graph);
+
+    /**
+     * @brief Выражение вентиля
+     * @param graph Сеть
+     * @param id Индекс вентиля
+     * @param out Сюда дописывается выражение
+     */
+    void appendExpression(const LogicGraph& graph, int id, QByteArray& out) const;
+
+    /**
+     * @brief Ссылка на вентиль из выражения потребителя
+     * @param graph Сеть
+     * @param id Индекс вентиля
+     * @param out Сюда дописывается ссылка или подставленное выражение
+     */
+    void appendOperand(const LogicGraph& graph, int id, QByteArray& out) const;
+
+    /**
+     * @brief Записать код и проверочную программу во временный каталог
+     * @param graph Сеть
+     * @param dir Временный каталог
+     * @param testPath Сюда записывается путь к проверочной программе
+     * @param program Сюда записывается путь к исполняемому файлу
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool writeCheck(const LogicGraph& graph, const QTemporaryDir& dir, QString& testPath, QString& program);
+
+    /**
+     * @brief Записать блок в устройство
+     * @param device Устройство
+     * @param buffer Блок; очищается после записи
+     * @return false при ошибке записи
+     */
+    bool flush(QIODevice* device, QByteArray& buffer);
+
+    QByteArray functionName = "logic";  ///< Префикс имён функций
+    std::vector<int> inputIndex;        ///< Номер входа для вентиля INPUT
+    std::vector<char> live;             ///< Вентиль влияет на выходы
+    std::vector<char> local;            ///< Вентиль вычисляется в локальную константу
+    QString error;                      ///< Текст последней ошибки
+    Statistics stats;                   ///< Статистика
+};
+
+#endif // CODEGENERATOR_H
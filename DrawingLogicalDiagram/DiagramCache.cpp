@@ -0,0 +1,184 @@
+#include "DiagramCache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+#include <vector>
+
+// Константы.
+static constexpr quint32 CACHE_MAGIC = 0x4C424443;  // "LBDC"
+static constexpr double EVICT_TARGET_RATIO = 0.9;
+static const char* const ENTRY_SUFFIX = ".layout";
+
+// Конструктор кэша.
+DiagramCache::DiagramCache(const QString& directory, qint64 maxBytes)
+    : directory(directory)
+    , maxBytes(maxBytes)
+    , usedBytes(0)
+{
+    if (this->directory.isEmpty())
+        this->directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/diagrams";
+
+    QDir().mkpath(this->directory);
+    scanDirectory();
+}
+
+// Построить ключ записи.
+QByteArray DiagramCache::makeKey(const QString& expression, const QString& options)
+{
+    QString normalized;
+    normalized.reserve(expression.size());
+    for (QChar c : expression) {
+        if (!c.isSpace())
+            normalized.append(c);
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(normalized.toUtf8());
+    hash.addData(QByteArray("\n") + options.toUtf8());
+    hash.addData(QByteArray("\nv") + QByteArray::number(FORMAT_VERSION));
+    return hash.result().toHex();
+}
+
+// Загрузить компоновку из кэша.
+bool DiagramCache::load(const QByteArray& key, DiagramLayout& layout)
+{
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return false;
+
+    QFile file(entryPath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        removeEntry(key);
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+
+    quint32 magic = 0;
+    qint32 version = 0;
+    in >> magic >> version;
+    if (magic != CACHE_MAGIC || version != FORMAT_VERSION) {
+        file.close();
+        removeEntry(key);
+        return false;
+    }
+
+    in >> layout;
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "Повреждённая запись кэша" << key;
+        file.close();
+        removeEntry(key);
+        return false;
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    file.setFileTime(now, QFileDevice::FileModificationTime);
+    it->lastUsed = now.toMSecsSinceEpoch();
+    return true;
+}
+
+// Сохранить компоновку в кэш.
+void DiagramCache::store(const QByteArray& key, const DiagramLayout& layout)
+{
+    QSaveFile file(entryPath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Не удалось открыть запись кэша" << file.fileName();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << CACHE_MAGIC << qint32(FORMAT_VERSION) << layout;
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qDebug() << "Не удалось записать запись кэша" << file.fileName();
+        return;
+    }
+
+    const qint64 size = QFileInfo(entryPath(key)).size();
+    auto it = entries.find(key);
+    if (it != entries.end())
+        usedBytes -= it->size;
+
+    entries.insert(key, Entry{size, QDateTime::currentMSecsSinceEpoch()});
+    usedBytes += size;
+
+    if (usedBytes > maxBytes)
+        evict();
+}
+
+// Удалить все записи кэша.
+void DiagramCache::clear()
+{
+    const QList<QByteArray> keys = entries.keys();
+    for (const QByteArray& key : keys)
+        removeEntry(key);
+}
+
+// Суммарный размер записей кэша.
+qint64 DiagramCache::totalBytes() const
+{
+    return usedBytes;
+}
+
+// Путь к файлу записи.
+QString DiagramCache::entryPath(const QByteArray& key) const
+{
+    return directory + "/" + QString::fromLatin1(key) + ENTRY_SUFFIX;
+}
+
+// Прочитать список записей из каталога.
+void DiagramCache::scanDirectory()
+{
+    entries.clear();
+    usedBytes = 0;
+
+    const QFileInfoList files = QDir(directory).entryInfoList(
+        QStringList() << QString("*") + ENTRY_SUFFIX, QDir::Files);
+
+    for (const QFileInfo& info : files) {
+        const QByteArray key = info.completeBaseName().toLatin1();
+        entries.insert(key, Entry{info.size(), info.lastModified().toMSecsSinceEpoch()});
+        usedBytes += info.size();
+    }
+
+    if (usedBytes > maxBytes)
+        evict();
+}
+
+// Вытеснить давно не использованные записи до лимита.
+void DiagramCache::evict()
+{
+    std::vector<std::pair<qint64, QByteArray>> byAge;
+    byAge.reserve(entries.size());
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+        byAge.emplace_back(it->lastUsed, it.key());
+
+    std::sort(byAge.begin(), byAge.end());
+
+    const qint64 target = static_cast<qint64>(maxBytes * EVICT_TARGET_RATIO);
+    for (const auto& entry : byAge) {
+        if (usedBytes <= target)
+            break;
+        removeEntry(entry.second);
+    }
+}
+
+// Удалить запись.
+void DiagramCache::removeEntry(const QByteArray& key)
+{
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return;
+
+    usedBytes -= it->size;
+    entries.erase(it);
+    QFile::remove(entryPath(key));
+}
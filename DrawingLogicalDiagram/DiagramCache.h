@@ -0,0 +1,122 @@
+#ifndef DIAGRAMCACHE_H
+#define DIAGRAMCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include "DiagramLayout.h"
+
+/**
+ * @class DiagramCache
+ * @brief Дисковый кэш готовых компоновок схем
+ *
+ * Хранит компоновки DiagramLayout в файлах локального каталога кэша.
+ * Ключ записи — хэш нормализованного выражения и параметров
+ * отрисовки; компоновка не зависит от размера окна, поэтому он
+ * в ключ не входит. При попадании в кэш разбор выражения и расчёт
+ * компоновки не выполняются вовсе.
+ *
+ * @details
+ * - Нормализация выражения: удаление пробельных символов
+ *   (разбор SchemaTree их игнорирует).
+ * - Общий объём файлов ограничивается maxBytes; при превышении
+ *   удаляются давно не использованные записи (LRU).
+ * - Время последнего использования хранится во времени изменения
+ *   файла и переживает перезапуск программы.
+ */
+class DiagramCache {
+public:
+    /**
+     * @brief Конструктор кэша
+     * @param directory Каталог кэша (пустая строка — стандартный каталог
+     *        кэша приложения с подкаталогом "diagrams")
+     * @param maxBytes Максимальный суммарный размер записей в байтах
+     */
+    explicit DiagramCache(const QString& directory = QString(),
+                          qint64 maxBytes = DEFAULT_MAX_BYTES);
+
+    /**
+     * @brief Построить ключ записи
+     * @param expression Логическое выражение в том виде, как его ввёл пользователь
+     * @param options Дополнительные параметры отрисовки (по умолчанию пусто)
+     * @return Шестнадцатеричный SHA-256 нормализованных входных данных
+     *
+     * В ключ также входит FORMAT_VERSION, чтобы изменение алгоритма
+     * компоновки не отдавало устаревшие записи.
+     */
+    static QByteArray makeKey(const QString& expression, const QString& options = QString());
+
+    /**
+     * @brief Загрузить компоновку из кэша
+     * @param key Ключ, полученный из makeKey()
+     * @param layout Компоновка для заполнения
+     * @return true при попадании в кэш
+     *
+     * Повреждённые записи удаляются и считаются промахом.
+     */
+    bool load(const QByteArray& key, DiagramLayout& layout);
+
+    /**
+     * @brief Сохранить компоновку в кэш
+     * @param key Ключ, полученный из makeKey()
+     * @param layout Компоновка для сохранения
+     *
+     * После записи при необходимости вытесняет старые записи.
+     */
+    void store(const QByteArray& key, const DiagramLayout& layout);
+
+    /**
+     * @brief Удалить все записи кэша
+     */
+    void clear();
+
+    /**
+     * @brief Суммарный размер записей кэша
+     * @return Размер в байтах
+     */
+    qint64 totalBytes() const;
+
+    static constexpr qint64 DEFAULT_MAX_BYTES = 256LL * 1024 * 1024;  ///< Лимит по умолчанию
+    static constexpr int FORMAT_VERSION = 3;  ///< Версия формата записей и компоновки
+
+private:
+    /**
+     * @struct Entry
+     * @brief Сведения о записи кэша
+     */
+    struct Entry
+    {
+        qint64 size;      ///< Размер файла в байтах
+        qint64 lastUsed;  ///< Время последнего использования (мс с эпохи)
+    };
+
+    /**
+     * @brief Путь к файлу записи
+     * @param key Ключ записи
+     * @return Абсолютный путь
+     */
+    QString entryPath(const QByteArray& key) const;
+
+    /**
+     * @brief Прочитать список записей из каталога
+     */
+    void scanDirectory();
+
+    /**
+     * @brief Вытеснить давно не использованные записи до лимита
+     */
+    void evict();
+
+    /**
+     * @brief Удалить запись
+     * @param key Ключ записи
+     */
+    void removeEntry(const QByteArray& key);
+
+    QString directory;               ///< Каталог кэша
+    qint64 maxBytes;                 ///< Лимит суммарного размера
+    qint64 usedBytes;                ///< Текущий суммарный размер
+    QHash<QByteArray, Entry> entries;  ///< Записи в памяти
+};
+
+#endif // DIAGRAMCACHE_H
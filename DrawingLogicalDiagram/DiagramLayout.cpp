@@ -0,0 +1,265 @@
+#include "DiagramLayout.h"
+#include <QGraphicsRectItem>
+#include <QGraphicsEllipseItem>
+#include <QGraphicsLineItem>
+#include <QGraphicsTextItem>
+#include <QFontInfo>
+#include <QFontMetricsF>
+#include <algorithm>
+
+// Константы.
+static constexpr qreal TEXT_MARGIN = 4.0;  // Поле документа QGraphicsTextItem по умолчанию
+
+// Число для атрибута SVG.
+static QByteArray svgNumber(qreal value)
+{
+    return QByteArray::number(value, 'g', 10);
+}
+
+// Цвет и прозрачность для атрибута SVG.
+static QByteArray svgPaint(const char* attribute, const QColor& color)
+{
+    QByteArray out = QByteArray(" ") + attribute + "=\"" + color.name().toLatin1() + "\"";
+    if (color.alpha() != 255)
+        out += QByteArray(" ") + attribute + "-opacity=\"" + svgNumber(color.alphaF()) + "\"";
+    return out;
+}
+
+// Атрибуты обводки и заливки.
+static QByteArray svgStyle(const QPen& pen, const QBrush* brush)
+{
+    QByteArray out;
+    if (pen.style() == Qt::NoPen) {
+        out += " stroke=\"none\"";
+    } else {
+        out += svgPaint("stroke", pen.color());
+        out += " stroke-width=\"" + svgNumber(pen.widthF() > 0 ? pen.widthF() : 1.0) + "\"";
+        if (pen.style() == Qt::DashLine)
+            out += " stroke-dasharray=\"4 2\"";
+        else if (pen.style() == Qt::DotLine)
+            out += " stroke-dasharray=\"1 2\"";
+    }
+
+    if (!brush)
+        return out;
+    if (brush->style() == Qt::NoBrush)
+        out += " fill=\"none\"";
+    else
+        out += svgPaint("fill", brush->color());
+    return out;
+}
+
+// Снять компоновку с готовой сцены.
+DiagramLayout DiagramLayout::fromScene(const QGraphicsScene* scene)
+{
+    DiagramLayout layout;
+    if (!scene) return layout;
+
+    layout.sceneRect = scene->sceneRect();
+
+    const QList<QGraphicsItem*> items = scene->items(Qt::AscendingOrder);
+    layout.primitives.reserve(items.size());
+
+    for (const QGraphicsItem* item : items) {
+        Primitive p;
+        p.pos = item->pos();
+
+        switch (item->type()) {
+        case QGraphicsRectItem::Type: {
+            auto* rectItem = static_cast<const QGraphicsRectItem*>(item);
+            p.kind = PrimitiveKind::RECT;
+            p.rect = rectItem->rect();
+            p.pen = rectItem->pen();
+            p.brush = rectItem->brush();
+            break;
+        }
+        case QGraphicsEllipseItem::Type: {
+            auto* ellipseItem = static_cast<const QGraphicsEllipseItem*>(item);
+            p.kind = PrimitiveKind::ELLIPSE;
+            p.rect = ellipseItem->rect();
+            p.pen = ellipseItem->pen();
+            p.brush = ellipseItem->brush();
+            break;
+        }
+        case QGraphicsLineItem::Type: {
+            auto* lineItem = static_cast<const QGraphicsLineItem*>(item);
+            p.kind = PrimitiveKind::LINE;
+            p.line = lineItem->line();
+            p.pen = lineItem->pen();
+            break;
+        }
+        case QGraphicsTextItem::Type: {
+            auto* textItem = static_cast<const QGraphicsTextItem*>(item);
+            p.kind = PrimitiveKind::TEXT;
+            p.text = textItem->toPlainText();
+            p.color = textItem->defaultTextColor();
+            p.font = textItem->font();
+            break;
+        }
+        default:
+            continue;
+        }
+
+        layout.primitives.push_back(std::move(p));
+    }
+
+    return layout;
+}
+
+// Построить новую сцену по компоновке.
+QGraphicsScene* DiagramLayout::toScene() const
+{
+    auto* scene = new QGraphicsScene();
+    scene->setSceneRect(sceneRect);
+
+    for (const Primitive& p : primitives) {
+        QGraphicsItem* item = nullptr;
+
+        switch (p.kind) {
+        case PrimitiveKind::RECT:
+            item = scene->addRect(p.rect, p.pen, p.brush);
+            break;
+        case PrimitiveKind::ELLIPSE:
+            item = scene->addEllipse(p.rect, p.pen, p.brush);
+            break;
+        case PrimitiveKind::LINE:
+            item = scene->addLine(p.line, p.pen);
+            break;
+        case PrimitiveKind::TEXT: {
+            auto* textItem = scene->addText(p.text, p.font);
+            textItem->setDefaultTextColor(p.color);
+            item = textItem;
+            break;
+        }
+        }
+
+        if (item)
+            item->setPos(p.pos);
+    }
+
+    return scene;
+}
+
+// Записать компоновку в SVG.
+QByteArray DiagramLayout::toSvg() const
+{
+    QByteArray svg;
+    svg += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    svg += "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" + svgNumber(sceneRect.width())
+         + "\" height=\"" + svgNumber(sceneRect.height()) + "\" viewBox=\""
+         + svgNumber(sceneRect.x()) + ' ' + svgNumber(sceneRect.y()) + ' '
+         + svgNumber(sceneRect.width()) + ' ' + svgNumber(sceneRect.height()) + "\">\n";
+
+    for (const Primitive& p : primitives) {
+        switch (p.kind) {
+        case PrimitiveKind::RECT: {
+            const QRectF r = p.rect.translated(p.pos);
+            svg += "<rect x=\"" + svgNumber(r.x()) + "\" y=\"" + svgNumber(r.y())
+                 + "\" width=\"" + svgNumber(r.width()) + "\" height=\"" + svgNumber(r.height())
+                 + '"' + svgStyle(p.pen, &p.brush) + "/>\n";
+            break;
+        }
+        case PrimitiveKind::ELLIPSE: {
+            const QRectF r = p.rect.translated(p.pos);
+            svg += "<ellipse cx=\"" + svgNumber(r.center().x()) + "\" cy=\"" + svgNumber(r.center().y())
+                 + "\" rx=\"" + svgNumber(r.width() / 2) + "\" ry=\"" + svgNumber(r.height() / 2)
+                 + '"' + svgStyle(p.pen, &p.brush) + "/>\n";
+            break;
+        }
+        case PrimitiveKind::LINE: {
+            const QLineF l = p.line.translated(p.pos);
+            svg += "<line x1=\"" + svgNumber(l.x1()) + "\" y1=\"" + svgNumber(l.y1())
+                 + "\" x2=\"" + svgNumber(l.x2()) + "\" y2=\"" + svgNumber(l.y2())
+                 + '"' + svgStyle(p.pen, nullptr) + "/>\n";
+            break;
+        }
+        case PrimitiveKind::TEXT: {
+            // Текст QGraphicsTextItem начинается после поля документа,
+            // каждая строка — отдельный элемент.
+            const QFontMetricsF metrics(p.font);
+            const QByteArray family = p.font.family().toHtmlEscaped().toUtf8();
+            const QByteArray size = QByteArray::number(QFontInfo(p.font).pixelSize());
+            qreal baseline = p.pos.y() + TEXT_MARGIN + metrics.ascent();
+            for (const QString& line : p.text.split('\n')) {
+                svg += "<text x=\"" + svgNumber(p.pos.x() + TEXT_MARGIN) + "\" y=\"" + svgNumber(baseline)
+                     + "\" font-family=\"" + family + "\" font-size=\"" + size + '"'
+                     + svgPaint("fill", p.color) + " xml:space=\"preserve\">"
+                     + line.toHtmlEscaped().toUtf8() + "</text>\n";
+                baseline += metrics.lineSpacing();
+            }
+            break;
+        }
+        }
+    }
+
+    svg += "</svg>\n";
+    return svg;
+}
+
+// Пустая ли компоновка.
+bool DiagramLayout::isEmpty() const
+{
+    return primitives.empty();
+}
+
+// Записать компоновку в поток.
+QDataStream& operator<<(QDataStream& out, const DiagramLayout& layout)
+{
+    out << layout.sceneRect << quint32(layout.primitives.size());
+
+    for (const DiagramLayout::Primitive& p : layout.primitives) {
+        out << quint8(p.kind) << p.pos;
+
+        switch (p.kind) {
+        case DiagramLayout::PrimitiveKind::RECT:
+        case DiagramLayout::PrimitiveKind::ELLIPSE:
+            out << p.rect << p.pen << p.brush;
+            break;
+        case DiagramLayout::PrimitiveKind::LINE:
+            out << p.line << p.pen;
+            break;
+        case DiagramLayout::PrimitiveKind::TEXT:
+            out << p.text << p.color << p.font;
+            break;
+        }
+    }
+
+    return out;
+}
+
+// Прочитать компоновку из потока.
+QDataStream& operator>>(QDataStream& in, DiagramLayout& layout)
+{
+    quint32 count = 0;
+    in >> layout.sceneRect >> count;
+
+    layout.primitives.clear();
+    layout.primitives.reserve(std::min<quint32>(count, 65536));
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        DiagramLayout::Primitive p;
+        quint8 kind = 0;
+        in >> kind >> p.pos;
+
+        switch (static_cast<DiagramLayout::PrimitiveKind>(kind)) {
+        case DiagramLayout::PrimitiveKind::RECT:
+        case DiagramLayout::PrimitiveKind::ELLIPSE:
+            in >> p.rect >> p.pen >> p.brush;
+            break;
+        case DiagramLayout::PrimitiveKind::LINE:
+            in >> p.line >> p.pen;
+            break;
+        case DiagramLayout::PrimitiveKind::TEXT:
+            in >> p.text >> p.color >> p.font;
+            break;
+        default:
+            in.setStatus(QDataStream::ReadCorruptData);
+            return in;
+        }
+
+        p.kind = static_cast<DiagramLayout::PrimitiveKind>(kind);
+        layout.primitives.push_back(std::move(p));
+    }
+
+    return in;
+}
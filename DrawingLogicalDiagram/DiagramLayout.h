@@ -0,0 +1,112 @@
+#ifndef DIAGRAMLAYOUT_H
+#define DIAGRAMLAYOUT_H
+
+#include <QByteArray>
+#include <QRectF>
+#include <QLineF>
+#include <QPen>
+#include <QBrush>
+#include <QFont>
+#include <QColor>
+#include <QString>
+#include <QDataStream>
+#include <QGraphicsScene>
+#include <vector>
+
+/**
+ * @class DiagramLayout
+ * @brief Готовая компоновка схемы в виде списка графических примитивов
+ *
+ * Хранит результат работы DrawingDiagram: прямоугольники, окружности,
+ * линии и тексты с итоговыми координатами и стилями. По компоновке можно
+ * восстановить QGraphicsScene без повторного разбора выражения
+ * и без повторного расчёта размеров.
+ *
+ * @details
+ * - Снимается со сцены методом fromScene().
+ * - Восстанавливается в новую сцену методом toScene().
+ * - Сериализуется через QDataStream для дискового кэша.
+ * - Записывается в SVG методом toSvg() без построения сцены.
+ */
+class DiagramLayout {
+public:
+    /**
+     * @enum PrimitiveKind
+     * @brief Типы графических примитивов компоновки
+     */
+    enum class PrimitiveKind {
+        RECT,     ///< Прямоугольник
+        ELLIPSE,  ///< Окружность/овал
+        LINE,     ///< Линия
+        TEXT      ///< Текстовая метка
+    };
+
+    /**
+     * @struct Primitive
+     * @brief Один графический примитив схемы
+     */
+    struct Primitive
+    {
+        PrimitiveKind kind;  ///< Тип примитива
+        QRectF rect;         ///< Геометрия прямоугольника/окружности
+        QLineF line;         ///< Геометрия линии
+        QPointF pos;         ///< Позиция элемента на сцене
+        QPen pen;            ///< Обводка
+        QBrush brush;        ///< Заливка
+        QString text;        ///< Текст (для TEXT)
+        QColor color;        ///< Цвет текста (для TEXT)
+        QFont font;          ///< Шрифт текста (для TEXT)
+    };
+
+    /**
+     * @brief Снять компоновку с готовой сцены
+     * @param scene Сцена, построенная DrawingDiagram
+     * @return Компоновка со всеми поддерживаемыми элементами сцены
+     *
+     * Элементы обходятся в порядке возрастания z-порядка,
+     * чтобы при восстановлении наложение совпадало с исходным.
+     */
+    static DiagramLayout fromScene(const QGraphicsScene* scene);
+
+    /**
+     * @brief Построить новую сцену по компоновке
+     * @return Указатель на новую QGraphicsScene
+     */
+    QGraphicsScene* toScene() const;
+
+    /**
+     * @brief Записать компоновку в SVG
+     * @return Документ SVG в UTF-8
+     *
+     * Примитивы пишутся в порядке отрисовки; базовая линия текста
+     * вычисляется по метрикам шрифта, как у QGraphicsTextItem.
+     */
+    QByteArray toSvg() const;
+
+    /**
+     * @brief Пустая ли компоновка
+     * @return true, если примитивов нет
+     */
+    bool isEmpty() const;
+
+    QRectF sceneRect;                   ///< Прямоугольник сцены
+    std::vector<Primitive> primitives;  ///< Примитивы в порядке отрисовки
+};
+
+/**
+ * @brief Записать компоновку в поток
+ * @param out Поток записи
+ * @param layout Компоновка
+ * @return Поток записи
+ */
+QDataStream& operator<<(QDataStream& out, const DiagramLayout& layout);
+
+/**
+ * @brief Прочитать компоновку из потока
+ * @param in Поток чтения
+ * @param layout Компоновка для заполнения
+ * @return Поток чтения (status() != Ok при повреждённых данных)
+ */
+QDataStream& operator>>(QDataStream& in, DiagramLayout& layout);
+
+#endif // DIAGRAMLAYOUT_H
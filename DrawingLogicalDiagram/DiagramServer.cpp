@@ -0,0 +1,376 @@
+#include "DiagramServer.h"
+#include "DiagramCache.h"
+#include "DrawingDiagram.h"
+#include "GraphDiagram.h"
+#include "ModelCounter.h"
+#include "ParallelParser.h"
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLocalSocket>
+#include <QPainter>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <vector>
+
+// Константы.
+static constexpr qint64 MAX_REQUEST_BYTES = 64LL * 1024 * 1024;
+static constexpr int PROBE_TIMEOUT_MS = 200;
+static constexpr qint64 NODE_BYTES = sizeof(SchemaTree::Node) + 32;
+static constexpr qint64 GATE_BYTES = sizeof(LogicGraph::Gate) + 64;
+
+// Число узлов дерева.
+static qint64 countNodes(const SchemaTree::Node* root)
+{
+    qint64 count = 0;
+    std::vector<const SchemaTree::Node*> stack;
+    if (root)
+        stack.push_back(root);
+    while (!stack.empty()) {
+        const SchemaTree::Node* node = stack.back();
+        stack.pop_back();
+        ++count;
+        for (const auto& child : node->children)
+            stack.push_back(child.get());
+    }
+    return count;
+}
+
+// Конструктор.
+DiagramServer::DiagramServer(int maxEntries, qint64 maxBytes, QObject* parent)
+    : QObject(parent)
+    , maxEntries(std::max(1, maxEntries))
+    , maxBytes(maxBytes)
+{
+    connect(&server, &QLocalServer::newConnection, this, &DiagramServer::acceptConnections);
+}
+
+// Начать приём соединений.
+bool DiagramServer::listen(const QString& name)
+{
+    error.clear();
+    if (server.listen(name))
+        return true;
+
+    // Сокет мог остаться от упавшего процесса: удаляется,
+    // только если на нём никто не отвечает.
+    if (server.serverError() == QAbstractSocket::AddressInUseError) {
+        QLocalSocket probe;
+        probe.connectToServer(name);
+        if (probe.waitForConnected(PROBE_TIMEOUT_MS)) {
+            error = QString("Служба %1 уже запущена").arg(name);
+            return false;
+        }
+        QLocalServer::removeServer(name);
+        if (server.listen(name))
+            return true;
+    }
+
+    error = QString("Не удалось открыть сокет %1: %2").arg(name, server.errorString());
+    return false;
+}
+
+// Полное имя сокета.
+QString DiagramServer::serverName() const
+{
+    return server.fullServerName();
+}
+
+// Описание последней ошибки.
+QString DiagramServer::errorString() const
+{
+    return error;
+}
+
+// Счётчики службы.
+DiagramServer::Statistics DiagramServer::statistics() const
+{
+    return stats;
+}
+
+// Принять новые соединения.
+void DiagramServer::acceptConnections()
+{
+    while (QLocalSocket* socket = server.nextPendingConnection()) {
+        ++stats.connections;
+        connect(socket, &QLocalSocket::readyRead, this, &DiagramServer::readRequests);
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+// Прочитать и выполнить готовые строки запросов соединения.
+void DiagramServer::readRequests()
+{
+    auto* socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket)
+        return;
+
+    // Ответы пакета собираются в один буфер и пишутся одной записью.
+    QByteArray replies;
+    while (socket->canReadLine()) {
+        QByteArray line = socket->readLine();
+        while (line.endsWith('\n') || line.endsWith('\r'))
+            line.chop(1);
+        replies += handleRequest(line);
+    }
+
+    if (!socket->canReadLine() && socket->bytesAvailable() > MAX_REQUEST_BYTES) {
+        replies += failure(QString("Запрос длиннее %1 байт").arg(MAX_REQUEST_BYTES));
+        socket->write(replies);
+        socket->disconnectFromServer();
+        return;
+    }
+
+    if (!replies.isEmpty())
+        socket->write(replies);
+}
+
+// Выполнить один запрос.
+QByteArray DiagramServer::handleRequest(const QByteArray& line)
+{
+    QElapsedTimer timer;
+    timer.start();
+    ++stats.requests;
+
+    const int space = line.indexOf(' ');
+    const QByteArray command = (space < 0 ? line : line.left(space)).toUpper();
+    QByteArray argument = space < 0 ? QByteArray() : line.mid(space + 1);
+
+    QByteArray response;
+    if (command == "PING") {
+        response = reply(QByteArray());
+    } else if (command == "INFO") {
+        response = reply("requests=" + QByteArray::number(stats.requests)
+                         + "\nerrors=" + QByteArray::number(stats.errors)
+                         + "\nhits=" + QByteArray::number(stats.hits)
+                         + "\nmisses=" + QByteArray::number(stats.misses)
+                         + "\nevictions=" + QByteArray::number(stats.evictions)
+                         + "\nconnections=" + QByteArray::number(stats.connections)
+                         + "\nentries=" + QByteArray::number(stats.entries)
+                         + "\nbytes=" + QByteArray::number(stats.bytes)
+                         + "\nbusy_us=" + QByteArray::number(stats.busyUs) + "\n");
+    } else if (command == "PNG" || command == "SVG" || command == "STATS" || command == "EVAL") {
+        QByteArray assignments;
+        if (command == "EVAL") {
+            const int end = argument.indexOf(' ');
+            assignments = end < 0 ? argument : argument.left(end);
+            argument = end < 0 ? QByteArray() : argument.mid(end + 1);
+        }
+
+        const qint64 missesBefore = stats.misses;
+        QString message;
+        Entry* entry = lookup(QString::fromUtf8(argument), message);
+        if (!entry) {
+            response = failure(message);
+        } else if (command == "EVAL") {
+            const QByteArray values = evaluate(entry->graph, assignments, message);
+            response = values.isEmpty() ? failure(message) : reply(values);
+            if (!values.isEmpty() && stats.misses == missesBefore)
+                ++stats.hits;
+        } else {
+            QByteArray* cached = command == "PNG" ? &entry->png : command == "SVG" ? &entry->svg : &entry->stats;
+            if (!cached->isEmpty()) {
+                ++stats.hits;
+            } else {
+                if (command == "PNG")
+                    *cached = renderPng(*entry);
+                else if (command == "SVG")
+                    *cached = layoutOf(*entry).toSvg();
+                else
+                    *cached = truthTableStats(entry->graph);
+                updateSize(*entry);
+            }
+            response = cached->isEmpty() ? failure("Не удалось построить изображение") : reply(*cached);
+        }
+    } else {
+        response = failure(QString("Неизвестная команда %1").arg(QString::fromUtf8(command)));
+    }
+
+    stats.busyUs += timer.nsecsElapsed() / 1000;
+    return response;
+}
+
+// Найти или создать запись выражения.
+DiagramServer::Entry* DiagramServer::lookup(const QString& text, QString& message)
+{
+    const QByteArray key = DiagramCache::makeKey(text, "server");
+    auto found = index.find(key);
+    if (found != index.end()) {
+        entries.splice(entries.begin(), entries, found.value());
+        return &entries.front();
+    }
+
+    ++stats.misses;
+    Entry entry;
+    entry.key = key;
+    if (LogicGraph::isEquationList(text)) {
+        entry.graph = LogicGraph::fromEquations(text, &message);
+        if (!message.isEmpty())
+            return nullptr;
+    } else {
+        entry.tree = ParallelParser::makeTree(text);
+        if (!entry.tree->getRoot()) {
+            message = "Пустое выражение";
+            return nullptr;
+        }
+        entry.graph = LogicGraph::fromTree(entry.tree->getRoot(), "Y");
+    }
+
+    entries.push_front(std::move(entry));
+    index.insert(key, entries.begin());
+    ++stats.entries;
+    updateSize(entries.front());
+    return &entries.front();
+}
+
+// Компоновка записи.
+const DiagramLayout& DiagramServer::layoutOf(Entry& entry)
+{
+    if (!entry.layout) {
+        QGraphicsScene* scene = nullptr;
+        if (entry.tree) {
+            DrawingDiagram diagram(entry.tree->getRoot());
+            scene = diagram.buildScene();
+        } else {
+            GraphDiagram diagram(entry.graph);
+            scene = diagram.buildScene();
+        }
+        entry.layout = std::make_unique<DiagramLayout>(DiagramLayout::fromScene(scene));
+        delete scene;
+    }
+    return *entry.layout;
+}
+
+// Изображение схемы в PNG.
+QByteArray DiagramServer::renderPng(Entry& entry)
+{
+    QGraphicsScene* scene = layoutOf(entry).toScene();
+    QImage image(scene->sceneRect().size().toSize(), QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    scene->render(&painter);
+    painter.end();
+    delete scene;
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "PNG"))
+        return QByteArray();
+    return data;
+}
+
+// Описание таблицы истинности.
+QByteArray DiagramServer::truthTableStats(const LogicGraph& graph)
+{
+    const int inputs = static_cast<int>(graph.inputs().size());
+    QByteArray out = "inputs=" + QByteArray::number(inputs)
+                   + "\noutputs=" + QByteArray::number(qulonglong(graph.outputs().size()))
+                   + "\ngates=" + QByteArray::number(graph.size())
+                   + "\nrows=" + BigUInt::powerOfTwo(inputs).toString().toUtf8()
+                   + "\n";
+
+    // Число единиц считается без перебора строк, поэтому оно точное
+    // при любом числе входов; перебор 2^n строк здесь не нужен.
+    ModelCounter counter;
+    if (!counter.count(graph))
+        return out + "counted=0\n";
+
+    out += "counted=1\n";
+    for (size_t o = 0; o < graph.outputs().size(); ++o) {
+        const QByteArray name = graph.outputs()[o].name.toUtf8();
+        out += "ones." + name + '=' + counter.modelCount(static_cast<int>(o)).toString().toUtf8() + '\n';
+        out += "probability." + name + '=' + QByteArray::number(counter.outputProbability(static_cast<int>(o)), 'g', 17) + '\n';
+    }
+    return out;
+}
+
+// Вычислить выходы на одном наборе входов.
+QByteArray DiagramServer::evaluate(const LogicGraph& graph, const QByteArray& assignments, QString& message)
+{
+    const std::vector<int>& inputs = graph.inputs();
+    std::vector<quint64> words(inputs.size(), 0);
+    std::vector<char> assigned(inputs.size(), 0);
+    std::vector<int> position(graph.size(), -1);
+    for (size_t i = 0; i < inputs.size(); ++i)
+        position[inputs[i]] = static_cast<int>(i);
+
+    for (const QByteArray& item : assignments.split(',')) {
+        if (item.isEmpty())
+            continue;
+        const int eq = item.indexOf('=');
+        const QByteArray value = eq < 0 ? QByteArray() : item.mid(eq + 1);
+        if (value != "0" && value != "1") {
+            message = QString("Неверное значение входа: %1").arg(QString::fromUtf8(item));
+            return QByteArray();
+        }
+
+        const QString name = QString::fromUtf8(item.left(eq));
+        const int id = graph.findInput(name);
+        if (id < 0) {
+            message = QString("Нет входа %1").arg(name);
+            return QByteArray();
+        }
+        words[position[id]] = value == "1" ? 1 : 0;
+        assigned[position[id]] = 1;
+    }
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!assigned[i]) {
+            message = QString("Не задан вход %1").arg(graph.inputName(inputs[i]));
+            return QByteArray();
+        }
+    }
+
+    const std::vector<quint64> values = graph.evaluate(words);
+    QByteArray out;
+    for (size_t o = 0; o < values.size(); ++o)
+        out += graph.outputs()[o].name.toUtf8() + '=' + QByteArray::number(values[o] & 1) + '\n';
+    if (out.isEmpty())
+        message = "Сеть без выходов";
+    return out;
+}
+
+// Пересчитать оценку памяти записи и вытеснить лишние записи.
+void DiagramServer::updateSize(Entry& entry)
+{
+    qint64 bytes = entry.key.size() + entry.png.size() + entry.svg.size() + entry.stats.size();
+    if (entry.tree)
+        bytes += countNodes(entry.tree->getRoot()) * NODE_BYTES;
+    bytes += qint64(entry.graph.size()) * GATE_BYTES;
+    if (entry.layout) {
+        bytes += qint64(entry.layout->primitives.size()) * qint64(sizeof(DiagramLayout::Primitive));
+        for (const DiagramLayout::Primitive& p : entry.layout->primitives)
+            bytes += p.text.size() * qint64(sizeof(QChar));
+    }
+    stats.bytes += bytes - entry.bytes;
+    entry.bytes = bytes;
+
+    // Запись, с которой сейчас работают, стоит в начале списка
+    // и не вытесняется, даже если одна превышает лимит.
+    while (entries.size() > 1 && (stats.entries > maxEntries || stats.bytes > maxBytes)) {
+        const Entry& victim = entries.back();
+        stats.bytes -= victim.bytes;
+        index.remove(victim.key);
+        entries.pop_back();
+        --stats.entries;
+        ++stats.evictions;
+    }
+}
+
+// Ответ об успехе.
+QByteArray DiagramServer::reply(const QByteArray& payload)
+{
+    return "OK " + QByteArray::number(payload.size()) + '\n' + payload;
+}
+
+// Ответ об ошибке.
+QByteArray DiagramServer::failure(const QString& message)
+{
+    ++stats.errors;
+    QString text = message;
+    text.replace('\n', ' ');
+    return "ERR " + text.toUtf8() + '\n';
+}
@@ -0,0 +1,217 @@
+#ifndef DIAGRAMSERVER_H
+#define DIAGRAMSERVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QLocalServer>
+#include <QObject>
+#include <QString>
+#include <QtGlobal>
+#include <list>
+#include <memory>
+#include "DiagramLayout.h"
+#include "LogicGraph.h"
+#include "SchemaTree.h"
+
+/**
+ * @class DiagramServer
+ * @brief Служба построения схем на локальном сокете
+ *
+ * Долгоживущий процесс принимает запросы по локальному сокету
+ * (сокет Unix или именованный канал Windows), поэтому запуск Qt,
+ * загрузка шрифтов и разбор повторяющихся выражений оплачиваются
+ * один раз. Разобранные деревья, сети, компоновки и готовые ответы
+ * хранятся в памяти в кэше LRU.
+ *
+ * Протокол — строки запросов и ответы с длиной:
+ * @code
+ * PNG <выражение>            → OK <байт>\n<изображение PNG>
+ * SVG <выражение>            → OK <байт>\n<документ SVG>
+ * STATS <выражение>          → OK <байт>\n<входы, выходы, число единиц>
+ * EVAL A=1,B=0 <выражение>   → OK <байт>\n<значения выходов>
+ * INFO                       → OK <байт>\n<статистика службы>
+ * PING                       → OK 0\n
+ * ошибка                     → ERR <описание>\n
+ * @endcode
+ *
+ * @details
+ * - Выражение — остаток строки: одно выражение или список уравнений
+ *   через ';' (как в поле ввода).
+ * - Пакет запросов — несколько строк за одну запись; ответы идут
+ *   в порядке запросов.
+ * - Ключ кэша — DiagramCache::makeKey(), поэтому выражения,
+ *   отличающиеся только пробелами, попадают в одну запись.
+ * - Компоновка и ответы каждого вида строятся при первом запросе
+ *   и хранятся в записи; запись вытесняется целиком.
+ * - Запросы выполняются в потоке цикла событий: сцены Qt строятся
+ *   только в нём.
+ */
+class DiagramServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @struct Statistics
+     * @brief Счётчики службы за всё время работы
+     */
+    struct Statistics
+    {
+        qint64 requests = 0;    ///< Выполнено запросов
+        qint64 errors = 0;      ///< Ответов с ошибкой
+        qint64 hits = 0;        ///< Ответов из кэша без вычислений
+        qint64 misses = 0;      ///< Разборов выражения
+        qint64 evictions = 0;   ///< Вытеснено записей
+        qint64 connections = 0; ///< Принято соединений
+        int entries = 0;        ///< Записей в кэше
+        qint64 bytes = 0;       ///< Оценка памяти записей, байт
+        qint64 busyUs = 0;      ///< Суммарное время обработки запросов, мкс
+    };
+
+    /**
+     * @brief Конструктор
+     * @param maxEntries Предельное число записей кэша
+     * @param maxBytes Предельная оценка памяти записей в байтах
+     * @param parent Родительский объект
+     */
+    explicit DiagramServer(int maxEntries = DEFAULT_MAX_ENTRIES,
+                           qint64 maxBytes = DEFAULT_MAX_BYTES,
+                           QObject* parent = nullptr);
+
+    /**
+     * @brief Начать приём соединений
+     * @param name Имя локального сокета
+     * @return true при успехе; иначе см. errorString()
+     *
+     * Оставшийся после аварийного завершения сокет удаляется,
+     * если на нём никто не отвечает.
+     */
+    bool listen(const QString& name);
+
+    /**
+     * @brief Полное имя сокета, на котором принимаются соединения
+     * @return Путь сокета или имя канала
+     */
+    QString serverName() const;
+
+    /**
+     * @brief Выполнить один запрос
+     * @param line Строка запроса без перевода строки
+     * @return Ответ вместе с заголовком "OK <байт>\n" или "ERR …\n"
+     */
+    QByteArray handleRequest(const QByteArray& line);
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Счётчики службы
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+    static constexpr int DEFAULT_MAX_ENTRIES = 1024;                ///< Лимит записей по умолчанию
+    static constexpr qint64 DEFAULT_MAX_BYTES = 512LL * 1024 * 1024;  ///< Лимит памяти по умолчанию
+
+private slots:
+    /**
+     * @brief Принять новые соединения
+     */
+    void acceptConnections();
+
+    /**
+     * @brief Прочитать и выполнить готовые строки запросов соединения
+     */
+    void readRequests();
+
+private:
+    /**
+     * @struct Entry
+     * @brief Запись кэша: разобранное выражение и готовые ответы
+     */
+    struct Entry
+    {
+        QByteArray key;                       ///< Ключ DiagramCache::makeKey()
+        std::unique_ptr<SchemaTree> tree;     ///< Дерево (для выражения с одним выходом)
+        LogicGraph graph;                     ///< Сеть выражения
+        std::unique_ptr<DiagramLayout> layout;  ///< Компоновка схемы
+        QByteArray png;                       ///< Ответ PNG
+        QByteArray svg;                       ///< Ответ SVG
+        QByteArray stats;                     ///< Ответ STATS
+        qint64 bytes = 0;                     ///< Оценка памяти записи
+    };
+
+    /**
+     * @brief Найти или создать запись выражения
+     * @param text Выражение или список уравнений
+     * @param message Сюда записывается описание ошибки разбора
+     * @return Запись в начале списка LRU или nullptr при ошибке
+     */
+    Entry* lookup(const QString& text, QString& message);
+
+    /**
+     * @brief Компоновка записи (строится при первом обращении)
+     * @param entry Запись
+     * @return Компоновка
+     */
+    const DiagramLayout& layoutOf(Entry& entry);
+
+    /**
+     * @brief Изображение схемы в PNG
+     * @param entry Запись
+     * @return Данные PNG или пустой массив при ошибке
+     */
+    QByteArray renderPng(Entry& entry);
+
+    /**
+     * @brief Описание таблицы истинности
+     * @param graph Сеть
+     * @return Строки "ключ=значение"
+     *
+     * Число единиц и вероятность единицы каждого выхода считает
+     * ModelCounter точно, без перебора строк.
+     */
+    static QByteArray truthTableStats(const LogicGraph& graph);
+
+    /**
+     * @brief Вычислить выходы на одном наборе входов
+     * @param graph Сеть
+     * @param assignments Набор вида "A=1,B=0"
+     * @param message Сюда записывается описание ошибки
+     * @return Строки "выход=значение" или пустой массив при ошибке
+     */
+    static QByteArray evaluate(const LogicGraph& graph, const QByteArray& assignments, QString& message);
+
+    /**
+     * @brief Пересчитать оценку памяти записи и вытеснить лишние записи
+     * @param entry Изменённая запись
+     */
+    void updateSize(Entry& entry);
+
+    /**
+     * @brief Ответ об успехе
+     * @param payload Данные ответа
+     * @return Заголовок и данные
+     */
+    static QByteArray reply(const QByteArray& payload);
+
+    /**
+     * @brief Ответ об ошибке
+     * @param message Описание ошибки
+     * @return Строка ошибки
+     */
+    QByteArray failure(const QString& message);
+
+    QLocalServer server;                  ///< Локальный сервер
+    int maxEntries;                       ///< Лимит записей
+    qint64 maxBytes;                      ///< Лимит памяти записей
+    std::list<Entry> entries;             ///< Записи, недавно использованные — в начале
+    QHash<QByteArray, std::list<Entry>::iterator> index;  ///< Запись по ключу
+    QString error;                        ///< Текст последней ошибки
+    Statistics stats;                     ///< Счётчики службы
+};
+
+#endif // DIAGRAMSERVER_H
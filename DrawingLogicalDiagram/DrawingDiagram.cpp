@@ -1,5 +1,6 @@
 #include "DrawingDiagram.h"
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QGraphicsRectItem>
 #include <QGraphicsLineItem>
 #include <QGraphicsTextItem>
@@ -12,339 +13,451 @@
 static constexpr qreal DEFAULT_SCENE_W = 800.0;
 static constexpr qreal DEFAULT_SCENE_H = 600.0;
 static constexpr qreal SCENE_MARGIN = 50.0;
-static constexpr qreal WIDTH_FACTOR_DEFAULT = 2.0;
-static constexpr qreal DIAMETER_COEFF = 0.4;
-static constexpr qreal BOXSIZE_COEFF = 0.35;
-static constexpr qreal MIN_BOX_SIZE = 10.0;
+static constexpr qreal GATE_WIDTH = 60.0;
+static constexpr qreal PIN_PITCH = 20.0;
+static constexpr qreal GATE_GAP = 20.0;
+static constexpr qreal ROUTE_GAP = 80.0;
+static constexpr qreal NOT_DIAMETER = 10.0;
+static constexpr qreal BOX_SIZE = 10.0;
 static constexpr qreal OUTPUT_LINE_LEN = 100.0;
-static constexpr qreal CENTRAL_RECT_RIGHT_TEXT_OFFSET = 5.0;
 static constexpr qreal RECT_TEXT_PADDING = 5.0;
+static constexpr qreal TEXT_OFFSET = 10.0;
 static constexpr qreal LETTER_TEXT_OFFSET_Y = 25.0;
-static constexpr qreal VAR_TEXT_OFFSET_X = 105.0;
-static constexpr qreal VAR_TEXT_NUMBER_OFFSET = 10.0;
+static constexpr qreal HIGHLIGHT_PEN_WIDTH = 3.0;
+static constexpr int SUMMARY_PINS = 1;
 
 // Конструктор класса DrawingDiagram.
-DrawingDiagram::DrawingDiagram(const SchemaTree::Node* root, QGraphicsView* view, QObject* parent)
+DrawingDiagram::DrawingDiagram(const SchemaTree::Node* root, QObject* parent)
     : QObject(parent)
-    , varLevelX(0)
     , root(root)
-    , view(view)
-    , sceneWidth(0)
-    , sceneHeight(0)
+    , maxDepth(0)
+    , maxInversions(0)
 {}
 
-// Добавляет текст в сцену.
-QGraphicsTextItem* DrawingDiagram::addText(QGraphicsScene* scene, const QString& txt, const QColor& color)
+// Задать узлы для подсветки.
+void DrawingDiagram::setHighlightedNodes(const QSet<const SchemaTree::Node*>& nodes)
 {
-    auto* item = scene->addText(txt);
-    item->setDefaultTextColor(color);
-    return item;
+    highlighted = nodes;
 }
 
-// Добавляет прямоугольник в сцену.
-void DrawingDiagram::addRectRaw(QGraphicsScene* scene, qreal x, qreal y, qreal w, qreal h, const QPen& pen, const QBrush& brush)
+// Задать индекс поиска.
+void DrawingDiagram::setSearchIndex(SearchIndex* index)
 {
-    scene->addRect(x, y, w, h, pen, brush);
+    searchIndex = index;
 }
-// Добавляет окружность/овал в сцену.
-void DrawingDiagram::addEllipseRaw(QGraphicsScene* scene, qreal x, qreal y, qreal w, qreal h, const QPen& pen)
+
+// Задать свёрнутые и раскрытые поддеревья.
+void DrawingDiagram::setExpansion(const Expansion& expansion)
 {
-    scene->addEllipse(x, y, w, h, pen);
+    this->expansion = expansion;
 }
 
-// Добавляет линию в сцену.
-void DrawingDiagram::addLineRaw(QGraphicsScene* scene, qreal x1, qreal y1, qreal x2, qreal y2, const QPen& pen)
+// Объём и время последнего построения сцены.
+DrawingDiagram::Statistics DrawingDiagram::statistics() const
+{
+    return stats;
+}
+
+// Перо для элемента узла с учётом подсветки.
+QPen DrawingDiagram::nodePen(const SchemaTree::Node* node, const QPen& pen) const
+{
+    if (!highlighted.contains(node))
+        return pen;
+    return QPen(Qt::red, std::max(pen.widthF(), HIGHLIGHT_PEN_WIDTH));
+}
+
+// Добавляет текст в сцену.
+QGraphicsTextItem* DrawingDiagram::addText(QGraphicsScene* scene, const QString& txt, const QColor& color)
 {
-    scene->addLine(x1, y1, x2, y2, pen);
+    auto* item = scene->addText(txt);
+    item->setDefaultTextColor(color);
+    return item;
 }
 
-// Вычисляет размер квадрата/прямоугольника на основе коэффициента.
-qreal DrawingDiagram::computeBoxSize(qreal coefficient) const
+// Записать элемент узла в индекс поиска.
+void DrawingDiagram::indexItem(const SchemaTree::Node* node, QGraphicsItem* item)
 {
-    qreal boxSize = coefficient * BOXSIZE_COEFF;
-    return (boxSize < MIN_BOX_SIZE) ? MIN_BOX_SIZE : boxSize;
+    if (searchIndex)
+        searchIndex->addItem(node, item);
 }
 
 // Построить QGraphicsScene и вернуть её.
 QGraphicsScene* DrawingDiagram::buildScene()
 {
     auto* scene = new QGraphicsScene();
-
-    if (view) {
-        QSize viewSize = view->viewport()->size();
-        sceneWidth = viewSize.width();
-        sceneHeight = viewSize.height();
-    } else {
-        sceneWidth = DEFAULT_SCENE_W;
-        sceneHeight = DEFAULT_SCENE_H;
-    }
-
-    scene->setSceneRect(0, 0, sceneWidth, sceneHeight);
+    stats = Statistics();
 
     if (!root) {
         qDebug() << "Корень дерева не задан";
+        scene->setSceneRect(0, 0, DEFAULT_SCENE_W, DEFAULT_SCENE_H);
         return scene;
     }
 
-    bool isGlobalNot = (root->type == NodeType::NOT);
-    const SchemaTree::Node* centralNode = isGlobalNot ? root->children[0].get() : root;
-
-    int totalNodes = countAllNodes(centralNode);
-    if (totalNodes <= 0) {
-        qDebug() << "Нет узлов для отрисовки";
-        return scene;
-    }
-
-    qreal coefficient = (sceneHeight - SCENE_MARGIN) / totalNodes;
-    qreal widthFactor = WIDTH_FACTOR_DEFAULT;
-    qreal widthCoefficient = coefficient * widthFactor;
-    int treeDepth = calculateHeight(centralNode);
-
-    qreal centralHeight = totalNodes * coefficient;
-    qreal centralWidth = treeDepth * widthCoefficient;
-
-    qreal centerX = sceneWidth / 2.0;
-    qreal centerY = sceneHeight / 2.0;
-    qreal rectX = centerX - centralWidth / 2.0;
-    qreal rectY = centerY - centralHeight / 2.0;
+    QElapsedTimer timer;
+    timer.start();
 
-    varLevelX = rectX - 100.0;
-    qreal rightmostX = rectX + centralWidth;
+    buildCells();
+    layoutCells();
 
-    drawCentralRectAndMaybeGlobalNot(scene, centralNode, isGlobalNot, rectX, rectY, centralWidth, centralHeight, coefficient, widthFactor, rightmostX);
-
-    if (centralNode->type == NodeType::VAR) {
-        auto* text = addText(scene, centralNode->value, Qt::green);
-        qreal textW = text->boundingRect().width();
-        qreal textH = text->boundingRect().height();
-        text->setPos(rectX + centralWidth / 2.0 - textW / 2.0, centerY - textH / 2.0);
+    std::vector<int> leaves;
+    for (int i = 0; i < static_cast<int>(cells.size()); ++i) {
+        if (cells[i].collapsed)
+            drawSummary(scene, i);
+        else if (cells[i].node->type == NodeType::OP)
+            drawGate(scene, i);
+        else
+            leaves.push_back(i);
     }
-    else if (centralNode->type == NodeType::OP) {
-        auto* opText = addText(scene, centralNode->value, Qt::blue);
-        qreal opW = opText->boundingRect().width();
-        opText->setPos(rectX + centralWidth - opW - RECT_TEXT_PADDING, rectY + RECT_TEXT_PADDING);
-
-        int totalChildNodes = totalNodes - 1;
-        qreal currentY = rectY;
-        qreal childConnectX = rectX;
-        for (const auto& ch : centralNode->children) {
-            int childCount = countAllNodes(ch.get());
-            qreal childAlloc = (totalChildNodes > 0)
-                                   ? (static_cast<qreal>(childCount) / totalChildNodes) * centralHeight
-                                   : centralHeight;
-            qreal childConnectY = currentY + childAlloc / 2.0;
-            drawNode(scene, ch.get(), childConnectX, childConnectY, childAlloc, coefficient, treeDepth, 1, widthFactor);
-            currentY += childAlloc;
-        }
+
+    // Переменные нумеруются сверху вниз.
+    std::stable_sort(leaves.begin(), leaves.end(),
+                     [this](int a, int b) { return cells[a].y < cells[b].y; });
+    for (int i : leaves)
+        drawVariable(scene, i);
+
+    qreal top = cells.front().y;
+    qreal bottom = cells.front().y;
+    for (const Cell& cell : cells) {
+        top = std::min(top, cell.y - cell.size / 2.0);
+        bottom = std::max(bottom, cell.y + cell.size / 2.0);
     }
 
-    drawOutputGroup(scene, rightmostX, centerY, coefficient);
+    const Cell& output = cells.front();
+    const qreal rightmostX = columnX(0) + GATE_WIDTH + output.inversions * NOT_DIAMETER;
+    drawInversions(scene, output, rightmostX, output.y);
+    drawOutputGroup(scene, rightmostX, output.y, top, bottom);
+
+    scene->setSceneRect(scene->itemsBoundingRect().adjusted(-SCENE_MARGIN, -SCENE_MARGIN,
+                                                            SCENE_MARGIN, SCENE_MARGIN));
 
+    stats.cells = static_cast<int>(cells.size());
+    stats.elapsedUs = timer.nsecsElapsed() / 1000;
     return scene;
 }
 
-// Рисует центральный прямоугольник и глобальный NOT при необходимости.
-void DrawingDiagram::drawCentralRectAndMaybeGlobalNot(QGraphicsScene* scene,
-                                                      const SchemaTree::Node* centralNode,
-                                                      bool isGlobalNot,
-                                                      qreal rectX, qreal rectY,
-                                                      qreal centralWidth, qreal centralHeight,
-                                                      qreal coefficient,
-                                                      qreal widthFactor,
-                                                      qreal& rightmostX)
+// Построить элементы компоновки обходом в ширину.
+void DrawingDiagram::buildCells()
 {
-    addRectRaw(scene, rectX, rectY, centralWidth, centralHeight, QPen(Qt::darkBlue, 1), QBrush(Qt::NoBrush));
-
-    qreal diameter = coefficient * DIAMETER_COEFF * widthFactor;
+    cells.clear();
+    maxDepth = 0;
+    maxInversions = 0;
+
+    auto addCell = [this](const SchemaTree::Node* src, int parent, int depth, int number) {
+        Cell cell;
+        cell.edge = src;
+        while (src->type == NodeType::NOT && !src->children.empty()) {
+            src = src->children.front().get();
+            ++cell.inversions;
+        }
+        cell.node = src;
+        cell.parent = parent;
+        cell.depth = depth;
+        cell.number = number;
+        cell.ancestor = static_cast<int>(cells.size());
+        cells.push_back(cell);
+    };
+
+    // Дети свёрнутого оператора не попадают в обход, поэтому его
+    // поддерево не просматривается вовсе.
+    addCell(root, -1, 0, 0);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        const SchemaTree::Node* node = cells[i].node;
+        const int depth = cells[i].depth;
+        const bool isOp = node->type == NodeType::OP;
+        const bool collapsed = isOp
+            && ((expansion.depth > 0 && depth >= expansion.depth) != expansion.toggled.contains(node));
+        const int childCount = isOp && !collapsed ? static_cast<int>(node->children.size()) : 0;
+
+        cells[i].firstChild = static_cast<int>(cells.size());
+        cells[i].childCount = childCount;
+        cells[i].collapsed = collapsed;
+        if (collapsed) {
+            cells[i].size = (SUMMARY_PINS + 1) * PIN_PITCH;
+            ++stats.collapsed;
+        } else {
+            cells[i].size = isOp ? (childCount + 1) * PIN_PITCH : PIN_PITCH;
+        }
+        maxDepth = std::max(maxDepth, depth);
+        if (i > 0)
+            maxInversions = std::max(maxInversions, cells[i].inversions);
 
-    if (isGlobalNot) {
-        qreal circleX = rectX + centralWidth;
-        qreal circleY = (rectY + rectY + centralHeight) / 2.0 - diameter / 2.0;
-        addEllipseRaw(scene, circleX, circleY, diameter, diameter, QPen(Qt::black, 2));
-        rightmostX = circleX + diameter;
-    } else {
-        rightmostX = rectX + centralWidth;
+        for (int k = 0; k < childCount; ++k)
+            addCell(node->children[k].get(), static_cast<int>(i), depth + 1, k);
     }
 }
 
-// Рисует выход группы справа: линию, квадрат, Y, номер и логические обозначения.
-void DrawingDiagram::drawOutputGroup(QGraphicsScene* scene,
-                                     qreal rightmostX,
-                                     qreal centerY,
-                                     qreal coefficient)
+// Расставить элементы по вертикали алгоритмом Уокера.
+void DrawingDiagram::layoutCells()
 {
-    const qreal outputEndX = rightmostX + OUTPUT_LINE_LEN;
-    addLineRaw(scene,
-               rightmostX, centerY,
-               outputEndX, centerY,
-               QPen(Qt::black, 2));
-
-    auto* yText      = addText(scene, "Y", Qt::black);
-    auto* outText    = addText(scene, generator.generateName(NameFormat::NUMERIC_PREFIX), Qt::darkGreen);
-    auto* logicText  = addText(scene, generator.generateName(NameFormat::LOGIC_SUFFIX), Qt::black);
-    auto* letterText = addText(scene, generator.generateName(NameFormat::LETTER_PREFIX), Qt::black);
-
-    const qreal notDiameter = coefficient * DIAMETER_COEFF * WIDTH_FACTOR_DEFAULT;
-    const qreal yW = yText->boundingRect().width();
-    const qreal yH = yText->boundingRect().height();
-
-    const qreal yPosX = rightmostX - CENTRAL_RECT_RIGHT_TEXT_OFFSET - yW - notDiameter;
-    const qreal yPosY = centerY - yH / 2.0;
-
-    yText->setPos(yPosX, yPosY);
-
-    const qreal boxSize = computeBoxSize(coefficient);
-    const qreal boxX    = outputEndX - boxSize / 2.0;
-    const qreal boxY    = centerY - boxSize / 2.0;
-
-    addRectRaw(scene,
-               boxX, boxY,
-               boxSize, boxSize,
-               QPen(Qt::black, 2),
-               QBrush(Qt::NoBrush));
+    // Первый проход: в обратном порядке обхода в ширину дети готовы
+    // раньше родителя. Для каждого ребёнка его поддерево уже собрано,
+    // и остаётся поставить его под старшего брата и придвинуть контуры.
+    for (int v = static_cast<int>(cells.size()) - 1; v >= 0; --v) {
+        const int first = cells[v].firstChild;
+        const int last = first + cells[v].childCount - 1;
+        if (cells[v].childCount == 0)
+            continue;
+
+        int defaultAncestor = first;
+        for (int w = first + 1; w <= last; ++w) {
+            const qreal midpoint = cells[w].prelim;
+            cells[w].prelim = cells[w - 1].prelim + separation(w - 1, w);
+            if (cells[w].childCount > 0)
+                cells[w].mod = cells[w].prelim - midpoint;
+            apportion(w, defaultAncestor);
+        }
 
-    outText->setPos(outputEndX + boxSize + 10.0,
-                    centerY - yH / 2.0);
+        executeShifts(v);
+        cells[v].prelim = (cells[first].prelim + cells[last].prelim) / 2.0;
+    }
 
-    const qreal logicH = logicText->boundingRect().height();
-    const qreal logicX = rightmostX;
-    const qreal logicY = centerY * 2.0 - LETTER_TEXT_OFFSET_Y +
-                        (LETTER_TEXT_OFFSET_Y - logicH) / 2.0;
+    // Второй проход: сумма сдвигов предков даёт итоговые координаты.
+    std::vector<qreal> modSum(cells.size(), 0.0);
+    qreal top = 0;
+    for (size_t v = 0; v < cells.size(); ++v) {
+        Cell& cell = cells[v];
+        cell.y = cell.prelim + modSum[v];
+        top = std::min(top, cell.y - cell.size / 2.0);
+        for (int c = cell.firstChild; c < cell.firstChild + cell.childCount; ++c)
+            modSum[c] = modSum[v] + cell.mod;
+    }
 
-    logicText->setPos(logicX, logicY);
+    for (Cell& cell : cells)
+        cell.y += SCENE_MARGIN - top;
+}
 
-    const qreal letterH = letterText->boundingRect().height();
-    const qreal letterX = rightmostX;
-    const qreal letterY = (LETTER_TEXT_OFFSET_Y - letterH) / 2.0;
+// Минимальное расстояние между центрами соседних элементов уровня.
+qreal DrawingDiagram::separation(int a, int b) const
+{
+    return (cells[a].size + cells[b].size) / 2.0 + GATE_GAP;
+}
 
-    letterText->setPos(letterX, letterY);
+// Следующий узел верхнего контура поддерева.
+int DrawingDiagram::nextTop(int v) const
+{
+    return cells[v].childCount > 0 ? cells[v].firstChild : cells[v].thread;
 }
 
-// Подсчитывает количество узлов в поддереве.
-int DrawingDiagram::countAllNodes(const SchemaTree::Node* node) const
+// Следующий узел нижнего контура поддерева.
+int DrawingDiagram::nextBottom(int v) const
 {
-    if (!node) return 0;
-    int count = 1;
-    for (const auto& ch : node->children) {
-        count += countAllNodes(ch.get());
-    }
-    return count;
+    return cells[v].childCount > 0 ? cells[v].firstChild + cells[v].childCount - 1 : cells[v].thread;
 }
 
-// Вычисляет максимальную глубину дерева
-int DrawingDiagram::calculateHeight(const SchemaTree::Node* node) const
+// Придвинуть поддерево v к уже расставленным старшим братьям.
+void DrawingDiagram::apportion(int v, int& defaultAncestor)
 {
-    if (!node) return 0;
-    if (node->type == NodeType::NOT) {
-        return calculateHeight(node->children[0].get());
+    // Обозначения Бухгейма: i — внутренние контуры (нижний контур
+    // старших братьев и верхний контур v), o — внешние.
+    const int parent = cells[v].parent;
+    int vir = v;
+    int vor = v;
+    int vil = v - 1;
+    int vol = cells[parent].firstChild;
+    qreal sir = cells[vir].mod;
+    qreal sor = cells[vor].mod;
+    qreal sil = cells[vil].mod;
+    qreal sol = cells[vol].mod;
+
+    while (nextBottom(vil) >= 0 && nextTop(vir) >= 0) {
+        vil = nextBottom(vil);
+        vir = nextTop(vir);
+        vol = nextTop(vol);
+        vor = nextBottom(vor);
+        cells[vor].ancestor = v;
+
+        const qreal shift = (cells[vil].prelim + sil) - (cells[vir].prelim + sir) + separation(vil, vir);
+        if (shift > 0) {
+            const int a = cells[vil].ancestor;
+            moveSubtree(cells[a].parent == parent ? a : defaultAncestor, v, shift);
+            sir += shift;
+            sor += shift;
+        }
+        sil += cells[vil].mod;
+        sir += cells[vir].mod;
+        sol += cells[vol].mod;
+        sor += cells[vor].mod;
+    }
+
+    if (nextBottom(vil) >= 0 && nextBottom(vor) < 0) {
+        cells[vor].thread = nextBottom(vil);
+        cells[vor].mod += sil - sor;
     }
-    int maxH = 0;
-    for (const auto& ch : node->children) {
-        maxH = std::max(maxH, calculateHeight(ch.get()));
+    if (nextTop(vir) >= 0 && nextTop(vol) < 0) {
+        cells[vol].thread = nextTop(vir);
+        cells[vol].mod += sir - sol;
+        defaultAncestor = v;
     }
-    return maxH + 1;
 }
 
-// Рекурсивно рисует узел дерева и соединяет его с родителем.
-void DrawingDiagram::drawNode(QGraphicsScene* scene,
-                              const SchemaTree::Node* node,
-                              qreal connectX,
-                              qreal connectY,
-                              qreal allocHeight,
-                              qreal coefficient,
-                              int treeDepth,
-                              int currentLevel,
-                              qreal widthFactor)
+// Сдвинуть поддерево и запомнить сдвиг промежуточных братьев.
+void DrawingDiagram::moveSubtree(int top, int bottom, qreal distance)
 {
-    if (!node) return;
-
-    QPen linePen(Qt::black, 2);
-    qreal widthCoefficient = coefficient * widthFactor;
-    qreal diameter = coefficient * DIAMETER_COEFF * widthFactor;
-
-    if (node->type == NodeType::VAR)
-    {
-        auto* text = addText(scene, node->value, Qt::black);
-        auto* textN = addText(scene, generator.generateName(NameFormat::NUMERIC_PREFIX), Qt::darkGreen);
-        qreal boxSize = computeBoxSize(coefficient);
-
-        qreal textNW = textN->boundingRect().width();
-        qreal textH = text->boundingRect().height();
-
-        qreal boxX  = varLevelX - (boxSize / 2.0);
-        qreal boxY  = connectY - (boxSize / 2.0);
+    const qreal subtrees = cells[bottom].number - cells[top].number;
+    cells[bottom].change -= distance / subtrees;
+    cells[bottom].shift += distance;
+    cells[top].change += distance / subtrees;
+    cells[bottom].prelim += distance;
+    cells[bottom].mod += distance;
+}
 
-        qreal textX  = varLevelX + VAR_TEXT_OFFSET_X;
-        qreal textY = connectY - textH / 2.0;
+// Применить отложенные сдвиги к детям элемента.
+void DrawingDiagram::executeShifts(int v)
+{
+    qreal shift = 0;
+    qreal change = 0;
+    for (int w = cells[v].firstChild + cells[v].childCount - 1; w >= cells[v].firstChild; --w) {
+        cells[w].prelim += shift;
+        cells[w].mod += shift;
+        change += cells[w].change;
+        shift += cells[w].shift + change;
+    }
+}
 
-        qreal textNX  = varLevelX - VAR_TEXT_NUMBER_OFFSET - textNW - boxSize;
+// Левый X столбца уровня.
+qreal DrawingDiagram::columnX(int depth) const
+{
+    const qreal pitch = GATE_WIDTH + ROUTE_GAP + maxInversions * NOT_DIAMETER;
+    return (maxDepth - depth) * pitch;
+}
 
-        text->setPos(textX, textY);
-        textN->setPos(textNX, textY);
+// Нарисовать оператор и его входные соединения.
+void DrawingDiagram::drawGate(QGraphicsScene* scene, int index)
+{
+    const Cell& cell = cells[index];
+    const qreal x = columnX(cell.depth);
+    const qreal top = cell.y - cell.size / 2.0;
+
+    indexItem(cell.node, scene->addRect(x, top, GATE_WIDTH, cell.size,
+                                        nodePen(cell.node, QPen(Qt::darkBlue, 1)), QBrush(Qt::NoBrush)));
+
+    auto* opText = addText(scene, operatorText(cell.node), Qt::blue);
+    opText->setPos(x + GATE_WIDTH - opText->boundingRect().width() - RECT_TEXT_PADDING, top + RECT_TEXT_PADDING);
+
+    // Вертикальные участки разносятся по ширине канала так, чтобы
+    // провода, идущие к входам сверху и снизу, не пересекались.
+    const int pins = cell.childCount;
+    for (int pin = 0; pin < pins; ++pin) {
+        const Cell& child = cells[cell.firstChild + pin];
+        const qreal pinY = top + (pin + 1) * PIN_PITCH;
+        const qreal inputX = x - child.inversions * NOT_DIAMETER;
+        const qreal fromX = columnX(child.depth) + GATE_WIDTH;
+        const qreal fromY = child.y;
+        const QPen linePen = nodePen(child.node, QPen(Qt::black, 2));
+
+        drawInversions(scene, child, x, pinY);
+
+        if (fromY == pinY) {
+            indexItem(child.node, scene->addLine(fromX, fromY, inputX, pinY, linePen));
+            continue;
+        }
 
-        addRectRaw(scene, boxX, boxY, boxSize, boxSize, QPen(Qt::black, 2), QBrush(Qt::NoBrush));
-        addLineRaw(scene, connectX, connectY, varLevelX, connectY, linePen);
-        return;
+        const int rank = fromY < pinY ? pin : pins - 1 - pin;
+        const qreal channelX = inputX - ROUTE_GAP * (rank + 1) / (pins + 1);
+        indexItem(child.node, scene->addLine(fromX, fromY, channelX, fromY, linePen));
+        indexItem(child.node, scene->addLine(channelX, fromY, channelX, pinY, linePen));
+        indexItem(child.node, scene->addLine(channelX, pinY, inputX, pinY, linePen));
     }
+}
 
-    if (node->type == NodeType::NOT)
-    {
-        qreal circleX = connectX - diameter;
-        qreal circleY = connectY - diameter / 2.0;
-        addEllipseRaw(scene, circleX, circleY, diameter, diameter, linePen);
-
-        qreal childConnectX = circleX;
-        drawNode(scene, node->children[0].get(),
-                 childConnectX, connectY,
-                 allocHeight,
-                 coefficient, treeDepth, currentLevel,
-                 widthFactor);
-        return;
-    }
+// Нарисовать свёрнутое поддерево одним блоком.
+void DrawingDiagram::drawSummary(QGraphicsScene* scene, int index)
+{
+    const Cell& cell = cells[index];
+    const qreal x = columnX(cell.depth);
+    const qreal top = cell.y - cell.size / 2.0;
+    const int inputs = static_cast<int>(cell.node->children.size());
+
+    QPen pen = nodePen(cell.node, QPen(Qt::darkBlue, 1));
+    pen.setStyle(Qt::DashLine);
+    auto* block = scene->addRect(x, top, GATE_WIDTH, cell.size, pen, QBrush(Qt::NoBrush));
+    block->setToolTip(QString("Свёрнуто: %1 входов; двойной щелчок раскрывает").arg(inputs));
+    indexItem(cell.node, block);
+
+    auto* opText = addText(scene, operatorText(cell.node), Qt::blue);
+    opText->setPos(x + GATE_WIDTH - opText->boundingRect().width() - RECT_TEXT_PADDING, top + RECT_TEXT_PADDING);
+
+    // Число входов свёрнутого оператора — без обхода его поддерева.
+    auto* countText = addText(scene, QString("+%1").arg(inputs), Qt::darkGray);
+    countText->setPos(x + RECT_TEXT_PADDING, top + RECT_TEXT_PADDING);
+}
 
-    if (node->type == NodeType::OP)
-    {
-        qreal rectWidth = (treeDepth - currentLevel) * widthCoefficient;
-        qreal rectHeight = allocHeight;
+// Обозначение оператора внутри вентиля.
+QString DrawingDiagram::operatorText(const SchemaTree::Node* node)
+{
+    if (node->value == "|")
+        return "1";
+    if (node->value == "^")
+        return "=1";
+    return node->value;
+}
 
-        qreal rectX = connectX;
-        qreal rectY = connectY - rectHeight / 2.0;
+// Нарисовать переменную (лист дерева).
+void DrawingDiagram::drawVariable(QGraphicsScene* scene, int index)
+{
+    const Cell& cell = cells[index];
+    const qreal boxX = columnX(cell.depth) + GATE_WIDTH / 2.0;
+    const QPen linePen = nodePen(cell.node, QPen(Qt::black, 2));
+
+    auto* text = addText(scene, cell.node->value, Qt::black);
+    auto* textN = addText(scene, generator.generateName(NameFormat::NUMERIC_PREFIX), Qt::darkGreen);
+    const qreal textH = text->boundingRect().height();
+
+    indexItem(cell.node, scene->addRect(boxX - BOX_SIZE / 2.0, cell.y - BOX_SIZE / 2.0, BOX_SIZE, BOX_SIZE,
+                                        linePen, QBrush(Qt::NoBrush)));
+    indexItem(cell.node, scene->addLine(boxX, cell.y, columnX(cell.depth) + GATE_WIDTH, cell.y, linePen));
+    if (searchIndex)
+        searchIndex->addName(textN->toPlainText(), cell.node);
+
+    text->setPos(boxX + BOX_SIZE, cell.y - textH);
+    textN->setPos(boxX - TEXT_OFFSET - textN->boundingRect().width() - BOX_SIZE, cell.y - textH / 2.0);
+}
 
-        addRectRaw(scene, rectX, rectY, rectWidth, rectHeight, QPen(Qt::darkBlue, 1), QBrush(Qt::NoBrush));
+// Нарисовать кружки цепочки NOT над элементом.
+void DrawingDiagram::drawInversions(QGraphicsScene* scene, const Cell& cell, qreal rightX, qreal centerY)
+{
+    // Верхний NOT цепочки ближе всего к потребителю сигнала.
+    const SchemaTree::Node* node = cell.edge;
+    for (int i = 0; i < cell.inversions; ++i) {
+        indexItem(node, scene->addEllipse(rightX - (i + 1) * NOT_DIAMETER, centerY - NOT_DIAMETER / 2.0,
+                                          NOT_DIAMETER, NOT_DIAMETER, nodePen(node, QPen(Qt::black, 2))));
+        node = node->children.front().get();
+    }
+}
 
-        QString displayText;
-        if (node->value == "|") {
-            displayText = "1";
-        } else if (node->value == "^") {
-            displayText = "=1";
-        } else {
-            displayText = node->value;
-        }
-        auto* opText = addText(scene, displayText, Qt::blue);
-        qreal opW = opText->boundingRect().width();
-        opText->setPos(rectX + rectWidth - opW - RECT_TEXT_PADDING, rectY + RECT_TEXT_PADDING);
+// Рисует выход схемы справа: линию, квадрат, Y, номер и логические обозначения.
+void DrawingDiagram::drawOutputGroup(QGraphicsScene* scene,
+                                     qreal rightmostX,
+                                     qreal centerY,
+                                     qreal top,
+                                     qreal bottom)
+{
+    const qreal outputEndX = rightmostX + OUTPUT_LINE_LEN;
+    indexItem(root, scene->addLine(rightmostX, centerY, outputEndX, centerY, nodePen(root, QPen(Qt::black, 2))));
 
-        int totalChildNodes = countAllNodes(node) - 1;
+    auto* yText      = addText(scene, "Y", Qt::black);
+    auto* outText    = addText(scene, generator.generateName(NameFormat::NUMERIC_PREFIX), Qt::darkGreen);
+    auto* logicText  = addText(scene, generator.generateName(NameFormat::LOGIC_SUFFIX), Qt::black);
+    auto* letterText = addText(scene, generator.generateName(NameFormat::LETTER_PREFIX), Qt::black);
+    if (searchIndex) {
+        searchIndex->addName(outText->toPlainText(), root);
+        searchIndex->addName(logicText->toPlainText(), root);
+        searchIndex->addName(letterText->toPlainText(), root);
+    }
 
-        qreal currentY = rectY;
-        qreal childConnectX = rectX;
+    const qreal yH = yText->boundingRect().height();
+    yText->setPos(rightmostX + TEXT_OFFSET, centerY - yH);
 
-        for (const auto& ch : node->children)
-        {
-            int childCount = countAllNodes(ch.get());
-            qreal childAlloc = (totalChildNodes > 0)
-                                   ? (static_cast<qreal>(childCount) / totalChildNodes) * rectHeight
-                                   : rectHeight;
+    scene->addRect(outputEndX - BOX_SIZE / 2.0, centerY - BOX_SIZE / 2.0,
+                   BOX_SIZE, BOX_SIZE,
+                   QPen(Qt::black, 2),
+                   QBrush(Qt::NoBrush));
 
-            qreal childConnectY = currentY + childAlloc / 2.0;
+    outText->setPos(outputEndX + BOX_SIZE + TEXT_OFFSET, centerY - yH / 2.0);
 
-            drawNode(scene, ch.get(),
-                     childConnectX, childConnectY,
-                     childAlloc,
-                     coefficient, treeDepth, currentLevel + 1,
-                     widthFactor);
+    const qreal letterH = letterText->boundingRect().height();
+    letterText->setPos(rightmostX, top - LETTER_TEXT_OFFSET_Y + (LETTER_TEXT_OFFSET_Y - letterH) / 2.0);
 
-            currentY += childAlloc;
-        }
-    }
+    const qreal logicH = logicText->boundingRect().height();
+    logicText->setPos(rightmostX, bottom + (LETTER_TEXT_OFFSET_Y - logicH) / 2.0);
 }
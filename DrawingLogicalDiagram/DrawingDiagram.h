@@ -4,23 +4,38 @@
 #include <QObject>
 #include <QGraphicsScene>
 #include <QGraphicsView>
+#include <QSet>
+#include <vector>
 #include "SchemaTree.h"
 #include "NameGenerator.h"
+#include "SearchIndex.h"
 
 /**
  * @class DrawingDiagram
  * @brief Класс, отвечающий за построение графической схемы по дереву SchemaTree.
  *
  * Класс принимает указатель на корень дерева логического выражения
- * и динамически формирует QGraphicsScene, содержащую:
+ * и формирует QGraphicsScene, содержащую:
  *
- *  - центральный прямоугольник (главная группа оператора)
- *  - глобальный NOT (кружок справа), если есть
- *  - рекурсивную отрисовку дочерних узлов
- *  - отдельный уровень переменных слева
- *  - выход группы справа (линия, квадрат, обозначения)
+ *  - вентили операторов постоянного размера, по столбцу на уровень дерева
+ *  - переменные в листьях дерева
+ *  - инверторы (кружки) на входах вентилей и на выходе схемы
+ *  - выход схемы справа (линия, квадрат, обозначения)
  *
- * Вычисления размеров выполняются автоматически.
+ * @details
+ * Компоновка выполняется алгоритмом Уокера (Reingold–Tilford) в варианте
+ * Бухгейма за линейное время: поддеревья сдвигаются друг к другу до
+ * минимального зазора по контурам, родитель ставится посередине между
+ * крайними детьми. NOT не занимает отдельного столбца. Размеры элементов
+ * не зависят от размера дерева, поэтому большая схема получается больше
+ * окна и просматривается прокруткой и масштабированием view.
+ * Обходы выполняются без рекурсии.
+ *
+ * Поддерево оператора можно свернуть (см. Expansion): оно рисуется
+ * одним блоком с числом входов оператора, а его узлы не обходятся,
+ * не компонуются и не получают элементов сцены. Поэтому время
+ * построения пропорционально числу видимых элементов, а не размеру
+ * дерева; раскрытие поддерева — новое построение сцены.
  */
 class DrawingDiagram : public QObject {
     Q_OBJECT
@@ -29,12 +44,35 @@ public:
     /**
      * @brief Конструктор класса DrawingDiagram
      * @param root Корневой узел дерева логического выражения
-     * @param view QGraphicsView, определяющий размеры сцены
      * @param parent Родительский объект QObject
      */
-    DrawingDiagram(const SchemaTree::Node* root,
-                   QGraphicsView* view,
-                   QObject* parent = nullptr);
+    explicit DrawingDiagram(const SchemaTree::Node* root,
+                            QObject* parent = nullptr);
+
+    /**
+     * @struct Expansion
+     * @brief Какие поддеревья операторов раскрыты
+     *
+     * Оператор на уровне ниже depth свёрнут, остальные раскрыты;
+     * узлы из toggled находятся в обратном состоянии. Уровень считается
+     * по столбцам схемы: NOT уровня не добавляет.
+     */
+    struct Expansion
+    {
+        int depth = 0;  ///< Уровней операторов, раскрытых по умолчанию; 0 — все
+        QSet<const SchemaTree::Node*> toggled;  ///< Узлы OP, свёрнутые или раскрытые вручную
+    };
+
+    /**
+     * @struct Statistics
+     * @brief Объём и время последнего построения сцены
+     */
+    struct Statistics
+    {
+        int cells = 0;         ///< Нарисовано переменных и операторов
+        int collapsed = 0;     ///< Из них свёрнутых поддеревьев
+        qint64 elapsedUs = 0;  ///< Время компоновки и создания элементов, мкс
+    };
 
     /**
      * @brief Построить QGraphicsScene и вернуть её
@@ -42,34 +80,79 @@ public:
      */
     QGraphicsScene* buildScene();
 
-private:
-    NameGenerator generator;               ///< Генератор имён выходов
-    qreal varLevelX;                       ///< X-координата уровня переменных слева
-    const SchemaTree::Node* root;          ///< Корень логического дерева
-    QGraphicsView* view;                   ///< View для отображения сцены
-    qreal sceneWidth;                      ///< Итоговая ширина сцены
-    qreal sceneHeight;                     ///< Итоговая высота сцены
+    /**
+     * @brief Задать узлы для подсветки (например, критический путь)
+     * @param nodes Узлы дерева, элементы которых рисуются выделенным цветом
+     */
+    void setHighlightedNodes(const QSet<const SchemaTree::Node*>& nodes);
 
     /**
-     * @brief Подсчитывает количество узлов в поддереве
-     * @param node Указатель на корень поддерева
-     * @return Число узлов
+     * @brief Задать индекс поиска, заполняемый при построении сцены
+     * @param index Индекс (nullptr — без индекса)
+     *
+     * В индекс записываются элементы каждого узла и сгенерированные
+     * обозначения переменных и выхода.
      */
-    int countAllNodes(const SchemaTree::Node* node) const;
+    void setSearchIndex(SearchIndex* index);
 
     /**
-     * @brief Вычисляет максимальную глубину дерева
-     * @param node Текущий узел
-     * @return Глубина (высота)
+     * @brief Задать свёрнутые и раскрытые поддеревья
+     * @param expansion Состояние раскрытия (по умолчанию всё раскрыто)
      */
-    int calculateHeight(const SchemaTree::Node* node) const;
+    void setExpansion(const Expansion& expansion);
 
     /**
-     * @brief Вычисляет размер квадрата/прямоугольника на основе коэффициента
-     * @param coefficient Масштабирующий коэффициент
-     * @return Размер стороны квадрата
+     * @brief Объём и время последнего построения сцены
+     * @return Статистика
      */
-    qreal computeBoxSize(qreal coefficient) const;
+    Statistics statistics() const;
+
+private:
+    /**
+     * @struct Cell
+     * @brief Элемент компоновки: переменная или оператор
+     *
+     * Цепочка NOT над элементом хранится как число инверсий на его выходе.
+     * Поля prelim … ancestor — рабочие величины алгоритма Уокера.
+     */
+    struct Cell
+    {
+        const SchemaTree::Node* node = nullptr;  ///< Узел VAR или OP
+        const SchemaTree::Node* edge = nullptr;  ///< Верхний узел цепочки NOT над node (или сам node)
+        int inversions = 0;   ///< Число NOT между node и родителем
+        int parent = -1;      ///< Родитель
+        int firstChild = 0;   ///< Первый ребёнок (дети идут подряд)
+        int childCount = 0;   ///< Число детей
+        bool collapsed = false;  ///< Оператор свёрнут: дети не строятся
+        int number = 0;       ///< Номер среди братьев
+        int depth = 0;        ///< Уровень (столбец) от выхода
+        qreal size = 0;       ///< Высота элемента
+        qreal prelim = 0;     ///< Предварительная координата относительно родителя
+        qreal mod = 0;        ///< Сдвиг всех потомков
+        qreal shift = 0;      ///< Отложенный сдвиг поддерева
+        qreal change = 0;     ///< Изменение отложенного сдвига между братьями
+        int thread = -1;      ///< Нить к следующему узлу контура
+        int ancestor = 0;     ///< Предок для разрешения конфликта контуров
+        qreal y = 0;          ///< Итоговый центр по вертикали
+    };
+
+    NameGenerator generator;               ///< Генератор имён выходов
+    const SchemaTree::Node* root;          ///< Корень логического дерева
+    QSet<const SchemaTree::Node*> highlighted;  ///< Подсвечиваемые узлы
+    SearchIndex* searchIndex = nullptr;    ///< Индекс поиска по элементам сцены
+    Expansion expansion;                   ///< Свёрнутые и раскрытые поддеревья
+    Statistics stats;                      ///< Статистика последнего построения
+    std::vector<Cell> cells;               ///< Элементы в порядке обхода в ширину
+    int maxDepth;                          ///< Наибольший уровень
+    int maxInversions;                     ///< Наибольшее число NOT на одном ребре
+
+    /**
+     * @brief Перо для элемента узла с учётом подсветки
+     * @param node Узел дерева
+     * @param pen Обычное перо элемента
+     * @return Исходное перо или перо подсветки
+     */
+    QPen nodePen(const SchemaTree::Node* node, const QPen& pen) const;
 
     /**
      * @brief Добавляет текст в сцену
@@ -83,107 +166,125 @@ private:
                                const QColor& color);
 
     /**
-     * @brief Добавляет прямоугольник в сцену
+     * @brief Записать элемент узла в индекс поиска, если он задан
+     * @param node Узел дерева
+     * @param item Элемент сцены
+     */
+    void indexItem(const SchemaTree::Node* node, QGraphicsItem* item);
+
+    /**
+     * @brief Построить элементы компоновки обходом в ширину
+     *
+     * Дети каждого элемента получают соседние индексы.
+     */
+    void buildCells();
+
+    /**
+     * @brief Расставить элементы по вертикали алгоритмом Уокера
+     */
+    void layoutCells();
+
+    /**
+     * @brief Минимальное расстояние между центрами соседних элементов уровня
+     * @param a Верхний элемент
+     * @param b Нижний элемент
+     * @return Расстояние
+     */
+    qreal separation(int a, int b) const;
+
+    /**
+     * @brief Следующий узел верхнего контура поддерева
+     * @param v Текущий узел контура
+     * @return Первый ребёнок или нить; -1 — контур закончился
+     */
+    int nextTop(int v) const;
+
+    /**
+     * @brief Следующий узел нижнего контура поддерева
+     * @param v Текущий узел контура
+     * @return Последний ребёнок или нить; -1 — контур закончился
+     */
+    int nextBottom(int v) const;
+
+    /**
+     * @brief Придвинуть поддерево v к уже расставленным старшим братьям
+     * @param v Элемент, не первый среди братьев
+     * @param defaultAncestor Предок по умолчанию (обновляется)
+     */
+    void apportion(int v, int& defaultAncestor);
+
+    /**
+     * @brief Сдвинуть поддерево и запомнить сдвиг промежуточных братьев
+     * @param top Старший брат, с поддеревом которого был конфликт
+     * @param bottom Сдвигаемый элемент
+     * @param distance Величина сдвига
+     */
+    void moveSubtree(int top, int bottom, qreal distance);
+
+    /**
+     * @brief Применить отложенные сдвиги к детям элемента
+     * @param v Родитель
+     */
+    void executeShifts(int v);
+
+    /**
+     * @brief Левый X столбца уровня
+     * @param depth Уровень от выхода
+     * @return Координата
+     */
+    qreal columnX(int depth) const;
+
+    /**
+     * @brief Нарисовать оператор и его входные соединения
      * @param scene Сцена
-     * @param x Левый X
-     * @param y Верхний Y
-     * @param w Ширина
-     * @param h Высота
-     * @param pen Обводка
-     * @param brush Заливка
+     * @param index Элемент
      */
-    void addRectRaw(QGraphicsScene* scene,
-                    qreal x, qreal y,
-                    qreal w, qreal h,
-                    const QPen& pen,
-                    const QBrush& brush = QBrush());
+    void drawGate(QGraphicsScene* scene, int index);
 
     /**
-     * @brief Добавляет окружность/овал в сцену
+     * @brief Нарисовать свёрнутое поддерево одним блоком
      * @param scene Сцена
-     * @param x Левый X
-     * @param y Верхний Y
-     * @param w Ширина
-     * @param h Высота
-     * @param pen Обводка
+     * @param index Элемент
      */
-    void addEllipseRaw(QGraphicsScene* scene,
-                       qreal x, qreal y,
-                       qreal w, qreal h,
-                       const QPen& pen);
+    void drawSummary(QGraphicsScene* scene, int index);
 
     /**
-     * @brief Добавляет линию в сцену
+     * @brief Обозначение оператора внутри вентиля
+     * @param node Узел OP
+     * @return "&", "1" или "=1"
+     */
+    static QString operatorText(const SchemaTree::Node* node);
+
+    /**
+     * @brief Нарисовать переменную (лист дерева)
      * @param scene Сцена
-     * @param x1 Начало X
-     * @param y1 Начало Y
-     * @param x2 Конец X
-     * @param y2 Конец Y
-     * @param pen Обводка линии
+     * @param index Элемент
      */
-    void addLineRaw(QGraphicsScene* scene,
-                    qreal x1, qreal y1,
-                    qreal x2, qreal y2,
-                    const QPen& pen);
+    void drawVariable(QGraphicsScene* scene, int index);
 
     /**
-     * @brief Рисует центральный прямоугольник и глобальный NOT при необходимости
-     *
+     * @brief Нарисовать кружки цепочки NOT над элементом
      * @param scene Сцена
-     * @param centralNode Узел, отображаемый внутри прямоугольника
-     * @param isGlobalNot Есть ли глобальное отрицание
-     * @param rectX X левого края прямоугольника
-     * @param rectY Y верхнего края прямоугольника
-     * @param centralWidth Ширина прямоугольника
-     * @param centralHeight Высота прямоугольника
-     * @param coefficient Масштабирующий коэффициент
-     * @param widthFactor Дополнительный множитель ширины
-     * @param rightmostX Сюда записывается крайняя правая координата элемента
-     */
-    void drawCentralRectAndMaybeGlobalNot(QGraphicsScene* scene,
-                                          const SchemaTree::Node* centralNode,
-                                          bool isGlobalNot,
-                                          qreal rectX, qreal rectY,
-                                          qreal centralWidth, qreal centralHeight,
-                                          qreal coefficient,
-                                          qreal widthFactor,
-                                          qreal& rightmostX);
-
-    /**
-     * @brief Рисует выход группы справа: линию, квадрат, Y, номер и логические обозначения
+     * @param cell Элемент
+     * @param rightX Правый край цепочки
+     * @param centerY Y-координата линии
+     */
+    void drawInversions(QGraphicsScene* scene, const Cell& cell, qreal rightX, qreal centerY);
+
+    /**
+     * @brief Рисует выход схемы справа: линию, квадрат, Y, номер и логические обозначения
      *
      * @param scene Сцена
      * @param rightmostX Правая точка, откуда должен начинаться выход
-     * @param centerY Y-координата центра группы
-     * @param coefficient Масштабирующий коэффициент
+     * @param centerY Y-координата выхода
+     * @param top Верхняя граница схемы
+     * @param bottom Нижняя граница схемы
      */
     void drawOutputGroup(QGraphicsScene* scene,
                          qreal rightmostX,
                          qreal centerY,
-                         qreal coefficient);
-
-    /**
-     * @brief Рекурсивно рисует узел дерева и соединяет его с родителем
-     *
-     * @param scene Сцена
-     * @param node Узел дерева
-     * @param connectX X точки соединения с родителем
-     * @param connectY Y точки соединения
-     * @param allocHeight Вертикальная область, выделенная под поддерево
-     * @param coefficient Масштаб отображения
-     * @param treeDepth Полная глубина всего дерева
-     * @param currentLevel Текущий уровень
-     * @param widthFactor Множитель ширины уровней
-     */
-    void drawNode(QGraphicsScene* scene,
-                  const SchemaTree::Node* node,
-                  qreal connectX,
-                  qreal connectY,
-                  qreal allocHeight,
-                  qreal coefficient,
-                  int treeDepth,
-                  int currentLevel,
-                  qreal widthFactor);
+                         qreal top,
+                         qreal bottom);
 };
 
 #endif // DRAWINGDIAGRAM_H
@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -9,20 +9,83 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    BigUInt.cpp \
+    CellLibrary.cpp \
+    CodeGenerator.cpp \
+    DiagramCache.cpp \
+    DiagramLayout.cpp \
+    DiagramServer.cpp \
     DrawingDiagram.cpp \
+    EditHistory.cpp \
+    EventSimulator.cpp \
+    ExpressionReader.cpp \
+    FaultSimulator.cpp \
+    GraphDiagram.cpp \
+    LayeredLayout.cpp \
+    LoadTester.cpp \
+    LogicGraph.cpp \
+    ModelCounter.cpp \
     NameGenerator.cpp \
+    NetlistReader.cpp \
+    NetlistWriter.cpp \
+    ParallelParser.cpp \
+    PassManager.cpp \
+    SatChecker.cpp \
+    SatSolver.cpp \
+    SchemaDocument.cpp \
     SchemaProgram.cpp \
     SchemaTree.cpp \
+    SearchIndex.cpp \
+    TechMapper.cpp \
+    TiledGraphicsView.cpp \
+    TimingAnalyzer.cpp \
+    TreeRebalancer.cpp \
+    TreeSimulator.cpp \
+    TruthTableModel.cpp \
+    VcdWriter.cpp \
+    WorkStealingPool.cpp \
     main.cpp \
     mainwindow.cpp
 
 HEADERS += \
+    BigUInt.h \
+    CellLibrary.h \
+    CodeGenerator.h \
+    DiagramCache.h \
+    DiagramLayout.h \
+    DiagramServer.h \
     DrawingDiagram.h \
+    EditHistory.h \
+    EventSimulator.h \
+    ExpressionReader.h \
+    FaultSimulator.h \
+    GraphDiagram.h \
+    LayeredLayout.h \
+    LoadTester.h \
+    LogicGraph.h \
+    ModelCounter.h \
     NameGenerator.h \
     NamingType.h \
+    NetlistFormat.h \
+    NetlistReader.h \
+    NetlistWriter.h \
+    ParallelParser.h \
+    PassManager.h \
+    SatChecker.h \
+    SatSolver.h \
+    SchemaDocument.h \
     SchemaProgram.h \
     SchemaTree.h \
     SchemaTypes.h \
+    SearchIndex.h \
+    TechMapper.h \
+    TiledGraphicsView.h \
+    TimingAnalyzer.h \
+    TreeRebalancer.h \
+    TreeSimulator.h \
+    TruthTableModel.h \
+    VcdWriter.h \
+    WorkStealingPool.h \
     mainwindow.h
 
 FORMS += \
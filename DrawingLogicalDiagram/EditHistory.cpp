@@ -0,0 +1,280 @@
+#include "EditHistory.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <algorithm>
+
+// Константы.
+static constexpr int DEFAULT_MAX_VERSIONS = 500;
+
+// Конструктор.
+EditHistory::EditHistory()
+    : maxVersions(DEFAULT_MAX_VERSIONS)
+{}
+
+// Задать наибольшее число версий.
+void EditHistory::setLimit(int versions)
+{
+    maxVersions = std::max(1, versions);
+}
+
+// Наибольшее число версий.
+int EditHistory::limit() const
+{
+    return maxVersions;
+}
+
+// Добавить версию.
+bool EditHistory::commit(const SchemaTree::Node* root)
+{
+    if (!root)
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+    addedNodes = 0;
+
+    // Узлы в прямом порядке; в обратном порядке дети
+    // попадают в таблицу раньше родителя.
+    std::vector<const SchemaTree::Node*> order;
+    std::vector<const SchemaTree::Node*> stack{root};
+    while (!stack.empty()) {
+        const SchemaTree::Node* node = stack.back();
+        stack.pop_back();
+        order.push_back(node);
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+            stack.push_back(it->get());
+    }
+
+    std::unordered_map<const SchemaTree::Node*, NodePtr> built;
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        const SchemaTree::Node* node = *it;
+        std::vector<NodePtr> children;
+        children.reserve(node->children.size());
+        for (const auto& child : node->children) {
+            auto found = built.find(child.get());
+            children.push_back(std::move(found->second));
+            built.erase(found);
+        }
+        built.emplace(node, intern(node->type, node->value, std::move(children)));
+    }
+    NodePtr top = std::move(built[root]);
+
+    if (position >= 0 && versions[position] == top) {
+        commitUs = timer.nsecsElapsed() / 1000;
+        return false;
+    }
+
+    // Новая версия отбрасывает ветку повтора, а сверх предела — самые старые.
+    const size_t before = versions.size();
+    versions.resize(position + 1);
+    versions.push_back(std::move(top));
+    const bool dropped = versions.size() <= before || static_cast<int>(versions.size()) > maxVersions;
+    if (static_cast<int>(versions.size()) > maxVersions)
+        versions.erase(versions.begin(), versions.end() - maxVersions);
+    position = static_cast<int>(versions.size()) - 1;
+    if (dropped)
+        purge();
+
+    commitUs = timer.nsecsElapsed() / 1000;
+    return true;
+}
+
+// Есть ли версия для отмены.
+bool EditHistory::canUndo() const
+{
+    return position > 0;
+}
+
+// Есть ли версия для повтора.
+bool EditHistory::canRedo() const
+{
+    return position + 1 < static_cast<int>(versions.size());
+}
+
+// Перейти к предыдущей версии.
+bool EditHistory::undo()
+{
+    if (!canUndo())
+        return false;
+    --position;
+    return true;
+}
+
+// Перейти к следующей версии.
+bool EditHistory::redo()
+{
+    if (!canRedo())
+        return false;
+    ++position;
+    return true;
+}
+
+// Текущая версия.
+EditHistory::NodePtr EditHistory::current() const
+{
+    return position >= 0 ? versions[position] : NodePtr();
+}
+
+// Текст выражения по дереву.
+QString EditHistory::toExpression(const NodePtr& root)
+{
+    // Операнд-оператор берётся в скобки; NOT пишется перед операндом.
+    // Обход без рекурсии, как и разбор глубоких деревьев в TreeRebalancer.
+    struct Frame
+    {
+        const Node* node;  ///< Узел
+        size_t next;       ///< Следующий ребёнок
+        bool parens;       ///< Закрыть скобку после узла
+    };
+
+    QString text;
+    if (!root)
+        return text;
+
+    std::vector<Frame> stack{Frame{root.get(), 0, false}};
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const Node* node = frame.node;
+
+        if (node->type == NodeType::NOT && frame.next == 0)
+            text += '!';
+
+        if (node->type != NodeType::VAR && frame.next < node->children.size()) {
+            if (node->type == NodeType::OP && frame.next > 0)
+                text += node->value;
+            const Node* child = node->children[frame.next++].get();
+            const bool parens = child->type == NodeType::OP;
+            if (parens)
+                text += '(';
+            stack.push_back(Frame{child, 0, parens});
+            continue;
+        }
+
+        if (node->type == NodeType::VAR)
+            text += node->value;
+        else if (node->type == NodeType::OP && node->children.size() < 2)
+            text += node->value;
+        else if (node->type == NodeType::NOT && node->children.empty())
+            text += "()";
+
+        const bool parens = frame.parens;
+        stack.pop_back();
+        if (parens)
+            text += ')';
+    }
+    return text;
+}
+
+// Построить дерево разбора по версии.
+std::unique_ptr<SchemaTree::Node> EditHistory::toTree(const NodePtr& root)
+{
+    return root ? buildTree(root.get()) : nullptr;
+}
+
+// Построить дерево разбора по узлу версии без рекурсии.
+std::unique_ptr<SchemaTree::Node> EditHistory::buildTree(const Node* root)
+{
+    auto tree = std::make_unique<SchemaTree::Node>(root->type, root->value);
+    std::vector<std::pair<const Node*, SchemaTree::Node*>> stack{{root, tree.get()}};
+    while (!stack.empty()) {
+        const auto [source, target] = stack.back();
+        stack.pop_back();
+        target->children.reserve(source->children.size());
+        for (const NodePtr& child : source->children) {
+            target->children.push_back(std::make_unique<SchemaTree::Node>(child->type, child->value));
+            stack.emplace_back(child.get(), target->children.back().get());
+        }
+    }
+    return tree;
+}
+
+// Перенести отличия версий в дерево разбора.
+void EditHistory::patch(SchemaTree::Node* tree, const NodePtr& from, const NodePtr& to,
+                        const std::function<void(SchemaTree::Node*)>& replaced)
+{
+    struct Item
+    {
+        SchemaTree::Node* node;  ///< Узел дерева
+        const Node* from;        ///< Его прежняя версия
+        const Node* to;          ///< Его новая версия
+    };
+
+    if (!tree || !from || !to)
+        return;
+
+    std::vector<Item> stack{Item{tree, from.get(), to.get()}};
+    while (!stack.empty()) {
+        const Item item = stack.back();
+        stack.pop_back();
+        if (item.from == item.to)
+            continue;
+
+        if (item.from->type == item.to->type && item.from->value == item.to->value
+            && item.from->children.size() == item.to->children.size()
+            && item.node->children.size() == item.to->children.size()) {
+            for (size_t i = 0; i < item.to->children.size(); ++i)
+                stack.push_back(Item{item.node->children[i].get(), item.from->children[i].get(),
+                                     item.to->children[i].get()});
+            continue;
+        }
+
+        // Новый корень поддерева строится отдельно, затем его
+        // содержимое переносится в прежний объект узла.
+        std::unique_ptr<SchemaTree::Node> built = buildTree(item.to);
+        item.node->type = built->type;
+        item.node->value = built->value;
+        item.node->children = std::move(built->children);
+        replaced(item.node);
+    }
+}
+
+// Состояние истории.
+EditHistory::Statistics EditHistory::statistics() const
+{
+    Statistics stats;
+    stats.versions = static_cast<int>(versions.size());
+    stats.current = position + 1;
+    for (const auto& entry : table)
+        stats.storedNodes += entry.second.expired() ? 0 : 1;
+    for (const NodePtr& version : versions)
+        stats.treeNodes += version->size;
+    stats.addedNodes = addedNodes;
+    stats.commitUs = commitUs;
+    return stats;
+}
+
+// Найти или создать узел.
+EditHistory::NodePtr EditHistory::intern(NodeType type, const QString& value, std::vector<NodePtr> children)
+{
+    // Дети уже общие, поэтому равенство поддеревьев сводится
+    // к равенству указателей на детей.
+    size_t hash = static_cast<size_t>(type) * 0x9E3779B97F4A7C15ULL ^ static_cast<size_t>(qHash(value));
+    qint64 size = 1;
+    for (const NodePtr& child : children) {
+        hash ^= child->hash + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+        size += child->size;
+    }
+
+    const auto range = table.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        NodePtr node = it->second.lock();
+        if (node && node->type == type && node->value == value && node->children == children)
+            return node;
+    }
+
+    auto node = std::make_shared<const Node>(Node{type, value, std::move(children), hash, size});
+    table.emplace(hash, node);
+    ++addedNodes;
+    return node;
+}
+
+// Удалить из таблицы записи освобождённых узлов.
+void EditHistory::purge()
+{
+    for (auto it = table.begin(); it != table.end();) {
+        if (it->second.expired())
+            it = table.erase(it);
+        else
+            ++it;
+    }
+}
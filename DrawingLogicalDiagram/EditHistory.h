@@ -0,0 +1,187 @@
+#ifndef EDITHISTORY_H
+#define EDITHISTORY_H
+
+#include <QString>
+#include <QtGlobal>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "SchemaTree.h"
+
+/**
+ * @class EditHistory
+ * @brief История версий выражения для отмены и повтора
+ *
+ * Каждая версия — корень неизменяемого (персистентного) дерева.
+ * Узлы хэшируются структурно: одинаковые поддеревья любых версий
+ * хранятся одним узлом. Правка выражения меняет только путь от
+ * изменённого места до корня, поэтому новая версия добавляет в память
+ * лишь узлы этого пути, а остальные поддеревья берёт у предыдущих версий.
+ *
+ * @details
+ * - Узел, на который не ссылается ни одна версия, освобождается;
+ *   таблица хэширования держит на узлы только слабые ссылки.
+ * - Новая версия после отмены отбрасывает ветку повтора.
+ * - Число версий ограничено; самые старые версии удаляются.
+ * - Текст версии восстанавливается по дереву (toExpression), поэтому
+ *   у одинаковых деревьев одинаковый текст и общий ключ DiagramCache:
+ *   при переключении версий компоновка берётся из кэша.
+ * - Отличия двух версий переносятся в изменяемое дерево разбора
+ *   (patch) без его перестройки: общие поддеревья версий — один
+ *   и тот же узел, и их сравнение сводится к сравнению указателей.
+ */
+class EditHistory {
+public:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    /**
+     * @struct Node
+     * @brief Неизменяемый узел дерева версии
+     */
+    struct Node
+    {
+        NodeType type;                   ///< Тип узла
+        QString value;                   ///< Значение (переменная или оператор)
+        std::vector<NodePtr> children;   ///< Дочерние узлы
+        size_t hash;                     ///< Структурный хэш
+        qint64 size;                     ///< Число узлов поддерева как дерева
+    };
+
+    /**
+     * @struct Statistics
+     * @brief Состояние истории
+     */
+    struct Statistics
+    {
+        int versions = 0;          ///< Число версий
+        int current = 0;           ///< Номер текущей версии (с 1), 0 — история пуста
+        qint64 storedNodes = 0;    ///< Узлов в памяти на все версии
+        qint64 treeNodes = 0;      ///< Узлов во всех версиях, если хранить их копиями
+        qint64 addedNodes = 0;     ///< Новых узлов последней версии
+        qint64 commitUs = 0;       ///< Время добавления последней версии, мкс
+    };
+
+    /**
+     * @brief Конструктор
+     */
+    EditHistory();
+
+    /**
+     * @brief Задать наибольшее число версий
+     * @param versions Предел (не меньше 1)
+     */
+    void setLimit(int versions);
+
+    /**
+     * @brief Наибольшее число версий
+     * @return Предел
+     */
+    int limit() const;
+
+    /**
+     * @brief Добавить версию
+     * @param root Корень дерева разбора
+     * @return true, если версия добавлена; false, если дерево пустое
+     *         или совпадает с текущей версией
+     */
+    bool commit(const SchemaTree::Node* root);
+
+    /**
+     * @brief Есть ли версия для отмены
+     * @return true, если текущая версия не первая
+     */
+    bool canUndo() const;
+
+    /**
+     * @brief Есть ли версия для повтора
+     * @return true, если текущая версия не последняя
+     */
+    bool canRedo() const;
+
+    /**
+     * @brief Перейти к предыдущей версии
+     * @return true при успехе
+     */
+    bool undo();
+
+    /**
+     * @brief Перейти к следующей версии
+     * @return true при успехе
+     */
+    bool redo();
+
+    /**
+     * @brief Текущая версия
+     * @return Корень дерева или nullptr, если история пуста
+     */
+    NodePtr current() const;
+
+    /**
+     * @brief Текст выражения по дереву
+     * @param root Корень дерева
+     * @return Выражение без пробелов, которое SchemaTree разбирает в то же дерево
+     */
+    static QString toExpression(const NodePtr& root);
+
+    /**
+     * @brief Построить дерево разбора по версии
+     * @param root Корень версии
+     * @return Корень нового дерева или nullptr для пустой версии
+     */
+    static std::unique_ptr<SchemaTree::Node> toTree(const NodePtr& root);
+
+    /**
+     * @brief Перенести отличия версий в дерево разбора
+     * @param tree Корень дерева, построенного по версии from
+     * @param from Версия, которой соответствует tree
+     * @param to Новая версия
+     * @param replaced Вызывается для каждого узла, заменённого на месте
+     *
+     * Общие поддеревья версий пропускаются. У узлов с тем же типом,
+     * значением и числом детей сравниваются дети; остальные узлы
+     * получают тип, значение и детей из to, а объект узла остаётся
+     * прежним, поэтому указатели на него и его предков действительны.
+     * Обход без рекурсии.
+     */
+    static void patch(SchemaTree::Node* tree, const NodePtr& from, const NodePtr& to,
+                      const std::function<void(SchemaTree::Node*)>& replaced);
+
+    /**
+     * @brief Состояние истории
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+private:
+    /**
+     * @brief Найти или создать узел
+     * @param type Тип узла
+     * @param value Значение
+     * @param children Дочерние узлы (уже из таблицы)
+     * @return Общий узел с такой структурой
+     */
+    NodePtr intern(NodeType type, const QString& value, std::vector<NodePtr> children);
+
+    /**
+     * @brief Построить дерево разбора по узлу версии без рекурсии
+     * @param root Узел версии
+     * @return Корень нового дерева
+     */
+    static std::unique_ptr<SchemaTree::Node> buildTree(const Node* root);
+
+    /**
+     * @brief Удалить из таблицы записи освобождённых узлов
+     */
+    void purge();
+
+    std::unordered_multimap<size_t, std::weak_ptr<const Node>> table;  ///< Таблица хэширования
+    std::vector<NodePtr> versions;   ///< Корни версий
+    int position = -1;               ///< Индекс текущей версии
+    int maxVersions;                 ///< Наибольшее число версий
+    qint64 addedNodes = 0;           ///< Новых узлов последней версии
+    qint64 commitUs = 0;             ///< Время добавления последней версии, мкс
+};
+
+#endif // EDITHISTORY_H
@@ -0,0 +1,353 @@
+#include "EventSimulator.h"
+#include "VcdWriter.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+// Конструктор.
+EventSimulator::EventSimulator(const LogicGraph& graph)
+    : graph(graph)
+{
+    const int count = graph.size();
+    levels.assign(count, 0);
+    fanoutStart.assign(count + 1, 0);
+
+    int maxLevel = 0;
+    for (int id = 0; id < count; ++id) {
+        for (int fanin : graph.gate(id).fanins) {
+            levels[id] = std::max(levels[id], levels[fanin] + 1);
+            ++fanoutStart[fanin + 1];
+        }
+        maxLevel = std::max(maxLevel, levels[id]);
+    }
+
+    // Списки потребителей хранятся подряд в одном массиве.
+    for (int id = 0; id < count; ++id)
+        fanoutStart[id + 1] += fanoutStart[id];
+    fanouts.resize(fanoutStart[count]);
+    std::vector<int> fill(fanoutStart.begin(), fanoutStart.end() - 1);
+    for (int id = 0; id < count; ++id)
+        for (int fanin : graph.gate(id).fanins)
+            fanouts[fill[fanin]++] = id;
+
+    queue.resize(maxLevel + 1);
+    scheduled.assign(count, 0);
+    inputValues.assign(count, 0);
+    reset();
+}
+
+// Установить способ пересчёта.
+void EventSimulator::setMode(Mode mode)
+{
+    this->mode = mode;
+}
+
+// Сбросить все входы в 0 и пересчитать сеть.
+void EventSimulator::reset()
+{
+    values.assign(graph.size(), 0);
+    std::fill(inputValues.begin(), inputValues.end(), 0);
+    std::fill(scheduled.begin(), scheduled.end(), 0);
+    for (auto& bucket : queue)
+        bucket.clear();
+    pendingInputs.clear();
+    evaluateAll();
+    changed.clear();
+}
+
+// Задать значение входа.
+void EventSimulator::setInput(int inputGate, bool value)
+{
+    inputValues[inputGate] = value;
+    if (!scheduled[inputGate]) {
+        scheduled[inputGate] = 1;
+        pendingInputs.push_back(inputGate);
+    }
+}
+
+// Распространить изменения входов по сети.
+int EventSimulator::propagate()
+{
+    changed.clear();
+    lowestScheduled = static_cast<int>(queue.size());
+    highestScheduled = 0;
+
+    for (int id : pendingInputs) {
+        scheduled[id] = 0;
+        if (values[id] == inputValues[id])
+            continue;
+        values[id] = inputValues[id];
+        changed.push_back(id);
+        if (mode == Mode::EVENT_DRIVEN)
+            scheduleFanouts(id);
+    }
+    pendingInputs.clear();
+
+    if (mode == Mode::FULL_EVALUATION)
+        return evaluateAll();
+
+    // Уровни обрабатываются по возрастанию: к моменту вычисления вентиля
+    // все его входы уже имеют новые значения.
+    int evaluations = 0;
+    for (int level = lowestScheduled; level <= highestScheduled; ++level) {
+        std::vector<int>& bucket = queue[level];
+        for (int id : bucket) {
+            scheduled[id] = 0;
+            ++evaluations;
+            char v = evaluate(id);
+            if (v == values[id])
+                continue;
+            values[id] = v;
+            changed.push_back(id);
+            scheduleFanouts(id);
+        }
+        bucket.clear();
+    }
+    return evaluations;
+}
+
+// Текущее значение вентиля.
+bool EventSimulator::value(int gate) const
+{
+    return values[gate];
+}
+
+// Вентили, изменившие значение при последнем propagate().
+const std::vector<int>& EventSimulator::changedGates() const
+{
+    return changed;
+}
+
+// Вычислить вентиль по текущим значениям входов.
+bool EventSimulator::evaluate(int id) const
+{
+    const LogicGraph::Gate& g = graph.gate(id);
+    switch (g.kind) {
+    case LogicGraph::GateKind::CONST0:
+        return false;
+    case LogicGraph::GateKind::CONST1:
+        return true;
+    case LogicGraph::GateKind::INPUT:
+        return values[id];
+    case LogicGraph::GateKind::NOT:
+        return !values[g.fanins.front()];
+    case LogicGraph::GateKind::AND:
+        for (int fanin : g.fanins)
+            if (!values[fanin]) return false;
+        return true;
+    case LogicGraph::GateKind::OR:
+        for (int fanin : g.fanins)
+            if (values[fanin]) return true;
+        return false;
+    case LogicGraph::GateKind::XOR: {
+        bool parity = false;
+        for (int fanin : g.fanins)
+            parity ^= values[fanin] != 0;
+        return parity;
+    }
+    }
+    return false;
+}
+
+// Поставить потребителей вентиля в очередь.
+void EventSimulator::scheduleFanouts(int id)
+{
+    for (int i = fanoutStart[id]; i < fanoutStart[id + 1]; ++i) {
+        int fanout = fanouts[i];
+        if (!scheduled[fanout]) {
+            const int level = levels[fanout];
+            scheduled[fanout] = 1;
+            queue[level].push_back(fanout);
+            lowestScheduled = std::min(lowestScheduled, level);
+            highestScheduled = std::max(highestScheduled, level);
+        }
+    }
+}
+
+// Пересчитать всю сеть в топологическом порядке.
+int EventSimulator::evaluateAll()
+{
+    int evaluations = 0;
+    for (int id = 0; id < graph.size(); ++id) {
+        if (graph.gate(id).kind == LogicGraph::GateKind::INPUT)
+            continue;
+        ++evaluations;
+        char v = evaluate(id);
+        if (v != values[id]) {
+            values[id] = v;
+            changed.push_back(id);
+        }
+    }
+    return evaluations;
+}
+
+// Промоделировать файл воздействий и записать VCD.
+bool EventSimulator::run(const QString& stimulusPath, const QString& vcdPath)
+{
+    QFile stimulus(stimulusPath);
+    if (!stimulus.open(QIODevice::ReadOnly)) {
+        error = QString("Не удалось открыть %1: %2").arg(stimulusPath, stimulus.errorString());
+        return false;
+    }
+
+    QSaveFile vcd(vcdPath);
+    if (!vcd.open(QIODevice::WriteOnly)) {
+        error = QString("Не удалось создать %1: %2").arg(vcdPath, vcd.errorString());
+        return false;
+    }
+
+    if (!run(&stimulus, &vcd))
+        return false;
+
+    if (!vcd.commit()) {
+        error = QString("Не удалось записать %1: %2").arg(vcdPath, vcd.errorString());
+        return false;
+    }
+    return true;
+}
+
+// Промоделировать воздействия из устройства.
+bool EventSimulator::run(QIODevice* stimulus, QIODevice* vcd)
+{
+    QElapsedTimer timer;
+    timer.start();
+    error.clear();
+    stats = Statistics();
+    reset();
+
+    QHash<QByteArray, int> inputByName;
+    for (int id : graph.inputs())
+        inputByName.insert(graph.inputName(id).toUtf8(), id);
+
+    // Сигналы VCD: сначала входы, затем выходы; у вентиля может быть несколько сигналов.
+    std::unique_ptr<VcdWriter> writer;
+    std::vector<std::vector<int>> signalsOfGate(graph.size());
+    if (vcd) {
+        writer = std::make_unique<VcdWriter>(vcd);
+        for (int id : graph.inputs())
+            signalsOfGate[id].push_back(writer->addSignal(graph.inputName(id)));
+        for (const auto& output : graph.outputs())
+            signalsOfGate[output.gate].push_back(writer->addSignal(output.name));
+        writer->writeHeader();
+        for (int id = 0; id < graph.size(); ++id)
+            for (int signal : signalsOfGate[id])
+                writer->change(0, signal, values[id]);
+    }
+
+    auto step = [&](qint64 time) {
+        stats.evaluations += propagate();
+        ++stats.steps;
+        for (int id : changed) {
+            if (graph.gate(id).kind == LogicGraph::GateKind::INPUT)
+                ++stats.inputEvents;
+            if (writer)
+                for (int signal : signalsOfGate[id])
+                    writer->change(time, signal, values[id]);
+        }
+    };
+
+    // Присваивания с одинаковым временем объединяются в один шаг.
+    qint64 pendingTime = -1;
+    int lineNumber = 0;
+    while (!stimulus->atEnd()) {
+        const QByteArray line = stimulus->readLine();
+        ++lineNumber;
+
+        const char* p = line.constData();
+        const char* end = p + line.size();
+        auto skipSpaces = [&]() { while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p; };
+        auto token = [&]() { const char* start = p; while (p < end && !(*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p; return QByteArray(start, p - start); };
+
+        skipSpaces();
+        if (p == end || *p == '#')
+            continue;
+
+        bool ok = false;
+        const qint64 time = token().toLongLong(&ok);
+        if (!ok || time < 0)
+            return fail("Ожидалось время", lineNumber);
+        if (time < pendingTime)
+            return fail("Время убывает", lineNumber);
+
+        if (time != pendingTime && pendingTime >= 0)
+            step(pendingTime);
+        pendingTime = time;
+
+        for (skipSpaces(); p < end; skipSpaces()) {
+            const QByteArray assignment = token();
+            const int eq = assignment.indexOf('=');
+            if (eq <= 0 || eq != assignment.size() - 2
+                || (assignment.back() != '0' && assignment.back() != '1'))
+                return fail(QString("Ожидалось вход=0|1, получено %1").arg(QString::fromUtf8(assignment)), lineNumber);
+
+            const int id = inputByName.value(assignment.left(eq), -1);
+            if (id < 0)
+                return fail(QString("Неизвестный вход %1").arg(QString::fromUtf8(assignment.left(eq))), lineNumber);
+            setInput(id, assignment.back() == '1');
+        }
+    }
+    if (pendingTime >= 0)
+        step(pendingTime);
+
+    if (writer && !writer->finish()) {
+        error = QString("Ошибка записи VCD: %1").arg(vcd->errorString());
+        return false;
+    }
+
+    stats.elapsedMs = timer.elapsed();
+    return true;
+}
+
+// Сравнить событийное моделирование с полным пересчётом.
+std::vector<EventSimulator::BenchmarkResult> EventSimulator::benchmark(const LogicGraph& graph, qint64 steps,
+                                                                       int toggles, quint32 seed)
+{
+    const std::vector<int>& inputs = graph.inputs();
+    std::vector<BenchmarkResult> results;
+    for (Mode mode : {Mode::EVENT_DRIVEN, Mode::FULL_EVALUATION}) {
+        EventSimulator simulator(graph);
+        simulator.setMode(mode);
+        std::mt19937 random(seed);
+
+        BenchmarkResult result;
+        result.mode = mode;
+        result.steps = steps;
+        QElapsedTimer timer;
+        timer.start();
+        for (qint64 step = 0; step < steps; ++step) {
+            for (int k = 0; k < toggles && !inputs.empty(); ++k) {
+                const int id = inputs[random() % inputs.size()];
+                simulator.setInput(id, !simulator.inputValues[id]);
+            }
+            result.evaluations += simulator.propagate();
+            for (const LogicGraph::Output& output : graph.outputs())
+                result.checksum = result.checksum * 31 + static_cast<quint64>(simulator.values[output.gate]);
+        }
+        result.elapsedUs = timer.nsecsElapsed() / 1000;
+        results.push_back(result);
+    }
+    return results;
+}
+
+// Описание последней ошибки.
+QString EventSimulator::errorString() const
+{
+    return error;
+}
+
+// Статистика последнего моделирования.
+EventSimulator::Statistics EventSimulator::statistics() const
+{
+    return stats;
+}
+
+// Установить текст ошибки.
+bool EventSimulator::fail(const QString& message, int line)
+{
+    error = QString("Строка %1: %2").arg(line).arg(message);
+    return false;
+}
@@ -0,0 +1,204 @@
+#ifndef EVENTSIMULATOR_H
+#define EVENTSIMULATOR_H
+
+#include <QString>
+#include <QIODevice>
+#include <vector>
+#include "LogicGraph.h"
+
+/**
+ * @class EventSimulator
+ * @brief Событийное моделирование сети LogicGraph на уровне вентилей
+ *
+ * При изменении входа пересчитываются только вентили, у которых
+ * изменился хотя бы один вход. Вентили разбиты на уровни
+ * (длина самого длинного пути от входов), очередь событий
+ * хранится по уровням, поэтому каждый вентиль за шаг
+ * вычисляется не более одного раза и уже после всех своих входов.
+ *
+ * @details Файл воздействий — текст, одна строка на момент времени:
+ * @code
+ * # время  вход=значение ...
+ * 0   A=0 B=1 C=0
+ * 10  A=1
+ * 25  B=0 C=1
+ * @endcode
+ * Моменты времени не убывают; невошедшие в строку входы сохраняют
+ * прежние значения; до первой строки все входы равны 0.
+ * Результат записывается в VCD: входы и выходы сети.
+ *
+ * Для сравнения предусмотрен режим полного пересчёта всей сети
+ * на каждом шаге; статистика обоих режимов доступна через statistics(),
+ * а benchmark() прогоняет оба режима на одной случайной
+ * последовательности воздействий.
+ */
+class EventSimulator {
+public:
+    /**
+     * @enum Mode
+     * @brief Способ пересчёта сети после изменения входов
+     */
+    enum class Mode {
+        EVENT_DRIVEN,     ///< Только вентили с изменившимися входами
+        FULL_EVALUATION   ///< Все вентили на каждом шаге
+    };
+
+    /**
+     * @struct Statistics
+     * @brief Статистика последнего моделирования
+     */
+    struct Statistics
+    {
+        qint64 steps = 0;        ///< Число моментов времени
+        qint64 inputEvents = 0;  ///< Число изменений входов
+        qint64 evaluations = 0;  ///< Число вычислений вентилей
+        qint64 elapsedMs = 0;    ///< Время моделирования, мс
+    };
+
+    /**
+     * @struct BenchmarkResult
+     * @brief Результат замера одного режима
+     */
+    struct BenchmarkResult
+    {
+        Mode mode = Mode::EVENT_DRIVEN;  ///< Способ пересчёта
+        qint64 steps = 0;                ///< Число шагов
+        qint64 evaluations = 0;          ///< Число вычислений вентилей
+        qint64 elapsedUs = 0;            ///< Время моделирования, мкс
+        quint64 checksum = 0;            ///< Свёртка значений выходов на всех шагах
+    };
+
+    /**
+     * @brief Конструктор
+     * @param graph Моделируемая сеть (должна жить дольше симулятора)
+     *
+     * Строит уровни и списки потребителей и вычисляет
+     * начальное состояние при нулевых входах.
+     */
+    explicit EventSimulator(const LogicGraph& graph);
+
+    /**
+     * @brief Установить способ пересчёта
+     * @param mode Режим
+     */
+    void setMode(Mode mode);
+
+    /**
+     * @brief Сбросить все входы в 0 и пересчитать сеть
+     */
+    void reset();
+
+    /**
+     * @brief Задать значение входа (вступает в силу при propagate())
+     * @param inputGate Индекс вентиля-входа
+     * @param value Новое значение
+     */
+    void setInput(int inputGate, bool value);
+
+    /**
+     * @brief Распространить изменения входов по сети
+     * @return Число вычисленных вентилей
+     */
+    int propagate();
+
+    /**
+     * @brief Текущее значение вентиля
+     * @param gate Индекс вентиля
+     * @return Значение
+     */
+    bool value(int gate) const;
+
+    /**
+     * @brief Вентили, изменившие значение при последнем propagate()
+     * @return Список индексов (включая входы)
+     */
+    const std::vector<int>& changedGates() const;
+
+    /**
+     * @brief Промоделировать файл воздействий и записать VCD
+     * @param stimulusPath Путь к файлу воздействий
+     * @param vcdPath Путь к выходному файлу VCD
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool run(const QString& stimulusPath, const QString& vcdPath);
+
+    /**
+     * @brief Промоделировать воздействия из устройства
+     * @param stimulus Открытое на чтение устройство с воздействиями
+     * @param vcd Открытое на запись устройство для VCD (может быть nullptr)
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool run(QIODevice* stimulus, QIODevice* vcd);
+
+    /**
+     * @brief Сравнить событийное моделирование с полным пересчётом
+     * @param graph Сеть
+     * @param steps Число шагов
+     * @param toggles Число случайных входов, переключаемых на каждом шаге
+     * @param seed Начальное значение генератора воздействий
+     * @return Результаты режимов EVENT_DRIVEN и FULL_EVALUATION
+     *
+     * Оба режима получают одну и ту же последовательность воздействий,
+     * поэтому их свёртки выходов должны совпасть. VCD не пишется.
+     */
+    static std::vector<BenchmarkResult> benchmark(const LogicGraph& graph, qint64 steps,
+                                                  int toggles = 1, quint32 seed = 1);
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Статистика последнего моделирования
+     * @return Число шагов, событий, вычислений и время
+     */
+    Statistics statistics() const;
+
+private:
+    /**
+     * @brief Вычислить вентиль по текущим значениям входов
+     * @param id Индекс вентиля
+     * @return Значение вентиля
+     */
+    bool evaluate(int id) const;
+
+    /**
+     * @brief Поставить потребителей вентиля в очередь
+     * @param id Индекс изменившегося вентиля
+     */
+    void scheduleFanouts(int id);
+
+    /**
+     * @brief Пересчитать всю сеть в топологическом порядке
+     * @return Число вычисленных вентилей
+     */
+    int evaluateAll();
+
+    /**
+     * @brief Установить текст ошибки
+     * @param message Описание ошибки
+     * @param line Номер строки файла воздействий
+     * @return Всегда false, для удобного возврата
+     */
+    bool fail(const QString& message, int line);
+
+    const LogicGraph& graph;               ///< Моделируемая сеть
+    Mode mode = Mode::EVENT_DRIVEN;        ///< Способ пересчёта
+    std::vector<char> values;              ///< Текущие значения вентилей
+    std::vector<int> levels;               ///< Уровень каждого вентиля
+    std::vector<int> fanoutStart;          ///< Начало списка потребителей вентиля
+    std::vector<int> fanouts;              ///< Списки потребителей подряд
+    std::vector<std::vector<int>> queue;   ///< Очередь событий по уровням
+    std::vector<char> scheduled;           ///< Признак нахождения в очереди
+    std::vector<char> inputValues;         ///< Заданные значения входов
+    std::vector<int> pendingInputs;        ///< Входы, изменённые с прошлого шага
+    int lowestScheduled = 0;               ///< Наименьший уровень в очереди
+    int highestScheduled = 0;              ///< Наибольший уровень в очереди
+    std::vector<int> changed;              ///< Изменения последнего шага
+    QString error;                         ///< Текст последней ошибки
+    Statistics stats;                      ///< Статистика моделирования
+};
+
+#endif // EVENTSIMULATOR_H
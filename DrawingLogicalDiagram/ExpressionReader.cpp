@@ -0,0 +1,253 @@
+#include "ExpressionReader.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+// Константы.
+static constexpr char32_t INVALID_CODE_POINT = 0xFFFD;
+static constexpr std::string_view UTF8_BOM = "\xEF\xBB\xBF";
+
+// Декодировать символ UTF-8; length — число его байтов.
+static char32_t decodeUtf8(const unsigned char* p, size_t available, int& length)
+{
+    const unsigned char lead = p[0];
+    char32_t code = 0;
+    if (lead < 0x80) {
+        length = 1;
+        return lead;
+    } else if ((lead & 0xE0) == 0xC0) {
+        length = 2;
+        code = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3;
+        code = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4;
+        code = lead & 0x07;
+    } else {
+        length = 1;
+        return INVALID_CODE_POINT;
+    }
+
+    if (static_cast<size_t>(length) > available) {
+        length = 1;
+        return INVALID_CODE_POINT;
+    }
+    for (int i = 1; i < length; ++i) {
+        if ((p[i] & 0xC0) != 0x80) {
+            length = 1;
+            return INVALID_CODE_POINT;
+        }
+        code = (code << 6) | (p[i] & 0x3F);
+    }
+    return code;
+}
+
+// Пробельный символ в смысле QChar::isSpace.
+static bool isSpaceCode(char32_t code)
+{
+    return code <= 0xFFFF && QChar(static_cast<char16_t>(code)).isSpace();
+}
+
+// Прочитать выражение из файла.
+bool ExpressionReader::read(const QString& path, std::unique_ptr<SchemaTree::Node>& root)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(QString("Не удалось открыть файл %1: %2").arg(path, file.errorString()));
+
+    const qint64 size = file.size();
+    if (size <= 0)
+        return fail(QString("Файл %1 пуст").arg(path));
+
+    QByteArray buffer;
+    const char* data = reinterpret_cast<const char*>(file.map(0, size));
+    const bool mapped = data != nullptr;
+    if (!data) {
+        buffer = file.readAll();
+        data = buffer.constData();
+    }
+
+    const bool ok = readData(data, size, root);
+    stats.mapped = mapped;
+    return ok;
+}
+
+// Прочитать выражение из буфера.
+bool ExpressionReader::readData(const char* data, qint64 size, std::unique_ptr<SchemaTree::Node>& root)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    error.clear();
+    stats = Statistics();
+    stats.bytes = size;
+    root.reset();
+
+    std::string_view text(data, static_cast<size_t>(size));
+    if (text.substr(0, UTF8_BOM.size()) == UTF8_BOM)
+        text.remove_prefix(UTF8_BOM.size());
+    if (text.find_first_of("=;") != std::string_view::npos)
+        return fail("Файл содержит список уравнений; введите его в поле выражения");
+
+    // Корень разбирается как любой операнд; операторы кладут в стек
+    // кадры, которые по одному выдают свои операнды, пока стек не опустеет.
+    stack.clear();
+    parseRange(text, nullptr, root);
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        if (frame.done) {
+            stack.pop_back();
+            continue;
+        }
+
+        std::string_view part;
+        if (frame.next == std::string_view::npos) {
+            part = frame.rest;
+            frame.done = true;
+        } else {
+            part = frame.rest.substr(0, frame.next);
+            frame.rest.remove_prefix(frame.next + 1);
+            frame.next = findOperator(frame.rest);
+        }
+        parseRange(part, frame.node, root);
+    }
+
+    if (!root)
+        return fail("Файл не содержит выражения");
+
+    stats.elapsedMs = timer.elapsed();
+    return true;
+}
+
+// Описание последней ошибки.
+QString ExpressionReader::errorString() const
+{
+    return error;
+}
+
+// Статистика последнего чтения.
+ExpressionReader::Statistics ExpressionReader::statistics() const
+{
+    return stats;
+}
+
+// Файл выражения по расширению.
+bool ExpressionReader::isExpressionFile(const QString& path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == "txt" || suffix == "expr";
+}
+
+// Разобрать диапазон и добавить узел к родителю.
+void ExpressionReader::parseRange(std::string_view text, SchemaTree::Node* parent,
+                                  std::unique_ptr<SchemaTree::Node>& root)
+{
+    auto attach = [&](std::unique_ptr<SchemaTree::Node> node) {
+        SchemaTree::Node* raw = node.get();
+        if (parent)
+            parent->children.push_back(std::move(node));
+        else
+            root = std::move(node);
+        ++stats.nodes;
+        return raw;
+    };
+
+    // Те же шаги, что в SchemaTree::buildTreeHelper, но над
+    // диапазонами исходного текста: пробелы ' ' не удаляются,
+    // а пропускаются там, где SchemaTree смотрит на края строки.
+    for (;;) {
+        text = trim(text);
+        if (text.empty())
+            return;
+
+        const size_t op = findOperator(text);
+        if (op != std::string_view::npos) {
+            SchemaTree::Node* node = attach(std::make_unique<SchemaTree::Node>(NodeType::OP, QString(QChar(text[op]))));
+            stack.push_back(Frame{node, text, op, false});
+            return;
+        }
+
+        if (text.front() == '!') {
+            parent = attach(std::make_unique<SchemaTree::Node>(NodeType::NOT, "!"));
+            text.remove_prefix(1);
+            const size_t first = text.find_first_not_of(' ');
+            const size_t last = text.find_last_not_of(' ');
+            if (first != std::string_view::npos && first < last && text[first] == '(' && text[last] == ')')
+                text = text.substr(first + 1, last - first - 1);
+            continue;
+        }
+
+        if (text.front() == '(' && text.back() == ')') {
+            text = text.substr(1, text.size() - 2);
+            continue;
+        }
+
+        attach(std::make_unique<SchemaTree::Node>(NodeType::VAR, variableName(text)));
+        return;
+    }
+}
+
+// Первый оператор верхнего уровня.
+size_t ExpressionReader::findOperator(std::string_view text)
+{
+    int depth = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c == '(')
+            ++depth;
+        else if (c == ')')
+            --depth;
+        else if (depth == 0 && (c == '&' || c == '|' || c == '^'))
+            return i;
+    }
+    return std::string_view::npos;
+}
+
+// Снять пробельные символы с краёв.
+std::string_view ExpressionReader::trim(std::string_view text)
+{
+    auto bytes = [&text]() { return reinterpret_cast<const unsigned char*>(text.data()); };
+
+    while (!text.empty()) {
+        int length = 0;
+        if (!isSpaceCode(decodeUtf8(bytes(), text.size(), length)))
+            break;
+        text.remove_prefix(length);
+    }
+
+    // С конца: начало последнего символа — первый байт,
+    // не являющийся продолжением последовательности UTF-8.
+    while (!text.empty()) {
+        size_t start = text.size() - 1;
+        while (start > 0 && text.size() - start < 4 && (bytes()[start] & 0xC0) == 0x80)
+            --start;
+        int length = 0;
+        const char32_t code = decodeUtf8(bytes() + start, text.size() - start, length);
+        if (start + length != text.size() || !isSpaceCode(code))
+            break;
+        text.remove_suffix(length);
+    }
+    return text;
+}
+
+// Имя переменной без пробелов.
+QString ExpressionReader::variableName(std::string_view text)
+{
+    if (text.find(' ') == std::string_view::npos)
+        return QString::fromUtf8(text.data(), static_cast<int>(text.size()));
+
+    nameBuffer.clear();
+    for (char c : text) {
+        if (c != ' ')
+            nameBuffer.append(c);
+    }
+    return QString::fromUtf8(nameBuffer);
+}
+
+// Запомнить ошибку.
+bool ExpressionReader::fail(const QString& message)
+{
+    error = message;
+    return false;
+}
@@ -0,0 +1,143 @@
+#ifndef EXPRESSIONREADER_H
+#define EXPRESSIONREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "SchemaTree.h"
+
+/**
+ * @class ExpressionReader
+ * @brief Чтение логического выражения из файла без перевода всего текста в QString
+ *
+ * Файл отображается в память и разбирается прямо по байтам UTF-8
+ * через std::string_view: пробелы пропускаются при разборе, а не
+ * удаляются копированием строки. В QString переводятся только имена
+ * переменных, поэтому при загрузке, кроме самого дерева, память
+ * занимает лишь отображение файла.
+ *
+ * @details
+ * - Строится то же дерево, что и SchemaTree для текста файла:
+ *   главный оператор — первый оператор верхнего уровня, пустые
+ *   операнды пропускаются, скобки снимаются по тем же правилам.
+ * - Края операндов обрезаются по QChar::isSpace, в том числе для
+ *   многобайтовых пробельных символов UTF-8; метка BOM пропускается.
+ * - Разбор без рекурсии; операнды ищутся ленивым просмотром,
+ *   поэтому положения операторов не хранятся.
+ * - Списки уравнений (`=` или `;`) этим классом не читаются.
+ */
+class ExpressionReader {
+public:
+    /**
+     * @struct Statistics
+     * @brief Статистика последнего чтения
+     */
+    struct Statistics
+    {
+        qint64 bytes = 0;      ///< Размер входных данных в байтах
+        qint64 nodes = 0;      ///< Число узлов дерева
+        qint64 elapsedMs = 0;  ///< Время чтения и разбора, мс
+        bool mapped = false;   ///< Файл был отображён в память
+    };
+
+    /**
+     * @brief Прочитать выражение из файла
+     * @param path Путь к файлу
+     * @param root Сюда записывается корень дерева
+     * @return true при успехе; иначе см. errorString()
+     *
+     * Файл отображается в память; если это невозможно,
+     * читается целиком в буфер.
+     */
+    bool read(const QString& path, std::unique_ptr<SchemaTree::Node>& root);
+
+    /**
+     * @brief Прочитать выражение из буфера
+     * @param data Начало данных в UTF-8
+     * @param size Размер данных в байтах
+     * @param root Сюда записывается корень дерева
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool readData(const char* data, qint64 size, std::unique_ptr<SchemaTree::Node>& root);
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Статистика последнего чтения
+     * @return Объём, время и размер дерева
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief Файл выражения по расширению
+     * @param path Путь к файлу
+     * @return true для *.txt и *.expr
+     */
+    static bool isExpressionFile(const QString& path);
+
+private:
+    /**
+     * @brief Разобрать диапазон и добавить узел к родителю
+     * @param text Диапазон текста
+     * @param parent Родитель; nullptr — корень
+     * @param root Корень дерева
+     *
+     * Узлы NOT и скобки снимаются сразу; для оператора в стек
+     * кладётся кадр, который выдаёт операнды по одному.
+     */
+    void parseRange(std::string_view text, SchemaTree::Node* parent, std::unique_ptr<SchemaTree::Node>& root);
+
+    /**
+     * @brief Первый оператор верхнего уровня
+     * @param text Диапазон текста
+     * @return Позиция оператора или std::string_view::npos
+     */
+    static size_t findOperator(std::string_view text);
+
+    /**
+     * @brief Снять пробельные символы с краёв
+     * @param text Диапазон текста
+     * @return Диапазон без пробельных символов по краям
+     */
+    static std::string_view trim(std::string_view text);
+
+    /**
+     * @brief Имя переменной без пробелов
+     * @param text Диапазон текста
+     * @return Имя в QString
+     */
+    QString variableName(std::string_view text);
+
+    /**
+     * @brief Запомнить ошибку
+     * @param message Текст ошибки
+     * @return false
+     */
+    bool fail(const QString& message);
+
+    /**
+     * @struct Frame
+     * @brief Оператор, операнды которого ещё не разобраны
+     */
+    struct Frame
+    {
+        SchemaTree::Node* node;  ///< Узел оператора
+        std::string_view rest;   ///< Текст после последнего выданного оператора
+        size_t next;             ///< Позиция следующего оператора в rest
+        bool done;               ///< Последний операнд выдан
+    };
+
+    std::vector<Frame> stack;   ///< Стек операторов
+    QByteArray nameBuffer;      ///< Буфер имени переменной с пробелами внутри
+    QString error;              ///< Описание последней ошибки
+    Statistics stats;           ///< Статистика последнего чтения
+};
+
+#endif // EXPRESSIONREADER_H
@@ -0,0 +1,347 @@
+#include "FaultSimulator.h"
+#include "WorkStealingPool.h"
+#include <QElapsedTimer>
+#include <algorithm>
+
+// Константы.
+static constexpr qint64 DEFAULT_RANDOM_PATTERNS = 1 << 16;
+static constexpr qint64 MAX_BATCH_WORDS = 1 << 22;
+static constexpr int FAULTS_PER_TASK = 16;
+static constexpr int CONST0_VARIABLE = -1;
+static constexpr int CONST1_VARIABLE = -2;
+static constexpr int DESCRIPTION_LENGTH = 40;
+
+// Маски первых шести переменных при полном переборе внутри слова.
+static constexpr quint64 EXHAUSTIVE_MASKS[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+// Перемешивание SplitMix64 для воспроизводимых случайных шаблонов.
+static quint64 splitMix64(quint64 x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Добавить дерево (выход) к моделируемой схеме.
+void FaultSimulator::addTree(const SchemaTree::Node* root)
+{
+    if (!root)
+        return;
+
+    // Обход без рекурсии: узел записывается после всех своих детей,
+    // индексы готовых детей копятся в стеке finished.
+    struct Frame { const SchemaTree::Node* node; size_t next; };
+    std::vector<Frame> stack{{root, 0}};
+    std::vector<int> finished;
+
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        if (frame.next < frame.node->children.size()) {
+            const SchemaTree::Node* child = frame.node->children[frame.next++].get();
+            stack.push_back({child, 0});
+            continue;
+        }
+
+        const SchemaTree::Node* src = frame.node;
+        stack.pop_back();
+
+        Node node{src->type, 0, static_cast<int>(childList.size()),
+                  static_cast<int>(src->children.size()), -1, 0, src};
+        const int index = static_cast<int>(nodes.size());
+
+        if (src->type == NodeType::VAR) {
+            if (src->value == "0") {
+                node.variable = CONST0_VARIABLE;
+            } else if (src->value == "1") {
+                node.variable = CONST1_VARIABLE;
+            } else {
+                node.variable = variableByName.value(src->value, -1);
+                if (node.variable < 0) {
+                    node.variable = variableByName.size();
+                    variableByName.insert(src->value, node.variable);
+                }
+            }
+        } else if (src->type == NodeType::OP) {
+            node.op = src->value.isEmpty() ? '&' : src->value.at(0).toLatin1();
+        }
+
+        const size_t first = finished.size() - node.childCount;
+        for (size_t i = first; i < finished.size(); ++i) {
+            childList.push_back(finished[i]);
+            nodes[finished[i]].parent = index;
+        }
+        finished.resize(first);
+        finished.push_back(index);
+        nodes.push_back(node);
+    }
+
+    roots.push_back(static_cast<int>(nodes.size()) - 1);
+}
+
+// Задать число шаблонов.
+void FaultSimulator::setPatternCount(qint64 count)
+{
+    patternCount = count;
+}
+
+// Задать начальное значение генератора шаблонов.
+void FaultSimulator::setSeed(quint64 seed)
+{
+    this->seed = seed;
+}
+
+// Задать число потоков.
+void FaultSimulator::setThreadCount(int threads)
+{
+    threadCount = threads;
+}
+
+// Слово значений переменной для блока шаблонов.
+quint64 FaultSimulator::inputWord(int variable, qint64 block) const
+{
+    if (!exhaustive)
+        return splitMix64(seed ^ splitMix64(static_cast<quint64>(block) * variableByName.size() + variable));
+
+    if (variable < 6)
+        return EXHAUSTIVE_MASKS[variable];
+    return ((block >> (variable - 6)) & 1) ? ~0ULL : 0ULL;
+}
+
+// Вычислить слово значений узла по значениям детей.
+quint64 FaultSimulator::evaluate(const Node& node, const quint64* values, const quint64* inputs) const
+{
+    if (node.type == NodeType::VAR) {
+        if (node.variable == CONST0_VARIABLE) return 0;
+        if (node.variable == CONST1_VARIABLE) return ~0ULL;
+        return inputs[node.variable];
+    }
+
+    const int* child = childList.data() + node.firstChild;
+    if (node.type == NodeType::NOT)
+        return node.childCount ? ~values[child[0]] : ~0ULL;
+
+    quint64 result = (node.op == '&') ? ~0ULL : 0;
+    for (int i = 0; i < node.childCount; ++i) {
+        const quint64 v = values[child[i]];
+        if (node.op == '&') result &= v;
+        else if (node.op == '|') result |= v;
+        else result ^= v;
+    }
+    return result;
+}
+
+// Свернуть эквивалентные неисправности.
+void FaultSimulator::collapseFaults()
+{
+    // Неисправность f = 2 * узел + значение. Представитель класса —
+    // неисправность ближайшего к корню узла: её путь распространения короче.
+    const int count = static_cast<int>(nodes.size()) * 2;
+    representative.resize(count);
+    for (int f = 0; f < count; ++f)
+        representative[f] = f;
+
+    auto find = [this](int f) {
+        while (representative[f] != f) {
+            representative[f] = representative[representative[f]];
+            f = representative[f];
+        }
+        return f;
+    };
+    auto unite = [&](int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a != b)
+            representative[std::min(a, b)] = std::max(a, b);
+    };
+
+    for (int p = 0; p < static_cast<int>(nodes.size()); ++p) {
+        const Node& node = nodes[p];
+        for (int i = 0; i < node.childCount; ++i) {
+            const int c = childList[node.firstChild + i];
+            if (node.type == NodeType::NOT) {
+                unite(2 * c, 2 * p + 1);
+                unite(2 * c + 1, 2 * p);
+            } else if (node.op == '&') {
+                unite(2 * c, 2 * p);
+            } else if (node.op == '|') {
+                unite(2 * c + 1, 2 * p + 1);
+            }
+        }
+    }
+
+    for (int f = 0; f < count; ++f)
+        representative[f] = find(f);
+}
+
+// Выполнить моделирование всех неисправностей.
+FaultSimulator::Statistics FaultSimulator::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const int nodeCount = static_cast<int>(nodes.size());
+    const int variableCount = variableByName.size();
+
+    stats = Statistics();
+    exhaustive = patternCount == 0 && variableCount <= MAX_EXHAUSTIVE_INPUTS;
+    stats.exhaustive = exhaustive;
+    stats.patterns = exhaustive ? (qint64(1) << variableCount)
+                                : (patternCount > 0 ? patternCount : DEFAULT_RANDOM_PATTERNS);
+    stats.faults = nodeCount * 2;
+
+    collapseFaults();
+    detectedFlags.assign(stats.faults, 0);
+
+    std::vector<int> pending;
+    for (int f = 0; f < stats.faults; ++f)
+        if (representative[f] == f)
+            pending.push_back(f);
+    stats.collapsedFaults = static_cast<int>(pending.size());
+
+    WorkStealingPool pool(threadCount);
+    stats.threads = pool.threadCount();
+
+    const qint64 blocks = (stats.patterns + 63) / 64;
+    const qint64 blocksPerBatch = std::max<qint64>(1, MAX_BATCH_WORDS / std::max(1, nodeCount));
+    std::vector<quint64> good;
+
+    for (qint64 batchStart = 0; batchStart < blocks && !pending.empty(); batchStart += blocksPerBatch) {
+        const int batchBlocks = static_cast<int>(std::min(blocksPerBatch, blocks - batchStart));
+        good.resize(static_cast<size_t>(batchBlocks) * nodeCount);
+
+        // Исправные значения всех узлов для блоков пакета.
+        pool.parallelFor(batchBlocks, [&](int b, int) {
+            std::vector<quint64> inputs(variableCount);
+            for (int v = 0; v < variableCount; ++v)
+                inputs[v] = inputWord(v, batchStart + b);
+            quint64* values = good.data() + static_cast<size_t>(b) * nodeCount;
+            for (int n = 0; n < nodeCount; ++n)
+                values[n] = evaluate(nodes[n], values, inputs.data());
+        });
+
+        const int tasks = static_cast<int>((pending.size() + FAULTS_PER_TASK - 1) / FAULTS_PER_TASK);
+        pool.parallelFor(tasks, [&](int task, int) {
+            const size_t end = std::min(pending.size(), static_cast<size_t>(task + 1) * FAULTS_PER_TASK);
+            for (size_t i = static_cast<size_t>(task) * FAULTS_PER_TASK; i < end; ++i) {
+                const int fault = pending[i];
+                for (int b = 0; b < batchBlocks; ++b) {
+                    const qint64 block = batchStart + b;
+                    const qint64 valid = std::min<qint64>(64, stats.patterns - block * 64);
+                    const quint64 mask = valid == 64 ? ~0ULL : ((1ULL << valid) - 1);
+                    const quint64* values = good.data() + static_cast<size_t>(b) * nodeCount;
+
+                    // Неисправность распространяется только вверх по дереву.
+                    int current = fault / 2;
+                    quint64 value = (fault & 1) ? ~0ULL : 0;
+                    bool visible = ((value ^ values[current]) & mask) != 0;
+                    while (visible && nodes[current].parent >= 0) {
+                        const int parent = nodes[current].parent;
+                        const Node& node = nodes[parent];
+                        const int* child = childList.data() + node.firstChild;
+                        quint64 result;
+                        if (node.type == NodeType::NOT) {
+                            result = ~value;
+                        } else {
+                            result = (node.op == '&') ? ~0ULL : 0;
+                            for (int k = 0; k < node.childCount; ++k) {
+                                const quint64 v = (child[k] == current) ? value : values[child[k]];
+                                if (node.op == '&') result &= v;
+                                else if (node.op == '|') result |= v;
+                                else result ^= v;
+                            }
+                        }
+                        value = result;
+                        current = parent;
+                        visible = ((value ^ values[current]) & mask) != 0;
+                    }
+
+                    if (visible) {
+                        detectedFlags[fault] = 1;
+                        break;
+                    }
+                }
+            }
+        });
+
+        // Обнаруженные неисправности в следующих пакетах не моделируются.
+        pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                     [this](int f) { return detectedFlags[f] != 0; }),
+                      pending.end());
+    }
+
+    for (int f = 0; f < stats.faults; ++f)
+        if (detectedFlags[representative[f]])
+            ++stats.detected;
+
+    stats.elapsedMs = timer.elapsed();
+    return stats;
+}
+
+// Замер масштабирования по числу потоков.
+std::vector<FaultSimulator::Statistics> FaultSimulator::benchmark(const std::vector<int>& threadCounts)
+{
+    const int savedThreads = threadCount;
+    std::vector<Statistics> result;
+    for (int threads : threadCounts) {
+        threadCount = threads;
+        result.push_back(run());
+    }
+    threadCount = savedThreads;
+    return result;
+}
+
+// Результаты последнего моделирования.
+FaultSimulator::Statistics FaultSimulator::statistics() const
+{
+    return stats;
+}
+
+// Необнаруженные неисправности последнего моделирования.
+std::vector<FaultSimulator::Fault> FaultSimulator::undetectedFaults() const
+{
+    std::vector<Fault> result;
+    for (size_t f = 0; f < representative.size(); ++f)
+        if (!detectedFlags[representative[f]])
+            result.push_back(Fault{static_cast<int>(f / 2), (f & 1) != 0});
+    return result;
+}
+
+// Текстовое описание неисправности.
+QString FaultSimulator::describe(const Fault& fault) const
+{
+    QString text;
+    appendText(nodes[fault.node].source, text, DESCRIPTION_LENGTH);
+    if (text.size() > DESCRIPTION_LENGTH)
+        text = text.left(DESCRIPTION_LENGTH) + "...";
+    return QString("%1 ≡ %2").arg(text).arg(fault.stuckAt ? 1 : 0);
+}
+
+// Текстовая запись поддерева с ограничением длины.
+void FaultSimulator::appendText(const SchemaTree::Node* node, QString& text, int maxLength)
+{
+    if (!node || text.size() > maxLength)
+        return;
+
+    if (node->type == NodeType::VAR) {
+        text += node->value;
+        return;
+    }
+    if (node->type == NodeType::NOT) {
+        text += "!";
+        if (!node->children.empty())
+            appendText(node->children.front().get(), text, maxLength);
+        return;
+    }
+
+    text += "(";
+    for (size_t i = 0; i < node->children.size() && text.size() <= maxLength; ++i) {
+        if (i > 0)
+            text += node->value;
+        appendText(node->children[i].get(), text, maxLength);
+    }
+    text += ")";
+}
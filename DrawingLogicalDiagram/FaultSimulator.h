@@ -0,0 +1,190 @@
+#ifndef FAULTSIMULATOR_H
+#define FAULTSIMULATOR_H
+
+#include <QString>
+#include <QHash>
+#include <vector>
+#include "SchemaTree.h"
+
+/**
+ * @class FaultSimulator
+ * @brief Параллельное по шаблонам моделирование константных неисправностей
+ *
+ * Для каждого ребра дерева SchemaTree (выхода каждого узла, включая
+ * листья-переменные и корень Y) рассматриваются неисправности
+ * «константа 0» и «константа 1». Класс определяет, какие из них
+ * обнаруживаются набором входных шаблонов, и вычисляет покрытие.
+ *
+ * @details
+ * - 64 шаблона моделируются одновременно в одном машинном слове.
+ * - Эквивалентные неисправности свёртываются (константа 0 на входе
+ *   AND ≡ константа 0 на выходе, константа 1 на входе OR ≡ константа 1
+ *   на выходе, неисправности входа и выхода NOT); моделируется один
+ *   представитель класса.
+ * - В дереве нет разветвлений, поэтому неисправность распространяется
+ *   только по пути к корню; распространение прекращается, как только
+ *   значение совпадает с исправным.
+ * - Обнаруженные неисправности исключаются из дальнейшего моделирования.
+ * - Список неисправностей распределяется по WorkStealingPool.
+ *
+ * Масштабирование по числу потоков замеряет benchmark().
+ *
+ * При числе входов до MAX_EXHAUSTIVE_INPUTS и нулевом числе шаблонов
+ * перебираются все входные наборы, иначе используются
+ * воспроизводимые псевдослучайные шаблоны.
+ */
+class FaultSimulator {
+public:
+    /**
+     * @struct Fault
+     * @brief Константная неисправность на выходе узла
+     */
+    struct Fault
+    {
+        int node;       ///< Номер узла (в порядке обхода «дети перед родителем»)
+        bool stuckAt;   ///< Константное значение неисправности
+    };
+
+    /**
+     * @struct Statistics
+     * @brief Результаты последнего моделирования
+     */
+    struct Statistics
+    {
+        int faults = 0;           ///< Всего неисправностей
+        int collapsedFaults = 0;  ///< Представителей классов эквивалентности
+        int detected = 0;         ///< Обнаружено неисправностей (из faults)
+        qint64 patterns = 0;      ///< Число входных шаблонов
+        bool exhaustive = false;  ///< Перебраны все входные наборы
+        int threads = 0;          ///< Число потоков
+        qint64 elapsedMs = 0;     ///< Время моделирования, мс
+
+        /**
+         * @brief Покрытие неисправностей
+         * @return Доля обнаруженных неисправностей в процентах
+         */
+        double coverage() const { return faults ? 100.0 * detected / faults : 100.0; }
+    };
+
+    static constexpr int MAX_EXHAUSTIVE_INPUTS = 20;  ///< Предел полного перебора
+
+    /**
+     * @brief Добавить дерево (выход) к моделируемой схеме
+     * @param root Корень дерева; переменные с одинаковыми именами общие
+     */
+    void addTree(const SchemaTree::Node* root);
+
+    /**
+     * @brief Задать число шаблонов
+     * @param count Число шаблонов (0 — полный перебор, если входов немного)
+     */
+    void setPatternCount(qint64 count);
+
+    /**
+     * @brief Задать начальное значение генератора шаблонов
+     * @param seed Начальное значение
+     */
+    void setSeed(quint64 seed);
+
+    /**
+     * @brief Задать число потоков
+     * @param threads Число потоков (0 — по числу ядер)
+     */
+    void setThreadCount(int threads);
+
+    /**
+     * @brief Выполнить моделирование всех неисправностей
+     * @return Статистика моделирования
+     */
+    Statistics run();
+
+    /**
+     * @brief Замер масштабирования по числу потоков
+     * @param threadCounts Числа потоков для прогонов
+     * @return Статистика прогона для каждого числа потоков
+     *
+     * Добавленные деревья моделируются заново для каждого числа
+     * потоков на одних и тех же шаблонах; заданное число потоков
+     * после замера восстанавливается.
+     */
+    std::vector<Statistics> benchmark(const std::vector<int>& threadCounts);
+
+    /**
+     * @brief Результаты последнего моделирования
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief Необнаруженные неисправности последнего моделирования
+     * @return Список неисправностей, включая эквивалентные
+     */
+    std::vector<Fault> undetectedFaults() const;
+
+    /**
+     * @brief Текстовое описание неисправности
+     * @param fault Неисправность
+     * @return Строка вида "(A&B) ≡ 0"
+     */
+    QString describe(const Fault& fault) const;
+
+private:
+    /**
+     * @struct Node
+     * @brief Узел дерева в плоском представлении
+     */
+    struct Node
+    {
+        NodeType type;                    ///< Тип узла
+        char op;                          ///< Оператор: '&', '|', '^'
+        int firstChild;                   ///< Начало детей в childList
+        int childCount;                   ///< Число детей
+        int parent;                       ///< Родитель или -1 для корня
+        int variable;                     ///< Номер переменной для листьев
+        const SchemaTree::Node* source;   ///< Исходный узел дерева
+    };
+
+    /**
+     * @brief Вычислить слово значений узла по значениям детей
+     * @param node Узел
+     * @param values Значения узлов
+     * @param inputs Значения переменных
+     * @return 64 значения узла
+     */
+    quint64 evaluate(const Node& node, const quint64* values, const quint64* inputs) const;
+
+    /**
+     * @brief Слово значений переменной для блока шаблонов
+     * @param variable Номер переменной
+     * @param block Номер блока из 64 шаблонов
+     * @return Значения переменной в 64 шаблонах
+     */
+    quint64 inputWord(int variable, qint64 block) const;
+
+    /**
+     * @brief Свернуть эквивалентные неисправности
+     */
+    void collapseFaults();
+
+    /**
+     * @brief Текстовая запись поддерева с ограничением длины
+     * @param node Узел
+     * @param text Сюда дописывается текст
+     * @param maxLength Предельная длина
+     */
+    static void appendText(const SchemaTree::Node* node, QString& text, int maxLength);
+
+    std::vector<Node> nodes;               ///< Узлы: дети раньше родителей
+    std::vector<int> childList;            ///< Списки детей подряд
+    std::vector<int> roots;                ///< Корни деревьев (выходы)
+    QHash<QString, int> variableByName;    ///< Номера переменных
+    std::vector<int> representative;       ///< Представитель класса каждой неисправности
+    std::vector<char> detectedFlags;       ///< Признак обнаружения представителя
+    qint64 patternCount = 0;               ///< Заданное число шаблонов
+    quint64 seed = 1;                      ///< Начальное значение генератора
+    int threadCount = 0;                   ///< Заданное число потоков
+    bool exhaustive = false;               ///< Режим полного перебора
+    Statistics stats;                      ///< Результаты моделирования
+};
+
+#endif // FAULTSIMULATOR_H
@@ -0,0 +1,216 @@
+#include "GraphDiagram.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QGraphicsTextItem>
+#include <QPen>
+#include <QBrush>
+#include <algorithm>
+
+// Константы.
+static constexpr qreal SCENE_MARGIN = 50.0;
+static constexpr qreal GATE_WIDTH = 60.0;
+static constexpr qreal PIN_PITCH = 20.0;
+static constexpr qreal GATE_GAP = 20.0;
+static constexpr qreal ROUTE_GAP = 80.0;
+static constexpr qreal NOT_DIAMETER = 10.0;
+static constexpr qreal INPUT_COLUMN_WIDTH = 120.0;
+static constexpr qreal TRACK_PITCH = 8.0;
+static constexpr qreal WIRE_GAP = 10.0;
+static constexpr qreal OUTPUT_LINE_LEN = 100.0;
+static constexpr qreal BOX_SIZE = 10.0;
+static constexpr qreal RECT_TEXT_PADDING = 5.0;
+static constexpr qreal TEXT_OFFSET = 10.0;
+
+// Конструктор класса GraphDiagram.
+GraphDiagram::GraphDiagram(const LogicGraph& graph, QObject* parent)
+    : QObject(parent)
+    , graph(graph)
+{}
+
+// Добавляет текст в сцену.
+QGraphicsTextItem* GraphDiagram::addText(QGraphicsScene* scene, const QString& txt, const QColor& color)
+{
+    auto* item = scene->addText(txt);
+    item->setDefaultTextColor(color);
+    return item;
+}
+
+// Построить QGraphicsScene и вернуть её.
+QGraphicsScene* GraphDiagram::buildScene()
+{
+    auto* scene = new QGraphicsScene();
+    stats = Statistics();
+
+    if (graph.outputs().empty()) {
+        qDebug() << "Сеть не содержит выходов";
+        return scene;
+    }
+
+    LayeredLayout layout;
+    const std::vector<int> outputNodes = buildLayout(layout);
+    stats.layout = layout.run();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Входы и выходы нумеруются сверху вниз.
+    std::vector<std::pair<qreal, int>> inputs;
+    for (int id = 0; id < graph.size(); ++id) {
+        Box& box = boxes[id];
+        if (box.node < 0)
+            continue;
+
+        const QPointF position = layout.position(box.node);
+        box.x = position.x();
+        box.y = position.y();
+        if (graph.gate(id).fanins.empty())
+            inputs.emplace_back(box.y, id);
+        else
+            drawGate(scene, id);
+    }
+    std::stable_sort(inputs.begin(), inputs.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (const auto& input : inputs)
+        drawInput(scene, input.second);
+
+    const QPen linePen(Qt::black, 2);
+    for (const LayeredLayout::Segment& segment : layout.segments())
+        scene->addLine(segment.from.x(), segment.from.y(), segment.to.x(), segment.to.y(), linePen);
+
+    std::vector<std::pair<qreal, int>> outputs;
+    for (size_t i = 0; i < outputNodes.size(); ++i)
+        outputs.emplace_back(layout.position(outputNodes[i]).y(), static_cast<int>(i));
+    std::stable_sort(outputs.begin(), outputs.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (const auto& output : outputs)
+        drawOutput(scene, output.second, layout.position(outputNodes[output.second]));
+
+    scene->setSceneRect(scene->itemsBoundingRect().adjusted(-SCENE_MARGIN, -SCENE_MARGIN,
+                                                            SCENE_MARGIN, SCENE_MARGIN));
+    stats.drawingUs = timer.nsecsElapsed() / 1000;
+    return scene;
+}
+
+// Статистика последнего построения.
+GraphDiagram::Statistics GraphDiagram::statistics() const
+{
+    return stats;
+}
+
+// Передать отображаемые вентили и выходы в компоновку.
+std::vector<int> GraphDiagram::buildLayout(LayeredLayout& layout)
+{
+    const int count = graph.size();
+    boxes.assign(count, Box());
+
+    LayeredLayout::Spacing spacing;
+    spacing.nodeGap = GATE_GAP;
+    spacing.wireGap = WIRE_GAP;
+    spacing.channelWidth = ROUTE_GAP;
+    spacing.trackPitch = TRACK_PITCH;
+    spacing.margin = SCENE_MARGIN;
+    layout.setSpacing(spacing);
+
+    // Отображаются только вентили, от которых зависит хотя бы один выход.
+    std::vector<char> used(count, 0);
+    for (const auto& output : graph.outputs())
+        used[output.gate] = 1;
+    for (int id = count - 1; id >= 0; --id) {
+        if (!used[id]) continue;
+        for (int fanin : graph.gate(id).fanins)
+            used[fanin] = 1;
+    }
+
+    for (int id = 0; id < count; ++id) {
+        if (!used[id]) continue;
+
+        const LogicGraph::Gate& g = graph.gate(id);
+        Box& box = boxes[id];
+        if (g.fanins.empty()) {
+            box.w = INPUT_COLUMN_WIDTH - ROUTE_GAP;
+            box.h = PIN_PITCH;
+        } else {
+            box.w = GATE_WIDTH;
+            box.h = (g.fanins.size() + 1) * PIN_PITCH;
+        }
+
+        const qreal width = box.w + (g.kind == LogicGraph::GateKind::NOT ? NOT_DIAMETER : 0.0);
+        box.node = layout.addNode(width, box.h);
+        for (size_t pin = 0; pin < g.fanins.size(); ++pin)
+            layout.addEdge(boxes[g.fanins[pin]].node, box.node, (pin + 1) * PIN_PITCH);
+    }
+
+    std::vector<int> outputNodes;
+    for (const auto& output : graph.outputs()) {
+        const int node = layout.addNode(OUTPUT_LINE_LEN, PIN_PITCH, true);
+        layout.addEdge(boxes[output.gate].node, node, PIN_PITCH / 2.0);
+        outputNodes.push_back(node);
+    }
+    return outputNodes;
+}
+
+// Нарисовать вентиль.
+void GraphDiagram::drawGate(QGraphicsScene* scene, int id)
+{
+    const LogicGraph::Gate& g = graph.gate(id);
+    const Box& box = boxes[id];
+
+    scene->addRect(box.x, box.y, box.w, box.h, QPen(Qt::darkBlue, 1), QBrush(Qt::NoBrush));
+
+    QString displayText = "&";
+    if (g.kind == LogicGraph::GateKind::OR || g.kind == LogicGraph::GateKind::NOT)
+        displayText = "1";
+    else if (g.kind == LogicGraph::GateKind::XOR)
+        displayText = "=1";
+
+    auto* opText = addText(scene, displayText, Qt::blue);
+    opText->setPos(box.x + box.w - opText->boundingRect().width() - RECT_TEXT_PADDING,
+                   box.y + RECT_TEXT_PADDING);
+
+    if (g.kind == LogicGraph::GateKind::NOT)
+        scene->addEllipse(box.x + box.w, box.y + box.h / 2.0 - NOT_DIAMETER / 2.0,
+                          NOT_DIAMETER, NOT_DIAMETER, QPen(Qt::black, 2));
+}
+
+// Нарисовать вход или константу в столбце входов.
+void GraphDiagram::drawInput(QGraphicsScene* scene, int id)
+{
+    const Box& box = boxes[id];
+    const qreal centerY = box.y + box.h / 2.0;
+
+    QString name = graph.inputName(id);
+    if (graph.gate(id).kind == LogicGraph::GateKind::CONST0) name = "0";
+    else if (graph.gate(id).kind == LogicGraph::GateKind::CONST1) name = "1";
+
+    auto* text = addText(scene, name, Qt::black);
+    auto* textN = addText(scene, generator.generateName(NameFormat::NUMERIC_PREFIX), Qt::darkGreen);
+    const qreal textH = text->boundingRect().height();
+
+    scene->addRect(box.x - BOX_SIZE / 2.0, centerY - BOX_SIZE / 2.0, BOX_SIZE, BOX_SIZE,
+                   QPen(Qt::black, 2), QBrush(Qt::NoBrush));
+    scene->addLine(box.x, centerY, box.x + box.w, centerY, QPen(Qt::black, 2));
+
+    text->setPos(box.x + BOX_SIZE, centerY - textH);
+    textN->setPos(box.x - TEXT_OFFSET - textN->boundingRect().width() - BOX_SIZE,
+                  centerY - textH / 2.0);
+}
+
+// Нарисовать выход.
+void GraphDiagram::drawOutput(QGraphicsScene* scene, int index, const QPointF& position)
+{
+    QPen linePen(Qt::black, 2);
+    const qreal x = position.x();
+    const qreal y = position.y() + PIN_PITCH / 2.0;
+    const qreal endX = x + OUTPUT_LINE_LEN;
+
+    scene->addLine(x, y, endX, y, linePen);
+    scene->addRect(endX - BOX_SIZE / 2.0, y - BOX_SIZE / 2.0, BOX_SIZE, BOX_SIZE,
+                   linePen, QBrush(Qt::NoBrush));
+
+    auto* nameText = addText(scene, graph.outputs()[index].name, Qt::black);
+    auto* outText = addText(scene, generator.generateName(NameFormat::NUMERIC_PREFIX), Qt::darkGreen);
+    const qreal textH = nameText->boundingRect().height();
+
+    nameText->setPos(x + TEXT_OFFSET, y - textH);
+    outText->setPos(endX + BOX_SIZE + TEXT_OFFSET, y - textH / 2.0);
+}
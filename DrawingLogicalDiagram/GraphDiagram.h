@@ -0,0 +1,125 @@
+#ifndef GRAPHDIAGRAM_H
+#define GRAPHDIAGRAM_H
+
+#include <QObject>
+#include <QGraphicsScene>
+#include <QPointF>
+#include <vector>
+#include "LayeredLayout.h"
+#include "LogicGraph.h"
+#include "NameGenerator.h"
+
+/**
+ * @class GraphDiagram
+ * @brief Построение схемы с несколькими выходами по сети LogicGraph
+ *
+ * В отличие от DrawingDiagram, который рисует одно дерево с одним
+ * выходом, класс размещает всю сеть целиком: общий столбец входов
+ * слева, общий столбец выходов справа и вентили между ними.
+ * Вентиль, питающий несколько потребителей, рисуется один раз,
+ * поэтому время компоновки и отрисовки зависит от числа уникальных
+ * вентилей, а не от суммарного размера всех уравнений.
+ *
+ * @details Компоновку выполняет LayeredLayout (метод Сугиямы):
+ * - слой вентиля — длина самого длинного пути от входов;
+ * - порядок в слоях уменьшает число пересечений соединений;
+ * - вентили тянутся к выводам соседей с сохранением порядка;
+ * - соединения прокладываются ортогональными ломаными по дорожкам
+ *   каналов между слоями.
+ *
+ * Размеры элементов фиксированы; масштабирование выполняет view.
+ */
+class GraphDiagram : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Конструктор класса GraphDiagram
+     * @param graph Сеть для отображения
+     * @param parent Родительский объект QObject
+     */
+    explicit GraphDiagram(const LogicGraph& graph, QObject* parent = nullptr);
+
+    /**
+     * @brief Построить QGraphicsScene и вернуть её
+     * @return Указатель на новую QGraphicsScene
+     */
+    QGraphicsScene* buildScene();
+
+    /**
+     * @struct Statistics
+     * @brief Время построения последней сцены
+     */
+    struct Statistics
+    {
+        LayeredLayout::Statistics layout;  ///< Этапы компоновки
+        qint64 drawingUs = 0;              ///< Создание элементов сцены, мкс
+    };
+
+    /**
+     * @brief Статистика последнего построения
+     * @return Время этапов компоновки и отрисовки
+     */
+    Statistics statistics() const;
+
+private:
+    /**
+     * @struct Box
+     * @brief Положение вентиля на сцене
+     */
+    struct Box
+    {
+        qreal x = 0;      ///< Левый X
+        qreal y = 0;      ///< Верхний Y
+        qreal w = 0;      ///< Ширина
+        qreal h = 0;      ///< Высота
+        int node = -1;    ///< Узел компоновки (-1 — вентиль не отображается)
+    };
+
+    /**
+     * @brief Передать отображаемые вентили и выходы в компоновку
+     * @param layout Компоновка
+     * @return Узлы компоновки выходов в порядке graph.outputs()
+     */
+    std::vector<int> buildLayout(LayeredLayout& layout);
+
+    /**
+     * @brief Нарисовать вентиль
+     * @param scene Сцена
+     * @param id Индекс вентиля
+     */
+    void drawGate(QGraphicsScene* scene, int id);
+
+    /**
+     * @brief Нарисовать вход или константу в столбце входов
+     * @param scene Сцена
+     * @param id Индекс вентиля
+     */
+    void drawInput(QGraphicsScene* scene, int id);
+
+    /**
+     * @brief Нарисовать выход
+     * @param scene Сцена
+     * @param index Номер выхода в graph.outputs()
+     * @param position Левый верхний угол выхода
+     */
+    void drawOutput(QGraphicsScene* scene, int index, const QPointF& position);
+
+    /**
+     * @brief Добавляет текст в сцену
+     * @param scene Сцена
+     * @param txt Строка текста
+     * @param color Цвет текста
+     * @return QGraphicsTextItem*
+     */
+    QGraphicsTextItem* addText(QGraphicsScene* scene,
+                               const QString& txt,
+                               const QColor& color);
+
+    const LogicGraph& graph;  ///< Отображаемая сеть
+    NameGenerator generator;  ///< Генератор имён входов и выходов
+    std::vector<Box> boxes;   ///< Положение каждого вентиля
+    Statistics stats;         ///< Статистика последнего построения
+};
+
+#endif // GRAPHDIAGRAM_H
@@ -0,0 +1,518 @@
+#include "LayeredLayout.h"
+#include "WorkStealingPool.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+// Константы.
+static constexpr int MAX_SWEEPS = 12;
+static constexpr int PARALLEL_CHUNK = 2048;
+
+// Задать зазоры.
+void LayeredLayout::setSpacing(const Spacing& spacing)
+{
+    this->spacing = spacing;
+}
+
+// Задать число потоков упорядочивания.
+void LayeredLayout::setThreadCount(int threads)
+{
+    threadCount = threads;
+}
+
+// Добавить узел.
+int LayeredLayout::addNode(qreal width, qreal height, bool sink)
+{
+    Vertex vertex;
+    vertex.width = width;
+    vertex.height = height;
+    vertex.sink = sink;
+    vertex.source = static_cast<int>(vertices.size());
+    vertices.push_back(vertex);
+    originalCount = static_cast<int>(vertices.size());
+    return vertex.source;
+}
+
+// Добавить ребро.
+void LayeredLayout::addEdge(int from, int to, qreal pinOffset)
+{
+    edges.push_back(Edge{from, to, pinOffset});
+}
+
+// Выполнить компоновку.
+LayeredLayout::Statistics LayeredLayout::run()
+{
+    stats = Statistics();
+    stats.nodes = originalCount;
+    stats.edges = static_cast<int>(edges.size());
+
+    WorkStealingPool pool(threadCount);
+    stats.threads = pool.threadCount();
+
+    QElapsedTimer timer;
+    timer.start();
+    assignLayers();
+    stats.layeringUs = timer.nsecsElapsed() / 1000;
+
+    timer.restart();
+    reduceCrossings(pool);
+    stats.orderingUs = timer.nsecsElapsed() / 1000;
+
+    timer.restart();
+    assignCoordinates();
+    stats.coordinatesUs = timer.nsecsElapsed() / 1000;
+
+    timer.restart();
+    route(pool);
+    stats.routingUs = timer.nsecsElapsed() / 1000;
+
+    return stats;
+}
+
+// Левый верхний угол узла.
+QPointF LayeredLayout::position(int node) const
+{
+    const Vertex& vertex = vertices[node];
+    return QPointF(layerX[vertex.layer], vertex.y);
+}
+
+// Слой узла.
+int LayeredLayout::layer(int node) const
+{
+    return vertices[node].layer;
+}
+
+// Отрезки всех соединений.
+const std::vector<LayeredLayout::Segment>& LayeredLayout::segments() const
+{
+    return wires;
+}
+
+// Статистика последней компоновки.
+LayeredLayout::Statistics LayeredLayout::statistics() const
+{
+    return stats;
+}
+
+// Слои по самому длинному пути и фиктивные узлы.
+void LayeredLayout::assignLayers()
+{
+    vertices.resize(originalCount);
+    links.clear();
+
+    // Топологический порядок (Кан) и самый длинный путь от истоков.
+    std::vector<int> indegree(originalCount, 0);
+    std::vector<int> outStart(originalCount + 1, 0);
+    for (const Edge& edge : edges) {
+        ++indegree[edge.to];
+        ++outStart[edge.from + 1];
+    }
+    for (int v = 0; v < originalCount; ++v)
+        outStart[v + 1] += outStart[v];
+    std::vector<int> outEdges(edges.size());
+    std::vector<int> fill(outStart.begin(), outStart.end() - 1);
+    for (int e = 0; e < static_cast<int>(edges.size()); ++e)
+        outEdges[fill[edges[e].from]++] = e;
+
+    std::vector<int> ready;
+    for (int v = 0; v < originalCount; ++v) {
+        vertices[v].layer = 0;
+        if (indegree[v] == 0)
+            ready.push_back(v);
+    }
+    for (size_t i = 0; i < ready.size(); ++i) {
+        const int v = ready[i];
+        for (int k = outStart[v]; k < outStart[v + 1]; ++k) {
+            const int to = edges[outEdges[k]].to;
+            vertices[to].layer = std::max(vertices[to].layer, vertices[v].layer + 1);
+            if (--indegree[to] == 0)
+                ready.push_back(to);
+        }
+    }
+
+    int lastLayer = 0;
+    bool hasSinks = false;
+    for (int v = 0; v < originalCount; ++v) {
+        if (vertices[v].sink)
+            hasSinks = true;
+        else
+            lastLayer = std::max(lastLayer, vertices[v].layer);
+    }
+    if (hasSinks) {
+        ++lastLayer;
+        for (int v = 0; v < originalCount; ++v)
+            if (vertices[v].sink)
+                vertices[v].layer = lastLayer;
+    }
+
+    // Длинные рёбра одного источника делят общую цепочку фиктивных
+    // узлов: цепь рисуется одним стволом, а фиктивных узлов меньше.
+    std::vector<int> chain;
+    for (int v = 0; v < originalCount; ++v) {
+        std::vector<int> order(outEdges.begin() + outStart[v], outEdges.begin() + outStart[v + 1]);
+        std::sort(order.begin(), order.end(), [this](int a, int b) {
+            return vertices[edges[a].to].layer < vertices[edges[b].to].layer;
+        });
+
+        chain.assign(1, v);
+        for (int e : order) {
+            const Edge& edge = edges[e];
+            const int span = vertices[edge.to].layer - vertices[v].layer;
+            if (span <= 0)
+                continue;
+            while (static_cast<int>(chain.size()) < span) {
+                Vertex dummy;
+                dummy.layer = vertices[v].layer + static_cast<int>(chain.size());
+                dummy.source = v;
+                dummy.dummy = true;
+                const int index = static_cast<int>(vertices.size());
+                vertices.push_back(dummy);
+                links.push_back(Link{chain.back(), index, 0.0});
+                chain.push_back(index);
+            }
+            links.push_back(Link{chain[span - 1], edge.to, edge.pinOffset});
+        }
+    }
+    stats.dummies = static_cast<int>(vertices.size()) - originalCount;
+
+    // Связи узлов в формате CSR.
+    const int count = static_cast<int>(vertices.size());
+    upperStart.assign(count + 1, 0);
+    lowerStart.assign(count + 1, 0);
+    for (const Link& link : links) {
+        ++upperStart[link.lower + 1];
+        ++lowerStart[link.upper + 1];
+    }
+    for (int v = 0; v < count; ++v) {
+        upperStart[v + 1] += upperStart[v];
+        lowerStart[v + 1] += lowerStart[v];
+    }
+    upperLinks.resize(links.size());
+    lowerLinks.resize(links.size());
+    std::vector<int> upperFill(upperStart.begin(), upperStart.end() - 1);
+    std::vector<int> lowerFill(lowerStart.begin(), lowerStart.end() - 1);
+    for (int k = 0; k < static_cast<int>(links.size()); ++k) {
+        upperLinks[upperFill[links[k].lower]++] = k;
+        lowerLinks[lowerFill[links[k].upper]++] = k;
+    }
+
+    layers.assign(originalCount ? lastLayer + 1 : 0, std::vector<int>());
+    for (int v = 0; v < count; ++v) {
+        vertices[v].order = static_cast<int>(layers[vertices[v].layer].size());
+        layers[vertices[v].layer].push_back(v);
+    }
+    stats.layers = static_cast<int>(layers.size());
+}
+
+// Уменьшить пересечения проходами с барицентрами.
+void LayeredLayout::reduceCrossings(WorkStealingPool& pool)
+{
+    stats.crossingsBefore = totalCrossings(pool);
+    stats.crossingsAfter = stats.crossingsBefore;
+
+    std::vector<std::vector<int>> best = layers;
+    const int layerCount = static_cast<int>(layers.size());
+
+    for (int sweep = 0; sweep < MAX_SWEEPS && stats.crossingsAfter > 0; ++sweep) {
+        if (sweep % 2 == 0) {
+            for (int l = 1; l < layerCount; ++l)
+                sortLayer(l, false, pool);
+        } else {
+            for (int l = layerCount - 2; l >= 0; --l)
+                sortLayer(l, true, pool);
+        }
+
+        const qint64 crossings = totalCrossings(pool);
+        if (crossings < stats.crossingsAfter) {
+            stats.crossingsAfter = crossings;
+            best = layers;
+        } else if (sweep > 0) {
+            break;
+        }
+    }
+
+    layers = std::move(best);
+    for (const auto& nodes : layers)
+        for (int i = 0; i < static_cast<int>(nodes.size()); ++i)
+            vertices[nodes[i]].order = i;
+}
+
+// Упорядочить слой по барицентрам соседнего слоя.
+void LayeredLayout::sortLayer(int layer, bool upward, WorkStealingPool& pool)
+{
+    std::vector<int>& nodes = layers[layer];
+    const int count = static_cast<int>(nodes.size());
+    const int neighbourLayer = upward ? layer + 1 : layer - 1;
+    const qreal scale = count > 1
+        ? static_cast<qreal>(layers[neighbourLayer].size()) / count
+        : 1.0;
+
+    // Узел без соседей сохраняет своё относительное место в слое.
+    std::vector<std::pair<qreal, int>> keys(count);
+    auto computeKeys = [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const int v = nodes[i];
+            const int* first = upward ? lowerLinks.data() + lowerStart[v] : upperLinks.data() + upperStart[v];
+            const int* last = upward ? lowerLinks.data() + lowerStart[v + 1] : upperLinks.data() + upperStart[v + 1];
+            qreal sum = 0;
+            for (const int* k = first; k != last; ++k)
+                sum += vertices[upward ? links[*k].lower : links[*k].upper].order;
+            keys[i] = {first != last ? sum / (last - first) : i * scale, v};
+        }
+    };
+
+    if (count >= 2 * PARALLEL_CHUNK) {
+        const int tasks = (count + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+        pool.parallelFor(tasks, [&](int task, int) {
+            computeKeys(task * PARALLEL_CHUNK, std::min(count, (task + 1) * PARALLEL_CHUNK));
+        });
+    } else {
+        computeKeys(0, count);
+    }
+
+    std::stable_sort(keys.begin(), keys.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (int i = 0; i < count; ++i) {
+        nodes[i] = keys[i].second;
+        vertices[nodes[i]].order = i;
+    }
+}
+
+// Число пересечений между слоями layer и layer + 1.
+qint64 LayeredLayout::countCrossings(int layer) const
+{
+    // Концы связей в нижнем слое в порядке верхних концов; пересечения —
+    // инверсии этой последовательности, они считаются деревом Фенвика.
+    const int lowerCount = static_cast<int>(layers[layer + 1].size());
+    std::vector<int> tree(lowerCount + 1, 0);
+    std::vector<int> ends;
+    qint64 crossings = 0;
+    qint64 inserted = 0;
+
+    for (int v : layers[layer]) {
+        ends.clear();
+        for (int k = lowerStart[v]; k < lowerStart[v + 1]; ++k)
+            ends.push_back(vertices[links[lowerLinks[k]].lower].order);
+        std::sort(ends.begin(), ends.end());
+
+        for (int position : ends) {
+            qint64 notGreater = 0;
+            for (int i = position + 1; i > 0; i -= i & -i)
+                notGreater += tree[i];
+            crossings += inserted - notGreater;
+        }
+        for (int position : ends) {
+            for (int i = position + 1; i <= lowerCount; i += i & -i)
+                ++tree[i];
+            ++inserted;
+        }
+    }
+    return crossings;
+}
+
+// Число пересечений всех пар слоёв.
+qint64 LayeredLayout::totalCrossings(WorkStealingPool& pool) const
+{
+    const int pairs = static_cast<int>(layers.size()) - 1;
+    if (pairs <= 0)
+        return 0;
+
+    std::vector<qint64> counts(pairs, 0);
+    pool.parallelFor(pairs, [&](int layer, int) { counts[layer] = countCrossings(layer); });
+
+    qint64 total = 0;
+    for (qint64 count : counts)
+        total += count;
+    return total;
+}
+
+// Вертикальные координаты.
+void LayeredLayout::assignCoordinates()
+{
+    const int layerCount = static_cast<int>(layers.size());
+    for (const auto& nodes : layers) {
+        qreal bottom = 0;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            Vertex& vertex = vertices[nodes[i]];
+            if (i > 0) {
+                const Vertex& previous = vertices[nodes[i - 1]];
+                bottom += (previous.dummy || vertex.dummy) ? spacing.wireGap : spacing.nodeGap;
+            }
+            vertex.y = bottom;
+            bottom += vertex.height;
+        }
+    }
+
+    for (int l = 1; l < layerCount; ++l)
+        placeLayer(l, false);
+    for (int l = layerCount - 2; l >= 0; --l)
+        placeLayer(l, true);
+    for (int l = 1; l < layerCount; ++l)
+        placeLayer(l, false);
+
+    qreal top = 0;
+    bool first = true;
+    for (const Vertex& vertex : vertices) {
+        top = first ? vertex.y : std::min(top, vertex.y);
+        first = false;
+    }
+    for (Vertex& vertex : vertices)
+        vertex.y += spacing.margin - top;
+}
+
+// Расставить слой по желаемым координатам с сохранением порядка.
+void LayeredLayout::placeLayer(int layer, bool upward)
+{
+    const std::vector<int>& nodes = layers[layer];
+    const int count = static_cast<int>(nodes.size());
+
+    // Верх узла i не выше offset[i] + z[i], где z не убывает. Ближайшие
+    // к желаемым неубывающие z находит слияние соседних нарушителей.
+    std::vector<qreal> offset(count, 0.0);
+    std::vector<qreal> target(count, 0.0);
+    for (int i = 0; i < count; ++i) {
+        const Vertex& vertex = vertices[nodes[i]];
+        if (i > 0) {
+            const Vertex& previous = vertices[nodes[i - 1]];
+            offset[i] = offset[i - 1] + previous.height
+                        + ((previous.dummy || vertex.dummy) ? spacing.wireGap : spacing.nodeGap);
+        }
+
+        const int v = nodes[i];
+        qreal sum = 0;
+        int pins = 0;
+        if (upward) {
+            for (int k = lowerStart[v]; k < lowerStart[v + 1]; ++k) {
+                const Link& link = links[lowerLinks[k]];
+                sum += vertices[link.lower].y + link.pinOffset - vertex.height / 2.0;
+                ++pins;
+            }
+        } else {
+            for (int k = upperStart[v]; k < upperStart[v + 1]; ++k) {
+                const Link& link = links[upperLinks[k]];
+                sum += outputY(link.upper) - link.pinOffset;
+                ++pins;
+            }
+        }
+        target[i] = (pins ? sum / pins : vertex.y) - offset[i];
+    }
+
+    struct Block { qreal sum; int size; };
+    std::vector<Block> blocks;
+    for (int i = 0; i < count; ++i) {
+        blocks.push_back(Block{target[i], 1});
+        while (blocks.size() > 1) {
+            const Block& last = blocks.back();
+            const Block& previous = blocks[blocks.size() - 2];
+            if (previous.sum / previous.size <= last.sum / last.size)
+                break;
+            const Block merged{previous.sum + last.sum, previous.size + last.size};
+            blocks.pop_back();
+            blocks.back() = merged;
+        }
+    }
+
+    int i = 0;
+    for (const Block& block : blocks) {
+        const qreal z = block.sum / block.size;
+        for (int k = 0; k < block.size; ++k, ++i)
+            vertices[nodes[i]].y = z + offset[i];
+    }
+}
+
+// Y выхода узла.
+qreal LayeredLayout::outputY(int v) const
+{
+    return vertices[v].y + vertices[v].height / 2.0;
+}
+
+// Ширины каналов, X слоёв и отрезки соединений.
+void LayeredLayout::route(WorkStealingPool& pool)
+{
+    wires.clear();
+    layerX.clear();
+    const int layerCount = static_cast<int>(layers.size());
+    if (layerCount == 0)
+        return;
+
+    std::vector<qreal> layerWidth(layerCount, 0.0);
+    for (const Vertex& vertex : vertices)
+        layerWidth[vertex.layer] = std::max(layerWidth[vertex.layer], vertex.width);
+
+    // Дорожки каналов: цепь (узел верхнего слоя и все его связи)
+    // занимает один вертикальный участок; участки, перекрывающиеся
+    // по Y, получают разные дорожки.
+    struct Net { int vertex; qreal top; qreal bottom; int track; };
+    std::vector<std::vector<Net>> nets(layerCount - 1);
+    std::vector<int> tracks(layerCount - 1, 0);
+
+    pool.parallelFor(layerCount - 1, [&](int l, int) {
+        std::vector<Net>& channel = nets[l];
+        for (int v : layers[l]) {
+            if (lowerStart[v] == lowerStart[v + 1])
+                continue;
+            Net net{v, outputY(v), outputY(v), -1};
+            for (int k = lowerStart[v]; k < lowerStart[v + 1]; ++k) {
+                const Link& link = links[lowerLinks[k]];
+                const qreal pinY = vertices[link.lower].y + link.pinOffset;
+                net.top = std::min(net.top, pinY);
+                net.bottom = std::max(net.bottom, pinY);
+            }
+            channel.push_back(net);
+        }
+
+        std::sort(channel.begin(), channel.end(),
+                  [](const Net& a, const Net& b) { return a.top < b.top; });
+        std::priority_queue<std::pair<qreal, int>, std::vector<std::pair<qreal, int>>,
+                            std::greater<std::pair<qreal, int>>> released;
+        for (Net& net : channel) {
+            if (net.top == net.bottom)
+                continue;
+            if (!released.empty() && released.top().first < net.top) {
+                net.track = released.top().second;
+                released.pop();
+            } else {
+                net.track = tracks[l]++;
+            }
+            released.push({net.bottom + spacing.trackPitch / 2.0, net.track});
+        }
+    });
+
+    std::vector<qreal> channelWidth(layerCount, 0.0);
+    layerX.assign(layerCount, spacing.margin);
+    for (int l = 0; l + 1 < layerCount; ++l) {
+        channelWidth[l] = std::max(spacing.channelWidth, (tracks[l] + 1) * spacing.trackPitch);
+        layerX[l + 1] = layerX[l] + layerWidth[l] + channelWidth[l];
+    }
+
+    for (int l = 0; l + 1 < layerCount; ++l) {
+        const qreal channelX = layerX[l] + layerWidth[l];
+        const qreal inputX = layerX[l + 1];
+
+        for (const Net& net : nets[l]) {
+            const Vertex& vertex = vertices[net.vertex];
+            const qreal fromX = vertex.dummy ? channelX : layerX[l] + vertex.width;
+            const qreal fromY = outputY(net.vertex);
+            const int source = vertex.source;
+
+            if (vertex.dummy && layerWidth[l] > 0)
+                wires.push_back(Segment{QPointF(layerX[l], fromY), QPointF(channelX, fromY), source});
+
+            if (net.track < 0) {
+                wires.push_back(Segment{QPointF(fromX, fromY), QPointF(inputX, fromY), source});
+                continue;
+            }
+
+            const qreal trackX = channelX + channelWidth[l] * (net.track + 1) / (tracks[l] + 1);
+            wires.push_back(Segment{QPointF(fromX, fromY), QPointF(trackX, fromY), source});
+            wires.push_back(Segment{QPointF(trackX, net.top), QPointF(trackX, net.bottom), source});
+            for (int k = lowerStart[net.vertex]; k < lowerStart[net.vertex + 1]; ++k) {
+                const Link& link = links[lowerLinks[k]];
+                const qreal pinY = vertices[link.lower].y + link.pinOffset;
+                wires.push_back(Segment{QPointF(trackX, pinY), QPointF(inputX, pinY), source});
+            }
+        }
+    }
+}
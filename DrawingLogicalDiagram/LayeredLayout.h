@@ -0,0 +1,258 @@
+#ifndef LAYEREDLAYOUT_H
+#define LAYEREDLAYOUT_H
+
+#include <QPointF>
+#include <QtGlobal>
+#include <vector>
+
+class WorkStealingPool;
+
+/**
+ * @class LayeredLayout
+ * @brief Послойная компоновка ациклического графа (метод Сугиямы)
+ *
+ * Класс не зависит от сцены: на вход получает узлы с размерами и рёбра
+ * с положением входного вывода, на выходе даёт координаты узлов
+ * и ортогональные отрезки соединений. Используется GraphDiagram для
+ * схем с общими подвыражениями, где у вентиля несколько потребителей.
+ *
+ * @details Этапы:
+ * 1. Слои по самому длинному пути от истоков; узлы-стоки (выходы схемы)
+ *    выносятся в отдельный последний слой.
+ * 2. Рёбра длиннее одного слоя разбиваются фиктивными узлами; длинные
+ *    рёбра одного источника делят общую цепочку фиктивных узлов.
+ * 3. Пересечения уменьшаются проходами вниз и вверх с сортировкой слоя
+ *    по барицентру соседей; барицентры большого слоя и число пересечений
+ *    пар соседних слоёв (дерево Фенвика, O(E log V)) считаются
+ *    параллельно в WorkStealingPool. Сохраняется лучший порядок.
+ * 4. Вертикальные координаты: проходы вниз, вверх и снова вниз;
+ *    в каждом слое узлы тянутся к выводам соседей с сохранением порядка
+ *    и зазоров (изотоническая регрессия, линейное время на слой).
+ * 5. Трассировка: в канале между слоями вертикальный участок каждой цепи
+ *    получает свою дорожку (алгоритм левого края), ширина канала
+ *    растёт с числом дорожек, поэтому вертикальные участки не перекрываются.
+ *
+ * Время каждого этапа записывается в Statistics.
+ */
+class LayeredLayout {
+public:
+    /**
+     * @struct Spacing
+     * @brief Зазоры компоновки
+     */
+    struct Spacing
+    {
+        qreal nodeGap = 20.0;      ///< Зазор между узлами слоя
+        qreal wireGap = 10.0;      ///< Зазор, если один из соседей фиктивный
+        qreal channelWidth = 80.0; ///< Наименьшая ширина канала между слоями
+        qreal trackPitch = 8.0;    ///< Шаг дорожек в канале
+        qreal margin = 50.0;       ///< Отступ от края сцены
+    };
+
+    /**
+     * @struct Segment
+     * @brief Отрезок соединения
+     */
+    struct Segment
+    {
+        QPointF from;     ///< Начало
+        QPointF to;       ///< Конец
+        int source = -1;  ///< Узел, выход которого передаёт отрезок
+    };
+
+    /**
+     * @struct Statistics
+     * @brief Размеры и время этапов последней компоновки
+     */
+    struct Statistics
+    {
+        int nodes = 0;                ///< Число узлов
+        int edges = 0;                ///< Число рёбер
+        int layers = 0;               ///< Число слоёв
+        int dummies = 0;              ///< Число фиктивных узлов
+        int threads = 0;              ///< Число потоков упорядочивания
+        qint64 crossingsBefore = 0;   ///< Пересечения при начальном порядке
+        qint64 crossingsAfter = 0;    ///< Пересечения после упорядочивания
+        qint64 layeringUs = 0;        ///< Слои и фиктивные узлы, мкс
+        qint64 orderingUs = 0;        ///< Уменьшение пересечений, мкс
+        qint64 coordinatesUs = 0;     ///< Координаты, мкс
+        qint64 routingUs = 0;         ///< Трассировка, мкс
+    };
+
+    /**
+     * @brief Задать зазоры (до run())
+     * @param spacing Зазоры
+     */
+    void setSpacing(const Spacing& spacing);
+
+    /**
+     * @brief Задать число потоков упорядочивания (0 — по числу ядер)
+     * @param threads Число потоков
+     */
+    void setThreadCount(int threads);
+
+    /**
+     * @brief Добавить узел
+     * @param width Ширина; выход узла — середина правой стороны
+     * @param height Высота
+     * @param sink true — узел ставится в отдельный последний слой
+     * @return Индекс узла
+     */
+    int addNode(qreal width, qreal height, bool sink = false);
+
+    /**
+     * @brief Добавить ребро
+     * @param from Узел-источник
+     * @param to Узел-приёмник
+     * @param pinOffset Расстояние от верха приёмника до входного вывода
+     */
+    void addEdge(int from, int to, qreal pinOffset);
+
+    /**
+     * @brief Выполнить компоновку
+     * @return Статистика этапов
+     *
+     * Граф должен быть ациклическим.
+     */
+    Statistics run();
+
+    /**
+     * @brief Левый верхний угол узла
+     * @param node Индекс узла
+     * @return Координаты
+     */
+    QPointF position(int node) const;
+
+    /**
+     * @brief Слой узла
+     * @param node Индекс узла
+     * @return Номер слоя, 0 — истоки
+     */
+    int layer(int node) const;
+
+    /**
+     * @brief Отрезки всех соединений
+     * @return Ортогональные отрезки
+     */
+    const std::vector<Segment>& segments() const;
+
+    /**
+     * @brief Статистика последней компоновки
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+private:
+    /**
+     * @struct Vertex
+     * @brief Узел графа слоёв (исходный или фиктивный)
+     */
+    struct Vertex
+    {
+        qreal width = 0;    ///< Ширина
+        qreal height = 0;   ///< Высота
+        int layer = 0;      ///< Слой
+        int order = 0;      ///< Позиция в слое
+        qreal y = 0;        ///< Верхний Y
+        int source = -1;    ///< Исходный узел, выход которого несёт фиктивный
+        bool sink = false;  ///< Узел последнего слоя
+        bool dummy = false; ///< Фиктивный узел длинного ребра
+    };
+
+    /**
+     * @struct Link
+     * @brief Ребро между соседними слоями
+     */
+    struct Link
+    {
+        int upper;        ///< Узел слоя L
+        int lower;        ///< Узел слоя L + 1
+        qreal pinOffset;  ///< Вывод на узле lower от его верха
+    };
+
+    /**
+     * @struct Edge
+     * @brief Исходное ребро
+     */
+    struct Edge
+    {
+        int from;         ///< Источник
+        int to;           ///< Приёмник
+        qreal pinOffset;  ///< Вывод на приёмнике от его верха
+    };
+
+    /**
+     * @brief Слои по самому длинному пути и фиктивные узлы
+     */
+    void assignLayers();
+
+    /**
+     * @brief Уменьшить пересечения проходами с барицентрами
+     * @param pool Пул потоков
+     */
+    void reduceCrossings(WorkStealingPool& pool);
+
+    /**
+     * @brief Упорядочить слой по барицентрам соседнего слоя
+     * @param layer Слой
+     * @param upward true — по нижним соседям, false — по верхним
+     * @param pool Пул потоков
+     */
+    void sortLayer(int layer, bool upward, WorkStealingPool& pool);
+
+    /**
+     * @brief Число пересечений между слоями layer и layer + 1
+     * @param layer Верхний слой пары
+     * @return Число пересечений
+     */
+    qint64 countCrossings(int layer) const;
+
+    /**
+     * @brief Число пересечений всех пар слоёв
+     * @param pool Пул потоков
+     * @return Сумма
+     */
+    qint64 totalCrossings(WorkStealingPool& pool) const;
+
+    /**
+     * @brief Вертикальные координаты
+     */
+    void assignCoordinates();
+
+    /**
+     * @brief Расставить слой по желаемым координатам с сохранением порядка
+     * @param layer Слой
+     * @param upward true — тянуть к нижним соседям, false — к верхним
+     */
+    void placeLayer(int layer, bool upward);
+
+    /**
+     * @brief Ширины каналов, X слоёв и отрезки соединений
+     * @param pool Пул потоков
+     */
+    void route(WorkStealingPool& pool);
+
+    /**
+     * @brief Y выхода узла
+     * @param v Узел
+     * @return Координата середины правой стороны
+     */
+    qreal outputY(int v) const;
+
+    Spacing spacing;                          ///< Зазоры
+    int threadCount = 0;                      ///< Число потоков
+    int originalCount = 0;                    ///< Число исходных узлов
+    std::vector<Vertex> vertices;             ///< Исходные и фиктивные узлы
+    std::vector<Edge> edges;                  ///< Исходные рёбра
+    std::vector<Link> links;                  ///< Рёбра между соседними слоями
+    std::vector<int> upperStart;              ///< CSR: начало верхних связей узла
+    std::vector<int> upperLinks;              ///< CSR: индексы связей к верхним соседям
+    std::vector<int> lowerStart;              ///< CSR: начало нижних связей узла
+    std::vector<int> lowerLinks;              ///< CSR: индексы связей к нижним соседям
+    std::vector<std::vector<int>> layers;     ///< Узлы слоёв в текущем порядке
+    std::vector<qreal> layerX;                ///< Левый X слоя
+    std::vector<Segment> wires;               ///< Отрезки соединений
+    Statistics stats;                         ///< Статистика
+};
+
+#endif // LAYEREDLAYOUT_H
@@ -0,0 +1,190 @@
+#include "LoadTester.h"
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// Константы.
+static constexpr int CONNECT_TIMEOUT_MS = 5000;
+static constexpr int REPLY_TIMEOUT_MS = 60000;
+
+// Процентиль по правилу ближайшего ранга.
+static qint64 percentile(const std::vector<qint64>& sorted, double q)
+{
+    if (sorted.empty())
+        return 0;
+    const size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+// Конструктор.
+LoadTester::LoadTester(const QString& serverName)
+    : serverName(serverName)
+{}
+
+// Задать строки запросов.
+void LoadTester::setRequests(const QList<QByteArray>& lines)
+{
+    requests = lines;
+}
+
+// Задать число соединений.
+void LoadTester::setConnections(int connections)
+{
+    this->connections = std::max(1, connections);
+}
+
+// Задать размер пакета.
+void LoadTester::setBatchSize(int batchSize)
+{
+    this->batchSize = std::max(1, batchSize);
+}
+
+// Выполнить прогон.
+bool LoadTester::run(qint64 total)
+{
+    result = Report();
+    error.clear();
+    if (requests.isEmpty()) {
+        error = "Нет запросов";
+        return false;
+    }
+
+    std::vector<Worker> workers(connections);
+    std::atomic<qint64> next{0};
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers.size());
+    for (Worker& worker : workers)
+        threads.emplace_back([this, &worker, &next, total]() { runConnection(worker, next, total); });
+    for (std::thread& thread : threads)
+        thread.join();
+
+    result.elapsedUs = timer.nsecsElapsed() / 1000;
+
+    std::vector<qint64> latencies;
+    for (const Worker& worker : workers) {
+        latencies.insert(latencies.end(), worker.latencies.begin(), worker.latencies.end());
+        result.errors += worker.errors;
+        result.bytes += worker.bytes;
+        if (error.isEmpty() && !worker.error.isEmpty())
+            error = worker.error;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    result.requests = static_cast<qint64>(latencies.size());
+    if (result.elapsedUs > 0)
+        result.requestsPerSecond = result.requests * 1e6 / result.elapsedUs;
+    result.p50Us = percentile(latencies, 0.50);
+    result.p90Us = percentile(latencies, 0.90);
+    result.p99Us = percentile(latencies, 0.99);
+    result.maxUs = latencies.empty() ? 0 : latencies.back();
+
+    QLocalSocket socket;
+    socket.connectToServer(serverName);
+    if (socket.waitForConnected(CONNECT_TIMEOUT_MS)) {
+        socket.write("INFO\n");
+        readReply(socket, result.serverInfo);
+    }
+
+    return error.isEmpty();
+}
+
+// Цикл одного соединения.
+void LoadTester::runConnection(Worker& worker, std::atomic<qint64>& next, qint64 total) const
+{
+    QLocalSocket socket;
+    socket.connectToServer(serverName);
+    if (!socket.waitForConnected(CONNECT_TIMEOUT_MS)) {
+        worker.error = QString("Не удалось подключиться к %1: %2").arg(serverName, socket.errorString());
+        return;
+    }
+
+    QByteArray batch;
+    QByteArray payload;
+    for (;;) {
+        const qint64 first = next.fetch_add(batchSize);
+        if (first >= total)
+            break;
+        const qint64 count = std::min<qint64>(batchSize, total - first);
+
+        batch.clear();
+        for (qint64 i = first; i < first + count; ++i)
+            batch += requests[static_cast<int>(i % requests.size())] + '\n';
+
+        QElapsedTimer timer;
+        timer.start();
+        socket.write(batch);
+        for (qint64 i = 0; i < count; ++i) {
+            const int status = readReply(socket, payload);
+            if (status < 0) {
+                worker.error = QString("Соединение прервано: %1").arg(socket.errorString());
+                return;
+            }
+            worker.latencies.push_back(timer.nsecsElapsed() / 1000);
+            worker.bytes += payload.size();
+            if (status == 0)
+                ++worker.errors;
+        }
+    }
+    socket.disconnectFromServer();
+}
+
+// Прочитать один ответ.
+int LoadTester::readReply(QLocalSocket& socket, QByteArray& payload)
+{
+    payload.clear();
+    while (!socket.canReadLine()) {
+        const bool ready = socket.bytesToWrite() > 0 ? socket.waitForBytesWritten(REPLY_TIMEOUT_MS)
+                                                     : socket.waitForReadyRead(REPLY_TIMEOUT_MS);
+        if (!ready)
+            return -1;
+    }
+
+    const QByteArray header = socket.readLine().trimmed();
+    if (header.startsWith("ERR"))
+        return 0;
+    if (!header.startsWith("OK "))
+        return -1;
+
+    bool ok = false;
+    const qint64 size = header.mid(3).toLongLong(&ok);
+    if (!ok || size < 0)
+        return -1;
+    while (socket.bytesAvailable() < size) {
+        if (!socket.waitForReadyRead(REPLY_TIMEOUT_MS))
+            return -1;
+    }
+    payload = socket.read(size);
+    return 1;
+}
+
+// Результат последнего прогона.
+LoadTester::Report LoadTester::report() const
+{
+    return result;
+}
+
+// Отчёт в виде текста.
+QString LoadTester::summary() const
+{
+    QString text = QString("Запросов: %1, ошибок: %2, получено %3 байт за %4 мс\n"
+                           "Пропускная способность: %5 запросов/с\n"
+                           "Задержка, мкс: p50 %6, p90 %7, p99 %8, max %9\n")
+        .arg(result.requests).arg(result.errors).arg(result.bytes)
+        .arg(result.elapsedUs / 1000)
+        .arg(result.requestsPerSecond, 0, 'f', 1)
+        .arg(result.p50Us).arg(result.p90Us).arg(result.p99Us).arg(result.maxUs);
+    if (!result.serverInfo.isEmpty())
+        text += "Служба:\n" + QString::fromUtf8(result.serverInfo);
+    return text;
+}
+
+// Описание последней ошибки.
+QString LoadTester::errorString() const
+{
+    return error;
+}
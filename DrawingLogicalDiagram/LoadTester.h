@@ -0,0 +1,135 @@
+#ifndef LOADTESTER_H
+#define LOADTESTER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+class QLocalSocket;
+
+/**
+ * @class LoadTester
+ * @brief Нагрузочный клиент службы DiagramServer
+ *
+ * Открывает несколько соединений с локальным сокетом службы и по кругу
+ * отправляет строки запросов, пока не будет выполнено заданное число
+ * запросов. Каждое соединение работает в своём потоке с блокирующими
+ * вызовами QLocalSocket и замеряет задержку каждого ответа.
+ *
+ * @details
+ * - Запросы отправляются пакетами по batchSize строк одной записью;
+ *   задержка запроса — от отправки пакета до получения его ответа.
+ * - Отчёт содержит пропускную способность и процентили задержки,
+ *   а также ответ службы на INFO после прогона (попадания в кэш).
+ */
+class LoadTester {
+public:
+    /**
+     * @struct Report
+     * @brief Результат прогона
+     */
+    struct Report
+    {
+        qint64 requests = 0;          ///< Получено ответов
+        qint64 errors = 0;            ///< Ответов ERR
+        qint64 bytes = 0;             ///< Получено байт данных
+        qint64 elapsedUs = 0;         ///< Длительность прогона, мкс
+        double requestsPerSecond = 0; ///< Ответов в секунду
+        qint64 p50Us = 0;             ///< Медиана задержки, мкс
+        qint64 p90Us = 0;             ///< 90-й процентиль задержки, мкс
+        qint64 p99Us = 0;             ///< 99-й процентиль задержки, мкс
+        qint64 maxUs = 0;             ///< Наибольшая задержка, мкс
+        QByteArray serverInfo;        ///< Ответ службы на INFO после прогона
+    };
+
+    /**
+     * @brief Конструктор
+     * @param serverName Имя локального сокета службы
+     */
+    explicit LoadTester(const QString& serverName);
+
+    /**
+     * @brief Задать строки запросов
+     * @param lines Запросы протокола DiagramServer без перевода строки
+     */
+    void setRequests(const QList<QByteArray>& lines);
+
+    /**
+     * @brief Задать число соединений
+     * @param connections Число соединений (потоков)
+     */
+    void setConnections(int connections);
+
+    /**
+     * @brief Задать размер пакета
+     * @param batchSize Число запросов в одной записи
+     */
+    void setBatchSize(int batchSize);
+
+    /**
+     * @brief Выполнить прогон
+     * @param total Общее число запросов
+     * @return true, если все соединения отработали без обрыва;
+     *         иначе см. errorString()
+     */
+    bool run(qint64 total);
+
+    /**
+     * @brief Результат последнего прогона
+     * @return Отчёт
+     */
+    Report report() const;
+
+    /**
+     * @brief Отчёт в виде текста
+     * @return Несколько строк для вывода в консоль
+     */
+    QString summary() const;
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+private:
+    /**
+     * @struct Worker
+     * @brief Результаты одного соединения
+     */
+    struct Worker
+    {
+        std::vector<qint64> latencies;  ///< Задержки ответов, мкс
+        qint64 errors = 0;              ///< Ответов ERR
+        qint64 bytes = 0;               ///< Получено байт данных
+        QString error;                  ///< Обрыв соединения
+    };
+
+    /**
+     * @brief Цикл одного соединения
+     * @param worker Результаты соединения
+     * @param next Счётчик следующего запроса, общий для соединений
+     * @param total Общее число запросов
+     */
+    void runConnection(Worker& worker, std::atomic<qint64>& next, qint64 total) const;
+
+    /**
+     * @brief Прочитать один ответ
+     * @param socket Соединение
+     * @param payload Сюда записываются данные ответа OK
+     * @return 1 — OK, 0 — ERR, -1 — обрыв или тайм-аут
+     */
+    static int readReply(QLocalSocket& socket, QByteArray& payload);
+
+    QString serverName;               ///< Имя сокета службы
+    QList<QByteArray> requests;       ///< Строки запросов
+    int connections = 1;              ///< Число соединений
+    int batchSize = 1;                ///< Запросов в пакете
+    Report result;                    ///< Результат последнего прогона
+    QString error;                    ///< Текст последней ошибки
+};
+
+#endif // LOADTESTER_H
@@ -0,0 +1,327 @@
+#include "LogicGraph.h"
+#include <QSet>
+#include <QStringList>
+#include <algorithm>
+
+// Хэш-функция ключа вентиля.
+size_t LogicGraph::GateKeyHash::operator()(const GateKey& key) const
+{
+    size_t h = static_cast<size_t>(key.kind) * 0x9E3779B97F4A7C15ULL;
+    for (int id : key.fanins)
+        h ^= static_cast<size_t>(id) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+// Добавить первичный вход.
+int LogicGraph::addInput(const QString& name)
+{
+    auto it = inputByName.constFind(name);
+    if (it != inputByName.constEnd())
+        return it.value();
+
+    int id = static_cast<int>(gates.size());
+    gates.push_back(Gate{GateKind::INPUT, {}});
+    inputIds.push_back(id);
+    inputByName.insert(name, id);
+    nameByInput.insert(id, name);
+    return id;
+}
+
+// Добавить константу.
+int LogicGraph::addConstant(bool value)
+{
+    int& id = constIds[value ? 1 : 0];
+    if (id < 0) {
+        id = static_cast<int>(gates.size());
+        gates.push_back(Gate{value ? GateKind::CONST1 : GateKind::CONST0, {}});
+    }
+    return id;
+}
+
+// Добавить вентиль.
+int LogicGraph::addGate(GateKind kind, std::vector<int> fanins)
+{
+    if (kind != GateKind::NOT && fanins.size() == 1)
+        return fanins.front();
+
+    GateKey key{kind, fanins};
+    if (kind != GateKind::NOT)
+        std::sort(key.fanins.begin(), key.fanins.end());
+
+    auto it = structuralHash.find(key);
+    if (it != structuralHash.end())
+        return it->second;
+
+    int id = static_cast<int>(gates.size());
+    gates.push_back(Gate{kind, std::move(fanins)});
+    structuralHash.emplace(std::move(key), id);
+    return id;
+}
+
+// Добавить выход.
+void LogicGraph::addOutput(const QString& name, int gate)
+{
+    outputList.push_back(Output{name, gate});
+}
+
+// Количество вентилей.
+int LogicGraph::size() const
+{
+    return static_cast<int>(gates.size());
+}
+
+// Получить вентиль по индексу.
+const LogicGraph::Gate& LogicGraph::gate(int id) const
+{
+    return gates[id];
+}
+
+// Индексы первичных входов.
+const std::vector<int>& LogicGraph::inputs() const
+{
+    return inputIds;
+}
+
+// Имя первичного входа.
+QString LogicGraph::inputName(int id) const
+{
+    return nameByInput.value(id);
+}
+
+// Найти вход по имени.
+int LogicGraph::findInput(const QString& name) const
+{
+    return inputByName.value(name, -1);
+}
+
+// Выходы сети.
+const std::vector<LogicGraph::Output>& LogicGraph::outputs() const
+{
+    return outputList;
+}
+
+// Построить сеть по дереву разбора.
+LogicGraph LogicGraph::fromTree(const SchemaTree::Node* root, const QString& outputName)
+{
+    LogicGraph graph;
+    int id = graph.addTree(root);
+    if (id >= 0)
+        graph.addOutput(outputName, id);
+    return graph;
+}
+
+// Проверить, задан ли текст как список именованных уравнений.
+bool LogicGraph::isEquationList(const QString& text)
+{
+    return text.contains('=') || text.contains(';');
+}
+
+// Построить сеть по списку уравнений.
+LogicGraph LogicGraph::fromEquations(const QString& text, QString* error)
+{
+    LogicGraph graph;
+    QString normalized = text;
+    normalized.replace('\n', ';');
+    const QStringList equations = normalized.split(';', Qt::SkipEmptyParts);
+
+    QSet<QString> names;
+    int number = 0;
+    for (const QString& equation : equations) {
+        if (equation.trimmed().isEmpty())
+            continue;
+        ++number;
+
+        QString name;
+        QString expr = equation;
+        int eq = equation.indexOf('=');
+        if (eq >= 0) {
+            name = equation.left(eq).trimmed();
+            expr = equation.mid(eq + 1);
+        }
+        if (name.isEmpty())
+            name = isEquationList(text) ? QString("Y%1").arg(number) : QString("Y");
+
+        if (names.contains(name)) {
+            if (error) *error = QString("Выход %1 задан повторно").arg(name);
+            return LogicGraph();
+        }
+        names.insert(name);
+
+        SchemaTree tree(expr.trimmed());
+        int id = graph.addTree(tree.getRoot());
+        if (id < 0) {
+            if (error) *error = QString("Пустое выражение для выхода %1").arg(name);
+            return LogicGraph();
+        }
+        graph.addOutput(name, id);
+    }
+
+    if (graph.outputs().empty() && error)
+        *error = QString("Нет ни одного уравнения");
+    return graph;
+}
+
+// Добавить дерево разбора к сети.
+int LogicGraph::addTree(const SchemaTree::Node* node)
+{
+    if (!node) return -1;
+
+    // Обратный обход с явным стеком: глубина дерева импортированного
+    // нетлиста или длинной цепочки не ограничена стеком вызовов.
+    // Вентили создаются в том же порядке, что и при рекурсивном обходе.
+    struct Frame
+    {
+        const SchemaTree::Node* node;  // Узел
+        size_t next;                   // Следующий обходимый ребёнок
+        std::vector<int> fanins;       // Вентили уже обойдённых детей
+    };
+    std::vector<Frame> stack;
+    stack.push_back({node, 0, {}});
+    int result = -1;
+
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const SchemaTree::Node* current = frame.node;
+        int id = -1;
+
+        if (current->type != NodeType::VAR && frame.next < current->children.size()) {
+            const SchemaTree::Node* child = current->children[frame.next++].get();
+            if (child)
+                stack.push_back({child, 0, {}});
+            continue;
+        }
+
+        if (current->type == NodeType::VAR) {
+            if (current->value == "0") id = addConstant(false);
+            else if (current->value == "1") id = addConstant(true);
+            else id = addInput(current->value);
+        } else if (!frame.fanins.empty()) {
+            if (current->type == NodeType::NOT) {
+                id = addGate(GateKind::NOT, {frame.fanins.front()});
+            } else {
+                GateKind kind = GateKind::AND;
+                if (current->value == "|") kind = GateKind::OR;
+                else if (current->value == "^") kind = GateKind::XOR;
+                id = addGate(kind, std::move(frame.fanins));
+            }
+        }
+
+        stack.pop_back();
+        if (stack.empty())
+            result = id;
+        else if (id >= 0)
+            stack.back().fanins.push_back(id);
+    }
+    return result;
+}
+
+// Развернуть выход сети в дерево разбора.
+std::unique_ptr<SchemaTree::Node> LogicGraph::toTree(int outputIndex, int maxNodes, QString* error) const
+{
+    if (outputIndex < 0 || outputIndex >= static_cast<int>(outputList.size())) {
+        if (error) *error = QString("Нет выхода с номером %1").arg(outputIndex);
+        return nullptr;
+    }
+
+    // Прямой обход с явным стеком: ребёнок присоединяется к родителю
+    // при снятии со стека, а дети кладутся в обратном порядке, поэтому
+    // порядок входов сохраняется.
+    struct Item
+    {
+        int id;                        // Вентиль
+        SchemaTree::Node* parent;      // Узел, к которому присоединяется поддерево
+    };
+    std::vector<Item> stack{{outputList[outputIndex].gate, nullptr}};
+    std::unique_ptr<SchemaTree::Node> root;
+    int budget = maxNodes;
+
+    while (!stack.empty()) {
+        const Item item = stack.back();
+        stack.pop_back();
+        if (--budget < 0) {
+            if (error)
+                *error = QString("Дерево выхода %1 превышает %2 узлов")
+                             .arg(outputList[outputIndex].name)
+                             .arg(maxNodes);
+            return nullptr;
+        }
+
+        const Gate& g = gates[item.id];
+        std::unique_ptr<SchemaTree::Node> node;
+        switch (g.kind) {
+        case GateKind::CONST0:
+            node = std::make_unique<SchemaTree::Node>(NodeType::VAR, "0");
+            break;
+        case GateKind::CONST1:
+            node = std::make_unique<SchemaTree::Node>(NodeType::VAR, "1");
+            break;
+        case GateKind::INPUT:
+            node = std::make_unique<SchemaTree::Node>(NodeType::VAR, nameByInput.value(item.id));
+            break;
+        case GateKind::NOT:
+            node = std::make_unique<SchemaTree::Node>(NodeType::NOT, "!");
+            break;
+        case GateKind::AND:
+            node = std::make_unique<SchemaTree::Node>(NodeType::OP, "&");
+            break;
+        case GateKind::OR:
+            node = std::make_unique<SchemaTree::Node>(NodeType::OP, "|");
+            break;
+        case GateKind::XOR:
+            node = std::make_unique<SchemaTree::Node>(NodeType::OP, "^");
+            break;
+        }
+
+        SchemaTree::Node* raw = node.get();
+        raw->children.reserve(g.fanins.size());
+        if (item.parent)
+            item.parent->children.push_back(std::move(node));
+        else
+            root = std::move(node);
+        for (auto it = g.fanins.rbegin(); it != g.fanins.rend(); ++it)
+            stack.push_back({*it, raw});
+    }
+    return root;
+}
+
+// Вычислить выходы сразу для 64 наборов входов.
+std::vector<quint64> LogicGraph::evaluate(const std::vector<quint64>& inputWords) const
+{
+    std::vector<quint64> values(gates.size(), 0);
+    for (size_t i = 0; i < inputIds.size() && i < inputWords.size(); ++i)
+        values[inputIds[i]] = inputWords[i];
+
+    for (size_t id = 0; id < gates.size(); ++id) {
+        const Gate& gate = gates[id];
+        switch (gate.kind) {
+        case GateKind::CONST0:
+        case GateKind::INPUT:
+            break;
+        case GateKind::CONST1:
+            values[id] = ~0ULL;
+            break;
+        case GateKind::NOT:
+            values[id] = ~values[gate.fanins.front()];
+            break;
+        case GateKind::AND:
+            values[id] = ~0ULL;
+            for (int in : gate.fanins)
+                values[id] &= values[in];
+            break;
+        case GateKind::OR:
+            for (int in : gate.fanins)
+                values[id] |= values[in];
+            break;
+        case GateKind::XOR:
+            for (int in : gate.fanins)
+                values[id] ^= values[in];
+            break;
+        }
+    }
+
+    std::vector<quint64> result;
+    result.reserve(outputList.size());
+    for (const Output& output : outputList)
+        result.push_back(values[output.gate]);
+    return result;
+}
@@ -0,0 +1,231 @@
+#ifndef LOGICGRAPH_H
+#define LOGICGRAPH_H
+
+#include <QString>
+#include <QHash>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "SchemaTree.h"
+
+/**
+ * @class LogicGraph
+ * @brief Логическая сеть вентилей (ориентированный ациклический граф)
+ *
+ * Компактное представление схемы в виде массива вентилей, где каждый
+ * вентиль ссылается на свои входы по индексам. В отличие от SchemaTree
+ * один вентиль может питать несколько потребителей, поэтому сеть
+ * подходит для импорта нетлистов и хранения общей логики.
+ *
+ * @details
+ * - Индексы вентилей топологически упорядочены: все входы вентиля
+ *   имеют меньший индекс, чем сам вентиль.
+ * - addGate() выполняет структурное хэширование: повторное добавление
+ *   вентиля того же типа с тем же набором входов возвращает
+ *   существующий индекс.
+ * - Константы в SchemaTree представляются переменными "0" и "1".
+ */
+class LogicGraph {
+public:
+    /**
+     * @enum GateKind
+     * @brief Типы вентилей сети
+     */
+    enum class GateKind {
+        CONST0,  ///< Логический ноль
+        CONST1,  ///< Логическая единица
+        INPUT,   ///< Первичный вход (переменная)
+        NOT,     ///< Инвертор
+        AND,     ///< И (n входов)
+        OR,      ///< ИЛИ (n входов)
+        XOR      ///< Исключающее ИЛИ (n входов)
+    };
+
+    /**
+     * @struct Gate
+     * @brief Один вентиль сети
+     */
+    struct Gate
+    {
+        GateKind kind;            ///< Тип вентиля
+        std::vector<int> fanins;  ///< Индексы входных вентилей
+    };
+
+    /**
+     * @struct Output
+     * @brief Именованный выход сети
+     */
+    struct Output
+    {
+        QString name;  ///< Имя выхода
+        int gate;      ///< Индекс вентиля, формирующего выход
+    };
+
+    /**
+     * @brief Добавить первичный вход
+     * @param name Имя входа
+     * @return Индекс вентиля; для уже существующего имени — прежний индекс
+     */
+    int addInput(const QString& name);
+
+    /**
+     * @brief Добавить константу
+     * @param value Значение константы
+     * @return Индекс вентиля константы (константы не дублируются)
+     */
+    int addConstant(bool value);
+
+    /**
+     * @brief Добавить вентиль
+     * @param kind Тип вентиля (NOT, AND, OR, XOR)
+     * @param fanins Индексы входных вентилей
+     * @return Индекс нового или совпавшего вентиля
+     *
+     * Вентиль с одним входом типа AND/OR/XOR не создаётся —
+     * возвращается индекс его входа.
+     */
+    int addGate(GateKind kind, std::vector<int> fanins);
+
+    /**
+     * @brief Добавить выход
+     * @param name Имя выхода
+     * @param gate Индекс вентиля, формирующего выход
+     */
+    void addOutput(const QString& name, int gate);
+
+    /**
+     * @brief Количество вентилей (включая входы и константы)
+     * @return Число вентилей
+     */
+    int size() const;
+
+    /**
+     * @brief Получить вентиль по индексу
+     * @param id Индекс вентиля
+     * @return Ссылка на вентиль
+     */
+    const Gate& gate(int id) const;
+
+    /**
+     * @brief Индексы первичных входов в порядке добавления
+     * @return Список индексов
+     */
+    const std::vector<int>& inputs() const;
+
+    /**
+     * @brief Имя первичного входа
+     * @param id Индекс вентиля-входа
+     * @return Имя входа или пустая строка для прочих вентилей
+     */
+    QString inputName(int id) const;
+
+    /**
+     * @brief Найти вход по имени
+     * @param name Имя входа
+     * @return Индекс вентиля или -1
+     */
+    int findInput(const QString& name) const;
+
+    /**
+     * @brief Выходы сети
+     * @return Список выходов в порядке добавления
+     */
+    const std::vector<Output>& outputs() const;
+
+    /**
+     * @brief Построить сеть по дереву разбора
+     * @param root Корень дерева SchemaTree
+     * @param outputName Имя единственного выхода
+     * @return Сеть с общими одинаковыми подвыражениями
+     */
+    static LogicGraph fromTree(const SchemaTree::Node* root, const QString& outputName = "Y");
+
+    /**
+     * @brief Проверить, задан ли текст как список именованных уравнений
+     * @param text Введённый текст
+     * @return true, если текст содержит '=' или ';'
+     */
+    static bool isEquationList(const QString& text);
+
+    /**
+     * @brief Построить сеть по списку уравнений
+     * @param text Уравнения вида "Y1 = A & B; Y2 = !(A & B) | C"
+     * @param error Сюда записывается описание ошибки (может быть nullptr)
+     * @return Сеть с общими для всех выходов подвыражениями
+     *
+     * Уравнения разделяются символом ';' или переводом строки.
+     * Уравнение без имени получает имя Y<номер>, текст без '='
+     * и ';' трактуется как одно уравнение с выходом "Y".
+     * При ошибке возвращается сеть без выходов.
+     */
+    static LogicGraph fromEquations(const QString& text, QString* error = nullptr);
+
+    /**
+     * @brief Добавить дерево разбора к сети
+     * @param node Корень поддерева
+     * @return Индекс вентиля, формирующего значение поддерева, или -1
+     *
+     * Дерево обходится без рекурсии, поэтому его глубина не ограничена.
+     */
+    int addTree(const SchemaTree::Node* node);
+
+    /**
+     * @brief Развернуть выход сети в дерево разбора
+     * @param outputIndex Номер выхода
+     * @param maxNodes Предельное число узлов дерева
+     * @param error Сюда записывается описание ошибки (может быть nullptr)
+     * @return Корень дерева или nullptr при ошибке
+     *
+     * Вентили с несколькими потребителями копируются в каждую ветвь,
+     * поэтому размер дерева может заметно превышать размер сети;
+     * maxNodes ограничивает этот рост. Сеть обходится без рекурсии.
+     */
+    std::unique_ptr<SchemaTree::Node> toTree(int outputIndex,
+                                             int maxNodes,
+                                             QString* error = nullptr) const;
+
+    /**
+     * @brief Вычислить выходы сразу для 64 наборов входов
+     * @param inputWords Слово на каждый вход в порядке inputs():
+     *                   бит k — значение входа в наборе k
+     * @return Слово на каждый выход в порядке outputs()
+     *
+     * Эталонное вычисление сети прямым проходом по вентилям.
+     */
+    std::vector<quint64> evaluate(const std::vector<quint64>& inputWords) const;
+
+private:
+    /**
+     * @struct GateKey
+     * @brief Ключ структурного хэширования вентиля
+     */
+    struct GateKey
+    {
+        GateKind kind;            ///< Тип вентиля
+        std::vector<int> fanins;  ///< Упорядоченные индексы входов
+
+        bool operator==(const GateKey& other) const
+        {
+            return kind == other.kind && fanins == other.fanins;
+        }
+    };
+
+    /**
+     * @struct GateKeyHash
+     * @brief Хэш-функция ключа вентиля
+     */
+    struct GateKeyHash
+    {
+        size_t operator()(const GateKey& key) const;
+    };
+
+    std::vector<Gate> gates;                  ///< Вентили в топологическом порядке
+    std::vector<int> inputIds;                ///< Индексы первичных входов
+    std::vector<Output> outputList;           ///< Выходы сети
+    QHash<QString, int> inputByName;          ///< Вход по имени
+    QHash<int, QString> nameByInput;          ///< Имя по индексу входа
+    int constIds[2] = {-1, -1};               ///< Индексы констант 0 и 1
+    std::unordered_map<GateKey, int, GateKeyHash> structuralHash;  ///< Таблица хэширования
+};
+
+#endif // LOGICGRAPH_H
@@ -0,0 +1,553 @@
+#include "ModelCounter.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <random>
+
+// Константы.
+static constexpr int FALSE_NODE = 0;
+static constexpr int TRUE_NODE = 1;
+static constexpr double DEFAULT_PROBABILITY = 0.5;
+static constexpr int BENCHMARK_MAX_FANIN = 4;
+static constexpr int BENCHMARK_WINDOW = 3;
+static constexpr int BENCHMARK_LOCALITY = 8;
+
+// Хэш тройки целых для таблиц BDD.
+size_t ModelCounter::TripleHash::operator()(const std::tuple<int, int, int>& key) const
+{
+    quint64 h = quint64(std::get<0>(key)) * 0x9E3779B97F4A7C15ULL;
+    h ^= quint64(std::get<1>(key)) + 0x7F4A7C159E3779B9ULL + (h << 6) + (h >> 2);
+    h ^= quint64(std::get<2>(key)) + 0x94D049BB133111EBULL + (h << 6) + (h >> 2);
+    return static_cast<size_t>(h);
+}
+
+// Задать вероятность единицы на входе.
+void ModelCounter::setInputProbability(const QString& name, double probability)
+{
+    inputProbability.insert(name, std::clamp(probability, 0.0, 1.0));
+}
+
+// Вернуть всем входам вероятность 0.5.
+void ModelCounter::clearInputProbabilities()
+{
+    inputProbability.clear();
+}
+
+// Задать предельное число узлов BDD.
+void ModelCounter::setMaxBddNodes(int nodes)
+{
+    maxBddNodes = std::max(2, nodes);
+}
+
+// Посчитать сеть.
+bool ModelCounter::count(const LogicGraph& graph)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    error.clear();
+    stats = Statistics();
+    const std::vector<int>& inputs = graph.inputs();
+    const int inputCount = static_cast<int>(inputs.size());
+    const int size = graph.size();
+    stats.inputs = inputCount;
+    stats.gates = size;
+
+    inputNumber.assign(size, -1);
+    for (int i = 0; i < inputCount; ++i)
+        inputNumber[inputs[i]] = i;
+    orderVariables(graph);
+
+    nodes = {BddNode{inputCount, FALSE_NODE, FALSE_NODE}, BddNode{inputCount, TRUE_NODE, TRUE_NODE}};
+    unique.clear();
+    computed.clear();
+    nodeCount.clear();
+    nodeProbability.clear();
+    gateBdd.assign(size, -1);
+    counts.assign(size, BigUInt());
+    probabilities.assign(size, 0.0);
+    supports.assign(size, 0);
+    outputCounts.clear();
+    outputProbabilities.clear();
+
+    // Множество переменных вентиля нужно, пока не посчитаны все его
+    // потребители, поэтому в памяти хранится только фронт обхода.
+    std::vector<int> consumers(size, 0);
+    for (int id = 0; id < size; ++id) {
+        for (int in : graph.gate(id).fanins)
+            ++consumers[in];
+    }
+    std::vector<std::vector<int>> variables(size);
+    std::vector<int> merged;
+
+    using Kind = LogicGraph::GateKind;
+    for (int id = 0; id < size; ++id) {
+        const LogicGraph::Gate& gate = graph.gate(id);
+        switch (gate.kind) {
+        case Kind::CONST0:
+            break;
+        case Kind::CONST1:
+            counts[id] = BigUInt(1);
+            probabilities[id] = 1.0;
+            break;
+        case Kind::INPUT:
+            variables[id] = {inputNumber[id]};
+            counts[id] = BigUInt(1);
+            probabilities[id] = levelProbability[levelOfInput[inputNumber[id]]];
+            break;
+        case Kind::NOT: {
+            const int in = gate.fanins.front();
+            variables[id] = variables[in];
+            counts[id] = BigUInt::powerOfTwo(supports[in]) - counts[in];
+            probabilities[id] = 1.0 - probabilities[in];
+            break;
+        }
+        case Kind::AND:
+        case Kind::OR:
+        case Kind::XOR: {
+            merged.clear();
+            size_t total = 0;
+            for (int in : gate.fanins) {
+                merged.insert(merged.end(), variables[in].begin(), variables[in].end());
+                total += variables[in].size();
+            }
+            std::sort(merged.begin(), merged.end());
+            merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+
+            if (merged.size() == total) {
+                // Входы независимы: результат складывается из частей.
+                BigUInt count = counts[gate.fanins.front()];
+                double p = probabilities[gate.fanins.front()];
+                int width = supports[gate.fanins.front()];
+                for (size_t k = 1; k < gate.fanins.size(); ++k) {
+                    const int in = gate.fanins[k];
+                    const BigUInt& other = counts[in];
+                    const double q = probabilities[in];
+                    const int otherWidth = supports[in];
+                    if (gate.kind == Kind::AND) {
+                        count = count * other;
+                        p = p * q;
+                    } else if (gate.kind == Kind::OR) {
+                        const BigUInt zeros = (BigUInt::powerOfTwo(width) - count)
+                                            * (BigUInt::powerOfTwo(otherWidth) - other);
+                        count = BigUInt::powerOfTwo(width + otherWidth) - zeros;
+                        p = 1.0 - (1.0 - p) * (1.0 - q);
+                    } else {
+                        count = count * (BigUInt::powerOfTwo(otherWidth) - other)
+                              + (BigUInt::powerOfTwo(width) - count) * other;
+                        p = p * (1.0 - q) + (1.0 - p) * q;
+                    }
+                    width += otherWidth;
+                }
+                counts[id] = count;
+                probabilities[id] = p;
+                ++stats.decomposed;
+            } else {
+                const int root = buildBdd(graph, id);
+                if (root < 0) {
+                    error = QString("Диаграмма решений превысила %1 узлов").arg(maxBddNodes);
+                    return false;
+                }
+                counts[id] = bddCount(root) >> (inputCount - static_cast<int>(merged.size()));
+                probabilities[id] = bddProbability(root);
+            }
+            variables[id] = merged;
+            break;
+        }
+        }
+
+        supports[id] = static_cast<int>(variables[id].size());
+        for (int in : gate.fanins) {
+            if (--consumers[in] == 0)
+                std::vector<int>().swap(variables[in]);
+        }
+    }
+
+    for (const LogicGraph::Output& output : graph.outputs()) {
+        outputCounts.push_back(counts[output.gate] << (inputCount - supports[output.gate]));
+        outputProbabilities.push_back(probabilities[output.gate]);
+    }
+
+    stats.bddNodes = static_cast<int>(nodes.size());
+    stats.elapsedUs = timer.nsecsElapsed() / 1000;
+    return true;
+}
+
+// Число наборов всех входов сети, на которых выход равен 1.
+BigUInt ModelCounter::modelCount(int output) const
+{
+    return outputCounts.at(output);
+}
+
+// Вероятность единицы на выходе.
+double ModelCounter::outputProbability(int output) const
+{
+    return outputProbabilities.at(output);
+}
+
+// Вероятность единицы на вентиле.
+double ModelCounter::probability(int gate) const
+{
+    return probabilities.at(gate);
+}
+
+// Число переменных, от которых зависит вентиль.
+int ModelCounter::supportSize(int gate) const
+{
+    return supports.at(gate);
+}
+
+// Описание последней ошибки.
+QString ModelCounter::errorString() const
+{
+    return error;
+}
+
+// Объём и время последнего подсчёта.
+ModelCounter::Statistics ModelCounter::statistics() const
+{
+    return stats;
+}
+
+// Расставить переменные по уровням BDD.
+void ModelCounter::orderVariables(const LogicGraph& graph)
+{
+    const std::vector<int>& inputs = graph.inputs();
+    const int inputCount = static_cast<int>(inputs.size());
+    levelOfInput.assign(inputCount, -1);
+    levelProbability.assign(inputCount, DEFAULT_PROBABILITY);
+
+    int next = 0;
+    std::vector<char> visited(graph.size(), 0);
+    std::vector<int> stack;
+    for (const LogicGraph::Output& output : graph.outputs()) {
+        stack.push_back(output.gate);
+        while (!stack.empty()) {
+            const int id = stack.back();
+            stack.pop_back();
+            if (visited[id])
+                continue;
+            visited[id] = 1;
+
+            const LogicGraph::Gate& gate = graph.gate(id);
+            if (gate.kind == LogicGraph::GateKind::INPUT)
+                levelOfInput[inputNumber[id]] = next++;
+            for (auto it = gate.fanins.rbegin(); it != gate.fanins.rend(); ++it)
+                stack.push_back(*it);
+        }
+    }
+    for (int i = 0; i < inputCount; ++i) {
+        if (levelOfInput[i] < 0)
+            levelOfInput[i] = next++;
+    }
+
+    for (int i = 0; i < inputCount; ++i)
+        levelProbability[levelOfInput[i]] = inputProbability.value(graph.inputName(inputs[i]), DEFAULT_PROBABILITY);
+}
+
+// Построить BDD вентиля и всех вентилей его конуса, у которых её нет.
+int ModelCounter::buildBdd(const LogicGraph& graph, int gate)
+{
+    std::vector<int> stack{gate};
+    while (!stack.empty()) {
+        const int id = stack.back();
+        if (gateBdd[id] >= 0) {
+            stack.pop_back();
+            continue;
+        }
+
+        const LogicGraph::Gate& g = graph.gate(id);
+        bool ready = true;
+        for (int in : g.fanins) {
+            if (gateBdd[in] < 0) {
+                stack.push_back(in);
+                ready = false;
+            }
+        }
+        if (!ready)
+            continue;
+        stack.pop_back();
+
+        using Kind = LogicGraph::GateKind;
+        int root = -1;
+        switch (g.kind) {
+        case Kind::CONST0:
+            root = FALSE_NODE;
+            break;
+        case Kind::CONST1:
+            root = TRUE_NODE;
+            break;
+        case Kind::INPUT:
+            root = makeNode(levelOfInput[inputNumber[id]], FALSE_NODE, TRUE_NODE);
+            break;
+        case Kind::NOT:
+            root = apply(Operation::XOR, gateBdd[g.fanins.front()], TRUE_NODE);
+            break;
+        case Kind::AND:
+        case Kind::OR:
+        case Kind::XOR: {
+            const Operation op = g.kind == Kind::AND ? Operation::AND
+                               : g.kind == Kind::OR ? Operation::OR : Operation::XOR;
+            root = gateBdd[g.fanins.front()];
+            for (size_t k = 1; k < g.fanins.size() && root >= 0; ++k)
+                root = apply(op, root, gateBdd[g.fanins[k]]);
+            break;
+        }
+        }
+
+        if (root < 0)
+            return -1;
+        gateBdd[id] = root;
+        ++stats.bddGates;
+    }
+    return gateBdd[gate];
+}
+
+// Узел BDD.
+int ModelCounter::makeNode(int level, int low, int high)
+{
+    if (low == high)
+        return low;
+
+    const std::tuple<int, int, int> key(level, low, high);
+    const auto found = unique.find(key);
+    if (found != unique.end())
+        return found->second;
+    if (static_cast<int>(nodes.size()) >= maxBddNodes)
+        return -1;
+
+    const int id = static_cast<int>(nodes.size());
+    nodes.push_back(BddNode{level, low, high});
+    unique.emplace(key, id);
+    return id;
+}
+
+// Применить операцию к двум BDD.
+int ModelCounter::apply(Operation op, int a, int b)
+{
+    struct Frame
+    {
+        int a;
+        int b;
+        int level;
+        int low;
+        int stage;
+    };
+
+    // Лист результата, если он определяется без разложения.
+    auto terminal = [op](int x, int y) {
+        switch (op) {
+        case Operation::AND:
+            if (x == FALSE_NODE || y == FALSE_NODE) return FALSE_NODE;
+            if (x == TRUE_NODE || x == y) return y;
+            if (y == TRUE_NODE) return x;
+            break;
+        case Operation::OR:
+            if (x == TRUE_NODE || y == TRUE_NODE) return TRUE_NODE;
+            if (x == FALSE_NODE || x == y) return y;
+            if (y == FALSE_NODE) return x;
+            break;
+        case Operation::XOR:
+            if (x == y) return FALSE_NODE;
+            if (x == FALSE_NODE) return y;
+            if (y == FALSE_NODE) return x;
+            break;
+        }
+        return -1;
+    };
+    auto cofactor = [this](int x, int level, bool high) {
+        const BddNode& node = nodes[x];
+        return node.level != level ? x : (high ? node.high : node.low);
+    };
+
+    // Таблица вычисленных операций очищается, чтобы не расти
+    // быстрее самой диаграммы.
+    if (static_cast<int>(computed.size()) > maxBddNodes)
+        computed.clear();
+
+    std::vector<Frame> stack{Frame{std::min(a, b), std::max(a, b), 0, 0, 0}};
+    int result = -1;
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        if (frame.stage == 0) {
+            result = terminal(frame.a, frame.b);
+            if (result >= 0) {
+                stack.pop_back();
+                continue;
+            }
+            const auto found = computed.find(std::make_tuple(int(op), frame.a, frame.b));
+            if (found != computed.end()) {
+                result = found->second;
+                stack.pop_back();
+                continue;
+            }
+
+            frame.level = std::min(nodes[frame.a].level, nodes[frame.b].level);
+            frame.stage = 1;
+            const int x = cofactor(frame.a, frame.level, false);
+            const int y = cofactor(frame.b, frame.level, false);
+            stack.push_back(Frame{std::min(x, y), std::max(x, y), 0, 0, 0});
+            continue;
+        }
+
+        if (result < 0)
+            return -1;
+        if (frame.stage == 1) {
+            frame.low = result;
+            frame.stage = 2;
+            const int x = cofactor(frame.a, frame.level, true);
+            const int y = cofactor(frame.b, frame.level, true);
+            stack.push_back(Frame{std::min(x, y), std::max(x, y), 0, 0, 0});
+            continue;
+        }
+
+        result = makeNode(frame.level, frame.low, result);
+        if (result < 0)
+            return -1;
+        computed.emplace(std::make_tuple(int(op), frame.a, frame.b), result);
+        stack.pop_back();
+    }
+    return result;
+}
+
+// Число наборов всех переменных, на которых BDD равна 1.
+BigUInt ModelCounter::bddCount(int root)
+{
+    // Число узла считается по переменным от его уровня до последней;
+    // пропущенные уровни между узлом и ребёнком удваивают число.
+    // У внутреннего узла сокращённой BDD число не бывает нулевым,
+    // поэтому ноль означает «ещё не посчитано».
+    if (nodeCount.size() < nodes.size()) {
+        nodeCount.resize(nodes.size());
+        nodeCount[TRUE_NODE] = BigUInt(1);
+    }
+    auto ready = [this](int id) { return id == FALSE_NODE || !nodeCount[id].isZero(); };
+
+    std::vector<int> stack{root};
+    while (!stack.empty()) {
+        const int id = stack.back();
+        if (ready(id)) {
+            stack.pop_back();
+            continue;
+        }
+        const BddNode& node = nodes[id];
+        if (!ready(node.low) || !ready(node.high)) {
+            if (!ready(node.low))
+                stack.push_back(node.low);
+            if (!ready(node.high))
+                stack.push_back(node.high);
+            continue;
+        }
+        nodeCount[id] = (nodeCount[node.low] << (nodes[node.low].level - node.level - 1))
+                      + (nodeCount[node.high] << (nodes[node.high].level - node.level - 1));
+        stack.pop_back();
+    }
+    return nodeCount[root] << nodes[root].level;
+}
+
+// Вероятность единицы BDD.
+double ModelCounter::bddProbability(int root)
+{
+    const size_t size = nodes.size();
+    if (nodeProbability.size() < size) {
+        nodeProbability.resize(size, -1.0);
+        nodeProbability[FALSE_NODE] = 0.0;
+        nodeProbability[TRUE_NODE] = 1.0;
+    }
+
+    std::vector<int> stack{root};
+    while (!stack.empty()) {
+        const int id = stack.back();
+        if (nodeProbability[id] >= 0) {
+            stack.pop_back();
+            continue;
+        }
+        const BddNode& node = nodes[id];
+        if (nodeProbability[node.low] < 0 || nodeProbability[node.high] < 0) {
+            if (nodeProbability[node.low] < 0)
+                stack.push_back(node.low);
+            if (nodeProbability[node.high] < 0)
+                stack.push_back(node.high);
+            continue;
+        }
+        const double p = levelProbability[node.level];
+        nodeProbability[id] = (1.0 - p) * nodeProbability[node.low] + p * nodeProbability[node.high];
+        stack.pop_back();
+    }
+    return nodeProbability[root];
+}
+
+// Замер на сгенерированных сетях.
+std::vector<ModelCounter::BenchmarkResult> ModelCounter::benchmark(const std::vector<int>& variableCounts,
+                                                                   quint32 seed)
+{
+    using Kind = LogicGraph::GateKind;
+    std::mt19937 random(seed);
+    std::vector<BenchmarkResult> results;
+
+    for (int n : variableCounts) {
+        for (int family = 0; family < 3; ++family) {
+            LogicGraph graph;
+            std::vector<int> x;
+            for (int i = 0; i < n; ++i)
+                x.push_back(graph.addInput(QString("x%1").arg(i)));
+
+            BenchmarkResult result;
+            result.variables = n;
+            if (family == 0) {
+                // Каждая переменная один раз: случайное дерево над
+                // перемешанными входами.
+                result.family = "однократное";
+                std::vector<int> level = x;
+                std::shuffle(level.begin(), level.end(), random);
+                while (level.size() > 1) {
+                    std::vector<int> next;
+                    for (size_t i = 0; i < level.size();) {
+                        const size_t take = std::min<size_t>(level.size() - i, 2 + random() % (BENCHMARK_MAX_FANIN - 1));
+                        std::vector<int> fanins(level.begin() + i, level.begin() + i + take);
+                        if (random() % 4 == 0)
+                            fanins.front() = graph.addGate(Kind::NOT, {fanins.front()});
+                        const Kind kind = random() % 3 == 0 ? Kind::XOR : (random() % 2 ? Kind::AND : Kind::OR);
+                        next.push_back(graph.addGate(kind, fanins));
+                        i += take;
+                    }
+                    level.swap(next);
+                }
+                graph.addOutput("Y", level.front());
+            } else if (family == 1) {
+                // ИЛИ произведений по окнам из BENCHMARK_WINDOW соседних
+                // переменных со случайными инверсиями.
+                result.family = "окна";
+                std::vector<int> terms;
+                for (int i = 0; i + BENCHMARK_WINDOW <= n; ++i) {
+                    std::vector<int> literals;
+                    for (int k = 0; k < BENCHMARK_WINDOW; ++k)
+                        literals.push_back(random() % 2 ? x[i + k] : graph.addGate(Kind::NOT, {x[i + k]}));
+                    terms.push_back(graph.addGate(Kind::AND, literals));
+                }
+                graph.addOutput("Y", graph.addGate(Kind::OR, terms));
+            } else {
+                // Случайная сеть: каждый вентиль берёт вход из недавних
+                // вентилей и переменную из окрестности, поэтому общие
+                // подвыражения и общие переменные встречаются часто.
+                result.family = "случайная";
+                std::vector<int> wires = x;
+                for (int i = 0; i < 2 * n; ++i) {
+                    const int recent = wires[wires.size() - 1 - random() % std::min<size_t>(wires.size(), BENCHMARK_LOCALITY)];
+                    const int local = x[std::min(n - 1, i / 2 + static_cast<int>(random() % BENCHMARK_LOCALITY))];
+                    const Kind kind = random() % 3 == 0 ? Kind::XOR : (random() % 2 ? Kind::AND : Kind::OR);
+                    const int gate = graph.addGate(kind, {recent, random() % 3 ? local : graph.addGate(Kind::NOT, {local})});
+                    wires.push_back(gate);
+                }
+                graph.addOutput("Y", wires.back());
+            }
+
+            ModelCounter counter;
+            result.ok = counter.count(graph);
+            result.stats = counter.statistics();
+            if (result.ok)
+                result.digits = counter.modelCount(0).toString().size();
+            results.push_back(result);
+        }
+    }
+    return results;
+}
@@ -0,0 +1,242 @@
+#ifndef MODELCOUNTER_H
+#define MODELCOUNTER_H
+
+#include <QHash>
+#include <QString>
+#include <QtGlobal>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "BigUInt.h"
+#include "LogicGraph.h"
+
+/**
+ * @class ModelCounter
+ * @brief Точное число выполняющих наборов и вероятности сигналов сети
+ *
+ * Для каждого вентиля считает, на скольких наборах его входов-переменных
+ * он равен 1, и вероятность единицы при независимых входах с заданными
+ * вероятностями. Перебор 2^n наборов не выполняется, поэтому сети
+ * с сотнями и тысячами входов считаются за время, зависящее
+ * от структуры, а не от числа наборов.
+ *
+ * @details
+ * - Вентиль, входы которого зависят от непересекающихся множеств
+ *   переменных, считается разложением: числа и вероятности частей
+ *   перемножаются. Так считается любое выражение, где каждая переменная
+ *   встречается один раз.
+ * - Вентиль с общими переменными во входах строится как ROBDD
+ *   (упорядоченная сокращённая диаграмма решений), число наборов
+ *   и вероятность снимаются с неё обходом с запоминанием.
+ * - Одинаковые подвыражения уже объединены структурным хэшированием
+ *   LogicGraph, поэтому каждый результат считается один раз.
+ * - Порядок переменных BDD — порядок первого появления при обходе
+ *   сети от выходов в глубину: переменные соседних подвыражений
+ *   оказываются рядом.
+ * - Число узлов BDD ограничено; при превышении подсчёт прерывается
+ *   с ошибкой.
+ */
+class ModelCounter {
+public:
+    /**
+     * @struct Statistics
+     * @brief Объём и время последнего подсчёта
+     */
+    struct Statistics
+    {
+        int inputs = 0;        ///< Число входов сети
+        int gates = 0;         ///< Число вентилей сети
+        int decomposed = 0;    ///< Вентилей, посчитанных разложением
+        int bddGates = 0;      ///< Вентилей, для которых строилась BDD
+        int bddNodes = 0;      ///< Узлов BDD
+        qint64 elapsedUs = 0;  ///< Время подсчёта, мкс
+    };
+
+    /**
+     * @struct BenchmarkResult
+     * @brief Результат замера на одной сгенерированной сети
+     */
+    struct BenchmarkResult
+    {
+        QString family;        ///< Вид сети
+        int variables = 0;     ///< Число входов
+        Statistics stats;      ///< Статистика подсчёта
+        int digits = 0;        ///< Десятичных цифр в числе наборов
+        bool ok = false;       ///< Подсчёт завершён
+    };
+
+    /**
+     * @brief Задать вероятность единицы на входе
+     * @param name Имя входа
+     * @param probability Вероятность из [0, 1]; по умолчанию 0.5
+     */
+    void setInputProbability(const QString& name, double probability);
+
+    /**
+     * @brief Вернуть всем входам вероятность 0.5
+     */
+    void clearInputProbabilities();
+
+    /**
+     * @brief Задать предельное число узлов BDD
+     * @param nodes Число узлов
+     */
+    void setMaxBddNodes(int nodes);
+
+    /**
+     * @brief Посчитать сеть
+     * @param graph Сеть
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool count(const LogicGraph& graph);
+
+    /**
+     * @brief Число наборов всех входов сети, на которых выход равен 1
+     * @param output Номер выхода
+     * @return Точное число из [0, 2^inputs]
+     */
+    BigUInt modelCount(int output) const;
+
+    /**
+     * @brief Вероятность единицы на выходе
+     * @param output Номер выхода
+     * @return Вероятность
+     */
+    double outputProbability(int output) const;
+
+    /**
+     * @brief Вероятность единицы на вентиле
+     * @param gate Индекс вентиля сети
+     * @return Вероятность
+     */
+    double probability(int gate) const;
+
+    /**
+     * @brief Число переменных, от которых зависит вентиль
+     * @param gate Индекс вентиля сети
+     * @return Размер носителя
+     */
+    int supportSize(int gate) const;
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Объём и время последнего подсчёта
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief Замер на сгенерированных сетях
+     * @param variableCounts Числа входов (например, 100, 200, 400)
+     * @param seed Начальное значение генератора
+     * @return По результату на каждый вид сети и число входов
+     *
+     * Виды сетей: выражение, где каждая переменная встречается один раз;
+     * сумма произведений по перекрывающимся окнам переменных;
+     * случайная сеть с общими подвыражениями.
+     */
+    static std::vector<BenchmarkResult> benchmark(const std::vector<int>& variableCounts, quint32 seed = 1);
+
+    static constexpr int DEFAULT_MAX_BDD_NODES = 1 << 22;  ///< Лимит узлов BDD по умолчанию
+
+private:
+    /**
+     * @enum Operation
+     * @brief Операции над BDD
+     */
+    enum class Operation { AND, OR, XOR };
+
+    /**
+     * @struct BddNode
+     * @brief Узел BDD: переменная уровня level, ветви для 0 и 1
+     */
+    struct BddNode
+    {
+        int level;  ///< Уровень переменной; у листьев — число переменных
+        int low;    ///< Узел при значении 0
+        int high;   ///< Узел при значении 1
+    };
+
+    /**
+     * @struct TripleHash
+     * @brief Хэш тройки целых для таблиц BDD
+     */
+    struct TripleHash
+    {
+        size_t operator()(const std::tuple<int, int, int>& key) const;
+    };
+
+    /**
+     * @brief Расставить переменные по уровням BDD
+     * @param graph Сеть
+     */
+    void orderVariables(const LogicGraph& graph);
+
+    /**
+     * @brief Построить BDD вентиля и всех вентилей его конуса, у которых её нет
+     * @param graph Сеть
+     * @param gate Индекс вентиля
+     * @return Узел BDD или -1 при превышении лимита
+     */
+    int buildBdd(const LogicGraph& graph, int gate);
+
+    /**
+     * @brief Узел BDD (с поиском в таблице уникальности)
+     * @param level Уровень переменной
+     * @param low Узел при значении 0
+     * @param high Узел при значении 1
+     * @return Индекс узла или -1 при превышении лимита
+     */
+    int makeNode(int level, int low, int high);
+
+    /**
+     * @brief Применить операцию к двум BDD
+     * @param op Операция
+     * @param a Первый операнд
+     * @param b Второй операнд
+     * @return Узел результата или -1 при превышении лимита
+     *
+     * Обход без рекурсии с таблицей уже вычисленных пар.
+     */
+    int apply(Operation op, int a, int b);
+
+    /**
+     * @brief Число наборов всех переменных, на которых BDD равна 1
+     * @param root Узел BDD
+     * @return Точное число
+     */
+    BigUInt bddCount(int root);
+
+    /**
+     * @brief Вероятность единицы BDD
+     * @param root Узел BDD
+     * @return Вероятность
+     */
+    double bddProbability(int root);
+
+    QHash<QString, double> inputProbability;  ///< Заданные вероятности входов
+    int maxBddNodes = DEFAULT_MAX_BDD_NODES;  ///< Лимит узлов BDD
+    std::vector<int> levelOfInput;            ///< Уровень BDD по номеру входа
+    std::vector<double> levelProbability;     ///< Вероятность переменной уровня
+    std::vector<int> inputNumber;             ///< Номер входа по индексу вентиля
+    std::vector<BddNode> nodes;               ///< Узлы BDD; 0 и 1 — листья
+    std::unordered_map<std::tuple<int, int, int>, int, TripleHash> unique;    ///< Таблица уникальности
+    std::unordered_map<std::tuple<int, int, int>, int, TripleHash> computed;  ///< Вычисленные операции
+    std::vector<BigUInt> nodeCount;           ///< Запомненные числа наборов узлов BDD
+    std::vector<double> nodeProbability;      ///< Запомненные вероятности узлов BDD
+    std::vector<int> gateBdd;                 ///< BDD вентиля или -1
+    std::vector<BigUInt> counts;              ///< Число наборов носителя, на которых вентиль равен 1
+    std::vector<double> probabilities;        ///< Вероятность единицы вентиля
+    std::vector<int> supports;                ///< Размер носителя вентиля
+    std::vector<BigUInt> outputCounts;        ///< Число наборов всех входов по выходам
+    std::vector<double> outputProbabilities;  ///< Вероятности выходов
+    QString error;                            ///< Текст последней ошибки
+    Statistics stats;                         ///< Статистика
+};
+
+#endif // MODELCOUNTER_H
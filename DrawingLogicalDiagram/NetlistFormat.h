@@ -0,0 +1,19 @@
+#ifndef NETLISTFORMAT_H
+#define NETLISTFORMAT_H
+
+/**
+ * @enum NetlistFormat
+ * @brief Форматы файлов нетлистов
+ *
+ * Определяет форматы, в которых схема может быть
+ * импортирована (NetlistReader) и экспортирована (NetlistWriter).
+ */
+enum class NetlistFormat {
+    AUTO,          ///< Определить по расширению и содержимому
+    BLIF,          ///< Berkeley Logic Interchange Format
+    AIGER_ASCII,   ///< AIGER, текстовый вариант (aag)
+    AIGER_BINARY,  ///< AIGER, двоичный вариант (aig)
+    VERILOG        ///< Структурный Verilog
+};
+
+#endif // NETLISTFORMAT_H
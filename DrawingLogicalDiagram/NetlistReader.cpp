@@ -0,0 +1,1054 @@
+#include "NetlistReader.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Сигнал нетлиста до сборки сети.
+struct NetlistNet
+{
+    /**
+     * @enum Def
+     * @brief Способ определения сигнала
+     */
+    enum class Def {
+        NONE,    ///< Сигнал использован, но не определён
+        INPUT,   ///< Первичный вход
+        CONST0,  ///< Константа 0
+        CONST1,  ///< Константа 1
+        GATE,    ///< Вентиль kind над fanins
+        COVER    ///< SOP-покрытие BLIF над fanins
+    };
+
+    Def def = Def::NONE;                                    ///< Способ определения
+    LogicGraph::GateKind kind = LogicGraph::GateKind::AND;  ///< Тип вентиля для GATE
+    bool inverted = false;              ///< Инверсия результата (nand/nor/xnor, offset-покрытие)
+    std::vector<int> fanins;            ///< Входные сигналы
+    std::vector<std::string_view> cubes;  ///< Входные части строк покрытия
+    QString name;                       ///< Имя сигнала
+    int graphId = -1;                   ///< Индекс вентиля в собранной сети
+};
+
+// Таблица сигналов, заполняемая за один проход по файлу.
+struct NetlistReader::SignalTable
+{
+    std::vector<NetlistNet> nets;                       ///< Все сигналы
+    std::unordered_map<std::string_view, int> byName;   ///< Сигнал по имени в файле
+    std::vector<int> inputs;                            ///< Входы в порядке объявления
+    std::vector<std::pair<QString, int>> outputs;       ///< Выходы в порядке объявления
+
+    // Найти или создать именованный сигнал.
+    int lookup(std::string_view name)
+    {
+        auto it = byName.find(name);
+        if (it != byName.end())
+            return it->second;
+        int id = create();
+        nets[id].name = QString::fromUtf8(name.data(), static_cast<int>(name.size()));
+        byName.emplace(name, id);
+        return id;
+    }
+
+    // Создать безымянный сигнал.
+    int create()
+    {
+        nets.emplace_back();
+        return static_cast<int>(nets.size()) - 1;
+    }
+
+    // Создать вентиль над сигналами.
+    int createGate(LogicGraph::GateKind kind, std::vector<int> fanins, bool inverted = false)
+    {
+        int id = create();
+        NetlistNet& net = nets[id];
+        net.def = NetlistNet::Def::GATE;
+        net.kind = kind;
+        net.inverted = inverted;
+        net.fanins = std::move(fanins);
+        return id;
+    }
+
+    // Объявить первичный вход.
+    void declareInput(int id)
+    {
+        if (nets[id].def == NetlistNet::Def::INPUT)
+            return;
+        nets[id].def = NetlistNet::Def::INPUT;
+        inputs.push_back(id);
+    }
+};
+
+// Пробельный символ нетлиста.
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Символ идентификатора Verilog.
+static inline bool isIdentChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+           || c == '_' || c == '$';
+}
+
+// Значение однобитовой константы Verilog: 0, 1, 1'b0, 1'h1 и т. п.; -1 для остальных.
+static int verilogConstant(std::string_view token)
+{
+    // Ширина задаётся до апострофа; у константы без апострофа
+    // ширины нет, но её значение тоже должно быть 0 или 1.
+    const size_t quote = token.find('\'');
+    std::string_view digits = token;
+    int base = 10;
+    if (quote != std::string_view::npos) {
+        if (token.substr(0, quote) != "1")
+            return -1;
+        size_t pos = quote + 1;
+        if (pos < token.size() && (token[pos] == 's' || token[pos] == 'S'))
+            ++pos;
+        if (pos >= token.size())
+            return -1;
+        switch (token[pos]) {
+        case 'b': case 'B': base = 2; break;
+        case 'o': case 'O': base = 8; break;
+        case 'd': case 'D': base = 10; break;
+        case 'h': case 'H': base = 16; break;
+        default: return -1;
+        }
+        digits = token.substr(pos + 1);
+    }
+
+    // Старшие разряды должны быть нулевыми: 1'b01 — это 1, а 2'b10 и 10 отвергаются.
+    int value = -1;
+    for (char c : digits) {
+        if (c == '_' && value >= 0)
+            continue;
+        int digit = -1;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        if (digit < 0 || digit >= base)
+            return -1;
+        value = std::max(value, 0) * base + digit;
+        if (value > 1)
+            return -1;
+    }
+    return value;
+}
+
+// Прочитать логическую строку BLIF (с продолжениями через '\') и разбить её на лексемы.
+static const char* nextBlifLine(const char* p, const char* end,
+                                std::vector<std::string_view>& tokens, int& lineNo)
+{
+    tokens.clear();
+    while (p < end) {
+        ++lineNo;
+        while (p < end && *p != '\n') {
+            if (isBlank(*p)) {
+                ++p;
+            } else if (*p == '#') {
+                while (p < end && *p != '\n') ++p;
+            } else {
+                const char* start = p;
+                while (p < end && *p != '\n' && *p != '#' && !isBlank(*p)) ++p;
+                tokens.emplace_back(start, static_cast<size_t>(p - start));
+            }
+        }
+        if (p < end) ++p;
+
+        bool continued = false;
+        if (!tokens.empty() && tokens.back().back() == '\\') {
+            tokens.back().remove_suffix(1);
+            if (tokens.back().empty())
+                tokens.pop_back();
+            continued = true;
+        }
+        if (!continued && !tokens.empty())
+            return p;
+    }
+    return p;
+}
+
+// Прочитать беззнаковое число ASCII AIGER.
+static bool readAigerNumber(const char*& p, const char* end, quint64& value)
+{
+    while (p < end && isBlank(*p)) ++p;
+    if (p >= end || *p < '0' || *p > '9')
+        return false;
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + static_cast<quint64>(*p++ - '0');
+    return true;
+}
+
+// Перейти к началу следующей строки.
+static void skipLine(const char*& p, const char* end)
+{
+    while (p < end && *p != '\n') ++p;
+    if (p < end) ++p;
+}
+
+// Прочитать число двоичного AIGER (7 бит на байт).
+static bool readAigerDelta(const char*& p, const char* end, quint64& value)
+{
+    value = 0;
+    int shift = 0;
+    while (p < end) {
+        auto byte = static_cast<unsigned char>(*p++);
+        value |= static_cast<quint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+        shift += 7;
+        if (shift > 63)
+            return false;
+    }
+    return false;
+}
+
+// Прочитать нетлист из файла.
+bool NetlistReader::read(const QString& path, LogicGraph& graph, NetlistFormat format)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(QString("Не удалось открыть файл %1: %2").arg(path, file.errorString()));
+
+    const qint64 size = file.size();
+    if (size <= 0)
+        return fail(QString("Файл %1 пуст").arg(path));
+
+    QByteArray buffer;
+    const char* data = reinterpret_cast<const char*>(file.map(0, size));
+    if (!data) {
+        buffer = file.readAll();
+        data = buffer.constData();
+    }
+
+    if (format == NetlistFormat::AUTO)
+        format = detectFormat(path, data, size);
+
+    return readData(data, size, format, graph);
+}
+
+// Прочитать нетлист из буфера.
+bool NetlistReader::readData(const char* data, qint64 size, NetlistFormat format, LogicGraph& graph)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    error.clear();
+    stats = Statistics();
+    stats.bytes = size;
+    graph = LogicGraph();
+
+    if (format == NetlistFormat::AUTO)
+        format = detectFormat(QString(), data, size);
+
+    SignalTable table;
+    const char* end = data + size;
+    bool ok = false;
+
+    switch (format) {
+    case NetlistFormat::AIGER_ASCII:
+    case NetlistFormat::AIGER_BINARY:
+        ok = parseAiger(data, end, table);
+        break;
+    case NetlistFormat::VERILOG:
+        ok = parseVerilog(data, end, table);
+        break;
+    case NetlistFormat::BLIF:
+    case NetlistFormat::AUTO:
+        ok = parseBlif(data, end, table);
+        break;
+    }
+
+    if (!ok || !buildGraph(table, graph)) {
+        graph = LogicGraph();
+        return false;
+    }
+
+    stats.elapsedMs = timer.elapsed();
+    stats.gates = graph.size();
+    stats.inputs = static_cast<int>(graph.inputs().size());
+    stats.outputs = static_cast<int>(graph.outputs().size());
+    return true;
+}
+
+// Описание последней ошибки.
+QString NetlistReader::errorString() const
+{
+    return error;
+}
+
+// Статистика последнего чтения.
+NetlistReader::Statistics NetlistReader::statistics() const
+{
+    return stats;
+}
+
+// Определить формат нетлиста.
+NetlistFormat NetlistReader::detectFormat(const QString& path, const char* data, qint64 size)
+{
+    const std::string_view head(data, static_cast<size_t>(std::min<qint64>(size, 4096)));
+    if (head.substr(0, 4) == "aag ")
+        return NetlistFormat::AIGER_ASCII;
+    if (head.substr(0, 4) == "aig ")
+        return NetlistFormat::AIGER_BINARY;
+
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "blif") return NetlistFormat::BLIF;
+    if (suffix == "v" || suffix == "sv") return NetlistFormat::VERILOG;
+
+    size_t pos = 0;
+    while (pos < head.size()) {
+        if (isBlank(head[pos]) || head[pos] == '\n') {
+            ++pos;
+        } else if (head[pos] == '#' || head.substr(pos, 2) == "//") {
+            pos = head.find('\n', pos);
+        } else if (head.substr(pos, 2) == "/*") {
+            pos = head.find("*/", pos);
+            if (pos != std::string_view::npos) pos += 2;
+        } else {
+            break;
+        }
+    }
+
+    if (pos < head.size() && head.substr(pos, 6) == "module")
+        return NetlistFormat::VERILOG;
+    return NetlistFormat::BLIF;
+}
+
+// Разобрать BLIF.
+bool NetlistReader::parseBlif(const char* data, const char* end, SignalTable& table)
+{
+    std::vector<std::string_view> tokens;
+    std::vector<std::string_view> outputNames;
+    int lineNo = 0;
+    int cover = -1;
+    bool coverHasRows = false;
+    const char* p = data;
+
+    while (p < end) {
+        p = nextBlifLine(p, end, tokens, lineNo);
+        if (tokens.empty())
+            break;
+
+        const std::string_view head = tokens.front();
+
+        if (head.front() != '.') {
+            if (cover < 0)
+                return fail("Строка покрытия вне .names", lineNo);
+
+            NetlistNet& net = table.nets[cover];
+            const size_t width = net.fanins.size();
+            std::string_view cube;
+            std::string_view bit;
+
+            if (width == 0 && tokens.size() == 1) {
+                bit = tokens[0];
+            } else if (tokens.size() == 2 && tokens[0].size() == width) {
+                cube = tokens[0];
+                bit = tokens[1];
+            } else {
+                return fail("Некорректная строка покрытия", lineNo);
+            }
+
+            if (bit != "0" && bit != "1")
+                return fail("Выход строки покрытия должен быть 0 или 1", lineNo);
+            for (char c : cube) {
+                if (c != '0' && c != '1' && c != '-')
+                    return fail("Недопустимый символ в кубе покрытия", lineNo);
+            }
+
+            const bool offset = (bit == "0");
+            if (coverHasRows && net.inverted != offset)
+                return fail("Покрытие смешивает строки для 0 и 1", lineNo);
+
+            net.inverted = offset;
+            net.cubes.push_back(cube);
+            coverHasRows = true;
+            continue;
+        }
+
+        cover = -1;
+
+        if (head == ".model" || head == ".default_input_arrival" || head == ".default_output_required") {
+            continue;
+        } else if (head == ".inputs") {
+            for (size_t i = 1; i < tokens.size(); ++i) {
+                int id = table.lookup(tokens[i]);
+                if (table.nets[id].def != NetlistNet::Def::NONE && table.nets[id].def != NetlistNet::Def::INPUT)
+                    return fail(QString("Вход %1 уже определён").arg(table.nets[id].name), lineNo);
+                table.declareInput(id);
+            }
+        } else if (head == ".outputs") {
+            for (size_t i = 1; i < tokens.size(); ++i)
+                outputNames.push_back(tokens[i]);
+        } else if (head == ".names") {
+            if (tokens.size() < 2)
+                return fail(".names без выходного сигнала", lineNo);
+
+            cover = table.lookup(tokens.back());
+            NetlistNet& net = table.nets[cover];
+            if (net.def != NetlistNet::Def::NONE)
+                return fail(QString("Сигнал %1 определён повторно").arg(net.name), lineNo);
+
+            std::vector<int> fanins;
+            fanins.reserve(tokens.size() - 2);
+            for (size_t i = 1; i + 1 < tokens.size(); ++i)
+                fanins.push_back(table.lookup(tokens[i]));
+
+            NetlistNet& defined = table.nets[cover];
+            defined.def = NetlistNet::Def::COVER;
+            defined.fanins = std::move(fanins);
+            coverHasRows = false;
+        } else if (head == ".end" || head == ".exdc") {
+            break;
+        } else if (head == ".latch" || head == ".mlatch") {
+            return fail("Защёлки (.latch) не поддерживаются", lineNo);
+        } else if (head == ".subckt" || head == ".gate") {
+            return fail("Подсхемы (.subckt/.gate) не поддерживаются", lineNo);
+        } else {
+            return fail(QString("Неизвестная директива %1")
+                            .arg(QString::fromUtf8(head.data(), static_cast<int>(head.size()))), lineNo);
+        }
+    }
+
+    for (std::string_view name : outputNames) {
+        int id = table.lookup(name);
+        table.outputs.emplace_back(table.nets[id].name, id);
+    }
+    return true;
+}
+
+// Разобрать AIGER (aag/aig).
+bool NetlistReader::parseAiger(const char* data, const char* end, SignalTable& table)
+{
+    const char* p = data;
+    const std::string_view magic(p, static_cast<size_t>(std::min<qint64>(end - p, 3)));
+    const bool binary = (magic == "aig");
+    if (!binary && magic != "aag")
+        return fail("Некорректный заголовок AIGER", 1);
+    p += 3;
+
+    quint64 header[5];
+    for (quint64& value : header) {
+        if (!readAigerNumber(p, end, value))
+            return fail("Некорректный заголовок AIGER", 1);
+    }
+    const quint64 maxVar = header[0], numInputs = header[1], numLatches = header[2];
+    const quint64 numOutputs = header[3], numAnds = header[4];
+
+    quint64 extra = 0;
+    while (p < end && *p != '\n') {
+        if (!readAigerNumber(p, end, extra)) break;
+        if (extra != 0)
+            return fail("Свойства, ограничения и справедливость AIGER не поддерживаются", 1);
+    }
+    skipLine(p, end);
+
+    if (numLatches != 0)
+        return fail("Защёлки AIGER не поддерживаются", 1);
+    // Суммы в заголовке не складываются, чтобы огромные значения
+    // не переполнили quint64; выход занимает строку не короче двух байт.
+    if (maxVar > 0x3FFFFFFF || numInputs > maxVar || numAnds > maxVar - numInputs
+        || numOutputs > static_cast<quint64>(end - p) / 2)
+        return fail("Некорректный заголовок AIGER", 1);
+
+    table.nets.resize(maxVar + 1);
+    table.nets[0].def = NetlistNet::Def::CONST0;
+    std::vector<int> negated(maxVar + 1, -1);
+    int constOne = -1;
+
+    auto literalNet = [&](quint64 lit) -> int {
+        const quint64 var = lit >> 1;
+        if (!(lit & 1))
+            return static_cast<int>(var);
+        if (lit == 1) {
+            if (constOne < 0) {
+                constOne = table.create();
+                table.nets[constOne].def = NetlistNet::Def::CONST1;
+            }
+            return constOne;
+        }
+        if (negated[var] < 0)
+            negated[var] = table.createGate(LogicGraph::GateKind::NOT, {static_cast<int>(var)});
+        return negated[var];
+    };
+
+    int lineNo = 1;
+    quint64 lit = 0;
+
+    for (quint64 i = 0; i < numInputs; ++i) {
+        ++lineNo;
+        quint64 var = i + 1;
+        if (!binary) {
+            if (!readAigerNumber(p, end, lit) || (lit & 1) || lit < 2 || (lit >> 1) > maxVar)
+                return fail("Некорректный литерал входа", lineNo);
+            skipLine(p, end);
+            var = lit >> 1;
+        }
+        if (var > maxVar)
+            return fail("Некорректный литерал входа", lineNo);
+        table.nets[var].name = QString("i%1").arg(i);
+        table.declareInput(static_cast<int>(var));
+    }
+
+    std::vector<quint64> outputLits;
+    outputLits.reserve(numOutputs);
+    for (quint64 i = 0; i < numOutputs; ++i) {
+        ++lineNo;
+        if (!readAigerNumber(p, end, lit) || (lit >> 1) > maxVar)
+            return fail("Некорректный литерал выхода", lineNo);
+        skipLine(p, end);
+        outputLits.push_back(lit);
+    }
+
+    for (quint64 i = 0; i < numAnds; ++i) {
+        quint64 lhs = 0, rhs0 = 0, rhs1 = 0;
+        if (binary) {
+            quint64 delta0 = 0, delta1 = 0;
+            lhs = 2 * (numInputs + i + 1);
+            if (!readAigerDelta(p, end, delta0) || !readAigerDelta(p, end, delta1)
+                || delta0 > lhs || delta1 > lhs - delta0)
+                return fail(QString("Некорректное кодирование вентиля AND %1").arg(i));
+            rhs0 = lhs - delta0;
+            rhs1 = rhs0 - delta1;
+        } else {
+            ++lineNo;
+            if (!readAigerNumber(p, end, lhs) || !readAigerNumber(p, end, rhs0)
+                || !readAigerNumber(p, end, rhs1))
+                return fail("Некорректная строка вентиля AND", lineNo);
+            skipLine(p, end);
+        }
+
+        const quint64 var = lhs >> 1;
+        if ((lhs & 1) || var == 0 || var > maxVar || (rhs0 >> 1) > maxVar || (rhs1 >> 1) > maxVar)
+            return fail("Некорректный литерал вентиля AND", lineNo);
+        if (table.nets[var].def != NetlistNet::Def::NONE)
+            return fail(QString("Переменная AIGER %1 определена повторно").arg(var), lineNo);
+
+        const int a = literalNet(rhs0);
+        const int b = literalNet(rhs1);
+        NetlistNet& net = table.nets[var];
+        net.def = NetlistNet::Def::GATE;
+        net.kind = LogicGraph::GateKind::AND;
+        net.fanins = {a, b};
+    }
+
+    std::vector<QString> outputNames(numOutputs);
+    for (quint64 i = 0; i < numOutputs; ++i)
+        outputNames[i] = QString("o%1").arg(i);
+
+    while (p < end) {
+        const char kind = *p;
+        if (kind == 'c')
+            break;
+        if (kind != 'i' && kind != 'o' && kind != 'l') {
+            skipLine(p, end);
+            continue;
+        }
+        ++p;
+        quint64 index = 0;
+        if (!readAigerNumber(p, end, index)) {
+            skipLine(p, end);
+            continue;
+        }
+        while (p < end && isBlank(*p)) ++p;
+        const char* start = p;
+        while (p < end && *p != '\n' && *p != '\r') ++p;
+        const QString name = QString::fromUtf8(start, static_cast<int>(p - start));
+        skipLine(p, end);
+
+        if (kind == 'i' && index < table.inputs.size())
+            table.nets[table.inputs[index]].name = name;
+        else if (kind == 'o' && index < numOutputs)
+            outputNames[index] = name;
+    }
+
+    for (quint64 i = 0; i < numOutputs; ++i)
+        table.outputs.emplace_back(outputNames[i], literalNet(outputLits[i]));
+    return true;
+}
+
+// Лексический анализатор структурного Verilog.
+struct VerilogLexer
+{
+    const char* p;           ///< Текущая позиция
+    const char* end;         ///< Конец данных
+    int line = 1;            ///< Текущая строка
+    std::string_view token;  ///< Текущая лексема (пустая в конце файла)
+    bool escaped = false;    ///< Текущая лексема — экранированный идентификатор
+
+    // Перейти к следующей лексеме.
+    void next()
+    {
+        for (;;) {
+            while (p < end && (isBlank(*p) || *p == '\n')) {
+                if (*p == '\n') ++line;
+                ++p;
+            }
+            if (p + 1 < end && p[0] == '/' && p[1] == '/') {
+                while (p < end && *p != '\n') ++p;
+            } else if (p + 1 < end && p[0] == '/' && p[1] == '*') {
+                p += 2;
+                while (p + 1 < end && !(p[0] == '*' && p[1] == '/')) {
+                    if (*p == '\n') ++line;
+                    ++p;
+                }
+                p = std::min(p + 2, end);
+            } else {
+                break;
+            }
+        }
+
+        const char* start = p;
+        escaped = false;
+        if (p >= end) {
+            token = std::string_view();
+            return;
+        }
+
+        if (*p == '\\') {
+            escaped = true;
+            ++start;
+            ++p;
+            while (p < end && !isBlank(*p) && *p != '\n') ++p;
+        } else if (isIdentChar(*p)) {
+            while (p < end && (isIdentChar(*p) || *p == '\'')) ++p;
+        } else if (p + 1 < end && ((p[0] == '~' && p[1] == '^') || (p[0] == '^' && p[1] == '~'))) {
+            p += 2;
+        } else {
+            ++p;
+        }
+        token = std::string_view(start, static_cast<size_t>(p - start));
+    }
+
+    // Совпадает ли текущая лексема с образцом.
+    bool is(std::string_view text) const
+    {
+        return token == text;
+    }
+
+    // Является ли текущая лексема идентификатором.
+    bool isIdentifier() const
+    {
+        if (token.empty()) return false;
+        if (escaped) return true;
+        return isIdentChar(token.front()) && !(token.front() >= '0' && token.front() <= '9');
+    }
+};
+
+// Рекурсивный разбор выражений assign.
+template <typename Table>
+struct VerilogExpressionParser
+{
+    VerilogLexer& lex;                   ///< Лексический анализатор
+    Table* table;                        ///< Таблица сигналов
+    int constNets[2];                    ///< Сигналы констант 0 и 1
+    QString error;                       ///< Описание ошибки
+
+    // Сигнал константы.
+    int constant(bool value)
+    {
+        int& id = constNets[value ? 1 : 0];
+        if (id < 0) {
+            id = table->create();
+            table->nets[id].def = value ? NetlistNet::Def::CONST1 : NetlistNet::Def::CONST0;
+        }
+        return id;
+    }
+
+    // Первичное выражение: идентификатор, константа, скобки, отрицание.
+    int parseUnary()
+    {
+        if (lex.is("~") || lex.is("!")) {
+            lex.next();
+            int operand = parseUnary();
+            if (operand < 0) return -1;
+            return table->createGate(LogicGraph::GateKind::NOT, {operand});
+        }
+        if (lex.is("(")) {
+            lex.next();
+            int inner = parseOr();
+            if (inner < 0) return -1;
+            if (!lex.is(")")) {
+                error = "Ожидалась ')'";
+                return -1;
+            }
+            lex.next();
+            return inner;
+        }
+        if (lex.token.empty()) {
+            error = "Неожиданный конец выражения";
+            return -1;
+        }
+
+        const std::string_view token = lex.token;
+        if (token.front() >= '0' && token.front() <= '9') {
+            const int value = verilogConstant(token);
+            if (value < 0) {
+                error = QString("Поддерживаются только однобитовые константы 0, 1, 1'b0 и 1'b1: %1")
+                            .arg(QString::fromUtf8(token.data(), static_cast<int>(token.size())));
+                return -1;
+            }
+            lex.next();
+            return constant(value == 1);
+        }
+        if (!lex.isIdentifier()) {
+            error = QString("Неожиданная лексема %1")
+                        .arg(QString::fromUtf8(token.data(), static_cast<int>(token.size())));
+            return -1;
+        }
+        lex.next();
+        if (lex.is("[")) {
+            error = "Векторные сигналы не поддерживаются";
+            return -1;
+        }
+        return table->lookup(token);
+    }
+
+    // Цепочка одинаковых бинарных операторов уровня приоритета.
+    template <typename Next>
+    int parseChain(std::string_view op, std::string_view invertedOp,
+                   LogicGraph::GateKind kind, Next next)
+    {
+        int first = next();
+        if (first < 0) return -1;
+
+        std::vector<int> operands{first};
+        while (lex.is(op) || (!invertedOp.empty() && lex.is(invertedOp))) {
+            const bool inverted = lex.is(invertedOp);
+            lex.next();
+            int operand = next();
+            if (operand < 0) return -1;
+            if (inverted) {
+                int pair = table->createGate(kind, {operands.size() == 1
+                                                        ? operands.front()
+                                                        : table->createGate(kind, operands),
+                                                    operand}, true);
+                operands = {pair};
+            } else {
+                operands.push_back(operand);
+            }
+        }
+        return operands.size() == 1 ? operands.front() : table->createGate(kind, std::move(operands));
+    }
+
+    // Уровень '&'.
+    int parseAnd()
+    {
+        return parseChain("&", std::string_view(), LogicGraph::GateKind::AND, [this] { return parseUnary(); });
+    }
+
+    // Уровень '^' и '~^'.
+    int parseXor()
+    {
+        return parseChain("^", "~^", LogicGraph::GateKind::XOR, [this] { return parseAnd(); });
+    }
+
+    // Уровень '|'.
+    int parseOr()
+    {
+        return parseChain("|", std::string_view(), LogicGraph::GateKind::OR, [this] { return parseXor(); });
+    }
+};
+
+// Разобрать структурный Verilog.
+bool NetlistReader::parseVerilog(const char* data, const char* end, SignalTable& table)
+{
+    VerilogLexer lex{data, end, 1, std::string_view(), false};
+    lex.next();
+
+    VerilogExpressionParser<SignalTable> expr{lex, &table, {-1, -1}, QString()};
+    std::vector<std::string_view> outputNames;
+
+    auto name = [](std::string_view token) {
+        return QString::fromUtf8(token.data(), static_cast<int>(token.size()));
+    };
+
+    auto define = [&](int id, int source) -> bool {
+        NetlistNet& net = table.nets[id];
+        if (net.def != NetlistNet::Def::NONE)
+            return fail(QString("Сигнал %1 определён повторно").arg(net.name), lex.line);
+        net.def = NetlistNet::Def::GATE;
+        net.kind = LogicGraph::GateKind::AND;
+        net.fanins = {source};
+        return true;
+    };
+
+    // Объявление списка сигналов направления direction до ';' или ')'.
+    auto declare = [&](std::string_view direction) -> bool {
+        for (;;) {
+            if (lex.is("wire") || lex.is("reg"))
+                lex.next();
+            if (lex.is("["))
+                return fail("Векторные сигналы не поддерживаются", lex.line);
+            if (!lex.isIdentifier())
+                return fail(QString("Ожидалось имя сигнала после %1").arg(name(direction)), lex.line);
+
+            if (direction == "input") {
+                int id = table.lookup(lex.token);
+                if (table.nets[id].def != NetlistNet::Def::NONE && table.nets[id].def != NetlistNet::Def::INPUT)
+                    return fail(QString("Вход %1 уже определён").arg(table.nets[id].name), lex.line);
+                table.declareInput(id);
+            } else if (direction == "output") {
+                outputNames.push_back(lex.token);
+            } else {
+                table.lookup(lex.token);
+            }
+
+            lex.next();
+            if (!lex.is(","))
+                return true;
+            lex.next();
+            if (lex.is("input") || lex.is("output") || lex.is("wire"))
+                return true;
+        }
+    };
+
+    if (!lex.is("module"))
+        return fail("Ожидалось ключевое слово module", lex.line);
+    lex.next();
+    if (!lex.isIdentifier())
+        return fail("Ожидалось имя модуля", lex.line);
+    lex.next();
+
+    if (lex.is("(")) {
+        lex.next();
+        while (!lex.is(")")) {
+            if (lex.token.empty())
+                return fail("Незакрытый список портов", lex.line);
+            if (lex.is("input") || lex.is("output") || lex.is("wire")) {
+                const std::string_view direction = lex.token;
+                lex.next();
+                if (!declare(direction)) return false;
+            } else {
+                lex.next();
+            }
+        }
+        lex.next();
+    }
+    if (!lex.is(";"))
+        return fail("Ожидалась ';' после заголовка модуля", lex.line);
+    lex.next();
+
+    static const std::unordered_map<std::string_view, std::pair<LogicGraph::GateKind, bool>> primitives = {
+        {"and",  {LogicGraph::GateKind::AND, false}},
+        {"or",   {LogicGraph::GateKind::OR,  false}},
+        {"xor",  {LogicGraph::GateKind::XOR, false}},
+        {"nand", {LogicGraph::GateKind::AND, true}},
+        {"nor",  {LogicGraph::GateKind::OR,  true}},
+        {"xnor", {LogicGraph::GateKind::XOR, true}},
+        {"not",  {LogicGraph::GateKind::NOT, false}},
+        {"buf",  {LogicGraph::GateKind::AND, false}},
+    };
+
+    while (!lex.is("endmodule")) {
+        if (lex.token.empty())
+            return fail("Ожидалось endmodule", lex.line);
+
+        if (lex.is("input") || lex.is("output") || lex.is("wire")) {
+            const std::string_view direction = lex.token;
+            lex.next();
+            if (!declare(direction)) return false;
+            if (!lex.is(";"))
+                return fail("Ожидалась ';'", lex.line);
+            lex.next();
+            continue;
+        }
+
+        if (lex.is("assign")) {
+            lex.next();
+            for (;;) {
+                if (!lex.isIdentifier())
+                    return fail("Ожидалось имя сигнала в assign", lex.line);
+                const int target = table.lookup(lex.token);
+                lex.next();
+                if (!lex.is("="))
+                    return fail("Ожидался '=' в assign", lex.line);
+                lex.next();
+                const int source = expr.parseOr();
+                if (source < 0)
+                    return fail(expr.error, lex.line);
+                if (!define(target, source)) return false;
+                if (!lex.is(",")) break;
+                lex.next();
+            }
+            if (!lex.is(";"))
+                return fail("Ожидалась ';' после assign", lex.line);
+            lex.next();
+            continue;
+        }
+
+        auto primitive = primitives.find(lex.token);
+        if (primitive == primitives.end())
+            return fail(QString("Неподдерживаемая конструкция %1").arg(name(lex.token)), lex.line);
+
+        const LogicGraph::GateKind kind = primitive->second.first;
+        const bool inverted = primitive->second.second;
+        const bool isBuffer = (kind == LogicGraph::GateKind::NOT || lex.is("buf"));
+        lex.next();
+        if (lex.is("#"))
+            return fail("Задержки примитивов не поддерживаются", lex.line);
+
+        for (;;) {
+            if (lex.isIdentifier())
+                lex.next();
+            if (!lex.is("("))
+                return fail("Ожидалась '(' в экземпляре примитива", lex.line);
+            lex.next();
+
+            std::vector<int> terminals;
+            for (;;) {
+                const int id = expr.parseUnary();
+                if (id < 0)
+                    return fail(expr.error, lex.line);
+                terminals.push_back(id);
+                if (!lex.is(",")) break;
+                lex.next();
+            }
+            if (!lex.is(")"))
+                return fail("Ожидалась ')' в экземпляре примитива", lex.line);
+            lex.next();
+            if (terminals.size() < 2)
+                return fail("У примитива должны быть выход и хотя бы один вход", lex.line);
+
+            if (isBuffer) {
+                const int in = terminals.back();
+                for (size_t i = 0; i + 1 < terminals.size(); ++i) {
+                    const int source = (kind == LogicGraph::GateKind::NOT)
+                                           ? table.createGate(LogicGraph::GateKind::NOT, {in})
+                                           : in;
+                    if (!define(terminals[i], source)) return false;
+                }
+            } else {
+                std::vector<int> ins(terminals.begin() + 1, terminals.end());
+                if (!define(terminals.front(), table.createGate(kind, std::move(ins), inverted)))
+                    return false;
+            }
+
+            if (!lex.is(",")) break;
+            lex.next();
+        }
+        if (!lex.is(";"))
+            return fail("Ожидалась ';' после экземпляра примитива", lex.line);
+        lex.next();
+    }
+
+    for (std::string_view output : outputNames) {
+        int id = table.lookup(output);
+        table.outputs.emplace_back(table.nets[id].name, id);
+    }
+    return true;
+}
+
+// Собрать LogicGraph по таблице сигналов.
+bool NetlistReader::buildGraph(SignalTable& table, LogicGraph& graph)
+{
+    if (table.outputs.empty())
+        return fail("В нетлисте нет выходов");
+
+    for (int id : table.inputs)
+        table.nets[id].graphId = graph.addInput(table.nets[id].name);
+
+    // 0 — не посещён, 1 — в обработке, 2 — собран.
+    std::vector<quint8> state(table.nets.size(), 0);
+    std::vector<int> stack;
+
+    auto netName = [&](int id) {
+        return table.nets[id].name.isEmpty() ? QString("#%1").arg(id) : table.nets[id].name;
+    };
+
+    for (const auto& output : table.outputs) {
+        stack.push_back(output.second);
+
+        while (!stack.empty()) {
+            const int id = stack.back();
+            NetlistNet& net = table.nets[id];
+
+            if (state[id] == 2) {
+                stack.pop_back();
+                continue;
+            }
+
+            if (state[id] == 0) {
+                if (net.def == NetlistNet::Def::NONE)
+                    return fail(QString("Сигнал %1 не определён").arg(netName(id)));
+                state[id] = 1;
+                for (int fanin : net.fanins) {
+                    if (state[fanin] == 1)
+                        return fail(QString("Комбинационный цикл через сигнал %1").arg(netName(fanin)));
+                    if (state[fanin] == 0)
+                        stack.push_back(fanin);
+                }
+                continue;
+            }
+
+            std::vector<int> fanins;
+            fanins.reserve(net.fanins.size());
+            for (int fanin : net.fanins)
+                fanins.push_back(table.nets[fanin].graphId);
+
+            int result = -1;
+            switch (net.def) {
+            case NetlistNet::Def::NONE:
+            case NetlistNet::Def::INPUT:
+                result = net.graphId;
+                break;
+            case NetlistNet::Def::CONST0:
+                result = graph.addConstant(false);
+                break;
+            case NetlistNet::Def::CONST1:
+                result = graph.addConstant(true);
+                break;
+            case NetlistNet::Def::GATE:
+                if (fanins.empty())
+                    return fail(QString("У вентиля %1 нет входов").arg(netName(id)));
+                result = (net.kind == LogicGraph::GateKind::NOT)
+                             ? graph.addGate(LogicGraph::GateKind::NOT, {fanins.front()})
+                             : graph.addGate(net.kind, std::move(fanins));
+                if (net.inverted)
+                    result = graph.addGate(LogicGraph::GateKind::NOT, {result});
+                break;
+            case NetlistNet::Def::COVER: {
+                std::vector<int> terms;
+                terms.reserve(net.cubes.size());
+                for (std::string_view cube : net.cubes) {
+                    std::vector<int> literals;
+                    for (size_t i = 0; i < cube.size(); ++i) {
+                        if (cube[i] == '1')
+                            literals.push_back(fanins[i]);
+                        else if (cube[i] == '0')
+                            literals.push_back(graph.addGate(LogicGraph::GateKind::NOT, {fanins[i]}));
+                    }
+                    terms.push_back(literals.empty()
+                                        ? graph.addConstant(true)
+                                        : graph.addGate(LogicGraph::GateKind::AND, std::move(literals)));
+                }
+                result = terms.empty() ? graph.addConstant(false)
+                                       : graph.addGate(LogicGraph::GateKind::OR, std::move(terms));
+                if (net.inverted)
+                    result = graph.addGate(LogicGraph::GateKind::NOT, {result});
+                break;
+            }
+            }
+
+            net.graphId = result;
+            state[id] = 2;
+            stack.pop_back();
+        }
+    }
+
+    for (const auto& output : table.outputs)
+        graph.addOutput(output.first, table.nets[output.second].graphId);
+    return true;
+}
+
+// Установить текст ошибки.
+bool NetlistReader::fail(const QString& message, int line)
+{
+    error = (line > 0) ? QString("Строка %1: %2").arg(line).arg(message) : message;
+    return false;
+}
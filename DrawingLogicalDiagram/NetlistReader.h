@@ -0,0 +1,137 @@
+#ifndef NETLISTREADER_H
+#define NETLISTREADER_H
+
+#include <QString>
+#include "LogicGraph.h"
+#include "NetlistFormat.h"
+
+/**
+ * @class NetlistReader
+ * @brief Потоковое чтение нетлистов BLIF, AIGER и структурного Verilog
+ *
+ * Класс читает файл нетлиста за один проход по отображённой в память
+ * области (или по буферу) и строит LogicGraph напрямую, без
+ * промежуточного инфиксного выражения для SchemaTree.
+ *
+ * @details Поддерживаемые форматы:
+ * - BLIF: .model, .inputs, .outputs, .names (SOP-покрытия), .end;
+ *   защёлки и подсхемы (.latch, .subckt) не поддерживаются.
+ * - AIGER: ASCII (aag) и двоичный (aig) без защёлок,
+ *   таблица символов используется для имён входов и выходов.
+ * - Структурный Verilog: один module со скалярными input/output/wire,
+ *   примитивы and/or/xor/nand/nor/xnor/not/buf и assign
+ *   с операторами ~, !, &, ^, |, скобками и константами 1'b0/1'b1.
+ *
+ * Определения сигналов могут идти в любом порядке; после прохода
+ * по файлу сеть собирается за линейное время с проверкой
+ * комбинационных циклов.
+ */
+class NetlistReader {
+public:
+    /**
+     * @struct Statistics
+     * @brief Статистика последнего чтения
+     */
+    struct Statistics
+    {
+        qint64 bytes = 0;      ///< Размер входных данных в байтах
+        qint64 elapsedMs = 0;  ///< Время чтения и сборки сети, мс
+        int gates = 0;         ///< Число вентилей в сети
+        int inputs = 0;        ///< Число первичных входов
+        int outputs = 0;       ///< Число выходов
+    };
+
+    /**
+     * @brief Прочитать нетлист из файла
+     * @param path Путь к файлу
+     * @param graph Сеть для заполнения
+     * @param format Формат файла (AUTO — определить автоматически)
+     * @return true при успехе; иначе см. errorString()
+     *
+     * Файл отображается в память; если это невозможно,
+     * читается целиком в буфер.
+     */
+    bool read(const QString& path, LogicGraph& graph, NetlistFormat format = NetlistFormat::AUTO);
+
+    /**
+     * @brief Прочитать нетлист из буфера
+     * @param data Начало данных
+     * @param size Размер данных в байтах
+     * @param format Формат данных (AUTO — определить по содержимому)
+     * @param graph Сеть для заполнения
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool readData(const char* data, qint64 size, NetlistFormat format, LogicGraph& graph);
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Статистика последнего чтения
+     * @return Объём, время и размеры сети
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief Определить формат нетлиста
+     * @param path Путь к файлу (может быть пустым)
+     * @param data Начало данных
+     * @param size Размер данных
+     * @return Определённый формат; BLIF, если признаков нет
+     */
+    static NetlistFormat detectFormat(const QString& path, const char* data, qint64 size);
+
+private:
+    struct SignalTable;
+
+    /**
+     * @brief Разобрать BLIF
+     * @param data Начало данных
+     * @param end Конец данных
+     * @param table Таблица сигналов
+     * @return true при успехе
+     */
+    bool parseBlif(const char* data, const char* end, SignalTable& table);
+
+    /**
+     * @brief Разобрать AIGER (aag/aig)
+     * @param data Начало данных
+     * @param end Конец данных
+     * @param table Таблица сигналов
+     * @return true при успехе
+     */
+    bool parseAiger(const char* data, const char* end, SignalTable& table);
+
+    /**
+     * @brief Разобрать структурный Verilog
+     * @param data Начало данных
+     * @param end Конец данных
+     * @param table Таблица сигналов
+     * @return true при успехе
+     */
+    bool parseVerilog(const char* data, const char* end, SignalTable& table);
+
+    /**
+     * @brief Собрать LogicGraph по таблице сигналов
+     * @param table Таблица сигналов
+     * @param graph Сеть для заполнения
+     * @return true при успехе
+     */
+    bool buildGraph(SignalTable& table, LogicGraph& graph);
+
+    /**
+     * @brief Установить текст ошибки
+     * @param message Описание ошибки
+     * @param line Номер строки (0 — без номера)
+     * @return Всегда false, для удобного возврата
+     */
+    bool fail(const QString& message, int line = 0);
+
+    QString error;     ///< Текст последней ошибки
+    Statistics stats;  ///< Статистика последнего чтения
+};
+
+#endif // NETLISTREADER_H
@@ -0,0 +1,744 @@
+#include "NetlistWriter.h"
+#include "NetlistReader.h"
+#include <QBuffer>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+#include <random>
+
+// Константы.
+static constexpr int OUTPUT_CHUNK_SIZE = 64 * 1024;
+static constexpr int NAMES_PER_LINE = 16;
+static constexpr quint64 ROUND_TRIP_SEED = 0x5eed;
+
+// Буферизованный вывод блоками фиксированного размера.
+class NetlistWriter::Output {
+public:
+    explicit Output(QIODevice* device) : device(device)
+    {
+        buffer.reserve(OUTPUT_CHUNK_SIZE + 1024);
+    }
+
+    Output& operator<<(const QByteArray& data)
+    {
+        buffer.append(data);
+        if (buffer.size() >= OUTPUT_CHUNK_SIZE)
+            flush();
+        return *this;
+    }
+
+    Output& operator<<(const char* data)
+    {
+        return *this << QByteArray(data);
+    }
+
+    Output& operator<<(char c)
+    {
+        buffer.append(c);
+        if (buffer.size() >= OUTPUT_CHUNK_SIZE)
+            flush();
+        return *this;
+    }
+
+    // Записать десятичное число.
+    Output& number(quint64 value)
+    {
+        return *this << QByteArray::number(value);
+    }
+
+    // Сбросить буфер в устройство.
+    bool flush()
+    {
+        if (!buffer.isEmpty() && device->write(buffer) != buffer.size())
+            ok = false;
+        buffer.clear();
+        return ok;
+    }
+
+    bool ok = true;  ///< Не было ли ошибок записи
+
+private:
+    QIODevice* device;  ///< Устройство вывода
+    QByteArray buffer;  ///< Текущий блок
+};
+
+// Имя сети вентиля.
+static QByteArray netName(const LogicGraph& graph, int id, const QByteArray& prefix)
+{
+    if (graph.gate(id).kind == LogicGraph::GateKind::INPUT)
+        return graph.inputName(id).toUtf8();
+    return prefix + QByteArray::number(id);
+}
+
+// Имена входов сети.
+static QStringList inputNameList(const LogicGraph& graph)
+{
+    QStringList names;
+    for (int id : graph.inputs())
+        names << graph.inputName(id);
+    return names;
+}
+
+// Имена выходов сети.
+static QStringList outputNameList(const LogicGraph& graph)
+{
+    QStringList names;
+    for (const LogicGraph::Output& output : graph.outputs())
+        names << output.name;
+    return names;
+}
+
+// Имена выходов отображённой схемы.
+static QStringList outputNameList(const TechMapper::Netlist& netlist)
+{
+    QStringList names;
+    for (const TechMapper::Netlist::Output& output : netlist.outputs)
+        names << output.name;
+    return names;
+}
+
+// Таблица истинности как число Verilog ширины 2^inputs.
+static QByteArray verilogTruth(quint64 function, int inputs)
+{
+    const int bits = 1 << inputs;
+    const quint64 mask = bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+    return QByteArray::number(bits) + "'h" + QByteArray::number(function & mask, 16).toUpper();
+}
+
+// Идентификатор Verilog (с экранированием при необходимости).
+static QByteArray verilogIdentifier(const QByteArray& name)
+{
+    static const QSet<QByteArray> keywords = {
+        "module", "endmodule", "input", "output", "inout", "wire", "reg", "assign",
+        "and", "or", "xor", "nand", "nor", "xnor", "not", "buf", "begin", "end",
+        "always", "initial", "if", "else", "case", "endcase", "for", "while", "function",
+    };
+
+    bool simple = !name.isEmpty() && !(name[0] >= '0' && name[0] <= '9') && name[0] != '$';
+    for (char c : name) {
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+              || c == '_' || c == '$')) {
+            simple = false;
+            break;
+        }
+    }
+
+    if (simple && !keywords.contains(name))
+        return name;
+    return "\\" + name + " ";
+}
+
+// Записать сеть в файл.
+bool NetlistWriter::write(const QString& path, const LogicGraph& graph, NetlistFormat format)
+{
+    if (format == NetlistFormat::AUTO)
+        format = formatForPath(path);
+    return writeFile(path, [&](QIODevice* device) { return write(device, graph, format); });
+}
+
+// Записать сеть в устройство.
+bool NetlistWriter::write(QIODevice* device, const LogicGraph& graph, NetlistFormat format)
+{
+    error.clear();
+
+    if (graph.outputs().empty()) {
+        error = "В схеме нет выходов";
+        return false;
+    }
+
+    Output out(device);
+
+    switch (format) {
+    case NetlistFormat::VERILOG:
+        writeVerilog(out, graph);
+        break;
+    case NetlistFormat::AIGER_ASCII:
+        writeAiger(out, graph, false);
+        break;
+    case NetlistFormat::AIGER_BINARY:
+        writeAiger(out, graph, true);
+        break;
+    case NetlistFormat::BLIF:
+    case NetlistFormat::AUTO:
+        writeBlif(out, graph);
+        break;
+    }
+
+    if (!out.flush()) {
+        error = QString("Ошибка записи: %1").arg(device->errorString());
+        return false;
+    }
+    return true;
+}
+
+// Записать отображённую схему в файл.
+bool NetlistWriter::write(const QString& path, const TechMapper::Netlist& netlist, NetlistFormat format)
+{
+    if (format == NetlistFormat::AUTO)
+        format = formatForPath(path);
+    return writeFile(path, [&](QIODevice* device) { return write(device, netlist, format); });
+}
+
+// Записать отображённую схему в устройство.
+bool NetlistWriter::write(QIODevice* device, const TechMapper::Netlist& netlist, NetlistFormat format)
+{
+    error.clear();
+
+    if (netlist.outputs.empty()) {
+        error = "В схеме нет выходов";
+        return false;
+    }
+    if (format == NetlistFormat::AIGER_ASCII || format == NetlistFormat::AIGER_BINARY) {
+        error = "Отображённая схема записывается только в BLIF или Verilog";
+        return false;
+    }
+
+    Output out(device);
+    if (format == NetlistFormat::VERILOG)
+        writeMappedVerilog(out, netlist);
+    else
+        writeMappedBlif(out, netlist);
+
+    if (!out.flush()) {
+        error = QString("Ошибка записи: %1").arg(device->errorString());
+        return false;
+    }
+    return true;
+}
+
+// Установить имя модуля.
+void NetlistWriter::setModuleName(const QString& name)
+{
+    moduleName = name;
+}
+
+// Описание последней ошибки.
+QString NetlistWriter::errorString() const
+{
+    return error;
+}
+
+// Определить формат по расширению файла.
+NetlistFormat NetlistWriter::formatForPath(const QString& path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "blif") return NetlistFormat::BLIF;
+    if (suffix == "aag") return NetlistFormat::AIGER_ASCII;
+    if (suffix == "aig") return NetlistFormat::AIGER_BINARY;
+    if (suffix == "v" || suffix == "sv") return NetlistFormat::VERILOG;
+    return NetlistFormat::AUTO;
+}
+
+// Проверить запись чтением.
+bool NetlistWriter::verifyRoundTrip(const LogicGraph& graph, NetlistFormat format, int rounds)
+{
+    if (format == NetlistFormat::AUTO)
+        format = NetlistFormat::BLIF;
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!write(&buffer, graph, format))
+        return false;
+
+    NetlistReader reader;
+    LogicGraph copy;
+    if (!reader.readData(data.constData(), data.size(), format, copy)) {
+        error = QString("Записанный нетлист не читается: %1").arg(reader.errorString());
+        return false;
+    }
+    if (copy.inputs().size() != graph.inputs().size() || copy.outputs().size() != graph.outputs().size()) {
+        error = QString("Прочитано %1 входов и %2 выходов вместо %3 и %4")
+                    .arg(static_cast<int>(copy.inputs().size()))
+                    .arg(static_cast<int>(copy.outputs().size()))
+                    .arg(static_cast<int>(graph.inputs().size()))
+                    .arg(static_cast<int>(graph.outputs().size()));
+        return false;
+    }
+
+    // Порядок входов в файле может отличаться, поэтому слово
+    // каждого входа копии берётся по имени.
+    QHash<QString, int> position;
+    for (int i = 0; i < static_cast<int>(graph.inputs().size()); ++i)
+        position.insert(graph.inputName(graph.inputs()[i]), i);
+    std::vector<int> source;
+    for (int id : copy.inputs()) {
+        const int i = position.value(copy.inputName(id), -1);
+        if (i < 0) {
+            error = QString("Прочитан лишний вход %1").arg(copy.inputName(id));
+            return false;
+        }
+        source.push_back(i);
+    }
+
+    std::mt19937_64 random(ROUND_TRIP_SEED);
+    std::vector<quint64> words(graph.inputs().size());
+    std::vector<quint64> copyWords(words.size());
+    for (int round = 0; round < rounds; ++round) {
+        for (quint64& word : words)
+            word = random();
+        for (size_t i = 0; i < source.size(); ++i)
+            copyWords[i] = words[source[i]];
+
+        const std::vector<quint64> expected = graph.evaluate(words);
+        const std::vector<quint64> actual = copy.evaluate(copyWords);
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (expected[i] != actual[i]) {
+                error = QString("Выход %1 прочитанного нетлиста отличается от исходного")
+                            .arg(graph.outputs()[i].name);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Записать файл целиком или не изменять его.
+bool NetlistWriter::writeFile(const QString& path, const std::function<bool(QIODevice*)>& writeDevice)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = QString("Не удалось открыть файл %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    if (!writeDevice(&file))
+        return false;
+
+    if (!file.commit()) {
+        error = QString("Не удалось записать файл %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+// Подобрать префикс внутренних сетей.
+QByteArray NetlistWriter::netPrefix(const QStringList& inputs, const std::vector<QByteArray>& outputs)
+{
+    // Выходы проверяются под именами, с которыми они записываются:
+    // выход n1 или переименованный выход n_o1 совпал бы с сетью вентиля.
+    std::vector<QByteArray> names(outputs);
+    for (const QString& input : inputs)
+        names.push_back(input.toUtf8());
+
+    QByteArray prefix = "n";
+    bool clash = true;
+    while (clash) {
+        clash = false;
+        for (const QByteArray& name : names) {
+            if (name.startsWith(prefix)) {
+                clash = true;
+                prefix += '_';
+                break;
+            }
+        }
+    }
+    return prefix;
+}
+
+// Имена выходов без совпадений с именами входов и друг с другом.
+std::vector<QByteArray> NetlistWriter::outputNames(const QStringList& inputs, const QStringList& outputs)
+{
+    QSet<QByteArray> used;
+    for (const QString& input : inputs)
+        used.insert(input.toUtf8());
+
+    std::vector<QByteArray> names;
+    names.reserve(outputs.size());
+    for (const QString& output : outputs) {
+        QByteArray name = output.toUtf8();
+        if (name.isEmpty())
+            name = "Y";
+        QByteArray unique = name;
+        for (int suffix = 1; used.contains(unique); ++suffix)
+            unique = name + "_o" + QByteArray::number(suffix);
+        used.insert(unique);
+        names.push_back(unique);
+    }
+    return names;
+}
+
+// Записать BLIF.
+void NetlistWriter::writeBlif(Output& out, const LogicGraph& graph)
+{
+    const QStringList inputs = inputNameList(graph);
+    const QStringList outputList = outputNameList(graph);
+    const std::vector<QByteArray> outputs = outputNames(inputs, outputList);
+    const QByteArray prefix = netPrefix(inputs, outputs);
+
+    writeBlifHeader(out, inputs, outputs);
+
+    for (int id = 0; id < graph.size(); ++id) {
+        const LogicGraph::Gate& g = graph.gate(id);
+        const QByteArray name = netName(graph, id, prefix);
+
+        switch (g.kind) {
+        case LogicGraph::GateKind::INPUT:
+            break;
+        case LogicGraph::GateKind::CONST0:
+            out << ".names " << name << '\n';
+            break;
+        case LogicGraph::GateKind::CONST1:
+            out << ".names " << name << "\n1\n";
+            break;
+        case LogicGraph::GateKind::NOT:
+            out << ".names " << netName(graph, g.fanins.front(), prefix) << ' ' << name << "\n0 1\n";
+            break;
+        case LogicGraph::GateKind::AND:
+        case LogicGraph::GateKind::OR: {
+            out << ".names";
+            for (int fanin : g.fanins)
+                out << ' ' << netName(graph, fanin, prefix);
+            const bool isAnd = (g.kind == LogicGraph::GateKind::AND);
+            out << ' ' << name << '\n'
+                << QByteArray(static_cast<int>(g.fanins.size()), isAnd ? '1' : '0')
+                << (isAnd ? " 1\n" : " 0\n");
+            break;
+        }
+        case LogicGraph::GateKind::XOR: {
+            QByteArray acc = netName(graph, g.fanins.front(), prefix);
+            for (size_t i = 1; i < g.fanins.size(); ++i) {
+                const QByteArray target = (i + 1 == g.fanins.size())
+                                              ? name
+                                              : name + "_" + QByteArray::number(static_cast<quint64>(i));
+                out << ".names " << acc << ' ' << netName(graph, g.fanins[i], prefix) << ' ' << target
+                    << "\n10 1\n01 1\n";
+                acc = target;
+            }
+            break;
+        }
+        }
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i)
+        out << ".names " << netName(graph, graph.outputs()[i].gate, prefix) << ' ' << outputs[i] << "\n1 1\n";
+
+    out << ".end\n";
+}
+
+// Записать заголовок BLIF: модель, входы и выходы.
+void NetlistWriter::writeBlifHeader(Output& out, const QStringList& inputs, const std::vector<QByteArray>& outputs)
+{
+    out << ".model " << moduleName.toUtf8() << "\n.inputs";
+    for (int i = 0; i < static_cast<int>(inputs.size()); ++i) {
+        if (i > 0 && i % NAMES_PER_LINE == 0)
+            out << " \\\n";
+        out << ' ' << inputs[i].toUtf8();
+    }
+    out << "\n.outputs";
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        if (i > 0 && i % NAMES_PER_LINE == 0)
+            out << " \\\n";
+        out << ' ' << outputs[i];
+    }
+    out << '\n';
+}
+
+// Записать структурный Verilog.
+void NetlistWriter::writeVerilog(Output& out, const LogicGraph& graph)
+{
+    const QStringList inputs = inputNameList(graph);
+    const QStringList outputList = outputNameList(graph);
+    const std::vector<QByteArray> outputs = outputNames(inputs, outputList);
+    const QByteArray prefix = netPrefix(inputs, outputs);
+
+    out << "module " << verilogIdentifier(moduleName.toUtf8()) << " (";
+    bool first = true;
+    for (int id : graph.inputs()) {
+        out << (first ? "" : ", ") << verilogIdentifier(graph.inputName(id).toUtf8());
+        first = false;
+    }
+    for (const QByteArray& name : outputs) {
+        out << (first ? "" : ", ") << verilogIdentifier(name);
+        first = false;
+    }
+    out << ");\n";
+
+    for (int id : graph.inputs())
+        out << "  input " << verilogIdentifier(graph.inputName(id).toUtf8()) << ";\n";
+    for (const QByteArray& name : outputs)
+        out << "  output " << verilogIdentifier(name) << ";\n";
+
+    for (int id = 0; id < graph.size(); ++id) {
+        if (graph.gate(id).kind != LogicGraph::GateKind::INPUT)
+            out << "  wire " << prefix << QByteArray::number(id) << ";\n";
+    }
+
+    for (int id = 0; id < graph.size(); ++id) {
+        const LogicGraph::Gate& g = graph.gate(id);
+        const QByteArray name = prefix + QByteArray::number(id);
+
+        const char* primitive = nullptr;
+        switch (g.kind) {
+        case LogicGraph::GateKind::INPUT:
+            continue;
+        case LogicGraph::GateKind::CONST0:
+            out << "  assign " << name << " = 1'b0;\n";
+            continue;
+        case LogicGraph::GateKind::CONST1:
+            out << "  assign " << name << " = 1'b1;\n";
+            continue;
+        case LogicGraph::GateKind::NOT: primitive = "not"; break;
+        case LogicGraph::GateKind::AND: primitive = "and"; break;
+        case LogicGraph::GateKind::OR:  primitive = "or";  break;
+        case LogicGraph::GateKind::XOR: primitive = "xor"; break;
+        }
+
+        out << "  " << primitive << " (" << name;
+        for (int fanin : g.fanins)
+            out << ", " << verilogIdentifier(netName(graph, fanin, prefix));
+        out << ");\n";
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i)
+        out << "  assign " << verilogIdentifier(outputs[i]) << " = "
+            << verilogIdentifier(netName(graph, graph.outputs()[i].gate, prefix)) << ";\n";
+
+    out << "endmodule\n";
+}
+
+// Записать AIGER.
+void NetlistWriter::writeAiger(Output& out, const LogicGraph& graph, bool binary)
+{
+    const quint64 numInputs = graph.inputs().size();
+    std::vector<quint64> literal(graph.size(), 0);
+    quint64 nextVar = numInputs + 1;
+
+    for (quint64 i = 0; i < numInputs; ++i)
+        literal[graph.inputs()[i]] = 2 * (i + 1);
+
+    // Двухвходовый AND; при record == true строка вентиля записывается в вывод.
+    auto makeAnd = [&](quint64 a, quint64 b, bool record) -> quint64 {
+        const quint64 lhs = 2 * nextVar++;
+        if (record) {
+            const quint64 rhs0 = std::max(a, b);
+            const quint64 rhs1 = std::min(a, b);
+            if (binary) {
+                for (quint64 delta : {lhs - rhs0, rhs0 - rhs1}) {
+                    while (delta & ~quint64(0x7F)) {
+                        out << static_cast<char>((delta & 0x7F) | 0x80);
+                        delta >>= 7;
+                    }
+                    out << static_cast<char>(delta);
+                }
+            } else {
+                out.number(lhs) << ' ';
+                out.number(rhs0) << ' ';
+                out.number(rhs1) << '\n';
+            }
+        }
+        return lhs;
+    };
+
+    // Проход по вентилям: вычисление литералов и (при record) запись AND.
+    auto mapGates = [&](bool record) {
+        nextVar = numInputs + 1;
+        for (int id = 0; id < graph.size(); ++id) {
+            const LogicGraph::Gate& g = graph.gate(id);
+            switch (g.kind) {
+            case LogicGraph::GateKind::INPUT:
+                break;
+            case LogicGraph::GateKind::CONST0:
+                literal[id] = 0;
+                break;
+            case LogicGraph::GateKind::CONST1:
+                literal[id] = 1;
+                break;
+            case LogicGraph::GateKind::NOT:
+                literal[id] = literal[g.fanins.front()] ^ 1;
+                break;
+            case LogicGraph::GateKind::AND:
+            case LogicGraph::GateKind::OR: {
+                const quint64 invert = (g.kind == LogicGraph::GateKind::OR) ? 1 : 0;
+                quint64 acc = literal[g.fanins.front()] ^ invert;
+                for (size_t i = 1; i < g.fanins.size(); ++i)
+                    acc = makeAnd(acc, literal[g.fanins[i]] ^ invert, record);
+                literal[id] = acc ^ invert;
+                break;
+            }
+            case LogicGraph::GateKind::XOR: {
+                quint64 acc = literal[g.fanins.front()];
+                for (size_t i = 1; i < g.fanins.size(); ++i) {
+                    const quint64 b = literal[g.fanins[i]];
+                    const quint64 left = makeAnd(acc, b ^ 1, record);
+                    const quint64 right = makeAnd(acc ^ 1, b, record);
+                    acc = makeAnd(left ^ 1, right ^ 1, record) ^ 1;
+                }
+                literal[id] = acc;
+                break;
+            }
+            }
+        }
+    };
+
+    mapGates(false);
+    const quint64 maxVar = nextVar - 1;
+    const quint64 numAnds = maxVar - numInputs;
+    const std::vector<QByteArray> outputs = outputNames(inputNameList(graph), outputNameList(graph));
+
+    out << (binary ? "aig " : "aag ");
+    out.number(maxVar) << ' ';
+    out.number(numInputs) << " 0 ";
+    out.number(outputs.size()) << ' ';
+    out.number(numAnds) << '\n';
+
+    if (!binary) {
+        for (quint64 i = 0; i < numInputs; ++i)
+            out.number(2 * (i + 1)) << '\n';
+    }
+    for (const LogicGraph::Output& output : graph.outputs())
+        out.number(literal[output.gate]) << '\n';
+
+    mapGates(true);
+
+    for (quint64 i = 0; i < numInputs; ++i) {
+        out << 'i';
+        out.number(i) << ' ' << graph.inputName(graph.inputs()[i]).toUtf8() << '\n';
+    }
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        out << 'o';
+        out.number(i) << ' ' << outputs[i] << '\n';
+    }
+}
+
+// Записать отображённую схему в BLIF.
+void NetlistWriter::writeMappedBlif(Output& out, const TechMapper::Netlist& netlist)
+{
+    const QStringList outputList = outputNameList(netlist);
+    const std::vector<QByteArray> outputs = outputNames(netlist.inputs, outputList);
+    const QByteArray prefix = netPrefix(netlist.inputs, outputs);
+    const int inputCount = static_cast<int>(netlist.inputs.size());
+    auto signalName = [&](int signal) -> QByteArray {
+        if (signal == TechMapper::Netlist::CONST0)
+            return prefix + "c0";
+        if (signal == TechMapper::Netlist::CONST1)
+            return prefix + "c1";
+        if (signal < inputCount)
+            return netlist.inputs[signal].toUtf8();
+        return prefix + QByteArray::number(signal - inputCount);
+    };
+
+    writeBlifHeader(out, netlist.inputs, outputs);
+    out << ".names " << signalName(TechMapper::Netlist::CONST0) << '\n'
+        << ".names " << signalName(TechMapper::Netlist::CONST1) << "\n1\n";
+
+    // Ячейки — строки .gate с входами a, b, … и выходом Y,
+    // LUT — покрытие .names по единицам таблицы истинности.
+    for (size_t index = 0; index < netlist.instances.size(); ++index) {
+        const TechMapper::Instance& instance = netlist.instances[index];
+        const QByteArray name = signalName(inputCount + static_cast<int>(index));
+        const int size = static_cast<int>(instance.inputs.size());
+        if (instance.cell >= 0) {
+            out << ".gate " << netlist.cells[instance.cell].name.toUtf8();
+            for (int pin = 0; pin < size; ++pin)
+                out << ' ' << static_cast<char>('a' + pin) << '=' << signalName(instance.inputs[pin]);
+            out << " Y=" << name << '\n';
+            continue;
+        }
+
+        out << ".names";
+        for (int input : instance.inputs)
+            out << ' ' << signalName(input);
+        out << ' ' << name << '\n';
+        for (int m = 0; m < (1 << size); ++m) {
+            if (!((instance.function >> m) & 1))
+                continue;
+            for (int j = 0; j < size; ++j)
+                out << (((m >> j) & 1) ? '1' : '0');
+            out << " 1\n";
+        }
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i)
+        out << ".names " << signalName(netlist.outputs[i].signal) << ' ' << outputs[i] << "\n1 1\n";
+
+    out << ".end\n";
+}
+
+// Записать отображённую схему в Verilog.
+void NetlistWriter::writeMappedVerilog(Output& out, const TechMapper::Netlist& netlist)
+{
+    const QStringList outputList = outputNameList(netlist);
+    const std::vector<QByteArray> outputs = outputNames(netlist.inputs, outputList);
+    const QByteArray prefix = netPrefix(netlist.inputs, outputs);
+    const int inputCount = static_cast<int>(netlist.inputs.size());
+    auto signalName = [&](int signal) -> QByteArray {
+        if (signal == TechMapper::Netlist::CONST0)
+            return "1'b0";
+        if (signal == TechMapper::Netlist::CONST1)
+            return "1'b1";
+        if (signal < inputCount)
+            return verilogIdentifier(netlist.inputs[signal].toUtf8());
+        return prefix + QByteArray::number(signal - inputCount);
+    };
+
+    out << "module " << verilogIdentifier(moduleName.toUtf8()) << " (";
+    bool first = true;
+    for (const QString& input : netlist.inputs) {
+        out << (first ? "" : ", ") << verilogIdentifier(input.toUtf8());
+        first = false;
+    }
+    for (const QByteArray& name : outputs) {
+        out << (first ? "" : ", ") << verilogIdentifier(name);
+        first = false;
+    }
+    out << ");\n";
+
+    for (const QString& input : netlist.inputs)
+        out << "  input " << verilogIdentifier(input.toUtf8()) << ";\n";
+    for (const QByteArray& name : outputs)
+        out << "  output " << verilogIdentifier(name) << ";\n";
+    for (size_t index = 0; index < netlist.instances.size(); ++index)
+        out << "  wire " << signalName(inputCount + static_cast<int>(index)) << ";\n";
+
+    // LUT выбирает бит своей таблицы по входам, старший вход — слева.
+    std::vector<char> usedCells(netlist.cells.size(), 0);
+    for (size_t index = 0; index < netlist.instances.size(); ++index) {
+        const TechMapper::Instance& instance = netlist.instances[index];
+        const QByteArray name = signalName(inputCount + static_cast<int>(index));
+        const int size = static_cast<int>(instance.inputs.size());
+        if (instance.cell >= 0) {
+            usedCells[instance.cell] = 1;
+            out << "  " << verilogIdentifier(netlist.cells[instance.cell].name.toUtf8()) << ' '
+                << prefix << 'g' << QByteArray::number(static_cast<quint64>(index)) << " (";
+            for (int pin = 0; pin < size; ++pin)
+                out << '.' << static_cast<char>('a' + pin) << '(' << signalName(instance.inputs[pin]) << "), ";
+            out << ".Y(" << name << "));\n";
+            continue;
+        }
+
+        out << "  assign " << name << " = " << verilogTruth(instance.function, size) << " >> {";
+        for (int j = size - 1; j >= 0; --j)
+            out << signalName(instance.inputs[j]) << (j > 0 ? ", " : "");
+        out << "};\n";
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i)
+        out << "  assign " << verilogIdentifier(outputs[i]) << " = " << signalName(netlist.outputs[i].signal)
+            << ";\n";
+    out << "endmodule\n";
+
+    // Описания использованных ячеек делают файл самодостаточным.
+    for (size_t cell = 0; cell < netlist.cells.size(); ++cell) {
+        if (!usedCells[cell])
+            continue;
+        const CellLibrary::Cell& description = netlist.cells[cell];
+        QByteArray pins;
+        QByteArray select;
+        for (int pin = 0; pin < description.inputs; ++pin) {
+            if (pin > 0) {
+                pins += ", ";
+                select += ", ";
+            }
+            pins += static_cast<char>('a' + pin);
+            select += static_cast<char>('a' + description.inputs - 1 - pin);
+        }
+        out << "\nmodule " << verilogIdentifier(description.name.toUtf8()) << " (" << pins << ", Y);\n"
+            << "  input " << pins << ";\n"
+            << "  output Y;\n"
+            << "  assign Y = " << verilogTruth(description.function, description.inputs) << " >> {" << select
+            << "};\n"
+            << "endmodule\n";
+    }
+}
@@ -0,0 +1,180 @@
+#ifndef NETLISTWRITER_H
+#define NETLISTWRITER_H
+
+#include <QString>
+#include <QIODevice>
+#include <functional>
+#include "LogicGraph.h"
+#include "NetlistFormat.h"
+#include "TechMapper.h"
+
+/**
+ * @class NetlistWriter
+ * @brief Потоковая запись LogicGraph в форматы BLIF, Verilog и AIGER
+ *
+ * Класс выводит сеть в QIODevice блоками фиксированного размера,
+ * поэтому потребление памяти при записи не зависит от размера файла.
+ *
+ * @details Имена сетей стабильны между запусками:
+ * - входы сохраняют имена переменных;
+ * - внутренний вентиль с индексом i получает имя <префикс>i, где префикс
+ *   ("n", "n_", ...) выбирается так, чтобы не совпадать с именами входов
+ *   и выходов;
+ * - выходы сохраняют свои имена (при совпадении с именем входа
+ *   к имени выхода добавляется суффикс).
+ *
+ * Многовходовые XOR раскладываются в цепочку двухвходовых,
+ * OR в BLIF записывается одной строкой нулевого покрытия,
+ * для AIGER все вентили раскладываются в двухвходовые AND с инверсиями.
+ *
+ * Отображённая схема (TechMapper::Netlist) записывается в BLIF
+ * строками .gate для ячеек и .names для LUT, в Verilog — экземплярами
+ * ячеек с их описаниями после модуля схемы; AIGER не поддерживается.
+ */
+class NetlistWriter {
+public:
+    /**
+     * @brief Записать сеть в файл
+     * @param path Путь к файлу
+     * @param graph Сеть
+     * @param format Формат (AUTO — по расширению файла, по умолчанию BLIF)
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool write(const QString& path, const LogicGraph& graph, NetlistFormat format = NetlistFormat::AUTO);
+
+    /**
+     * @brief Записать сеть в устройство
+     * @param device Открытое на запись устройство
+     * @param graph Сеть
+     * @param format Формат (AUTO трактуется как BLIF)
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool write(QIODevice* device, const LogicGraph& graph, NetlistFormat format);
+
+    /**
+     * @brief Записать отображённую схему в файл
+     * @param path Путь к файлу
+     * @param netlist Схема из TechMapper
+     * @param format BLIF или VERILOG (AUTO — по расширению файла, по умолчанию BLIF)
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool write(const QString& path, const TechMapper::Netlist& netlist, NetlistFormat format = NetlistFormat::AUTO);
+
+    /**
+     * @brief Записать отображённую схему в устройство
+     * @param device Открытое на запись устройство
+     * @param netlist Схема из TechMapper
+     * @param format BLIF или VERILOG (AUTO трактуется как BLIF)
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool write(QIODevice* device, const TechMapper::Netlist& netlist, NetlistFormat format);
+
+    /**
+     * @brief Установить имя модуля (.model в BLIF, module в Verilog)
+     * @param name Имя модуля
+     */
+    void setModuleName(const QString& name);
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Определить формат по расширению файла
+     * @param path Путь к файлу
+     * @return Формат; AUTO, если расширение не распознано
+     */
+    static NetlistFormat formatForPath(const QString& path);
+
+    /**
+     * @brief Проверить запись чтением: записать сеть, прочитать её NetlistReader и сравнить
+     * @param graph Сеть
+     * @param format Формат записи (AUTO трактуется как BLIF)
+     * @param rounds Проходов по 64 случайных набора
+     * @return true, если прочитанная сеть на всех наборах даёт те же выходы; иначе см. errorString()
+     *
+     * Нетлист пишется в память. Входы сопоставляются по именам,
+     * выходы — по порядку: при записи имя выхода может получить суффикс.
+     */
+    bool verifyRoundTrip(const LogicGraph& graph, NetlistFormat format, int rounds = DEFAULT_ROUND_TRIP_ROUNDS);
+
+    static constexpr int DEFAULT_ROUND_TRIP_ROUNDS = 16;  ///< Проходов проверки записи по умолчанию
+
+private:
+    class Output;
+
+    /**
+     * @brief Записать файл целиком или не изменять его
+     * @param path Путь к файлу
+     * @param writeDevice Запись содержимого в открытое устройство
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool writeFile(const QString& path, const std::function<bool(QIODevice*)>& writeDevice);
+
+    /**
+     * @brief Записать BLIF
+     * @param out Буферизованный вывод
+     * @param graph Сеть
+     */
+    void writeBlif(Output& out, const LogicGraph& graph);
+
+    /**
+     * @brief Записать заголовок BLIF: модель, входы и выходы
+     * @param out Буферизованный вывод
+     * @param inputs Имена входов
+     * @param outputs Имена выходов
+     */
+    void writeBlifHeader(Output& out, const QStringList& inputs, const std::vector<QByteArray>& outputs);
+
+    /**
+     * @brief Записать структурный Verilog
+     * @param out Буферизованный вывод
+     * @param graph Сеть
+     */
+    void writeVerilog(Output& out, const LogicGraph& graph);
+
+    /**
+     * @brief Записать AIGER
+     * @param out Буферизованный вывод
+     * @param graph Сеть
+     * @param binary true — двоичный вариант (aig), false — текстовый (aag)
+     */
+    void writeAiger(Output& out, const LogicGraph& graph, bool binary);
+
+    /**
+     * @brief Записать отображённую схему в BLIF
+     * @param out Буферизованный вывод
+     * @param netlist Схема
+     */
+    void writeMappedBlif(Output& out, const TechMapper::Netlist& netlist);
+
+    /**
+     * @brief Записать отображённую схему в Verilog
+     * @param out Буферизованный вывод
+     * @param netlist Схема
+     */
+    void writeMappedVerilog(Output& out, const TechMapper::Netlist& netlist);
+
+    /**
+     * @brief Подобрать префикс внутренних сетей
+     * @param inputs Имена входов
+     * @param outputs Имена выходов, как они записываются (см. outputNames())
+     * @return Префикс, с которого не начинается ни одно из имён
+     */
+    static QByteArray netPrefix(const QStringList& inputs, const std::vector<QByteArray>& outputs);
+
+    /**
+     * @brief Имена выходов без совпадений с именами входов и друг с другом
+     * @param inputs Имена входов
+     * @param outputs Имена выходов
+     * @return Имена в порядке выходов
+     */
+    static std::vector<QByteArray> outputNames(const QStringList& inputs, const QStringList& outputs);
+
+    QString moduleName = "schema";  ///< Имя модуля
+    QString error;                  ///< Текст последней ошибки
+};
+
+#endif // NETLISTWRITER_H
@@ -0,0 +1,447 @@
+#include "ParallelParser.h"
+#include "WorkStealingPool.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <atomic>
+
+// Константы.
+static constexpr int MIN_PARALLEL_CHARS = 1 << 20;
+static constexpr int MIN_GRAIN_CHARS = 1 << 14;
+static constexpr int TASKS_PER_THREAD = 16;
+static constexpr int CHUNKS_PER_THREAD = 4;
+static constexpr int MIN_CHUNK_CHARS = 1 << 16;
+
+// Бинарный оператор.
+static inline bool isOperator(QChar c)
+{
+    return c == '&' || c == '|' || c == '^';
+}
+
+// Конструктор.
+ParallelParser::ParallelParser(int threads)
+    : threadCount(threads)
+{}
+
+// Разобрать выражение.
+std::unique_ptr<SchemaTree::Node> ParallelParser::parse(const QString& text)
+{
+    QElapsedTimer timer;
+    timer.start();
+    stats = Statistics();
+
+    WorkStealingPool pool(threadCount);
+    stats.threads = pool.threadCount();
+    scan(text, pool);
+
+    std::unique_ptr<SchemaTree::Node> root;
+    const int size = static_cast<int>(compact.size());
+    const int grain = std::max(MIN_GRAIN_CHARS, size / (stats.threads * TASKS_PER_THREAD));
+
+    // Верх дерева раскрывается в этом потоке, пока диапазоны больше
+    // зерна; операнды одного оператора собираются в группы примерно
+    // по зерну символов, огромный операнд раскрывается дальше.
+    QElapsedTimer parseTimer;
+    parseTimer.start();
+    std::vector<Task> tasks;
+    std::vector<SchemaTree::Node*> expanded;
+    std::vector<Range> stack{Range{0, size, 0, &root}};
+    qint64 expandedNodes = 0;
+    while (!stack.empty()) {
+        Range range = stack.back();
+        stack.pop_back();
+
+        for (;;) {
+            trim(range.begin, range.end);
+            if (range.end - range.begin <= grain) {
+                if (range.begin < range.end)
+                    tasks.push_back(Task{nullptr, range, 0, 0, nullptr, 0, 0, 0});
+                break;
+            }
+
+            int opCount = 0;
+            const int* ops = topLevelOps(range.begin, range.end, range.depth, opCount);
+            if (opCount > 0) {
+                auto node = std::make_unique<SchemaTree::Node>(NodeType::OP, QString(compact.at(ops[0])));
+                node->children.resize(opCount + 1);
+                SchemaTree::Node* op = node.get();
+                *range.slot = std::move(node);
+                expanded.push_back(op);
+                ++expandedNodes;
+
+                const Task owner{op, range, range.begin, range.end, ops, opCount, 0, 0};
+                int part = 0;
+                while (part <= opCount) {
+                    int begin = 0;
+                    int end = 0;
+                    partBounds(owner, part, begin, end);
+                    const int target = begin + grain;
+                    const int next = static_cast<int>(std::lower_bound(ops, ops + opCount, target) - ops);
+                    if (next > part) {
+                        Task task = owner;
+                        task.firstPart = part;
+                        task.lastPart = next;
+                        tasks.push_back(task);
+                        part = next;
+                    } else {
+                        stack.push_back(Range{begin, end, range.depth, &op->children[part]});
+                        ++part;
+                    }
+                }
+                break;
+            }
+
+            const QChar first = compact.at(range.begin);
+            if (first == '!') {
+                auto node = std::make_unique<SchemaTree::Node>(NodeType::NOT, "!");
+                node->children.resize(1);
+                SchemaTree::Node* notNode = node.get();
+                *range.slot = std::move(node);
+                expanded.push_back(notNode);
+                ++expandedNodes;
+
+                Range inside{range.begin + 1, range.end, range.depth, &notNode->children.front()};
+                if (inside.end - inside.begin >= 2 && compact.at(inside.begin) == '(' && compact.at(inside.end - 1) == ')') {
+                    ++inside.begin;
+                    --inside.end;
+                    ++inside.depth;
+                }
+                range = inside;
+                continue;
+            }
+            if (first == '(' && compact.at(range.end - 1) == ')') {
+                ++range.begin;
+                --range.end;
+                ++range.depth;
+                continue;
+            }
+
+            *range.slot = std::make_unique<SchemaTree::Node>(NodeType::VAR, compact.mid(range.begin, range.end - range.begin));
+            ++expandedNodes;
+            break;
+        }
+    }
+
+    std::atomic<qint64> nodes{expandedNodes};
+    pool.parallelFor(static_cast<int>(tasks.size()), [&](int index, int) {
+        const Task& task = tasks[index];
+        std::vector<SchemaTree::Node*> created;
+        qint64 count = 0;
+        if (!task.parent) {
+            count = parseRange(task.range, created);
+        } else {
+            for (int part = task.firstPart; part < task.lastPart; ++part) {
+                int begin = 0;
+                int end = 0;
+                partBounds(task, part, begin, end);
+                count += parseRange(Range{begin, end, task.range.depth, &task.parent->children[part]}, created);
+            }
+        }
+        compactChildren(created);
+        nodes += count;
+    });
+    compactChildren(expanded);
+
+    stats.nodes = nodes.load();
+    stats.tasks = static_cast<int>(tasks.size());
+    stats.parseUs = parseTimer.nsecsElapsed() / 1000;
+    stats.totalUs = timer.nsecsElapsed() / 1000;
+
+    compact.clear();
+    depthStart.clear();
+    opsByDepth.clear();
+    return root;
+}
+
+// Время этапов последнего разбора.
+ParallelParser::Statistics ParallelParser::statistics() const
+{
+    return stats;
+}
+
+// Построить дерево выражения.
+std::unique_ptr<SchemaTree> ParallelParser::makeTree(const QString& text)
+{
+    if (text.size() < MIN_PARALLEL_CHARS)
+        return std::make_unique<SchemaTree>(text);
+
+    ParallelParser parser;
+    return std::make_unique<SchemaTree>(parser.parse(text));
+}
+
+// Замер масштабирования по числу потоков.
+std::vector<ParallelParser::Statistics> ParallelParser::benchmark(const QString& text,
+                                                                  const std::vector<int>& threadCounts)
+{
+    std::vector<Statistics> result;
+    for (int threads : threadCounts) {
+        ParallelParser parser(threads);
+        parser.parse(text);
+        result.push_back(parser.statistics());
+    }
+    return result;
+}
+
+// Удалить пробелы и построить индекс операторов по глубине.
+void ParallelParser::scan(const QString& text, WorkStealingPool& pool)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // Текст делится на отрезки; каждый проход — параллельный цикл
+    // по отрезкам, между проходами — префиксная сумма по отрезкам.
+    auto chunking = [&](int size, int& chunkCount, int& chunkSize) {
+        chunkCount = std::max(1, std::min(pool.threadCount() * CHUNKS_PER_THREAD, size / MIN_CHUNK_CHARS));
+        chunkSize = (size + chunkCount - 1) / std::max(1, chunkCount);
+    };
+
+    const int length = static_cast<int>(text.size());
+    int chunkCount = 0;
+    int chunkSize = 0;
+    chunking(length, chunkCount, chunkSize);
+    const QChar* source = text.constData();
+
+    std::vector<int> kept(chunkCount + 1, 0);
+    pool.parallelFor(chunkCount, [&](int chunk, int) {
+        const int end = std::min(length, (chunk + 1) * chunkSize);
+        int count = 0;
+        for (int i = chunk * chunkSize; i < end; ++i)
+            count += source[i] != ' ';
+        kept[chunk + 1] = count;
+    });
+    for (int chunk = 0; chunk < chunkCount; ++chunk)
+        kept[chunk + 1] += kept[chunk];
+
+    compact = QString(kept[chunkCount], Qt::Uninitialized);
+    QChar* target = compact.data();
+    pool.parallelFor(chunkCount, [&](int chunk, int) {
+        const int end = std::min(length, (chunk + 1) * chunkSize);
+        int out = kept[chunk];
+        for (int i = chunk * chunkSize; i < end; ++i) {
+            if (source[i] != ' ')
+                target[out++] = source[i];
+        }
+    });
+
+    // Глубина перед каждым оператором: сумма изменений глубины
+    // предыдущих отрезков плюс изменение внутри своего отрезка.
+    struct ChunkInfo
+    {
+        int delta = 0;      ///< Изменение глубины
+        int low = 0;        ///< Наименьшая глубина относительно начала
+        int high = 0;       ///< Наибольшая глубина относительно начала
+        int ops = 0;        ///< Операторов
+    };
+
+    const int size = static_cast<int>(compact.size());
+    chunking(size, chunkCount, chunkSize);
+    const QChar* data = compact.constData();
+    std::vector<ChunkInfo> info(chunkCount);
+    pool.parallelFor(chunkCount, [&](int chunk, int) {
+        ChunkInfo& c = info[chunk];
+        const int end = std::min(size, (chunk + 1) * chunkSize);
+        for (int i = chunk * chunkSize; i < end; ++i) {
+            const QChar ch = data[i];
+            if (ch == '(') {
+                c.high = std::max(c.high, ++c.delta);
+            } else if (ch == ')') {
+                c.low = std::min(c.low, --c.delta);
+            } else if (isOperator(ch)) {
+                ++c.ops;
+            }
+        }
+    });
+
+    std::vector<int> startDepth(chunkCount, 0);
+    std::vector<int> startOp(chunkCount + 1, 0);
+    int depth = 0;
+    int low = 0;
+    int high = 0;
+    for (int chunk = 0; chunk < chunkCount; ++chunk) {
+        startDepth[chunk] = depth;
+        low = std::min(low, depth + info[chunk].low);
+        high = std::max(high, depth + info[chunk].high);
+        depth += info[chunk].delta;
+        startOp[chunk + 1] = startOp[chunk] + info[chunk].ops;
+    }
+    const int opCount = startOp[chunkCount];
+
+    std::vector<int> opPosition(opCount);
+    std::vector<int> opDepth(opCount);
+    pool.parallelFor(chunkCount, [&](int chunk, int) {
+        const int end = std::min(size, (chunk + 1) * chunkSize);
+        int d = startDepth[chunk];
+        int k = startOp[chunk];
+        for (int i = chunk * chunkSize; i < end; ++i) {
+            const QChar ch = data[i];
+            if (ch == '(') {
+                ++d;
+            } else if (ch == ')') {
+                --d;
+            } else if (isOperator(ch)) {
+                opPosition[k] = i;
+                opDepth[k++] = d;
+            }
+        }
+    });
+    stats.chars = size;
+    stats.operators = opCount;
+    stats.scanUs = timer.nsecsElapsed() / 1000;
+
+    // Группировка по глубине подсчётом: при небольшом числе глубин —
+    // отдельные счётчики у каждого отрезка операторов, иначе один проход.
+    timer.restart();
+    minDepth = low;
+    const int depths = high - low + 1;
+    depthStart.assign(depths + 1, 0);
+    opsByDepth.resize(opCount);
+
+    const int groups = std::max(1, std::min(pool.threadCount() * CHUNKS_PER_THREAD, opCount / MIN_CHUNK_CHARS));
+    const qint64 counters = static_cast<qint64>(groups) * depths;
+    if (groups > 1 && counters <= opCount) {
+        const int groupSize = (opCount + groups - 1) / groups;
+        std::vector<int> offsets(counters, 0);
+        pool.parallelFor(groups, [&](int group, int) {
+            int* count = offsets.data() + static_cast<qint64>(group) * depths;
+            const int end = std::min(opCount, (group + 1) * groupSize);
+            for (int k = group * groupSize; k < end; ++k)
+                ++count[opDepth[k] - minDepth];
+        });
+
+        // Порядок: глубина, затем отрезок — позиции остаются по возрастанию.
+        int position = 0;
+        for (int d = 0; d < depths; ++d) {
+            depthStart[d] = position;
+            for (int group = 0; group < groups; ++group) {
+                int& slot = offsets[static_cast<qint64>(group) * depths + d];
+                const int count = slot;
+                slot = position;
+                position += count;
+            }
+        }
+        depthStart[depths] = position;
+
+        pool.parallelFor(groups, [&](int group, int) {
+            int* offset = offsets.data() + static_cast<qint64>(group) * depths;
+            const int end = std::min(opCount, (group + 1) * groupSize);
+            for (int k = group * groupSize; k < end; ++k)
+                opsByDepth[offset[opDepth[k] - minDepth]++] = opPosition[k];
+        });
+    } else {
+        for (int k = 0; k < opCount; ++k)
+            ++depthStart[opDepth[k] - minDepth + 1];
+        for (int d = 0; d < depths; ++d)
+            depthStart[d + 1] += depthStart[d];
+        std::vector<int> offset(depthStart.begin(), depthStart.end() - 1);
+        for (int k = 0; k < opCount; ++k)
+            opsByDepth[offset[opDepth[k] - minDepth]++] = opPosition[k];
+    }
+    stats.indexUs = timer.nsecsElapsed() / 1000;
+}
+
+// Операторы верхнего уровня диапазона.
+const int* ParallelParser::topLevelOps(int begin, int end, int depth, int& count) const
+{
+    // Оператор верхнего уровня диапазона — оператор на той же глубине,
+    // что и начало диапазона: так же считает и SchemaTree, начиная с нуля.
+    const int* first = opsByDepth.data() + depthStart[depth - minDepth];
+    const int* last = opsByDepth.data() + depthStart[depth - minDepth + 1];
+    const int* from = std::lower_bound(first, last, begin);
+    const int* to = std::lower_bound(from, last, end);
+    count = static_cast<int>(to - from);
+    return from;
+}
+
+// Начало и конец операнда оператора.
+void ParallelParser::partBounds(const Task& task, int part, int& begin, int& end)
+{
+    begin = part == 0 ? task.begin : task.ops[part - 1] + 1;
+    end = part == task.opCount ? task.end : task.ops[part];
+}
+
+// Разобрать диапазон последовательно.
+qint64 ParallelParser::parseRange(const Range& start, std::vector<SchemaTree::Node*>& created) const
+{
+    // Повторяет SchemaTree::buildTreeHelper: обрезка краёв, операторы
+    // верхнего уровня, затем NOT, скобки, переменная. Пустой операнд
+    // оставляет место ребёнка пустым, и оно удаляется в compactChildren.
+    qint64 count = 0;
+    std::vector<Range> stack{start};
+    while (!stack.empty()) {
+        Range range = stack.back();
+        stack.pop_back();
+
+        for (;;) {
+            trim(range.begin, range.end);
+            if (range.begin >= range.end)
+                break;
+
+            int opCount = 0;
+            const int* ops = topLevelOps(range.begin, range.end, range.depth, opCount);
+            if (opCount > 0) {
+                auto node = std::make_unique<SchemaTree::Node>(NodeType::OP, QString(compact.at(ops[0])));
+                node->children.resize(opCount + 1);
+                SchemaTree::Node* op = node.get();
+                *range.slot = std::move(node);
+                created.push_back(op);
+                ++count;
+
+                const Task owner{op, range, range.begin, range.end, ops, opCount, 0, 0};
+                for (int part = opCount; part >= 0; --part) {
+                    int begin = 0;
+                    int end = 0;
+                    partBounds(owner, part, begin, end);
+                    stack.push_back(Range{begin, end, range.depth, &op->children[part]});
+                }
+                break;
+            }
+
+            const QChar first = compact.at(range.begin);
+            if (first == '!') {
+                auto node = std::make_unique<SchemaTree::Node>(NodeType::NOT, "!");
+                node->children.resize(1);
+                SchemaTree::Node* notNode = node.get();
+                *range.slot = std::move(node);
+                created.push_back(notNode);
+                ++count;
+
+                Range inside{range.begin + 1, range.end, range.depth, &notNode->children.front()};
+                if (inside.end - inside.begin >= 2 && compact.at(inside.begin) == '(' && compact.at(inside.end - 1) == ')') {
+                    ++inside.begin;
+                    --inside.end;
+                    ++inside.depth;
+                }
+                range = inside;
+                continue;
+            }
+            if (first == '(' && compact.at(range.end - 1) == ')') {
+                ++range.begin;
+                --range.end;
+                ++range.depth;
+                continue;
+            }
+
+            *range.slot = std::make_unique<SchemaTree::Node>(NodeType::VAR, compact.mid(range.begin, range.end - range.begin));
+            ++count;
+            break;
+        }
+    }
+    return count;
+}
+
+// Снять пробельные символы с краёв диапазона.
+void ParallelParser::trim(int& begin, int& end) const
+{
+    while (begin < end && compact.at(begin).isSpace())
+        ++begin;
+    while (end > begin && compact.at(end - 1).isSpace())
+        --end;
+}
+
+// Удалить пустые места детей, оставшиеся от пустых операндов.
+void ParallelParser::compactChildren(const std::vector<SchemaTree::Node*>& nodes)
+{
+    for (SchemaTree::Node* node : nodes) {
+        auto& children = node->children;
+        children.erase(std::remove(children.begin(), children.end(), nullptr), children.end());
+    }
+}
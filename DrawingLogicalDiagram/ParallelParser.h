@@ -0,0 +1,174 @@
+#ifndef PARALLELPARSER_H
+#define PARALLELPARSER_H
+
+#include <QString>
+#include <QtGlobal>
+#include <memory>
+#include <vector>
+#include "SchemaTree.h"
+
+class WorkStealingPool;
+
+/**
+ * @class ParallelParser
+ * @brief Параллельный разбор очень больших выражений
+ *
+ * Строит то же дерево, что и SchemaTree (включая его особенности:
+ * главный оператор — первый оператор верхнего уровня, пустые операнды
+ * пропускаются, несбалансированные скобки разбираются так же), но без
+ * копирования подстрок на каждом уровне и без рекурсии.
+ *
+ * @details
+ * Разбор идёт в три этапа:
+ * - параллельный просмотр: удаление пробелов и глубина скобок
+ *   перед каждым оператором (префиксные суммы по отрезкам текста);
+ * - индекс операторов: позиции, сгруппированные по глубине, поэтому
+ *   операторы верхнего уровня любого диапазона находятся двоичным поиском;
+ * - разбор: верх дерева раскрывается последовательно, пока диапазоны
+ *   операндов не станут меньше зерна, затем группы соседних операндов
+ *   разбираются независимо в WorkStealingPool и вставляются на свои места.
+ *
+ * Пример:
+ * @code
+ * ParallelParser parser;
+ * SchemaTree tree(parser.parse(text));
+ * @endcode
+ */
+class ParallelParser {
+public:
+    /**
+     * @struct Statistics
+     * @brief Время этапов последнего разбора
+     */
+    struct Statistics
+    {
+        int threads = 0;          ///< Число потоков
+        qint64 chars = 0;         ///< Символов без пробелов
+        qint64 operators = 0;     ///< Бинарных операторов
+        qint64 nodes = 0;         ///< Узлов дерева
+        int tasks = 0;            ///< Параллельных задач разбора
+        qint64 scanUs = 0;        ///< Удаление пробелов и глубина скобок, мкс
+        qint64 indexUs = 0;       ///< Группировка операторов по глубине, мкс
+        qint64 parseUs = 0;       ///< Построение дерева, мкс
+        qint64 totalUs = 0;       ///< Всего, мкс
+    };
+
+    /**
+     * @brief Конструктор
+     * @param threads Число потоков (0 — по числу ядер)
+     */
+    explicit ParallelParser(int threads = 0);
+
+    /**
+     * @brief Разобрать выражение
+     * @param text Логическое выражение
+     * @return Корень дерева, совпадающего с деревом SchemaTree(text); nullptr для пустого
+     */
+    std::unique_ptr<SchemaTree::Node> parse(const QString& text);
+
+    /**
+     * @brief Время этапов последнего разбора
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief Построить дерево выражения
+     * @param text Логическое выражение
+     * @return Дерево; длинный текст разбирается параллельно, короткий — SchemaTree
+     */
+    static std::unique_ptr<SchemaTree> makeTree(const QString& text);
+
+    /**
+     * @brief Замер масштабирования по числу потоков
+     * @param text Логическое выражение
+     * @param threadCounts Числа потоков для замера
+     * @return Статистика разбора для каждого числа потоков
+     */
+    static std::vector<Statistics> benchmark(const QString& text, const std::vector<int>& threadCounts);
+
+private:
+    /**
+     * @struct Range
+     * @brief Диапазон текста, который разбирается в один узел
+     */
+    struct Range
+    {
+        int begin;                            ///< Начало
+        int end;                              ///< Конец (не включая)
+        int depth;                            ///< Глубина скобок в начале
+        std::unique_ptr<SchemaTree::Node>* slot;  ///< Куда записать узел
+    };
+
+    /**
+     * @struct Task
+     * @brief Параллельная задача: подряд идущие операнды одного оператора
+     */
+    struct Task
+    {
+        SchemaTree::Node* parent;  ///< Оператор; nullptr — задача из одного диапазона
+        Range range;               ///< Диапазон (для задачи из одного диапазона)
+        int begin;                 ///< Начало диапазона оператора
+        int end;                   ///< Конец диапазона оператора
+        const int* ops;            ///< Операторы верхнего уровня оператора
+        int opCount;               ///< Их число
+        int firstPart;             ///< Первый операнд группы
+        int lastPart;              ///< Операнд после последнего
+    };
+
+    /**
+     * @brief Удалить пробелы и построить индекс операторов по глубине
+     * @param text Исходный текст
+     * @param pool Пул потоков
+     */
+    void scan(const QString& text, WorkStealingPool& pool);
+
+    /**
+     * @brief Операторы верхнего уровня диапазона
+     * @param begin Начало
+     * @param end Конец
+     * @param depth Глубина скобок в начале
+     * @param count Сюда записывается число операторов
+     * @return Указатель на первую позицию (по возрастанию)
+     */
+    const int* topLevelOps(int begin, int end, int depth, int& count) const;
+
+    /**
+     * @brief Начало и конец операнда оператора
+     * @param task Задача с описанием оператора
+     * @param part Номер операнда
+     * @param begin Сюда записывается начало
+     * @param end Сюда записывается конец
+     */
+    static void partBounds(const Task& task, int part, int& begin, int& end);
+
+    /**
+     * @brief Разобрать диапазон последовательно
+     * @param range Диапазон и место для узла
+     * @param created Сюда добавляются созданные NOT и OP (для удаления пустых детей)
+     * @return Число созданных узлов
+     */
+    qint64 parseRange(const Range& range, std::vector<SchemaTree::Node*>& created) const;
+
+    /**
+     * @brief Снять пробельные символы с краёв диапазона
+     * @param begin Начало (сдвигается вправо)
+     * @param end Конец (сдвигается влево)
+     */
+    void trim(int& begin, int& end) const;
+
+    /**
+     * @brief Удалить пустые места детей, оставшиеся от пустых операндов
+     * @param nodes Узлы NOT и OP
+     */
+    static void compactChildren(const std::vector<SchemaTree::Node*>& nodes);
+
+    int threadCount;               ///< Заданное число потоков
+    QString compact;               ///< Текст без пробелов
+    int minDepth = 0;              ///< Наименьшая глубина скобок
+    std::vector<int> depthStart;   ///< CSR: начало списка операторов глубины minDepth + i
+    std::vector<int> opsByDepth;   ///< CSR: позиции операторов по глубине и возрастанию
+    Statistics stats;              ///< Статистика последнего разбора
+};
+
+#endif // PARALLELPARSER_H
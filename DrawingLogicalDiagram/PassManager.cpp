@@ -0,0 +1,474 @@
+#include "PassManager.h"
+#include "TreeRebalancer.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_map>
+
+using Node = SchemaTree::Node;
+
+const char* const PassManager::DEFAULT_PIPELINE = "constant-folding,double-negation,de-morgan,flatten,absorption";
+
+// Ячейки дерева (корень и ссылки на детей) в прямом порядке обхода.
+static std::vector<std::unique_ptr<Node>*> preorderSlots(std::unique_ptr<Node>& root)
+{
+    std::vector<std::unique_ptr<Node>*> order;
+    std::vector<std::unique_ptr<Node>*> stack;
+    if (root)
+        stack.push_back(&root);
+    while (!stack.empty()) {
+        std::unique_ptr<Node>* slot = stack.back();
+        stack.pop_back();
+        order.push_back(slot);
+        for (auto it = (*slot)->children.rbegin(); it != (*slot)->children.rend(); ++it)
+            stack.push_back(&*it);
+    }
+    return order;
+}
+
+// Число узлов дерева.
+static int countNodes(const Node* root)
+{
+    int count = 0;
+    std::vector<const Node*> stack;
+    if (root)
+        stack.push_back(root);
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        ++count;
+        for (const auto& child : node->children)
+            stack.push_back(child.get());
+    }
+    return count;
+}
+
+// Является ли узел константой 0 или 1.
+static bool isConstant(const Node* node)
+{
+    return node->type == NodeType::VAR && (node->value == "0" || node->value == "1");
+}
+
+// Узел константы.
+static std::unique_ptr<Node> makeConstant(bool value)
+{
+    return std::make_unique<Node>(NodeType::VAR, value ? "1" : "0");
+}
+
+// Конструктор.
+PassManager::PassManager()
+{
+    registerPass("constant-folding", "Свёртка констант 0 и 1", foldConstants);
+    registerPass("double-negation", "Удаление двойного отрицания", removeDoubleNegation);
+    registerPass("de-morgan", "Перенос отрицания внутрь оператора", pushNegations);
+    registerPass("flatten", "Слияние цепочек одинаковых операторов", flattenChains);
+    registerPass("absorption", "Идемпотентность, дополнение и поглощение", absorb);
+    setPipeline(QString(DEFAULT_PIPELINE));
+}
+
+// Зарегистрировать проход.
+void PassManager::registerPass(const QString& name, const QString& description, Pass pass)
+{
+    const int index = find(name);
+    if (index >= 0)
+        registry[index] = Entry{name, description, std::move(pass)};
+    else
+        registry.push_back(Entry{name, description, std::move(pass)});
+}
+
+// Имена зарегистрированных проходов.
+QStringList PassManager::availablePasses() const
+{
+    QStringList names;
+    for (const Entry& entry : registry)
+        names << entry.name;
+    return names;
+}
+
+// Описание прохода.
+QString PassManager::description(const QString& name) const
+{
+    const int index = find(name);
+    return index >= 0 ? registry[index].description : QString();
+}
+
+// Задать конвейер.
+bool PassManager::setPipeline(const QStringList& names)
+{
+    std::vector<int> indices;
+    for (const QString& name : names) {
+        const int index = find(name);
+        if (index < 0) {
+            error = QString("Неизвестный проход: %1").arg(name);
+            return false;
+        }
+        indices.push_back(index);
+    }
+    stages = std::move(indices);
+    error.clear();
+    return true;
+}
+
+// Задать конвейер строкой.
+bool PassManager::setPipeline(const QString& spec)
+{
+    QStringList names;
+    for (const QString& part : spec.split(',')) {
+        const QString name = part.trimmed();
+        if (!name.isEmpty())
+            names << name;
+    }
+    return setPipeline(names);
+}
+
+// Текущий конвейер.
+QString PassManager::pipeline() const
+{
+    QStringList names;
+    for (int index : stages)
+        names << registry[index].name;
+    return names.join(',');
+}
+
+// Задать наибольшее число итераций конвейера.
+void PassManager::setMaxIterations(int iterations)
+{
+    maxIterations = std::max(1, iterations);
+}
+
+// Прогнать конвейер.
+std::unique_ptr<Node> PassManager::run(std::unique_ptr<Node> root)
+{
+    stats = Report();
+    for (int index : stages)
+        stats.passes.push_back(PassStatistics{registry[index].name});
+
+    QElapsedTimer timer;
+    timer.start();
+    int nodes = countNodes(root.get());
+    stats.nodesBefore = nodes;
+
+    // Узлы пересчитываются только после изменивших дерево проходов,
+    // и этот подсчёт не входит во время прохода.
+    while (root && stats.iterations < maxIterations) {
+        bool changed = false;
+        for (size_t i = 0; i < stages.size(); ++i) {
+            PassStatistics& pass = stats.passes[i];
+            QElapsedTimer passTimer;
+            passTimer.start();
+            const bool passChanged = registry[stages[i]].pass(root);
+            pass.elapsedUs += passTimer.nsecsElapsed() / 1000;
+            ++pass.runs;
+            if (passChanged) {
+                const int after = countNodes(root.get());
+                ++pass.changes;
+                pass.removedNodes += nodes - after;
+                nodes = after;
+                changed = true;
+            }
+        }
+        ++stats.iterations;
+        if (!changed) {
+            stats.converged = true;
+            break;
+        }
+    }
+
+    stats.nodesAfter = nodes;
+    stats.elapsedUs = timer.nsecsElapsed() / 1000;
+    return root;
+}
+
+// Отчёт о последнем прогоне.
+PassManager::Report PassManager::report() const
+{
+    return stats;
+}
+
+// Отчёт о последнем прогоне в виде текста.
+QString PassManager::summary() const
+{
+    QStringList passes;
+    for (const PassStatistics& pass : stats.passes) {
+        passes << QString("%1 %2%3 (%4/%5, %6 мкс)")
+                      .arg(pass.name)
+                      .arg(pass.removedNodes > 0 ? "−" : "+")
+                      .arg(std::abs(pass.removedNodes))
+                      .arg(pass.changes)
+                      .arg(pass.runs)
+                      .arg(pass.elapsedUs);
+    }
+    return QString("Проходы: узлов %1 → %2, итераций %3%4, %5 мкс; %6")
+        .arg(stats.nodesBefore)
+        .arg(stats.nodesAfter)
+        .arg(stats.iterations)
+        .arg(stats.converged ? "" : " (предел)")
+        .arg(stats.elapsedUs)
+        .arg(passes.join(", "));
+}
+
+// Описание последней ошибки.
+QString PassManager::errorString() const
+{
+    return error;
+}
+
+// Найти проход в реестре.
+int PassManager::find(const QString& name) const
+{
+    for (size_t i = 0; i < registry.size(); ++i) {
+        if (registry[i].name == name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Проход constant-folding.
+bool PassManager::foldConstants(std::unique_ptr<Node>& root)
+{
+    bool changed = false;
+    const std::vector<std::unique_ptr<Node>*> order = preorderSlots(root);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        std::unique_ptr<Node>& slot = **it;
+        Node* node = slot.get();
+
+        if (node->type == NodeType::NOT) {
+            if (isConstant(node->children.front().get())) {
+                slot = makeConstant(node->children.front()->value == "0");
+                changed = true;
+            }
+            continue;
+        }
+        if (node->type != NodeType::OP)
+            continue;
+
+        const bool hasConstant = std::any_of(node->children.begin(), node->children.end(),
+                                             [](const std::unique_ptr<Node>& child) { return isConstant(child.get()); });
+        if (!hasConstant)
+            continue;
+
+        // Поглощающая константа заменяет весь оператор, нейтральные
+        // отбрасываются, единицы в XOR меняют чётность.
+        const bool isAnd = node->value == "&";
+        const bool isOr = node->value == "|";
+        bool dominated = false;
+        bool parity = false;
+        std::vector<std::unique_ptr<Node>> kept;
+        for (auto& child : node->children) {
+            if (!isConstant(child.get())) {
+                kept.push_back(std::move(child));
+                continue;
+            }
+            const bool value = child->value == "1";
+            if (isAnd)
+                dominated |= !value;
+            else if (isOr)
+                dominated |= value;
+            else
+                parity ^= value;
+        }
+
+        changed = true;
+        if (dominated) {
+            slot = makeConstant(isOr);
+            continue;
+        }
+        if (kept.empty()) {
+            slot = makeConstant(isAnd || parity);
+            continue;
+        }
+
+        std::unique_ptr<Node> result;
+        if (kept.size() == 1) {
+            result = std::move(kept.front());
+        } else {
+            node->children = std::move(kept);
+            result = std::move(slot);
+        }
+        if (parity) {
+            auto inverter = std::make_unique<Node>(NodeType::NOT, "!");
+            inverter->children.push_back(std::move(result));
+            result = std::move(inverter);
+        }
+        slot = std::move(result);
+    }
+    return changed;
+}
+
+// Проход double-negation.
+bool PassManager::removeDoubleNegation(std::unique_ptr<Node>& root)
+{
+    bool changed = false;
+    const std::vector<std::unique_ptr<Node>*> order = preorderSlots(root);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        std::unique_ptr<Node>& slot = **it;
+        if (slot->type != NodeType::NOT || slot->children.front()->type != NodeType::NOT)
+            continue;
+        std::unique_ptr<Node> inner = std::move(slot->children.front()->children.front());
+        slot = std::move(inner);
+        changed = true;
+    }
+    return changed;
+}
+
+// Проход de-morgan.
+bool PassManager::pushNegations(std::unique_ptr<Node>& root)
+{
+    // Обход сверху вниз: отрицание, перенесённое к операндам,
+    // продолжает спуск в том же проходе.
+    bool changed = false;
+    std::vector<std::unique_ptr<Node>*> stack;
+    if (root)
+        stack.push_back(&root);
+    while (!stack.empty()) {
+        std::unique_ptr<Node>& slot = *stack.back();
+        stack.pop_back();
+
+        if (slot->type == NodeType::NOT && slot->children.front()->type == NodeType::OP) {
+            std::unique_ptr<Node>& op = slot->children.front();
+            const int operands = static_cast<int>(op->children.size());
+            const int negated = static_cast<int>(std::count_if(op->children.begin(), op->children.end(),
+                [](const std::unique_ptr<Node>& child) { return child->type == NodeType::NOT; }));
+
+            if (op->value == "^" && negated > 0) {
+                // !(!a ^ b) = a ^ b: отрицание поглощается одним операндом.
+                for (auto& child : op->children) {
+                    if (child->type == NodeType::NOT) {
+                        std::unique_ptr<Node> inner = std::move(child->children.front());
+                        child = std::move(inner);
+                        break;
+                    }
+                }
+                std::unique_ptr<Node> result = std::move(op);
+                slot = std::move(result);
+                changed = true;
+            } else if (op->value != "^" && 2 * negated + 1 >= operands) {
+                // Убирается отрицание оператора и negated отрицаний
+                // операндов, добавляется operands - negated новых.
+                for (auto& child : op->children) {
+                    if (child->type == NodeType::NOT) {
+                        std::unique_ptr<Node> inner = std::move(child->children.front());
+                        child = std::move(inner);
+                    } else {
+                        auto inverter = std::make_unique<Node>(NodeType::NOT, "!");
+                        inverter->children.push_back(std::move(child));
+                        child = std::move(inverter);
+                    }
+                }
+                op->value = op->value == "&" ? "|" : "&";
+                std::unique_ptr<Node> result = std::move(op);
+                slot = std::move(result);
+                changed = true;
+            }
+        }
+
+        for (auto& child : slot->children)
+            stack.push_back(&child);
+    }
+    return changed;
+}
+
+// Проход flatten.
+bool PassManager::flattenChains(std::unique_ptr<Node>& root)
+{
+    return root && TreeRebalancer::flatten(root.get());
+}
+
+// Проход absorption.
+bool PassManager::absorb(std::unique_ptr<Node>& root)
+{
+    // Равные поддеревья получают один номер: ключ узла составлен из типа,
+    // значения и номеров детей (у операторов — упорядоченных, так как
+    // все операторы коммутативны).
+    std::unordered_map<const Node*, int> ids;
+    QHash<QByteArray, int> canonical;
+    auto number = [&ids, &canonical](const Node* node) {
+        std::vector<int> childIds;
+        for (const auto& child : node->children)
+            childIds.push_back(ids.at(child.get()));
+        if (node->type == NodeType::OP)
+            std::sort(childIds.begin(), childIds.end());
+
+        QByteArray key = QByteArray::number(static_cast<int>(node->type)) + node->value.toUtf8() + ':';
+        for (int id : childIds)
+            key += QByteArray::number(id) + ',';
+        const auto found = canonical.constFind(key);
+        if (found != canonical.constEnd())
+            return found.value();
+        const int id = canonical.size();
+        canonical.insert(key, id);
+        return id;
+    };
+
+    bool changed = false;
+    const std::vector<std::unique_ptr<Node>*> order = preorderSlots(root);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        std::unique_ptr<Node>& slot = **it;
+        Node* node = slot.get();
+
+        if (node->type == NodeType::OP) {
+            QSet<int> present;
+            for (const auto& child : node->children)
+                present.insert(ids.at(child.get()));
+
+            std::vector<std::unique_ptr<Node>> kept;
+            bool dominated = false;
+            if (node->value == "^") {
+                // x ^ x = 0: операнды, встречающиеся чётное число раз, уходят.
+                QHash<int, int> occurrences;
+                for (const auto& child : node->children)
+                    ++occurrences[ids.at(child.get())];
+                QSet<int> taken;
+                for (auto& child : node->children) {
+                    const int id = ids.at(child.get());
+                    if (occurrences.value(id) % 2 == 1 && !taken.contains(id)) {
+                        taken.insert(id);
+                        kept.push_back(std::move(child));
+                    }
+                }
+            } else {
+                const QString dual = node->value == "&" ? "|" : "&";
+                QSet<int> taken;
+                for (auto& child : node->children) {
+                    const int id = ids.at(child.get());
+                    if (taken.contains(id))
+                        continue;  // x & x = x
+                    if (child->type == NodeType::NOT && present.contains(ids.at(child->children.front().get()))) {
+                        dominated = true;  // x & !x = 0, x | !x = 1
+                        break;
+                    }
+                    if (child->type == NodeType::OP && child->value == dual) {
+                        // x | (x & y) = x, x & (x | y) = x.
+                        const bool absorbed = std::any_of(child->children.begin(), child->children.end(),
+                            [&](const std::unique_ptr<Node>& grandChild) { return present.contains(ids.at(grandChild.get())); });
+                        if (absorbed)
+                            continue;
+                    }
+                    taken.insert(id);
+                    kept.push_back(std::move(child));
+                }
+            }
+
+            if (dominated) {
+                slot = makeConstant(node->value == "|");
+                changed = true;
+            } else if (kept.size() < node->children.size()) {
+                changed = true;
+                if (kept.empty()) {
+                    slot = makeConstant(false);
+                } else if (kept.size() == 1) {
+                    std::unique_ptr<Node> result = std::move(kept.front());
+                    slot = std::move(result);
+                } else {
+                    node->children = std::move(kept);
+                }
+            } else {
+                node->children = std::move(kept);
+            }
+        }
+        ids[slot.get()] = number(slot.get());
+    }
+    return changed;
+}
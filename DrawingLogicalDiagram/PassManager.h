@@ -0,0 +1,218 @@
+#ifndef PASSMANAGER_H
+#define PASSMANAGER_H
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "SchemaTree.h"
+
+/**
+ * @class PassManager
+ * @brief Конвейер проходов, переписывающих дерево разбора перед отрисовкой
+ *
+ * Проход — функция, которая переписывает дерево на месте, сохраняя
+ * его логическую функцию, и сообщает, изменила ли она что-нибудь.
+ * Проходы хранятся в реестре по имени; конвейер — список имён,
+ * который выполняется по кругу, пока хотя бы один проход что-то
+ * меняет (неподвижная точка), но не больше заданного числа итераций.
+ *
+ * Встроенные проходы:
+ * - constant-folding — свёртка констант 0 и 1;
+ * - double-negation — удаление двойного отрицания !!x → x;
+ * - de-morgan — перенос NOT внутрь оператора по правилам де Моргана,
+ *   если после сокращения двойных отрицаний дерево не станет больше;
+ * - flatten — слияние цепочек одинаковых операторов;
+ * - absorption — идемпотентность (x & x), дополнение (x & !x),
+ *   поглощение (x | (x & y)) и сокращение пар в XOR.
+ *
+ * Для каждого прохода собираются число запусков и изменений, время
+ * и изменение числа узлов, чтобы видеть, какие проходы окупаются
+ * на больших выражениях.
+ *
+ * Пример:
+ * @code
+ * PassManager passes;
+ * passes.setPipeline("constant-folding,double-negation,flatten");
+ * root = passes.run(std::move(root));
+ * qDebug() << passes.summary();
+ * @endcode
+ */
+class PassManager {
+public:
+    /**
+     * @brief Проход: переписывает дерево с корнем root, возвращает true при изменении
+     */
+    using Pass = std::function<bool(std::unique_ptr<SchemaTree::Node>& root)>;
+
+    /**
+     * @struct PassStatistics
+     * @brief Итоги одного прохода конвейера
+     */
+    struct PassStatistics
+    {
+        QString name;             ///< Имя прохода
+        int runs = 0;             ///< Число запусков
+        int changes = 0;          ///< Запусков, изменивших дерево
+        qint64 removedNodes = 0;  ///< Убрано узлов (отрицательное — добавлено)
+        qint64 elapsedUs = 0;     ///< Суммарное время, мкс
+    };
+
+    /**
+     * @struct Report
+     * @brief Результаты последнего прогона конвейера
+     */
+    struct Report
+    {
+        int nodesBefore = 0;     ///< Узлов до
+        int nodesAfter = 0;      ///< Узлов после
+        int iterations = 0;      ///< Выполнено итераций конвейера
+        bool converged = false;  ///< Достигнута неподвижная точка
+        qint64 elapsedUs = 0;    ///< Время прогона, мкс
+        std::vector<PassStatistics> passes;  ///< По позиции в конвейере
+    };
+
+    /**
+     * @brief Конструктор; регистрирует встроенные проходы и конвейер по умолчанию
+     */
+    PassManager();
+
+    /**
+     * @brief Зарегистрировать проход
+     * @param name Имя (заменяет проход с тем же именем)
+     * @param description Краткое описание
+     * @param pass Функция прохода
+     */
+    void registerPass(const QString& name, const QString& description, Pass pass);
+
+    /**
+     * @brief Имена зарегистрированных проходов
+     * @return Имена в порядке регистрации
+     */
+    QStringList availablePasses() const;
+
+    /**
+     * @brief Описание прохода
+     * @param name Имя прохода
+     * @return Описание или пустая строка
+     */
+    QString description(const QString& name) const;
+
+    /**
+     * @brief Задать конвейер
+     * @param names Имена проходов в порядке выполнения (повторы допустимы)
+     * @return false, если какого-то имени нет в реестре; см. errorString()
+     */
+    bool setPipeline(const QStringList& names);
+
+    /**
+     * @brief Задать конвейер строкой
+     * @param spec Имена через запятую, например "flatten,absorption"
+     * @return false, если какого-то имени нет в реестре; см. errorString()
+     */
+    bool setPipeline(const QString& spec);
+
+    /**
+     * @brief Текущий конвейер
+     * @return Имена через запятую (годится для ключа кэша)
+     */
+    QString pipeline() const;
+
+    /**
+     * @brief Задать наибольшее число итераций конвейера
+     * @param iterations Число итераций (1 — один проход без поиска неподвижной точки)
+     */
+    void setMaxIterations(int iterations);
+
+    /**
+     * @brief Прогнать конвейер
+     * @param root Корень дерева
+     * @return Корень эквивалентного переписанного дерева
+     */
+    std::unique_ptr<SchemaTree::Node> run(std::unique_ptr<SchemaTree::Node> root);
+
+    /**
+     * @brief Отчёт о последнем прогоне
+     * @return Итоги по конвейеру и по проходам
+     */
+    Report report() const;
+
+    /**
+     * @brief Отчёт о последнем прогоне в виде текста
+     * @return Строка для statusBar
+     */
+    QString summary() const;
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+    static constexpr int DEFAULT_MAX_ITERATIONS = 8;  ///< Итераций конвейера по умолчанию
+    static const char* const DEFAULT_PIPELINE;        ///< Конвейер по умолчанию
+
+private:
+    /**
+     * @struct Entry
+     * @brief Зарегистрированный проход
+     */
+    struct Entry
+    {
+        QString name;         ///< Имя
+        QString description;  ///< Описание
+        Pass pass;            ///< Функция прохода
+    };
+
+    /**
+     * @brief Найти проход в реестре
+     * @param name Имя прохода
+     * @return Индекс в реестре или -1
+     */
+    int find(const QString& name) const;
+
+    /**
+     * @brief Проход constant-folding
+     * @param root Корень дерева
+     * @return true, если дерево изменилось
+     */
+    static bool foldConstants(std::unique_ptr<SchemaTree::Node>& root);
+
+    /**
+     * @brief Проход double-negation
+     * @param root Корень дерева
+     * @return true, если дерево изменилось
+     */
+    static bool removeDoubleNegation(std::unique_ptr<SchemaTree::Node>& root);
+
+    /**
+     * @brief Проход de-morgan
+     * @param root Корень дерева
+     * @return true, если дерево изменилось
+     */
+    static bool pushNegations(std::unique_ptr<SchemaTree::Node>& root);
+
+    /**
+     * @brief Проход flatten
+     * @param root Корень дерева
+     * @return true, если дерево изменилось
+     */
+    static bool flattenChains(std::unique_ptr<SchemaTree::Node>& root);
+
+    /**
+     * @brief Проход absorption
+     * @param root Корень дерева
+     * @return true, если дерево изменилось
+     */
+    static bool absorb(std::unique_ptr<SchemaTree::Node>& root);
+
+    std::vector<Entry> registry;                 ///< Реестр проходов
+    std::vector<int> stages;                     ///< Конвейер: индексы в реестре
+    int maxIterations = DEFAULT_MAX_ITERATIONS;  ///< Предел итераций
+    Report stats;                                ///< Отчёт о последнем прогоне
+    QString error;                               ///< Текст последней ошибки
+};
+
+#endif // PASSMANAGER_H
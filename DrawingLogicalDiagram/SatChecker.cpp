@@ -0,0 +1,209 @@
+#include "SatChecker.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// Конструктор.
+SatChecker::SatChecker()
+    : solvers(std::max(1, QThread::idealThreadCount()))
+{}
+
+// Задать число решателей портфеля.
+void SatChecker::setSolverCount(int solvers)
+{
+    this->solvers = std::max(1, solvers);
+}
+
+// Число решателей портфеля.
+int SatChecker::solverCount() const
+{
+    return solvers;
+}
+
+// Задать предел конфликтов для каждого решателя.
+void SatChecker::setConflictLimit(qint64 limit)
+{
+    conflictLimit = std::max<qint64>(0, limit);
+}
+
+// Задать начальное значение генератора портфеля.
+void SatChecker::setSeed(quint32 seed)
+{
+    this->seed = seed;
+}
+
+// Найти набор входов, на котором выход равен value.
+SatChecker::Result SatChecker::findAssignment(const LogicGraph& graph, int output, bool value) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    Result result;
+    const Encoding encoding = encode(graph, graph.outputs()[output].gate);
+    result.variables = encoding.variables;
+    result.clauses = static_cast<int>(encoding.clauses.size()) + 1;
+    result.encodeUs = timer.nsecsElapsed() / 1000;
+
+    solvePortfolio(encoding, value ? encoding.root : -encoding.root, result);
+    result.elapsedUs = timer.nsecsElapsed() / 1000;
+    return result;
+}
+
+// Определить, тождественна ли функция выхода.
+SatChecker::Verdict SatChecker::classify(const LogicGraph& graph, int output,
+                                         Result* whenTrue, Result* whenFalse) const
+{
+    const Result one = findAssignment(graph, output, true);
+    if (whenTrue)
+        *whenTrue = one;
+    if (one.status == SatSolver::Status::UNSATISFIABLE)
+        return Verdict::CONTRADICTION;
+
+    const Result zero = findAssignment(graph, output, false);
+    if (whenFalse)
+        *whenFalse = zero;
+    if (zero.status == SatSolver::Status::UNSATISFIABLE)
+        return one.status == SatSolver::Status::SATISFIABLE ? Verdict::TAUTOLOGY : Verdict::UNKNOWN;
+    if (one.status == SatSolver::Status::SATISFIABLE && zero.status == SatSolver::Status::SATISFIABLE)
+        return Verdict::CONTINGENT;
+    return Verdict::UNKNOWN;
+}
+
+// Набор входов в виде текста.
+QString SatChecker::formatWitness(const LogicGraph& graph, const std::vector<bool>& witness)
+{
+    QStringList parts;
+    const std::vector<int>& inputs = graph.inputs();
+    for (size_t i = 0; i < inputs.size() && i < witness.size(); ++i)
+        parts << QString("%1=%2").arg(graph.inputName(inputs[i])).arg(witness[i] ? 1 : 0);
+    return parts.join(", ");
+}
+
+// Закодировать конус выхода по Цейтину.
+SatChecker::Encoding SatChecker::encode(const LogicGraph& graph, int gate)
+{
+    Encoding encoding;
+
+    // Вентили топологически упорядочены, поэтому конус отмечается
+    // одним обратным проходом от выхода.
+    std::vector<char> inCone(gate + 1, 0);
+    inCone[gate] = 1;
+    for (int id = gate; id >= 0; --id) {
+        if (!inCone[id])
+            continue;
+        for (int fanin : graph.gate(id).fanins)
+            inCone[fanin] = 1;
+    }
+
+    std::vector<int> literal(gate + 1, 0);
+    int constantTrue = 0;
+    for (int id = 0; id <= gate; ++id) {
+        if (!inCone[id])
+            continue;
+        const LogicGraph::Gate& g = graph.gate(id);
+        switch (g.kind) {
+        case LogicGraph::GateKind::CONST0:
+        case LogicGraph::GateKind::CONST1:
+            if (constantTrue == 0) {
+                constantTrue = ++encoding.variables;
+                encoding.clauses.push_back({constantTrue});
+            }
+            literal[id] = g.kind == LogicGraph::GateKind::CONST1 ? constantTrue : -constantTrue;
+            break;
+        case LogicGraph::GateKind::INPUT:
+            literal[id] = ++encoding.variables;
+            break;
+        case LogicGraph::GateKind::NOT:
+            literal[id] = -literal[g.fanins[0]];
+            break;
+        case LogicGraph::GateKind::AND:
+        case LogicGraph::GateKind::OR: {
+            // AND: g → xi для всех i, (x1 & ... & xn) → g.
+            // OR — то же для отрицаний.
+            const int sign = g.kind == LogicGraph::GateKind::AND ? 1 : -1;
+            const int out = ++encoding.variables;
+            std::vector<int> all{sign * out};
+            for (int fanin : g.fanins) {
+                const int x = sign * literal[fanin];
+                encoding.clauses.push_back({-sign * out, x});
+                all.push_back(-x);
+            }
+            encoding.clauses.push_back(std::move(all));
+            literal[id] = out;
+            break;
+        }
+        case LogicGraph::GateKind::XOR: {
+            int acc = literal[g.fanins[0]];
+            for (size_t k = 1; k < g.fanins.size(); ++k) {
+                const int b = literal[g.fanins[k]];
+                const int out = ++encoding.variables;
+                encoding.clauses.push_back({-out, acc, b});
+                encoding.clauses.push_back({-out, -acc, -b});
+                encoding.clauses.push_back({out, -acc, b});
+                encoding.clauses.push_back({out, acc, -b});
+                acc = out;
+            }
+            literal[id] = acc;
+            break;
+        }
+        }
+    }
+
+    const std::vector<int>& inputs = graph.inputs();
+    encoding.inputVariable.assign(inputs.size(), 0);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i] <= gate && inCone[inputs[i]])
+            encoding.inputVariable[i] = literal[inputs[i]];
+    }
+    encoding.root = literal[gate];
+    return encoding;
+}
+
+// Решить КНФ портфелем решателей.
+void SatChecker::solvePortfolio(const Encoding& encoding, int rootLiteral, Result& result) const
+{
+    std::atomic<bool> stop(false);
+    std::atomic<int> winner(-1);
+    result.solvers.assign(solvers, SatSolver::Statistics());
+
+    auto run = [&](int index) {
+        SatSolver solver(index == 0 ? 0 : seed + quint32(index));
+        for (int v = 0; v < encoding.variables; ++v)
+            solver.newVariable();
+        for (const std::vector<int>& clause : encoding.clauses)
+            solver.addClause(clause);
+        solver.addClause({rootLiteral});
+
+        const SatSolver::Status status = solver.solve(&stop, conflictLimit);
+        result.solvers[index] = solver.statistics();
+        if (status == SatSolver::Status::UNKNOWN)
+            return;
+
+        int expected = -1;
+        if (!winner.compare_exchange_strong(expected, index))
+            return;
+        stop.store(true);
+        result.status = status;
+        result.winner = index;
+        if (status == SatSolver::Status::SATISFIABLE) {
+            result.witness.assign(encoding.inputVariable.size(), false);
+            for (size_t i = 0; i < encoding.inputVariable.size(); ++i)
+                result.witness[i] = encoding.inputVariable[i] != 0 && solver.value(encoding.inputVariable[i]);
+        }
+    };
+
+    if (solvers == 1) {
+        run(0);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(solvers);
+    for (int i = 0; i < solvers; ++i)
+        threads.emplace_back(run, i);
+    for (std::thread& thread : threads)
+        thread.join();
+}
@@ -0,0 +1,162 @@
+#ifndef SATCHECKER_H
+#define SATCHECKER_H
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+#include "LogicGraph.h"
+#include "SatSolver.h"
+
+/**
+ * @class SatChecker
+ * @brief Проверка выполнимости и тождественной истинности выходов сети
+ *
+ * Отвечает, бывает ли выход равен 1 (или 0), и если бывает — приводит
+ * набор входов-свидетель. Наборы не перебираются: выход кодируется
+ * в КНФ и передаётся решателю SatSolver.
+ *
+ * @details
+ * - Кодирование Цейтина: переменная на каждый вход и вентиль конуса
+ *   выхода, NOT — отрицание литерала входа, AND и OR — n-арные
+ *   дизъюнкты, XOR — цепочка двухвходовых XOR через вспомогательные
+ *   переменные. Размер КНФ линеен по числу вентилей.
+ * - Кодируется LogicGraph, а не дерево разбора: одинаковые
+ *   подвыражения уже объединены структурным хэшированием.
+ * - Портфель: несколько решателей с разными начальными значениями
+ *   генератора решают одну КНФ в отдельных потоках. Первый, кто
+ *   получил ответ, поднимает общий флаг остановки, остальные
+ *   прерываются на ближайшей проверке.
+ * - Решатель 0 всегда детерминирован (без случайных решений).
+ *
+ * Пример:
+ * @code
+ * SatChecker checker;
+ * SatChecker::Result whenTrue, whenFalse;
+ * if (checker.classify(graph, 0, &whenTrue, &whenFalse) == SatChecker::Verdict::TAUTOLOGY)
+ *     qDebug() << "Y = 1 на всех наборах";
+ * @endcode
+ */
+class SatChecker {
+public:
+    /**
+     * @enum Verdict
+     * @brief Класс логической функции выхода
+     */
+    enum class Verdict {
+        TAUTOLOGY,      ///< Равна 1 на всех наборах
+        CONTRADICTION,  ///< Равна 0 на всех наборах
+        CONTINGENT,     ///< Принимает оба значения
+        UNKNOWN         ///< Проверка прервана по пределу конфликтов
+    };
+
+    /**
+     * @struct Result
+     * @brief Ответ на один запрос «может ли выход быть равен value»
+     */
+    struct Result
+    {
+        SatSolver::Status status = SatSolver::Status::UNKNOWN;  ///< Итог
+        std::vector<bool> witness;   ///< Набор входов в порядке inputs() при SATISFIABLE
+        int winner = -1;             ///< Номер решателя, давшего ответ, или -1
+        std::vector<SatSolver::Statistics> solvers;  ///< Счётчики каждого решателя
+        int variables = 0;           ///< Переменных КНФ
+        int clauses = 0;             ///< Дизъюнктов КНФ
+        qint64 encodeUs = 0;         ///< Время кодирования, мкс
+        qint64 elapsedUs = 0;        ///< Время запроса, мкс
+    };
+
+    /**
+     * @brief Конструктор; число решателей — по числу ядер
+     */
+    SatChecker();
+
+    /**
+     * @brief Задать число решателей портфеля
+     * @param solvers Число решателей (и потоков); не меньше 1
+     */
+    void setSolverCount(int solvers);
+
+    /**
+     * @brief Число решателей портфеля
+     * @return Число решателей
+     */
+    int solverCount() const;
+
+    /**
+     * @brief Задать предел конфликтов для каждого решателя
+     * @param limit Предел; 0 — без предела
+     */
+    void setConflictLimit(qint64 limit);
+
+    /**
+     * @brief Задать начальное значение генератора портфеля
+     * @param seed Решатель i > 0 получает seed + i
+     */
+    void setSeed(quint32 seed);
+
+    /**
+     * @brief Найти набор входов, на котором выход равен value
+     * @param graph Сеть
+     * @param output Номер выхода
+     * @param value Требуемое значение выхода
+     * @return Ответ; witness заполнен при SATISFIABLE
+     */
+    Result findAssignment(const LogicGraph& graph, int output, bool value) const;
+
+    /**
+     * @brief Определить, тождественна ли функция выхода
+     * @param graph Сеть
+     * @param output Номер выхода
+     * @param whenTrue Сюда записывается ответ на запрос «выход = 1» (может быть nullptr)
+     * @param whenFalse Сюда записывается ответ на запрос «выход = 0» (может быть nullptr)
+     * @return Класс функции
+     *
+     * Если выход не бывает равен 1, второй запрос не выполняется
+     * и whenFalse не меняется.
+     */
+    Verdict classify(const LogicGraph& graph, int output,
+                     Result* whenTrue = nullptr, Result* whenFalse = nullptr) const;
+
+    /**
+     * @brief Набор входов в виде текста
+     * @param graph Сеть
+     * @param witness Набор в порядке inputs()
+     * @return Строка вида "A=1, B=0"
+     */
+    static QString formatWitness(const LogicGraph& graph, const std::vector<bool>& witness);
+
+private:
+    /**
+     * @struct Encoding
+     * @brief КНФ конуса выхода
+     */
+    struct Encoding
+    {
+        std::vector<std::vector<int>> clauses;  ///< Дизъюнкты
+        std::vector<int> inputVariable;  ///< Переменная входа в порядке inputs() или 0 вне конуса
+        int variables = 0;               ///< Число переменных
+        int root = 0;                    ///< Литерал выхода
+    };
+
+    /**
+     * @brief Закодировать конус выхода по Цейтину
+     * @param graph Сеть
+     * @param gate Вентиль выхода
+     * @return КНФ
+     */
+    static Encoding encode(const LogicGraph& graph, int gate);
+
+    /**
+     * @brief Решить КНФ портфелем решателей
+     * @param encoding КНФ
+     * @param rootLiteral Литерал, который должен быть истинным
+     * @param result Сюда записываются итог, свидетель и счётчики
+     */
+    void solvePortfolio(const Encoding& encoding, int rootLiteral, Result& result) const;
+
+    int solvers = 1;          ///< Число решателей портфеля
+    qint64 conflictLimit = 0; ///< Предел конфликтов каждого решателя
+    quint32 seed = 1;         ///< Начальное значение генератора портфеля
+};
+
+#endif // SATCHECKER_H
@@ -0,0 +1,487 @@
+#include "SatSolver.h"
+#include <QElapsedTimer>
+#include <algorithm>
+
+// Константы.
+static constexpr qint8 FALSE_VALUE = 0;
+static constexpr qint8 TRUE_VALUE = 1;
+static constexpr qint8 UNDEFINED = 2;
+static constexpr double VARIABLE_DECAY = 0.95;
+static constexpr double CLAUSE_DECAY = 0.999;
+static constexpr double RESCALE_LIMIT = 1e100;
+static constexpr double RANDOM_FREQUENCY = 0.02;
+static constexpr int DEFAULT_RESTART_BASE = 100;
+static constexpr int MIN_LEARNED_LIMIT = 2000;
+static constexpr double LEARNED_GROWTH = 1.1;
+
+// Внутренняя запись литерала: 2·v + 1 для отрицания.
+static int internalLiteral(int literal)
+{
+    return literal > 0 ? 2 * (literal - 1) : 2 * (-literal - 1) + 1;
+}
+
+// Член последовательности Люби: 1, 1, 2, 1, 1, 2, 4, 1, ...
+static qint64 luby(qint64 index)
+{
+    qint64 size = 1;
+    int power = 0;
+    while (size < index + 1) {
+        ++power;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != index) {
+        size = (size - 1) / 2;
+        --power;
+        index %= size;
+    }
+    return qint64(1) << power;
+}
+
+// Конструктор.
+SatSolver::SatSolver(quint32 seed)
+    : randomState(seed * 2654435761u + 1)
+{
+    // Решатель с нулевым значением ведёт себя детерминированно,
+    // остальные отличаются случайными решениями и шагом перезапусков.
+    if (seed != 0) {
+        randomFrequency = RANDOM_FREQUENCY;
+        restartBase = DEFAULT_RESTART_BASE / 2 + static_cast<int>(nextRandom() % DEFAULT_RESTART_BASE);
+    } else {
+        restartBase = DEFAULT_RESTART_BASE;
+    }
+}
+
+// Добавить переменную.
+int SatSolver::newVariable()
+{
+    const int variable = static_cast<int>(assigns.size());
+    assigns.push_back(UNDEFINED);
+    levels.push_back(0);
+    reasons.push_back(-1);
+    phases.push_back(randomFrequency > 0 ? qint8(nextRandom() & 1) : FALSE_VALUE);
+    seen.push_back(0);
+    activity.push_back(randomFrequency > 0 ? (nextRandom() % 1000) * 1e-5 : 0.0);
+    heapPosition.push_back(-1);
+    watches.emplace_back();
+    watches.emplace_back();
+    heapInsert(variable);
+    ++stats.variables;
+    return variable + 1;
+}
+
+// Добавить дизъюнкт.
+void SatSolver::addClause(std::vector<int> literals)
+{
+    if (inconsistent)
+        return;
+
+    for (int& literal : literals)
+        literal = internalLiteral(literal);
+    std::sort(literals.begin(), literals.end());
+    literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+
+    // Дизъюнкт с v и -v всегда истинен; ложные на нулевом уровне
+    // литералы не нужны.
+    std::vector<int> kept;
+    for (size_t i = 0; i < literals.size(); ++i) {
+        if (i + 1 < literals.size() && (literals[i] ^ 1) == literals[i + 1])
+            return;
+        const int value = literalValue(literals[i]);
+        if (value == TRUE_VALUE)
+            return;
+        if (value == UNDEFINED)
+            kept.push_back(literals[i]);
+    }
+    ++stats.clauses;
+
+    if (kept.empty()) {
+        inconsistent = true;
+    } else if (kept.size() == 1) {
+        assign(kept.front(), -1);
+        inconsistent = propagate() >= 0;
+    } else {
+        clauses.push_back(Clause{std::move(kept)});
+        watch(static_cast<int>(clauses.size()) - 1);
+    }
+}
+
+// Найти выполняющий набор.
+SatSolver::Status SatSolver::solve(const std::atomic<bool>* stop, qint64 conflictLimit)
+{
+    QElapsedTimer timer;
+    timer.start();
+    model.clear();
+    cancelUntil(0);
+
+    auto finish = [this, &timer](Status status) {
+        stats.elapsedUs = timer.nsecsElapsed() / 1000;
+        return status;
+    };
+
+    if (inconsistent || propagate() >= 0) {
+        inconsistent = true;
+        return finish(Status::UNSATISFIABLE);
+    }
+
+    qint64 restartIndex = 0;
+    qint64 restartLimit = luby(restartIndex) * restartBase;
+    qint64 conflictsSinceRestart = 0;
+    double learnedLimit = std::max<double>(MIN_LEARNED_LIMIT, clauses.size() / 3.0);
+    qint64 learnedAlive = 0;
+    std::vector<int> learnt;
+
+    for (;;) {
+        const int conflict = propagate();
+        if (conflict >= 0) {
+            ++stats.conflicts;
+            ++conflictsSinceRestart;
+            if (trailLimits.empty()) {
+                inconsistent = true;
+                return finish(Status::UNSATISFIABLE);
+            }
+
+            const int backLevel = analyze(conflict, learnt);
+            cancelUntil(backLevel);
+            if (learnt.size() == 1) {
+                assign(learnt.front(), -1);
+            } else {
+                clauses.push_back(Clause{learnt, true, false, clauseIncrement});
+                const int index = static_cast<int>(clauses.size()) - 1;
+                watch(index);
+                assign(learnt.front(), index);
+                ++learnedAlive;
+            }
+            ++stats.learned;
+
+            variableIncrement /= VARIABLE_DECAY;
+            clauseIncrement /= CLAUSE_DECAY;
+            continue;
+        }
+
+        if (stop && stop->load(std::memory_order_relaxed))
+            return finish(Status::UNKNOWN);
+        if (conflictLimit > 0 && stats.conflicts >= conflictLimit)
+            return finish(Status::UNKNOWN);
+
+        if (conflictsSinceRestart >= restartLimit) {
+            cancelUntil(0);
+            ++stats.restarts;
+            conflictsSinceRestart = 0;
+            restartLimit = luby(++restartIndex) * restartBase;
+        }
+        if (learnedAlive - static_cast<qint64>(trail.size()) >= learnedLimit) {
+            const qint64 before = stats.deleted;
+            reduceLearned();
+            learnedAlive -= stats.deleted - before;
+            learnedLimit *= LEARNED_GROWTH;
+        }
+
+        const int variable = pickBranch();
+        if (variable < 0) {
+            model.resize(assigns.size());
+            for (size_t v = 0; v < assigns.size(); ++v)
+                model[v] = assigns[v] == TRUE_VALUE;
+            return finish(Status::SATISFIABLE);
+        }
+
+        ++stats.decisions;
+        trailLimits.push_back(static_cast<int>(trail.size()));
+        assign(2 * variable + (phases[variable] == TRUE_VALUE ? 0 : 1), -1);
+    }
+}
+
+// Значение переменной в найденном наборе.
+bool SatSolver::value(int variable) const
+{
+    const size_t index = static_cast<size_t>(variable - 1);
+    return index < model.size() && model[index];
+}
+
+// Счётчики последнего поиска.
+SatSolver::Statistics SatSolver::statistics() const
+{
+    return stats;
+}
+
+// Значение литерала.
+int SatSolver::literalValue(int literal) const
+{
+    const qint8 value = assigns[literal >> 1];
+    return value == UNDEFINED ? UNDEFINED : (value ^ (literal & 1));
+}
+
+// Присвоить литералу значение «истина».
+void SatSolver::assign(int literal, int reason)
+{
+    const int variable = literal >> 1;
+    assigns[variable] = (literal & 1) ? FALSE_VALUE : TRUE_VALUE;
+    levels[variable] = static_cast<int>(trailLimits.size());
+    reasons[variable] = reason;
+    trail.push_back(literal);
+}
+
+// Распространить присвоенные значения.
+int SatSolver::propagate()
+{
+    while (propagated < trail.size()) {
+        const int falseLiteral = trail[propagated++] ^ 1;
+        std::vector<int>& list = watches[falseLiteral];
+        size_t keep = 0;
+        for (size_t i = 0; i < list.size(); ++i) {
+            const int index = list[i];
+            std::vector<int>& literals = clauses[index].literals;
+            if (literals[0] == falseLiteral)
+                std::swap(literals[0], literals[1]);
+
+            if (literalValue(literals[0]) == TRUE_VALUE) {
+                list[keep++] = index;
+                continue;
+            }
+
+            // Новый наблюдаемый литерал среди не ложных.
+            bool moved = false;
+            for (size_t k = 2; k < literals.size(); ++k) {
+                if (literalValue(literals[k]) != FALSE_VALUE) {
+                    std::swap(literals[1], literals[k]);
+                    watches[literals[1]].push_back(index);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved)
+                continue;
+
+            list[keep++] = index;
+            if (literalValue(literals[0]) == FALSE_VALUE) {
+                for (++i; i < list.size(); ++i)
+                    list[keep++] = list[i];
+                list.resize(keep);
+                propagated = trail.size();
+                return index;
+            }
+            assign(literals[0], index);
+            ++stats.propagations;
+        }
+        list.resize(keep);
+    }
+    return -1;
+}
+
+// Выучить дизъюнкт из конфликта.
+int SatSolver::analyze(int conflict, std::vector<int>& learnt)
+{
+    learnt.assign(1, -1);
+    const int level = static_cast<int>(trailLimits.size());
+    int pending = 0;
+    int literal = -1;
+    size_t position = trail.size();
+    int reason = conflict;
+
+    // Литералы текущего уровня заменяются их причинами, пока
+    // не останется один — первая точка сходимости.
+    do {
+        Clause& clause = clauses[reason];
+        if (clause.learned) {
+            clause.activity += clauseIncrement;
+            if (clause.activity > RESCALE_LIMIT) {
+                for (Clause& c : clauses)
+                    c.activity /= RESCALE_LIMIT;
+                clauseIncrement /= RESCALE_LIMIT;
+            }
+        }
+        for (size_t k = (literal < 0 ? 0 : 1); k < clause.literals.size(); ++k) {
+            const int q = clause.literals[k];
+            const int variable = q >> 1;
+            if (seen[variable] || levels[variable] == 0)
+                continue;
+            seen[variable] = 1;
+            bumpVariable(variable);
+            if (levels[variable] >= level)
+                ++pending;
+            else
+                learnt.push_back(q);
+        }
+
+        while (!seen[trail[position - 1] >> 1])
+            --position;
+        literal = trail[--position];
+        reason = reasons[literal >> 1];
+        seen[literal >> 1] = 0;
+        --pending;
+    } while (pending > 0);
+    learnt[0] = literal ^ 1;
+
+    int backLevel = 0;
+    size_t highest = 1;
+    for (size_t k = 1; k < learnt.size(); ++k) {
+        seen[learnt[k] >> 1] = 0;
+        if (levels[learnt[k] >> 1] > backLevel) {
+            backLevel = levels[learnt[k] >> 1];
+            highest = k;
+        }
+    }
+    if (learnt.size() > 1)
+        std::swap(learnt[1], learnt[highest]);
+    return backLevel;
+}
+
+// Отменить присваивания выше уровня.
+void SatSolver::cancelUntil(int level)
+{
+    if (static_cast<int>(trailLimits.size()) <= level)
+        return;
+
+    const size_t start = static_cast<size_t>(trailLimits[level]);
+    for (size_t i = trail.size(); i-- > start;) {
+        const int variable = trail[i] >> 1;
+        phases[variable] = assigns[variable];
+        assigns[variable] = UNDEFINED;
+        reasons[variable] = -1;
+        if (heapPosition[variable] < 0)
+            heapInsert(variable);
+    }
+    trail.resize(start);
+    trailLimits.resize(level);
+    propagated = trail.size();
+}
+
+// Выбрать переменную решения.
+int SatSolver::pickBranch()
+{
+    if (randomFrequency > 0 && !heap.empty()
+        && (nextRandom() % 1000000) < randomFrequency * 1000000) {
+        const int variable = heap[nextRandom() % heap.size()];
+        if (assigns[variable] == UNDEFINED)
+            return variable;
+    }
+    while (!heap.empty()) {
+        const int variable = heapPop();
+        if (assigns[variable] == UNDEFINED)
+            return variable;
+    }
+    return -1;
+}
+
+// Удалить половину малоактивных выученных дизъюнктов.
+void SatSolver::reduceLearned()
+{
+    // Дизъюнкт, служащий причиной присваивания, и двухлитеральные
+    // дизъюнкты не удаляются.
+    std::vector<int> candidates;
+    for (size_t i = 0; i < clauses.size(); ++i) {
+        const Clause& clause = clauses[i];
+        if (!clause.learned || clause.deleted || clause.literals.size() <= 2)
+            continue;
+        const int first = clause.literals[0];
+        if (reasons[first >> 1] == static_cast<int>(i) && literalValue(first) == TRUE_VALUE)
+            continue;
+        candidates.push_back(static_cast<int>(i));
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+        return clauses[a].activity < clauses[b].activity;
+    });
+    for (size_t i = 0; i < candidates.size() / 2; ++i) {
+        Clause& clause = clauses[candidates[i]];
+        clause.deleted = true;
+        std::vector<int>().swap(clause.literals);
+        ++stats.deleted;
+    }
+
+    for (std::vector<int>& list : watches)
+        list.clear();
+    for (size_t i = 0; i < clauses.size(); ++i) {
+        if (!clauses[i].deleted)
+            watch(static_cast<int>(i));
+    }
+}
+
+// Добавить дизъюнкт в списки наблюдения.
+void SatSolver::watch(int index)
+{
+    const std::vector<int>& literals = clauses[index].literals;
+    watches[literals[0]].push_back(index);
+    watches[literals[1]].push_back(index);
+}
+
+// Увеличить активность переменной.
+void SatSolver::bumpVariable(int variable)
+{
+    activity[variable] += variableIncrement;
+    if (activity[variable] > RESCALE_LIMIT) {
+        for (double& a : activity)
+            a /= RESCALE_LIMIT;
+        variableIncrement /= RESCALE_LIMIT;
+    }
+    if (heapPosition[variable] >= 0)
+        heapUp(variable);
+}
+
+// Следующее случайное число.
+quint32 SatSolver::nextRandom()
+{
+    // xorshift32.
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+// Поднять переменную в куче активности.
+void SatSolver::heapUp(int variable)
+{
+    int position = heapPosition[variable];
+    while (position > 0) {
+        const int parent = (position - 1) / 2;
+        if (activity[heap[parent]] >= activity[variable])
+            break;
+        heap[position] = heap[parent];
+        heapPosition[heap[position]] = position;
+        position = parent;
+    }
+    heap[position] = variable;
+    heapPosition[variable] = position;
+}
+
+// Опустить элемент кучи активности.
+void SatSolver::heapDown(int position)
+{
+    const int variable = heap[position];
+    const int size = static_cast<int>(heap.size());
+    for (;;) {
+        int child = 2 * position + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && activity[heap[child + 1]] > activity[heap[child]])
+            ++child;
+        if (activity[heap[child]] <= activity[variable])
+            break;
+        heap[position] = heap[child];
+        heapPosition[heap[position]] = position;
+        position = child;
+    }
+    heap[position] = variable;
+    heapPosition[variable] = position;
+}
+
+// Вставить переменную в кучу активности.
+void SatSolver::heapInsert(int variable)
+{
+    heapPosition[variable] = static_cast<int>(heap.size());
+    heap.push_back(variable);
+    heapUp(variable);
+}
+
+// Извлечь самую активную переменную.
+int SatSolver::heapPop()
+{
+    const int top = heap.front();
+    heapPosition[top] = -1;
+    const int last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        heap[0] = last;
+        heapPosition[last] = 0;
+        heapDown(0);
+    }
+    return top;
+}
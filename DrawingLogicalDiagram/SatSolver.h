@@ -0,0 +1,224 @@
+#ifndef SATSOLVER_H
+#define SATSOLVER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+/**
+ * @class SatSolver
+ * @brief Решатель задачи выполнимости КНФ методом CDCL
+ *
+ * Ищет набор значений переменных, при котором истинны все дизъюнкты,
+ * или доказывает, что такого набора нет. Переменные нумеруются с 1,
+ * литерал — номер переменной со знаком (как в формате DIMACS).
+ *
+ * @details
+ * - Распространение единичных дизъюнктов по двум наблюдаемым литералам.
+ * - Анализ конфликта до первой точки сходимости (1UIP), выученный
+ *   дизъюнкт и возврат сразу на уровень его второго литерала.
+ * - Выбор переменной по активности (VSIDS) с сохранением фазы;
+ *   перезапуски по последовательности Люби.
+ * - Половина малоактивных выученных дизъюнктов периодически удаляется.
+ * - Начальное значение генератора меняет начальные фазы, долю
+ *   случайных решений и шаг перезапусков, поэтому решатели с разными
+ *   значениями идут разными путями — на этом построен портфель
+ *   SatChecker.
+ * - Поиск прерывается по внешнему флагу остановки или по пределу
+ *   числа конфликтов.
+ */
+class SatSolver {
+public:
+    /**
+     * @enum Status
+     * @brief Итог поиска
+     */
+    enum class Status {
+        SATISFIABLE,    ///< Найден выполняющий набор
+        UNSATISFIABLE,  ///< Выполняющего набора нет
+        UNKNOWN         ///< Поиск прерван
+    };
+
+    /**
+     * @struct Statistics
+     * @brief Счётчики поиска
+     */
+    struct Statistics
+    {
+        int variables = 0;        ///< Число переменных
+        int clauses = 0;          ///< Число исходных дизъюнктов
+        qint64 decisions = 0;     ///< Число решений
+        qint64 propagations = 0;  ///< Число выведенных значений
+        qint64 conflicts = 0;     ///< Число конфликтов
+        qint64 learned = 0;       ///< Число выученных дизъюнктов
+        qint64 deleted = 0;       ///< Удалено выученных дизъюнктов
+        qint64 restarts = 0;      ///< Число перезапусков
+        qint64 elapsedUs = 0;     ///< Время поиска, мкс
+    };
+
+    /**
+     * @brief Конструктор
+     * @param seed Начальное значение генератора; 0 — без случайных решений
+     */
+    explicit SatSolver(quint32 seed = 0);
+
+    /**
+     * @brief Добавить переменную
+     * @return Номер новой переменной (с 1)
+     */
+    int newVariable();
+
+    /**
+     * @brief Добавить дизъюнкт
+     * @param literals Литералы: v — переменная v, -v — её отрицание
+     *
+     * Повторы литералов убираются, дизъюнкт с v и -v отбрасывается.
+     * Дизъюнкты добавляются до вызова solve().
+     */
+    void addClause(std::vector<int> literals);
+
+    /**
+     * @brief Найти выполняющий набор
+     * @param stop Флаг остановки (nullptr — не проверяется)
+     * @param conflictLimit Предел числа конфликтов; 0 — без предела
+     * @return Итог поиска
+     */
+    Status solve(const std::atomic<bool>* stop = nullptr, qint64 conflictLimit = 0);
+
+    /**
+     * @brief Значение переменной в найденном наборе
+     * @param variable Номер переменной
+     * @return Значение; после итога, отличного от SATISFIABLE, — false
+     */
+    bool value(int variable) const;
+
+    /**
+     * @brief Счётчики последнего поиска
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+private:
+    /**
+     * @struct Clause
+     * @brief Дизъюнкт; наблюдаемые литералы — первые два
+     */
+    struct Clause
+    {
+        std::vector<int> literals;  ///< Литералы во внутренней записи
+        bool learned = false;       ///< Выучен при анализе конфликта
+        bool deleted = false;       ///< Удалён при чистке
+        double activity = 0.0;      ///< Активность выученного дизъюнкта
+    };
+
+    /**
+     * @brief Значение литерала
+     * @param literal Литерал во внутренней записи (2·v + знак)
+     * @return TRUE_VALUE, FALSE_VALUE или UNDEFINED
+     */
+    int literalValue(int literal) const;
+
+    /**
+     * @brief Присвоить литералу значение «истина»
+     * @param literal Литерал
+     * @param reason Дизъюнкт-причина или -1 для решения
+     */
+    void assign(int literal, int reason);
+
+    /**
+     * @brief Распространить присвоенные значения
+     * @return Индекс конфликтного дизъюнкта или -1
+     */
+    int propagate();
+
+    /**
+     * @brief Выучить дизъюнкт из конфликта
+     * @param conflict Конфликтный дизъюнкт
+     * @param learnt Сюда записывается выученный дизъюнкт (первый литерал — утверждаемый)
+     * @return Уровень возврата
+     */
+    int analyze(int conflict, std::vector<int>& learnt);
+
+    /**
+     * @brief Отменить присваивания выше уровня
+     * @param level Уровень, который остаётся
+     */
+    void cancelUntil(int level);
+
+    /**
+     * @brief Выбрать переменную решения
+     * @return Переменная или -1, если все присвоены
+     */
+    int pickBranch();
+
+    /**
+     * @brief Удалить половину малоактивных выученных дизъюнктов
+     */
+    void reduceLearned();
+
+    /**
+     * @brief Добавить дизъюнкт в списки наблюдения
+     * @param index Индекс дизъюнкта
+     */
+    void watch(int index);
+
+    /**
+     * @brief Увеличить активность переменной
+     * @param variable Переменная (с 0)
+     */
+    void bumpVariable(int variable);
+
+    /**
+     * @brief Следующее случайное число
+     * @return Псевдослучайное 32-битное число
+     */
+    quint32 nextRandom();
+
+    /**
+     * @brief Поднять переменную в куче активности
+     * @param variable Переменная (с 0)
+     */
+    void heapUp(int variable);
+
+    /**
+     * @brief Опустить элемент кучи активности
+     * @param position Позиция в куче
+     */
+    void heapDown(int position);
+
+    /**
+     * @brief Вставить переменную в кучу активности
+     * @param variable Переменная (с 0)
+     */
+    void heapInsert(int variable);
+
+    /**
+     * @brief Извлечь самую активную переменную
+     * @return Переменная (с 0)
+     */
+    int heapPop();
+
+    std::vector<Clause> clauses;            ///< Исходные и выученные дизъюнкты
+    std::vector<std::vector<int>> watches;  ///< Дизъюнкты, наблюдающие литерал
+    std::vector<qint8> assigns;             ///< Значение переменной или UNDEFINED
+    std::vector<int> levels;                ///< Уровень присваивания переменной
+    std::vector<int> reasons;               ///< Дизъюнкт-причина переменной или -1
+    std::vector<qint8> phases;              ///< Сохранённая фаза переменной
+    std::vector<char> seen;                 ///< Отметки анализа конфликта
+    std::vector<double> activity;           ///< Активность переменной
+    std::vector<int> heap;                  ///< Куча переменных по активности
+    std::vector<int> heapPosition;          ///< Позиция переменной в куче или -1
+    std::vector<int> trail;                 ///< Присвоенные литералы по порядку
+    std::vector<int> trailLimits;           ///< Начало каждого уровня в trail
+    std::vector<bool> model;                ///< Найденный набор
+    size_t propagated = 0;                  ///< Число распространённых литералов trail
+    double variableIncrement = 1.0;         ///< Шаг активности переменных
+    double clauseIncrement = 1.0;           ///< Шаг активности дизъюнктов
+    double randomFrequency = 0.0;           ///< Доля случайных решений
+    int restartBase = 0;                    ///< Конфликтов в единице последовательности Люби
+    quint32 randomState = 0;                ///< Состояние генератора
+    bool inconsistent = false;              ///< Противоречие найдено при добавлении
+    Statistics stats;                       ///< Счётчики
+};
+
+#endif // SATSOLVER_H
@@ -0,0 +1,318 @@
+#include "SchemaDocument.h"
+#include "LogicGraph.h"
+#include "ParallelParser.h"
+#include "SchemaProgram.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QPainter>
+#include <QSaveFile>
+#include <QStringList>
+
+// Конструктор.
+SchemaDocument::SchemaDocument(DiagramCache* cache)
+    : cache(cache)
+{}
+
+// Открыть выражение.
+bool SchemaDocument::open(const QString& text, TreeRebalancer* rebalancer, PassManager* passes,
+                          int collapseDepth, std::unique_ptr<SchemaTree> parsed)
+{
+    ++stats.opens;
+
+    QStringList parts;
+    if (passes)
+        parts << QString("passes:%1").arg(passes->pipeline());
+    if (rebalancer)
+        parts << QString("rebalance:%1").arg(rebalancer->maxFanin());
+    if (collapseDepth > 0)
+        parts << QString("collapse:%1").arg(collapseDepth);
+    const QString key = parts.join(';');
+
+    if (sceneData && text == source && key == options) {
+        ++stats.reused;
+        return false;
+    }
+
+    clear();
+    source = text;
+    options = key;
+    pipeline = passes ? passes->pipeline() : QString();
+    maxFanin = rebalancer ? rebalancer->maxFanin() : -1;
+
+    // Компоновка не зависит от размера окна, поэтому он не входит в ключ.
+    QByteArray cacheKey;
+    if (cache) {
+        cacheKey = DiagramCache::makeKey(text, options);
+        DiagramLayout cached;
+        if (cache->load(cacheKey, cached)) {
+            layoutData = std::make_unique<DiagramLayout>(std::move(cached));
+            sceneData.reset(layoutData->toScene());
+            parsedTree = std::move(parsed);
+            ++stats.cacheHits;
+            return true;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    bool cacheable = true;
+
+    if (LogicGraph::isEquationList(text)) {
+        // Схема с ошибкой всё равно рисуется из того, что удалось
+        // разобрать, но в кэш не попадает и сетью не считается.
+        QString message;
+        LogicGraph graph = LogicGraph::fromEquations(text, &message);
+        error = message;
+        cacheable = message.isEmpty();
+
+        GraphDiagram diagram(graph);
+        sceneData.reset(diagram.buildScene());
+        graphStats = diagram.statistics();
+        if (cacheable)
+            graphData = std::make_unique<LogicGraph>(std::move(graph));
+    } else {
+        if (!parsed) {
+            parsed = ParallelParser::makeTree(text);
+            ++stats.parses;
+        }
+        drawnTree = prepare(std::move(parsed), rebalancer, passes);
+        stats.parseUs = timer.nsecsElapsed() / 1000;
+
+        DrawingDiagram::Expansion expansion;
+        expansion.depth = collapseDepth;
+        DrawingDiagram diagram(drawnTree->getRoot());
+        diagram.setExpansion(expansion);
+        sceneData.reset(diagram.buildScene());
+        treeStats = diagram.statistics();
+    }
+
+    ++stats.layouts;
+    stats.layoutUs = timer.nsecsElapsed() / 1000 - stats.parseUs;
+
+    if (cache && cacheable)
+        cache->store(cacheKey, layout());
+    return true;
+}
+
+// Закрыть документ и удалить сцену.
+void SchemaDocument::clear()
+{
+    source.clear();
+    options.clear();
+    pipeline.clear();
+    maxFanin = -1;
+    parsedTree.reset();
+    drawnTree.reset();
+    graphData.reset();
+    layoutData.reset();
+    sceneData.reset();
+    graphStats = GraphDiagram::Statistics();
+    treeStats = DrawingDiagram::Statistics();
+    stats.parseUs = 0;
+    stats.layoutUs = 0;
+    error.clear();
+}
+
+// Показать сцену в view и вписать её в окно.
+void SchemaDocument::show(QGraphicsView* view)
+{
+    SchemaProgram::showScene(sceneData.get(), view);
+}
+
+// Заново вписать показанную сцену после изменения размера view.
+void SchemaDocument::fit(QGraphicsView* view)
+{
+    if (!isShownIn(view))
+        return;
+    SchemaProgram::fitView(view);
+    ++stats.fits;
+}
+
+// Показывает ли view сцену документа.
+bool SchemaDocument::isShownIn(const QGraphicsView* view) const
+{
+    return sceneData && view->scene() == sceneData.get();
+}
+
+// Текст открытого выражения.
+QString SchemaDocument::text() const
+{
+    return source;
+}
+
+// Дерево, по которому нарисована схема.
+const SchemaTree* SchemaDocument::tree()
+{
+    if (drawnTree || !sceneData || LogicGraph::isEquationList(source))
+        return drawnTree.get();
+
+    // Сцена взята из кэша: дерево обрабатывается так же, как при построении.
+    QElapsedTimer timer;
+    timer.start();
+    if (!parsedTree) {
+        parsedTree = ParallelParser::makeTree(source);
+        ++stats.parses;
+    }
+
+    PassManager passes;
+    TreeRebalancer rebalancer;
+    if (maxFanin >= 0)
+        rebalancer.setMaxFanin(maxFanin);
+    drawnTree = prepare(std::move(parsedTree),
+                        maxFanin >= 0 ? &rebalancer : nullptr,
+                        !pipeline.isEmpty() && passes.setPipeline(pipeline) ? &passes : nullptr);
+    stats.parseUs = timer.nsecsElapsed() / 1000;
+    return drawnTree.get();
+}
+
+// Перестроить сцену по дереву документа.
+bool SchemaDocument::redraw(const DrawingDiagram::Expansion& expansion, SearchIndex* index)
+{
+    const SchemaTree* drawn = tree();
+    if (!drawn)
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool indexTree = index && index->isEmpty();
+    if (index)
+        index->clearItems();
+
+    DrawingDiagram diagram(drawn->getRoot());
+    diagram.setSearchIndex(index);
+    diagram.setExpansion(expansion);
+    if (QGraphicsScene* previous = sceneData.release())
+        previous->deleteLater();
+    sceneData.reset(diagram.buildScene());
+    layoutData.reset();
+    treeStats = diagram.statistics();
+    if (indexTree)
+        index->build(drawn->getRoot());
+
+    ++stats.layouts;
+    stats.layoutUs = timer.nsecsElapsed() / 1000;
+    return true;
+}
+
+// Сеть, по которой нарисована схема.
+const LogicGraph* SchemaDocument::graph()
+{
+    if (graphData || !sceneData)
+        return graphData.get();
+
+    if (LogicGraph::isEquationList(source)) {
+        QString message;
+        LogicGraph parsed = LogicGraph::fromEquations(source, &message);
+        if (!message.isEmpty()) {
+            error = message;
+            return nullptr;
+        }
+        graphData = std::make_unique<LogicGraph>(std::move(parsed));
+    } else {
+        const SchemaTree* drawn = tree();
+        if (!drawn || !drawn->getRoot()) {
+            error = "Пустое выражение";
+            return nullptr;
+        }
+        graphData = std::make_unique<LogicGraph>(LogicGraph::fromTree(drawn->getRoot(), "Y"));
+    }
+    return graphData.get();
+}
+
+// Компоновка сцены.
+const DiagramLayout& SchemaDocument::layout()
+{
+    if (!layoutData)
+        layoutData = std::make_unique<DiagramLayout>(sceneData ? DiagramLayout::fromScene(sceneData.get())
+                                                               : DiagramLayout());
+    return *layoutData;
+}
+
+// Сцена документа.
+QGraphicsScene* SchemaDocument::scene() const
+{
+    return sceneData.get();
+}
+
+// Сохранить схему в файл.
+bool SchemaDocument::save(const QString& fileName)
+{
+    error.clear();
+    if (!sceneData) {
+        error = "Схема не построена";
+        return false;
+    }
+    if (QFileInfo(fileName).suffix().compare("svg", Qt::CaseInsensitive) == 0)
+        return writeSvg(layout(), fileName, &error);
+    return save(sceneData.get(), fileName, &error);
+}
+
+// Сохранить произвольную сцену в файл.
+bool SchemaDocument::save(QGraphicsScene* scene, const QString& fileName, QString* error)
+{
+    if (QFileInfo(fileName).suffix().compare("svg", Qt::CaseInsensitive) == 0)
+        return writeSvg(DiagramLayout::fromScene(scene), fileName, error);
+
+    QImage image(scene->sceneRect().size().toSize(), QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    scene->render(&painter);
+    painter.end();
+
+    if (!image.save(fileName)) {
+        if (error)
+            *error = QString("Не удалось записать изображение %1").arg(fileName);
+        return false;
+    }
+    return true;
+}
+
+// Записать SVG в файл.
+bool SchemaDocument::writeSvg(const DiagramLayout& layout, const QString& fileName, QString* error)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(layout.toSvg()) < 0 || !file.commit()) {
+        if (error)
+            *error = QString("Не удалось записать файл %1: %2").arg(fileName, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+// Описание последней ошибки.
+QString SchemaDocument::errorString() const
+{
+    return error;
+}
+
+// Статистика послойной компоновки.
+GraphDiagram::Statistics SchemaDocument::graphStatistics() const
+{
+    return graphStats;
+}
+
+// Статистика построения схемы дерева.
+DrawingDiagram::Statistics SchemaDocument::treeStatistics() const
+{
+    return treeStats;
+}
+
+// Счётчики работы документа.
+SchemaDocument::Statistics SchemaDocument::statistics() const
+{
+    return stats;
+}
+
+// Применить проходы и балансировку к разобранному дереву.
+std::unique_ptr<SchemaTree> SchemaDocument::prepare(std::unique_ptr<SchemaTree> parsed,
+                                                    TreeRebalancer* rebalancer, PassManager* passes)
+{
+    if (passes)
+        parsed = std::make_unique<SchemaTree>(passes->run(parsed->takeRoot()));
+    if (rebalancer)
+        parsed = std::make_unique<SchemaTree>(rebalancer->rebalance(parsed->takeRoot()));
+    return parsed;
+}
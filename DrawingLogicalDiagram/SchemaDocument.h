@@ -0,0 +1,239 @@
+#ifndef SCHEMADOCUMENT_H
+#define SCHEMADOCUMENT_H
+
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QString>
+#include <QtGlobal>
+#include <memory>
+#include "DiagramCache.h"
+#include "DiagramLayout.h"
+#include "DrawingDiagram.h"
+#include "GraphDiagram.h"
+#include "LogicGraph.h"
+#include "PassManager.h"
+#include "SchemaTree.h"
+#include "TreeRebalancer.h"
+
+/**
+ * @class SchemaDocument
+ * @brief Открытая схема: разобранное дерево, компоновка и сцена
+ *
+ * Живёт между нажатиями "Execute", изменениями размера окна
+ * и сохранениями, поэтому выражение разбирается и компонуется
+ * один раз.
+ *
+ * @details
+ * - Повторное открытие того же текста с теми же параметрами
+ *   отрисовки ничего не перестраивает.
+ * - Компоновка не зависит от размера окна (элементы постоянного
+ *   размера), поэтому при изменении размера view схема только
+ *   заново вписывается в окно — без разбора и без новой сцены.
+ *   По той же причине размер окна не входит в ключ кэша.
+ * - При попадании в дисковый кэш сцена восстанавливается
+ *   из компоновки, а дерево разбирается только при первом
+ *   обращении к tree().
+ * - Команды над схемой (экспорт, моделирование, анализ) берут
+ *   tree() и graph() документа, а не разбирают поле ввода заново.
+ * - Ошибка в списке уравнений не мешает нарисовать разобранную
+ *   часть, но остаётся в errorString(), а graph() для такой
+ *   схемы возвращает nullptr.
+ * - Изображение сохраняется с готовой сцены, SVG — из компоновки
+ *   DiagramLayout, которая снимается со сцены один раз и та же
+ *   записывается в кэш.
+ * - Документ владеет сценой; view, показывающий её, сбрасывается
+ *   при удалении сцены средствами Qt.
+ * - redraw() перестраивает сцену по тому же дереву, например вместе
+ *   с индексом поиска или со свёрнутыми поддеревьями; такая сцена
+ *   в кэш не записывается и живёт до следующего построения.
+ */
+class SchemaDocument {
+public:
+    /**
+     * @struct Statistics
+     * @brief Счётчики работы документа
+     */
+    struct Statistics
+    {
+        int opens = 0;        ///< Вызовов open()
+        int reused = 0;       ///< Из них без перестроения
+        int parses = 0;       ///< Разборов выражения
+        int layouts = 0;      ///< Построений компоновки
+        int cacheHits = 0;    ///< Сцен, восстановленных из кэша
+        int fits = 0;         ///< Вписываний в окно без перестроения
+        qint64 parseUs = 0;   ///< Время последнего разбора с проходами, мкс
+        qint64 layoutUs = 0;  ///< Время последнего построения сцены, мкс
+    };
+
+    /**
+     * @brief Конструктор
+     * @param cache Дисковый кэш компоновок (nullptr — без кэша)
+     */
+    explicit SchemaDocument(DiagramCache* cache = nullptr);
+
+    /**
+     * @brief Открыть выражение
+     * @param text Выражение или список уравнений
+     * @param rebalancer Уменьшение глубины дерева перед отрисовкой (nullptr — без него)
+     * @param passes Конвейер переписывающих проходов, выполняется до rebalancer (nullptr — без него)
+     * @param collapseDepth Уровней операторов, раскрытых в схеме дерева; 0 — все
+     * @param parsed Уже разобранное дерево text (nullptr — разобрать при необходимости)
+     * @return true, если схема построена заново; false, если открыт тот же документ
+     *
+     * Отчёты rebalancer и passes заполняются, только если дерево
+     * действительно обрабатывалось. Ошибка в списке уравнений
+     * доступна через errorString().
+     */
+    bool open(const QString& text, TreeRebalancer* rebalancer = nullptr, PassManager* passes = nullptr,
+              int collapseDepth = 0, std::unique_ptr<SchemaTree> parsed = nullptr);
+
+    /**
+     * @brief Закрыть документ и удалить сцену
+     */
+    void clear();
+
+    /**
+     * @brief Показать сцену в view и вписать её в окно
+     * @param view View для отображения схемы
+     */
+    void show(QGraphicsView* view);
+
+    /**
+     * @brief Заново вписать показанную сцену после изменения размера view
+     * @param view View, показывающий сцену документа
+     */
+    void fit(QGraphicsView* view);
+
+    /**
+     * @brief Показывает ли view сцену документа
+     * @param view View
+     * @return true, если сцена view — сцена документа
+     */
+    bool isShownIn(const QGraphicsView* view) const;
+
+    /**
+     * @brief Текст открытого выражения
+     * @return Текст или пустая строка
+     */
+    QString text() const;
+
+    /**
+     * @brief Дерево, по которому нарисована схема
+     * @return Дерево после проходов и балансировки; nullptr для списка уравнений
+     *
+     * После попадания в кэш дерево разбирается при первом вызове.
+     */
+    const SchemaTree* tree();
+
+    /**
+     * @brief Сеть, по которой нарисована схема
+     * @return Сеть уравнений или дерева документа (выход "Y");
+     *         nullptr, если документ пуст или содержит ошибку (см. errorString())
+     *
+     * Сеть дерева строится при первом вызове.
+     */
+    const LogicGraph* graph();
+
+    /**
+     * @brief Перестроить сцену по дереву документа
+     * @param expansion Свёрнутые и раскрытые поддеревья
+     * @param index Индекс поиска, заполняемый по новой сцене (nullptr — без индекса)
+     * @return true, если сцена построена; false, если дерева нет
+     *
+     * Непустой индекс считается построенным по tree(): в нём
+     * обновляются только элементы сцены. Прежняя сцена удаляется
+     * через deleteLater(), поэтому redraw() можно вызывать
+     * из обработчика событий её элементов.
+     */
+    bool redraw(const DrawingDiagram::Expansion& expansion, SearchIndex* index = nullptr);
+
+    /**
+     * @brief Компоновка сцены
+     * @return Компоновка (снимается со сцены при первом вызове)
+     */
+    const DiagramLayout& layout();
+
+    /**
+     * @brief Сцена документа
+     * @return Сцена или nullptr, если документ пуст
+     */
+    QGraphicsScene* scene() const;
+
+    /**
+     * @brief Сохранить схему в файл
+     * @param fileName Путь; *.svg пишется из компоновки, остальное — изображение сцены
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool save(const QString& fileName);
+
+    /**
+     * @brief Сохранить произвольную сцену в файл
+     * @param scene Сцена
+     * @param fileName Путь; *.svg или формат изображения по расширению
+     * @param error Сюда записывается описание ошибки (может быть nullptr)
+     * @return true при успехе
+     */
+    static bool save(QGraphicsScene* scene, const QString& fileName, QString* error = nullptr);
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Статистика послойной компоновки
+     * @return Время этапов; пустая, если схема строилась деревом или взята из кэша
+     */
+    GraphDiagram::Statistics graphStatistics() const;
+
+    /**
+     * @brief Статистика построения схемы дерева
+     * @return Число элементов, свёрнутых поддеревьев и время; пустая,
+     *         если схема строилась по сети или взята из кэша
+     */
+    DrawingDiagram::Statistics treeStatistics() const;
+
+    /**
+     * @brief Счётчики работы документа
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+private:
+    /**
+     * @brief Применить проходы и балансировку к разобранному дереву
+     * @param parsed Дерево разбора
+     * @param rebalancer Балансировка (nullptr — без неё)
+     * @param passes Проходы (nullptr — без них)
+     * @return Дерево для отрисовки
+     */
+    static std::unique_ptr<SchemaTree> prepare(std::unique_ptr<SchemaTree> parsed,
+                                               TreeRebalancer* rebalancer, PassManager* passes);
+
+    /**
+     * @brief Записать SVG в файл
+     * @param layout Компоновка
+     * @param fileName Путь
+     * @param error Сюда записывается описание ошибки (может быть nullptr)
+     * @return true при успехе
+     */
+    static bool writeSvg(const DiagramLayout& layout, const QString& fileName, QString* error);
+
+    DiagramCache* cache = nullptr;                ///< Дисковый кэш компоновок
+    QString source;                               ///< Текст выражения
+    QString options;                              ///< Параметры отрисовки (часть ключа кэша)
+    QString pipeline;                             ///< Конвейер проходов или пустая строка
+    int maxFanin = -1;                            ///< Предел балансировки; -1 — без неё
+    std::unique_ptr<SchemaTree> parsedTree;       ///< Дерево разбора, ещё не обработанное
+    std::unique_ptr<SchemaTree> drawnTree;        ///< Дерево, по которому нарисована схема
+    std::unique_ptr<LogicGraph> graphData;        ///< Сеть схемы (строится по запросу)
+    std::unique_ptr<DiagramLayout> layoutData;    ///< Компоновка сцены
+    std::unique_ptr<QGraphicsScene> sceneData;    ///< Сцена
+    GraphDiagram::Statistics graphStats;          ///< Статистика послойной компоновки
+    DrawingDiagram::Statistics treeStats;         ///< Статистика построения схемы дерева
+    Statistics stats;                             ///< Счётчики
+    QString error;                                ///< Текст последней ошибки
+};
+
+#endif // SCHEMADOCUMENT_H
@@ -1,14 +1,87 @@
 #include "SchemaProgram.h"
 #include "DrawingDiagram.h"
+#include "GraphDiagram.h"
+#include <algorithm>
 
-// Конструктор программы построения схемы.
-SchemaProgram::SchemaProgram(const QString& text, QGraphicsView* view)
+// Константы.
+static constexpr qreal MIN_VIEW_SCALE = 0.5;
+
+// Конструктор программы построения схемы по готовому дереву.
+SchemaProgram::SchemaProgram(const SchemaTree& tree, QGraphicsView* view,
+                             const QSet<const SchemaTree::Node*>& highlighted,
+                             SearchIndex* index, const DrawingDiagram::Expansion& expansion)
 {
-    SchemaTree tree(text);
-    DrawingDiagram diagram(tree.getRoot(), view);
+    const bool indexTree = index && index->isEmpty();
+    if (index)
+        index->clearItems();
+
+    DrawingDiagram diagram(tree.getRoot());
+    diagram.setHighlightedNodes(highlighted);
+    diagram.setSearchIndex(index);
+    diagram.setExpansion(expansion);
+    QGraphicsScene* scene = diagram.buildScene();
+    scene->setParent(view);
+    showScene(scene, view);
+    treeStats = diagram.statistics();
 
+    if (indexTree)
+        index->build(tree.getRoot());
+}
+
+// Конструктор программы построения схемы по сети с несколькими выходами.
+SchemaProgram::SchemaProgram(const LogicGraph& graph, QGraphicsView* view)
+{
+    GraphDiagram diagram(graph);
     QGraphicsScene* scene = diagram.buildScene();
+    scene->setParent(view);
+    showScene(scene, view);
+    graphStats = diagram.statistics();
+}
+
+// Статистика послойной компоновки.
+GraphDiagram::Statistics SchemaProgram::graphStatistics() const
+{
+    return graphStats;
+}
+
+// Статистика построения схемы дерева.
+DrawingDiagram::Statistics SchemaProgram::treeStatistics() const
+{
+    return treeStats;
+}
+
+// Показать сцену в view.
+void SchemaProgram::showScene(QGraphicsScene* scene, QGraphicsView* view)
+{
+    // Сцену, построенную программой для этого view, больше никто
+    // не покажет. Удаление откладывается: смена схемы может идти
+    // из обработчика событий её же элементов.
+    QGraphicsScene* previous = view->scene();
+    if (previous && previous != scene && previous->parent() == view)
+        previous->deleteLater();
+
     view->setScene(scene);
     view->setRenderHint(QPainter::Antialiasing);
-    view->fitInView(scene->sceneRect(), Qt::KeepAspectRatio);
+    view->setDragMode(QGraphicsView::ScrollHandDrag);
+    view->setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    fitView(view);
+}
+
+// Вписать сцену view в окно.
+void SchemaProgram::fitView(QGraphicsView* view)
+{
+    if (!view->scene())
+        return;
+
+    // Небольшая схема вписывается в окно целиком, большая остаётся
+    // читаемой и просматривается прокруткой.
+    const QRectF rect = view->scene()->sceneRect();
+    const QSize viewport = view->viewport()->size();
+    qreal scale = 1.0;
+    if (!rect.isEmpty())
+        scale = std::min(viewport.width() / rect.width(), viewport.height() / rect.height());
+
+    view->resetTransform();
+    view->scale(std::max(scale, MIN_VIEW_SCALE), std::max(scale, MIN_VIEW_SCALE));
+    view->centerOn(rect.right(), rect.center().y());
 }
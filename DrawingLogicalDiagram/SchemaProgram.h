@@ -2,38 +2,93 @@
 #define SCHEMAPROGRAM_H
 
 #include <QObject>
+#include <QSet>
 #include <SchemaTree.h>
+#include "DrawingDiagram.h"
+#include "GraphDiagram.h"
+#include "LogicGraph.h"
+#include "SearchIndex.h"
 #include "ui_MainWindow.h"
 
 /**
  * @class ShemaProgram
- * @brief Программа для построения схемы из выражения
+ * @brief Программа для построения схемы по готовому дереву или сети
  *
- * Класс получает из строкового логического выражения дерево разбора,
- * отрисовыват дерево.
+ * Класс отрисовывает дерево разбора или сеть и показывает сцену в view.
+ * Схема выражения из поля ввода строится SchemaDocument, который
+ * хранит дерево и сцену между построениями.
+ *
+ * Сцена, построенная программой, принадлежит view и удаляется,
+ * когда view показывает другую сцену; сцену документа удаляет
+ * сам документ.
  */
 class SchemaProgram : public QObject{
     Q_OBJECT
 
 public:
     /**
-     * @brief Конструктор программы построения схемы
-     * @param text Логическое выражение в инфиксной нотации
-     *
-     * Поддерживаемые операторы:
-     * - & (AND), | (OR), ^ (XOR), ! (NOT)
+     * @brief Конструктор программы построения схемы по готовому дереву
+     * @param tree Дерево, построенное без разбора выражения (например, импорт нетлиста)
+     * @param view View для отображения схемы
+     * @param highlighted Узлы, выделяемые цветом (например, критический путь)
+     * @param index Индекс поиска, заполняемый по построенной сцене (nullptr — без индекса)
+     * @param expansion Свёрнутые и раскрытые поддеревья (по умолчанию всё раскрыто)
      *
-     * Пример:
-     * @code
-     * ShemaProgram program("!((A|B)&!C)");
-     * @endcode
+     * Непустой индекс считается построенным по этому же дереву:
+     * в нём обновляются только элементы сцены, дерево повторно
+     * не обходится.
+     */
+    SchemaProgram(const SchemaTree& tree, QGraphicsView* view,
+                  const QSet<const SchemaTree::Node*>& highlighted = {},
+                  SearchIndex* index = nullptr,
+                  const DrawingDiagram::Expansion& expansion = {});
+
+    /**
+     * @brief Конструктор программы построения схемы по сети с несколькими выходами
+     * @param graph Сеть (например, импортированный нетлист)
+     * @param view View для отображения схемы
      */
-    explicit SchemaProgram(const QString& text, QGraphicsView* view);
+    SchemaProgram(const LogicGraph& graph, QGraphicsView* view);
 
     ~SchemaProgram() = default;
 
+    /**
+     * @brief Статистика послойной компоновки
+     * @return Время этапов; пустая, если схема строилась деревом или взята из кэша
+     */
+    GraphDiagram::Statistics graphStatistics() const;
+
+    /**
+     * @brief Статистика построения схемы дерева
+     * @return Число элементов, свёрнутых поддеревьев и время; пустая,
+     *         если схема строилась по сети или взята из кэша
+     */
+    DrawingDiagram::Statistics treeStatistics() const;
+
+    /**
+     * @brief Показать сцену в view и вписать её в окно
+     * @param scene Построенная сцена
+     * @param view View для отображения схемы
+     *
+     * Предыдущая сцена view, если её родитель — view, удаляется
+     * через deleteLater().
+     */
+    static void showScene(QGraphicsScene* scene, QGraphicsView* view);
+
+    /**
+     * @brief Вписать сцену view в окно
+     * @param view View со сценой
+     *
+     * Небольшая схема масштабируется под окно, большая остаётся
+     * в масштабе не меньше MIN_VIEW_SCALE; видна правая часть схемы с выходом.
+     */
+    static void fitView(QGraphicsView* view);
+
 private:
+
     std::unique_ptr<SchemaTree::Node> root;  ///< Корень дерева
+    GraphDiagram::Statistics graphStats;     ///< Статистика послойной компоновки
+    DrawingDiagram::Statistics treeStats;    ///< Статистика построения схемы дерева
 };
 
 #endif // SCHEMAPROGRAM_H
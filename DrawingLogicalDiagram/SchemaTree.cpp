@@ -1,6 +1,19 @@
 #include <SchemaTree.h>
 #include <QDebug>
 
+// Деструктор узла
+SchemaTree::Node::~Node() {
+    // Каждый узел из списка удаляется уже без детей.
+    std::vector<std::unique_ptr<Node>> pending = std::move(children);
+    while (!pending.empty()) {
+        std::unique_ptr<Node> node = std::move(pending.back());
+        pending.pop_back();
+        for (auto& child : node->children)
+            pending.push_back(std::move(child));
+        node->children.clear();
+    }
+}
+
 // Реализация конструктора
 SchemaTree::SchemaTree(const QString& text){
     SchemaTree::buildTree(text);
@@ -8,6 +21,14 @@ SchemaTree::SchemaTree(const QString& text){
     width = calculateWidth(root);
 }
 
+// Конструктор дерева из готового корня
+SchemaTree::SchemaTree(std::unique_ptr<Node> root)
+    : root(std::move(root))
+{
+    height = calculateHeight(this->root);
+    width = calculateWidth(this->root);
+}
+
 // Получить высоту дерева
 int  SchemaTree::getHeight() const{
     return height;
@@ -33,27 +54,50 @@ const SchemaTree::Node* SchemaTree::getRoot() const {
     return root.get();
 }
 
+// Забрать корень дерева
+std::unique_ptr<SchemaTree::Node> SchemaTree::takeRoot() {
+    height = 0;
+    width = 0;
+    return std::move(root);
+}
+
 // Посчитать высоту
 int SchemaTree::calculateHeight(const std::unique_ptr<SchemaTree::Node>& node) const{
     if (!node) return 0;
 
+    // Обход с явным стеком: импортированные деревья бывают глубже стека вызовов.
     int maxHeight = 0;
+    std::vector<std::pair<const Node*, int>> stack{{node.get(), 1}};
+    while (!stack.empty()) {
+        const auto [current, depth] = stack.back();
+        stack.pop_back();
+        maxHeight = std::max(maxHeight, depth);
+        for (const auto& child : current->children)
+            if (child)
+                stack.emplace_back(child.get(), depth + 1);
+    }
 
-    for (const auto& child : node->children)
-        maxHeight = std::max(maxHeight, calculateHeight(child));
-
-    return maxHeight + 1;
+    return maxHeight;
 }
 
 // Посчитать ширину
 int SchemaTree::calculateWidth(const std::unique_ptr<SchemaTree::Node>& node) const{
     if (!node) return 0;
-    if (node->children.empty()) return 1;
 
+    // Ширина равна числу листьев.
     int total = 0;
-
-    for (const auto& child : node->children)
-        total += calculateWidth(child);
+    std::vector<const Node*> stack{node.get()};
+    while (!stack.empty()) {
+        const Node* current = stack.back();
+        stack.pop_back();
+        if (current->children.empty()) {
+            ++total;
+            continue;
+        }
+        for (const auto& child : current->children)
+            if (child)
+                stack.push_back(child.get());
+    }
 
     return total;
 }
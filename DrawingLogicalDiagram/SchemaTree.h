@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QString>
+#include <memory>
+#include <vector>
 #include <SchemaTypes.h>
 
 /**
@@ -46,6 +48,14 @@ public:
          * @param v Значение узла (по умолчанию пустая строка)
          */
         Node(NodeType t, const QString& v = "") : type(t), value(v) {}
+
+        /**
+         * @brief Деструктор узла
+         *
+         * Потомки удаляются через рабочий список, а не рекурсией,
+         * поэтому глубокие импортированные деревья не переполняют стек.
+         */
+        ~Node();
     };
 
 public:
@@ -63,6 +73,14 @@ public:
      */
     explicit SchemaTree(const QString& text);
 
+    /**
+     * @brief Конструктор дерева из готового корня
+     * @param root Корень дерева, построенный без разбора выражения
+     *
+     * Используется при импорте нетлистов, когда узлы строятся напрямую.
+     */
+    explicit SchemaTree(std::unique_ptr<Node> root);
+
     ~SchemaTree() = default;
 
     /**
@@ -112,6 +130,15 @@ public:
      */
     const Node* getRoot() const;
 
+    /**
+     * @brief Забрать корень дерева
+     * @return Корень дерева; дерево после вызова пустое
+     *
+     * Позволяет преобразовать разобранное дерево (например,
+     * TreeRebalancer) без копирования узлов.
+     */
+    std::unique_ptr<Node> takeRoot();
+
     /**
      * @brief Вывести дерево
      *
@@ -0,0 +1,271 @@
+#include "SearchIndex.h"
+#include <QAbstractGraphicsShapeItem>
+#include <QElapsedTimer>
+#include <QGraphicsLineItem>
+#include <algorithm>
+
+// Константы.
+static constexpr qreal HIGHLIGHT_PEN_WIDTH = 3.0;
+static const QColor HIGHLIGHT_COLOR(255, 140, 0);
+
+// Очистить индекс.
+void SearchIndex::clear()
+{
+    variables.clear();
+    subtrees.clear();
+    nodeCount = 0;
+    matchCount = 0;
+    buildUs = 0;
+    queryUs = 0;
+    clearItems();
+}
+
+// Забыть элементы сцены и обозначения, сохранив индекс дерева.
+void SearchIndex::clearItems()
+{
+    names.clear();
+    items.clear();
+    owners.clear();
+    highlightedNodes.clear();
+    itemCount = 0;
+}
+
+// Проиндексировать дерево.
+void SearchIndex::build(const SchemaTree::Node* root)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    variables.clear();
+    subtrees.clear();
+
+    std::vector<const SchemaTree::Node*> order;
+    std::unordered_map<const SchemaTree::Node*, size_t> hashes;
+    if (root)
+        hashTree(root, order, hashes);
+
+    // Списки заполняются в прямом порядке, поэтому совпадения
+    // выдаются сверху вниз по схеме без сортировки.
+    for (const SchemaTree::Node* node : order) {
+        if (node->type == NodeType::VAR)
+            variables[node->value].push_back(node);
+        subtrees[hashes[node]].push_back(node);
+    }
+
+    nodeCount = static_cast<int>(order.size());
+    buildUs = timer.nsecsElapsed() / 1000;
+}
+
+// Запомнить элемент сцены узла.
+void SearchIndex::addItem(const SchemaTree::Node* node, QGraphicsItem* item)
+{
+    QPen pen;
+    if (auto* shape = dynamic_cast<QAbstractGraphicsShapeItem*>(item))
+        pen = shape->pen();
+    else if (auto* line = dynamic_cast<QGraphicsLineItem*>(item))
+        pen = line->pen();
+    else
+        return;
+
+    items[node].push_back(Entry{item, pen, pen});
+    owners[item] = node;
+    ++itemCount;
+}
+
+// Запомнить обозначение на схеме.
+void SearchIndex::addName(const QString& name, const SchemaTree::Node* node)
+{
+    // Генератор может повторить имя, поэтому у обозначения может быть несколько узлов.
+    names[name].push_back(node);
+}
+
+// Узел, которому принадлежит элемент сцены.
+const SchemaTree::Node* SearchIndex::nodeOf(const QGraphicsItem* item) const
+{
+    const auto it = owners.find(item);
+    return it == owners.end() ? nullptr : it->second;
+}
+
+// Индекс пуст.
+bool SearchIndex::isEmpty() const
+{
+    return nodeCount == 0;
+}
+
+// Найти узлы.
+std::vector<const SchemaTree::Node*> SearchIndex::find(const QString& query)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<const SchemaTree::Node*> result;
+    const QString text = query.trimmed();
+    static const QString OPERATOR_CHARS = QStringLiteral("&|^!() \t");
+    const bool plainName = !text.isEmpty()
+        && std::none_of(text.begin(), text.end(), [](QChar c) { return OPERATOR_CHARS.contains(c); });
+
+    if (text.isEmpty()) {
+        // Пустой запрос ничего не находит.
+    } else if (const auto name = names.constFind(text); name != names.constEnd()) {
+        result = *name;
+    } else if (const auto variable = variables.constFind(text); plainName && variable != variables.constEnd()) {
+        result = *variable;
+    } else {
+        SchemaTree tree(text);
+        if (tree.getRoot()) {
+            std::vector<const SchemaTree::Node*> order;
+            std::unordered_map<const SchemaTree::Node*, size_t> hashes;
+            hashTree(tree.getRoot(), order, hashes);
+
+            const auto found = subtrees.find(hashes[tree.getRoot()]);
+            if (found != subtrees.end()) {
+                for (const SchemaTree::Node* node : found->second) {
+                    if (sameTree(node, tree.getRoot()))
+                        result.push_back(node);
+                }
+            }
+        }
+    }
+
+    matchCount = static_cast<int>(result.size());
+    queryUs = timer.nsecsElapsed() / 1000;
+    return result;
+}
+
+// Подсветить найденные поддеревья.
+void SearchIndex::highlight(const std::vector<const SchemaTree::Node*>& matches)
+{
+    // Перо восстанавливается из items, поэтому цвет, заданный
+    // setColor() во время подсветки, не теряется.
+    for (const SchemaTree::Node* node : highlightedNodes) {
+        for (const Entry& entry : items[node])
+            setPen(entry.item, entry.pen);
+    }
+    highlightedNodes.clear();
+
+    for (const SchemaTree::Node* match : matches) {
+        for (const SchemaTree::Node* node : subtree(match)) {
+            const auto found = items.find(node);
+            if (found == items.end() || !highlightedNodes.insert(node).second)
+                continue;
+            for (const Entry& entry : found->second)
+                setPen(entry.item, QPen(HIGHLIGHT_COLOR, std::max(entry.pen.widthF(), HIGHLIGHT_PEN_WIDTH)));
+        }
+    }
+}
+
+// Перекрасить элементы узла.
+void SearchIndex::setColor(const SchemaTree::Node* node, const QColor& color)
+{
+    const auto found = items.find(node);
+    if (found == items.end())
+        return;
+
+    const bool highlighted = highlightedNodes.count(node) > 0;
+    for (Entry& entry : found->second) {
+        entry.pen.setColor(color);
+        if (!highlighted)
+            setPen(entry.item, entry.pen);
+    }
+}
+
+// Вернуть всем элементам исходное перо.
+void SearchIndex::resetColors()
+{
+    for (auto& [node, entries] : items) {
+        const bool highlighted = highlightedNodes.count(node) > 0;
+        for (Entry& entry : entries) {
+            if (entry.pen == entry.drawn)
+                continue;
+            entry.pen = entry.drawn;
+            if (!highlighted)
+                setPen(entry.item, entry.pen);
+        }
+    }
+}
+
+// Область сцены поддерева.
+QRectF SearchIndex::boundingRect(const SchemaTree::Node* node) const
+{
+    QRectF rect;
+    for (const SchemaTree::Node* child : subtree(node)) {
+        const auto found = items.find(child);
+        if (found == items.end())
+            continue;
+        for (const Entry& entry : found->second)
+            rect = rect.united(entry.item->sceneBoundingRect());
+    }
+    return rect;
+}
+
+// Размер индекса и время последних операций.
+SearchIndex::Statistics SearchIndex::statistics() const
+{
+    Statistics stats;
+    stats.nodes = nodeCount;
+    stats.variables = variables.size();
+    stats.subtrees = static_cast<int>(subtrees.size());
+    stats.names = names.size();
+    stats.items = itemCount;
+    stats.matches = matchCount;
+    stats.buildUs = buildUs;
+    stats.queryUs = queryUs;
+    return stats;
+}
+
+// Структурные хэши поддеревьев.
+void SearchIndex::hashTree(const SchemaTree::Node* root,
+                           std::vector<const SchemaTree::Node*>& order,
+                           std::unordered_map<const SchemaTree::Node*, size_t>& hashes)
+{
+    order = subtree(root);
+    hashes.reserve(order.size());
+
+    // В обратном прямом порядке дети обрабатываются раньше родителя.
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        const SchemaTree::Node* node = *it;
+        size_t hash = static_cast<size_t>(node->type) * 0x9E3779B97F4A7C15ULL ^ static_cast<size_t>(qHash(node->value));
+        for (const auto& child : node->children)
+            hash ^= hashes[child.get()] + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+        hashes[node] = hash;
+    }
+}
+
+// Равенство поддеревьев по структуре.
+bool SearchIndex::sameTree(const SchemaTree::Node* a, const SchemaTree::Node* b)
+{
+    std::vector<std::pair<const SchemaTree::Node*, const SchemaTree::Node*>> stack{{a, b}};
+    while (!stack.empty()) {
+        const auto [x, y] = stack.back();
+        stack.pop_back();
+        if (x->type != y->type || x->value != y->value || x->children.size() != y->children.size())
+            return false;
+        for (size_t i = 0; i < x->children.size(); ++i)
+            stack.emplace_back(x->children[i].get(), y->children[i].get());
+    }
+    return true;
+}
+
+// Задать перо элементу.
+void SearchIndex::setPen(QGraphicsItem* item, const QPen& pen)
+{
+    if (auto* shape = dynamic_cast<QAbstractGraphicsShapeItem*>(item))
+        shape->setPen(pen);
+    else if (auto* line = dynamic_cast<QGraphicsLineItem*>(item))
+        line->setPen(pen);
+}
+
+// Узлы поддерева.
+std::vector<const SchemaTree::Node*> SearchIndex::subtree(const SchemaTree::Node* root)
+{
+    std::vector<const SchemaTree::Node*> order;
+    std::vector<const SchemaTree::Node*> stack{root};
+    while (!stack.empty()) {
+        const SchemaTree::Node* node = stack.back();
+        stack.pop_back();
+        order.push_back(node);
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+            stack.push_back(it->get());
+    }
+    return order;
+}
@@ -0,0 +1,210 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QGraphicsItem>
+#include <QColor>
+#include <QHash>
+#include <QPen>
+#include <QRectF>
+#include <QString>
+#include <QtGlobal>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "SchemaTree.h"
+
+/**
+ * @class SearchIndex
+ * @brief Индекс поиска переменных, подвыражений и обозначений на схеме
+ *
+ * Строится один раз вместе с деревом и схемой, после чего запрос
+ * отвечается поиском в хэш-таблицах без обхода дерева и сцены:
+ *
+ *  - имя переменной → узлы VAR с этим именем;
+ *  - структурный хэш → корни поддеревьев с таким хэшем;
+ *  - сгенерированное обозначение (номер вывода) → узлы;
+ *  - узел → элементы сцены, нарисованные его пером, и обратно.
+ *
+ * @details
+ * - Подвыражение запроса разбирается SchemaTree и сравнивается
+ *   по структуре: порядок операндов и расстановка скобок учитываются,
+ *   поэтому `A&B` не совпадает с `B&A`.
+ * - Совпадения идут в прямом порядке обхода дерева.
+ * - Подсветка меняет перо только у элементов найденных поддеревьев
+ *   и восстанавливает его при следующем запросе; схема не перестраивается.
+ * - setColor() меняет обычный цвет элементов одного узла (например,
+ *   значение сигнала при моделировании) тоже без перестроения схемы;
+ *   resetColors() возвращает цвета, с которыми элементы нарисованы.
+ * - Указатели на элементы действительны, пока жива сцена,
+ *   для которой заполнялся индекс.
+ */
+class SearchIndex {
+public:
+    /**
+     * @struct Statistics
+     * @brief Размер индекса и время последних операций
+     */
+    struct Statistics
+    {
+        int nodes = 0;           ///< Узлов дерева
+        int variables = 0;       ///< Разных переменных
+        int subtrees = 0;        ///< Разных структурных хэшей
+        int names = 0;           ///< Разных обозначений на схеме
+        int items = 0;           ///< Элементов сцены
+        int matches = 0;         ///< Совпадений последнего запроса
+        qint64 buildUs = 0;      ///< Время построения, мкс
+        qint64 queryUs = 0;      ///< Время последнего запроса, мкс
+    };
+
+    /**
+     * @brief Очистить индекс
+     *
+     * Вызывается перед построением новой сцены.
+     */
+    void clear();
+
+    /**
+     * @brief Забыть элементы сцены и обозначения, сохранив индекс дерева
+     *
+     * Вызывается перед новым построением сцены по тому же дереву
+     * (например, после раскрытия свёрнутого поддерева).
+     */
+    void clearItems();
+
+    /**
+     * @brief Проиндексировать дерево
+     * @param root Корень дерева, по которому нарисована сцена
+     *
+     * Элементы и обозначения (addItem, addName) сохраняются.
+     */
+    void build(const SchemaTree::Node* root);
+
+    /**
+     * @brief Запомнить элемент сцены узла
+     * @param node Узел дерева
+     * @param item Элемент (прямоугольник, эллипс или линия)
+     */
+    void addItem(const SchemaTree::Node* node, QGraphicsItem* item);
+
+    /**
+     * @brief Запомнить обозначение на схеме
+     * @param name Сгенерированное имя
+     * @param node Узел, к которому относится имя
+     */
+    void addName(const QString& name, const SchemaTree::Node* node);
+
+    /**
+     * @brief Узел, которому принадлежит элемент сцены
+     * @param item Элемент
+     * @return Узел или nullptr, если элемент не записан в индекс
+     */
+    const SchemaTree::Node* nodeOf(const QGraphicsItem* item) const;
+
+    /**
+     * @brief Индекс пуст
+     * @return true, если дерево не индексировано
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Найти узлы
+     * @param query Обозначение, имя переменной или подвыражение
+     * @return Корни найденных поддеревьев в прямом порядке обхода
+     */
+    std::vector<const SchemaTree::Node*> find(const QString& query);
+
+    /**
+     * @brief Подсветить найденные поддеревья
+     * @param matches Корни поддеревьев; пустой список снимает подсветку
+     */
+    void highlight(const std::vector<const SchemaTree::Node*>& matches);
+
+    /**
+     * @brief Перекрасить элементы узла
+     * @param node Узел дерева
+     * @param color Новый цвет пера; толщина и стиль сохраняются
+     *
+     * Цвет становится обычным цветом элементов: у подсвеченного узла
+     * он появится после снятия подсветки. Узел без элементов
+     * (например, внутри свёрнутого поддерева) пропускается.
+     */
+    void setColor(const SchemaTree::Node* node, const QColor& color);
+
+    /**
+     * @brief Вернуть всем элементам перо, с которым они нарисованы
+     *
+     * Отменяет setColor(); подсветка найденных поддеревьев сохраняется.
+     */
+    void resetColors();
+
+    /**
+     * @brief Область сцены поддерева
+     * @param node Корень поддерева
+     * @return Объединение границ элементов поддерева
+     */
+    QRectF boundingRect(const SchemaTree::Node* node) const;
+
+    /**
+     * @brief Размер индекса и время последних операций
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+private:
+    /**
+     * @struct Entry
+     * @brief Элемент сцены с исходным пером
+     */
+    struct Entry
+    {
+        QGraphicsItem* item;  ///< Элемент
+        QPen pen;             ///< Перо до подсветки
+        QPen drawn;           ///< Перо, с которым элемент нарисован
+    };
+
+    /**
+     * @brief Структурные хэши поддеревьев
+     * @param root Корень
+     * @param order Сюда записываются узлы в прямом порядке
+     * @param hashes Сюда записываются хэши узлов
+     */
+    static void hashTree(const SchemaTree::Node* root,
+                         std::vector<const SchemaTree::Node*>& order,
+                         std::unordered_map<const SchemaTree::Node*, size_t>& hashes);
+
+    /**
+     * @brief Равенство поддеревьев по структуре
+     * @param a Первое поддерево
+     * @param b Второе поддерево
+     * @return true, если типы, значения и порядок детей совпадают
+     */
+    static bool sameTree(const SchemaTree::Node* a, const SchemaTree::Node* b);
+
+    /**
+     * @brief Задать перо элементу
+     * @param item Элемент
+     * @param pen Перо
+     */
+    static void setPen(QGraphicsItem* item, const QPen& pen);
+
+    /**
+     * @brief Узлы поддерева
+     * @param root Корень
+     * @return Узлы в прямом порядке
+     */
+    static std::vector<const SchemaTree::Node*> subtree(const SchemaTree::Node* root);
+
+    QHash<QString, std::vector<const SchemaTree::Node*>> variables;        ///< Переменная → узлы VAR
+    std::unordered_map<size_t, std::vector<const SchemaTree::Node*>> subtrees;  ///< Хэш → корни поддеревьев
+    QHash<QString, std::vector<const SchemaTree::Node*>> names;            ///< Обозначение → узлы
+    std::unordered_map<const SchemaTree::Node*, std::vector<Entry>> items;  ///< Узел → элементы сцены
+    std::unordered_map<const QGraphicsItem*, const SchemaTree::Node*> owners;  ///< Элемент сцены → узел
+    std::unordered_set<const SchemaTree::Node*> highlightedNodes;  ///< Узлы с подсвеченными элементами
+    int nodeCount = 0;                     ///< Узлов дерева
+    int itemCount = 0;                     ///< Элементов сцены
+    int matchCount = 0;                    ///< Совпадений последнего запроса
+    qint64 buildUs = 0;                    ///< Время построения, мкс
+    qint64 queryUs = 0;                    ///< Время последнего запроса, мкс
+};
+
+#endif // SEARCHINDEX_H
@@ -0,0 +1,805 @@
+#include "TechMapper.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+// Константы.
+static constexpr float INFINITE_COST = 1e30f;
+static constexpr float COST_EPSILON = 1e-4f;
+static constexpr int UNMAPPED_SIGNAL = -3;
+static constexpr int VERIFY_ROUNDS = 16;
+static constexpr quint64 VERIFY_SEED = 0x5eed;
+static const quint64 VARIABLE_TRUTH[CellLibrary::MAX_INPUTS] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL,
+};
+// Маски перестановки соседних переменных v и v+1: неподвижные биты,
+// биты, уходящие вверх, и биты, уходящие вниз.
+static const quint64 SWAP_MASKS[CellLibrary::MAX_INPUTS - 1][3] = {
+    {0x9999999999999999ULL, 0x2222222222222222ULL, 0x4444444444444444ULL},
+    {0xC3C3C3C3C3C3C3C3ULL, 0x0C0C0C0C0C0C0C0CULL, 0x3030303030303030ULL},
+    {0xF00FF00FF00FF00FULL, 0x00F000F000F000F0ULL, 0x0F000F000F000F00ULL},
+    {0xFF0000FFFF0000FFULL, 0x0000FF000000FF00ULL, 0x00FF000000FF0000ULL},
+    {0xFFFF00000000FFFFULL, 0x00000000FFFF0000ULL, 0x0000FFFF00000000ULL},
+};
+
+// Маска таблицы истинности от n переменных.
+static quint64 truthMask(int n)
+{
+    return n >= CellLibrary::MAX_INPUTS ? ~0ULL : (1ULL << (1 << n)) - 1;
+}
+
+// Поменять местами переменные v и v+1 таблицы истинности.
+static quint64 swapAdjacent(quint64 truth, int v)
+{
+    const int shift = 1 << v;
+    const quint64* masks = SWAP_MASKS[v];
+    return (truth & masks[0]) | ((truth & masks[1]) << shift) | ((truth & masks[2]) >> shift);
+}
+
+// Зависит ли функция от переменной.
+static bool dependsOn(quint64 truth, int v)
+{
+    const int shift = 1 << v;
+    return ((truth & VARIABLE_TRUTH[v]) >> shift) != (truth & ~VARIABLE_TRUTH[v]);
+}
+
+// Перенести таблицу с листьев from на надмножество листьев to.
+static quint64 stretch(quint64 truth, const int* from, int fromSize, const int* to, int toSize)
+{
+    // Переменные поднимаются на свои места, начиная со старшей,
+    // поэтому младшие ещё не сдвинуты и не мешают.
+    int position = toSize - 1;
+    for (int i = fromSize - 1; i >= 0; --i) {
+        while (to[position] != from[i])
+            --position;
+        for (int v = i; v < position; ++v)
+            truth = swapAdjacent(truth, v);
+        --position;
+    }
+    return truth;
+}
+
+// Выбросить из разреза листья, от которых функция не зависит.
+static void shrink(int* leaves, int& size, quint64& truth)
+{
+    for (int i = size - 1; i >= 0; --i) {
+        if (dependsOn(truth, i))
+            continue;
+        for (int v = i; v < size - 1; ++v) {
+            truth = swapAdjacent(truth, v);
+            leaves[v] = leaves[v + 1];
+        }
+        --size;
+    }
+}
+
+// Значение сигнала схемы на 64 наборах.
+static quint64 signalWord(const std::vector<quint64>& values, int signal)
+{
+    if (signal == TechMapper::Netlist::CONST0)
+        return 0;
+    if (signal == TechMapper::Netlist::CONST1)
+        return ~0ULL;
+    return values[signal];
+}
+
+// Развернуть сигнал схемы в дерево.
+static std::unique_ptr<SchemaTree::Node> signalTree(const TechMapper::Netlist& netlist, int signal, int& budget)
+{
+    if (--budget < 0)
+        return nullptr;
+
+    if (signal == TechMapper::Netlist::CONST0)
+        return std::make_unique<SchemaTree::Node>(NodeType::VAR, "0");
+    if (signal == TechMapper::Netlist::CONST1)
+        return std::make_unique<SchemaTree::Node>(NodeType::VAR, "1");
+    const int inputCount = static_cast<int>(netlist.inputs.size());
+    if (signal < inputCount)
+        return std::make_unique<SchemaTree::Node>(NodeType::VAR, netlist.inputs[signal]);
+
+    const int index = signal - inputCount;
+    const TechMapper::Instance& instance = netlist.instances[index];
+    auto node = netlist.isInverter(index)
+                    ? std::make_unique<SchemaTree::Node>(NodeType::NOT, "!")
+                    : std::make_unique<SchemaTree::Node>(NodeType::OP, netlist.typeName(index));
+    node->children.reserve(instance.inputs.size());
+    for (int input : instance.inputs) {
+        auto child = signalTree(netlist, input, budget);
+        if (!child)
+            return nullptr;
+        node->children.push_back(std::move(child));
+    }
+    return node;
+}
+
+// Имя типа экземпляра.
+QString TechMapper::Netlist::typeName(int index) const
+{
+    const Instance& instance = instances[index];
+    if (instance.cell >= 0)
+        return cells[instance.cell].name;
+    return QString("LUT%1").arg(instance.inputs.size());
+}
+
+// Является ли экземпляр инвертором.
+bool TechMapper::Netlist::isInverter(int index) const
+{
+    const Instance& instance = instances[index];
+    return instance.inputs.size() == 1 && (instance.function & 0x3) == 0x1;
+}
+
+// Вычислить выходы сразу для 64 наборов входов.
+std::vector<quint64> TechMapper::Netlist::evaluate(const std::vector<quint64>& inputWords) const
+{
+    std::vector<quint64> values(inputs.size() + instances.size(), 0);
+    for (int i = 0; i < static_cast<int>(inputs.size()) && i < static_cast<int>(inputWords.size()); ++i)
+        values[i] = inputWords[i];
+
+    // Выход экземпляра — дизъюнкция его минтермов.
+    std::vector<quint64> words;
+    for (size_t index = 0; index < instances.size(); ++index) {
+        const Instance& instance = instances[index];
+        const int size = static_cast<int>(instance.inputs.size());
+        words.resize(size);
+        for (int j = 0; j < size; ++j)
+            words[j] = signalWord(values, instance.inputs[j]);
+
+        quint64 out = 0;
+        for (int m = 0; m < (1 << size); ++m) {
+            if (!((instance.function >> m) & 1))
+                continue;
+            quint64 term = ~0ULL;
+            for (int j = 0; j < size; ++j)
+                term &= ((m >> j) & 1) ? words[j] : ~words[j];
+            out |= term;
+        }
+        values[inputs.size() + index] = out;
+    }
+
+    std::vector<quint64> result;
+    result.reserve(outputs.size());
+    for (const Output& output : outputs)
+        result.push_back(signalWord(values, output.signal));
+    return result;
+}
+
+// Развернуть выход в дерево для DrawingDiagram.
+std::unique_ptr<SchemaTree::Node> TechMapper::Netlist::toTree(int outputIndex, int maxNodes, QString* error) const
+{
+    if (outputIndex < 0 || outputIndex >= static_cast<int>(outputs.size())) {
+        if (error) *error = QString("Нет выхода с номером %1").arg(outputIndex);
+        return nullptr;
+    }
+
+    int budget = maxNodes;
+    auto root = signalTree(*this, outputs[outputIndex].signal, budget);
+    if (!root && error)
+        *error = QString("Дерево выхода %1 превышает %2 узлов")
+                     .arg(outputs[outputIndex].name)
+                     .arg(maxNodes);
+    return root;
+}
+
+// Задать библиотеку и отображать на ячейки.
+void TechMapper::setLibrary(const CellLibrary& cellLibrary)
+{
+    library = cellLibrary;
+    lutSize = 0;
+}
+
+// Отображать на LUT.
+void TechMapper::setLutSize(int inputs)
+{
+    lutSize = std::clamp(inputs, 2, static_cast<int>(CellLibrary::MAX_INPUTS));
+}
+
+// Задать критерий выбора разрезов.
+void TechMapper::setGoal(Goal mappingGoal)
+{
+    goal = mappingGoal;
+}
+
+// Задать число разрезов, сохраняемых на узел.
+void TechMapper::setCutLimit(int limit)
+{
+    cutLimit = std::max(1, limit);
+}
+
+// Отобразить сеть.
+bool TechMapper::map(const LogicGraph& graph)
+{
+    error.clear();
+    result = Netlist();
+    stats = Statistics();
+    if (graph.outputs().empty()) {
+        error = "В схеме нет выходов";
+        return false;
+    }
+    if (lutSize == 0 && library.isEmpty())
+        library = CellLibrary::nandNor();
+
+    QElapsedTimer timer;
+    timer.start();
+    const std::vector<int> outputs = buildAig(graph);
+    stats.aigNodes = static_cast<int>(fanin0.size()) - 1 - inputCount;
+    stats.aigUs = timer.nsecsElapsed() / 1000;
+
+    timer.restart();
+    if (lutSize == 0)
+        buildMatches();
+    const bool mapped = enumerateCuts();
+    stats.cutLimit = cutLimit;
+    stats.cuts = static_cast<qint64>(cutStore.size());
+    stats.cutBytes = static_cast<qint64>(cutStore.capacity() * sizeof(Cut)
+                                         + cutStart.capacity() * sizeof(int)
+                                         + choices.capacity() * sizeof(Choice));
+    stats.cutUs = timer.nsecsElapsed() / 1000;
+
+    if (mapped) {
+        timer.restart();
+        cover(graph, outputs);
+        stats.coverUs = timer.nsecsElapsed() / 1000;
+    } else {
+        error = "Библиотека не реализует функцию одного из узлов";
+    }
+
+    // Рабочие структуры нужны только на время отображения.
+    std::vector<int>().swap(fanin0);
+    std::vector<int>().swap(fanin1);
+    std::vector<int>().swap(references);
+    std::unordered_map<quint64, int>().swap(strash);
+    std::vector<Cut>().swap(cutStore);
+    std::vector<int>().swap(cutStart);
+    std::vector<Choice>().swap(choices);
+    return mapped;
+}
+
+// Сравнить отображённую схему с исходной сетью.
+bool TechMapper::verify(const LogicGraph& graph)
+{
+    stats.vectors = 0;
+    std::mt19937_64 random(VERIFY_SEED);
+    std::vector<quint64> words(graph.inputs().size());
+    for (int round = 0; round < VERIFY_ROUNDS; ++round) {
+        for (quint64& word : words)
+            word = random();
+        const std::vector<quint64> expected = graph.evaluate(words);
+        const std::vector<quint64> actual = result.evaluate(words);
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (i >= actual.size() || expected[i] != actual[i]) {
+                error = QString("Выход %1 отображённой схемы не совпадает с исходным").arg(graph.outputs()[i].name);
+                return false;
+            }
+        }
+        stats.vectors += 64;
+    }
+    return true;
+}
+
+// Результат последнего отображения.
+const TechMapper::Netlist& TechMapper::netlist() const
+{
+    return result;
+}
+
+// Число экземпляров каждого типа.
+QString TechMapper::cellSummary() const
+{
+    QHash<QString, int> counts;
+    for (int i = 0; i < static_cast<int>(result.instances.size()); ++i)
+        ++counts[result.typeName(i)];
+
+    std::vector<std::pair<int, QString>> sorted;
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it)
+        sorted.emplace_back(-it.value(), it.key());
+    std::sort(sorted.begin(), sorted.end());
+
+    QStringList parts;
+    for (const auto& [count, name] : sorted)
+        parts << QString("%1×%2").arg(name).arg(-count);
+    return parts.join(", ");
+}
+
+// Описание последней ошибки.
+QString TechMapper::errorString() const
+{
+    return error;
+}
+
+// Размер, качество и время последнего отображения.
+TechMapper::Statistics TechMapper::statistics() const
+{
+    return stats;
+}
+
+// Построить AIG по сети.
+std::vector<int> TechMapper::buildAig(const LogicGraph& graph)
+{
+    inputCount = static_cast<int>(graph.inputs().size());
+    fanin0.assign(1 + inputCount, -1);
+    fanin1.assign(1 + inputCount, -1);
+    strash.clear();
+
+    // Раскладываются только вентили, от которых зависят выходы.
+    std::vector<char> needed(graph.size(), 0);
+    for (const LogicGraph::Output& output : graph.outputs())
+        needed[output.gate] = 1;
+    for (int id = graph.size() - 1; id >= 0; --id) {
+        if (needed[id]) {
+            for (int fanin : graph.gate(id).fanins)
+                needed[fanin] = 1;
+        }
+    }
+
+    std::vector<int> literals(graph.size(), 0);
+    for (int i = 0; i < inputCount; ++i)
+        literals[graph.inputs()[i]] = 2 * (1 + i);
+
+    // Многовходовые вентили собираются сбалансированным деревом.
+    std::vector<int> operands;
+    std::vector<int> next;
+    for (int id = 0; id < graph.size(); ++id) {
+        if (!needed[id])
+            continue;
+        const LogicGraph::Gate& gate = graph.gate(id);
+        switch (gate.kind) {
+        case LogicGraph::GateKind::CONST0:
+            literals[id] = 0;
+            continue;
+        case LogicGraph::GateKind::CONST1:
+            literals[id] = 1;
+            continue;
+        case LogicGraph::GateKind::INPUT:
+            continue;
+        case LogicGraph::GateKind::NOT:
+            literals[id] = literals[gate.fanins.front()] ^ 1;
+            continue;
+        case LogicGraph::GateKind::AND:
+        case LogicGraph::GateKind::OR:
+        case LogicGraph::GateKind::XOR:
+            break;
+        }
+
+        // OR сводится к AND по закону де Моргана.
+        const bool isOr = gate.kind == LogicGraph::GateKind::OR;
+        const bool isXor = gate.kind == LogicGraph::GateKind::XOR;
+        operands.clear();
+        for (int fanin : gate.fanins)
+            operands.push_back(literals[fanin] ^ (isOr ? 1 : 0));
+        while (operands.size() > 1) {
+            next.clear();
+            for (size_t i = 0; i + 1 < operands.size(); i += 2) {
+                const int a = operands[i];
+                const int b = operands[i + 1];
+                if (isXor)
+                    next.push_back(addAnd(addAnd(a, b ^ 1) ^ 1, addAnd(a ^ 1, b) ^ 1) ^ 1);
+                else
+                    next.push_back(addAnd(a, b));
+            }
+            if (operands.size() % 2)
+                next.push_back(operands.back());
+            operands.swap(next);
+        }
+        literals[id] = operands.empty() ? (isXor || isOr ? 0 : 1) : operands.front() ^ (isOr ? 1 : 0);
+    }
+
+    std::vector<int> outputs;
+    references.assign(fanin0.size(), 0);
+    for (size_t node = 1 + inputCount; node < fanin0.size(); ++node) {
+        ++references[fanin0[node] >> 1];
+        ++references[fanin1[node] >> 1];
+    }
+    for (const LogicGraph::Output& output : graph.outputs()) {
+        outputs.push_back(literals[output.gate]);
+        ++references[literals[output.gate] >> 1];
+    }
+    return outputs;
+}
+
+// Добавить узел AND с упрощением и структурным хэшированием.
+int TechMapper::addAnd(int a, int b)
+{
+    if (a > b)
+        std::swap(a, b);
+    if (a == 0 || a == (b ^ 1))
+        return 0;
+    if (a == 1)
+        return b;
+    if (a == b)
+        return a;
+
+    const quint64 key = (static_cast<quint64>(a) << 32) | static_cast<quint32>(b);
+    const auto found = strash.find(key);
+    if (found != strash.end())
+        return 2 * found->second;
+
+    const int node = static_cast<int>(fanin0.size());
+    fanin0.push_back(a);
+    fanin1.push_back(b);
+    strash.emplace(key, node);
+    return 2 * node;
+}
+
+// Собрать таблицу соответствий функций ячейкам.
+void TechMapper::buildMatches()
+{
+    matchList.clear();
+    matches.assign(CellLibrary::MAX_INPUTS + 1, {});
+
+    // Для каждой перестановки входов и набора инверсий листьев
+    // ячейка реализует свою функцию листьев; одинаковые пары
+    // (ячейка, инверсии) дают одинаковую цену и хранятся один раз.
+    const std::vector<CellLibrary::Cell>& cells = library.cells();
+    for (int cell = 0; cell < static_cast<int>(cells.size()); ++cell) {
+        const int size = cells[cell].inputs;
+        if (size < 2)
+            continue;
+
+        int permutation[CellLibrary::MAX_INPUTS];
+        std::iota(permutation, permutation + size, 0);
+        do {
+            for (int inverted = 0; inverted < (1 << size); ++inverted) {
+                quint64 function = 0;
+                for (int m = 0; m < (1 << size); ++m) {
+                    int pins = 0;
+                    for (int pin = 0; pin < size; ++pin)
+                        pins |= (((m ^ inverted) >> permutation[pin]) & 1) << pin;
+                    function |= ((cells[cell].function >> pins) & 1) << m;
+                }
+
+                std::vector<int>& list = matches[size][function];
+                const bool duplicate = std::any_of(list.begin(), list.end(), [&](int index) {
+                    return matchList[index].cell == cell && matchList[index].inverted == inverted;
+                });
+                if (duplicate)
+                    continue;
+
+                Match match;
+                match.cell = cell;
+                match.inverted = static_cast<quint8>(inverted);
+                for (int pin = 0; pin < size; ++pin)
+                    match.pins[pin] = static_cast<quint8>(permutation[pin]);
+                list.push_back(static_cast<int>(matchList.size()));
+                matchList.push_back(match);
+            }
+        } while (std::next_permutation(permutation, permutation + size));
+    }
+}
+
+// Перебрать разрезы и выбрать реализации всех узлов.
+bool TechMapper::enumerateCuts()
+{
+    const int nodeCount = static_cast<int>(fanin0.size());
+    const int maxLeaves = lutSize > 0 ? lutSize : std::max(2, library.maxInputs());
+    const CellLibrary::Cell* inverter = lutSize > 0 ? nullptr : &library.cells()[library.inverter()];
+    const float inverterDelay = inverter ? static_cast<float>(inverter->delay) : 1.0f;
+    const float inverterArea = inverter ? static_cast<float>(inverter->area) : 1.0f;
+
+    cutStore.clear();
+    cutStart.assign(nodeCount + 1, 0);
+    choices.assign(2 * nodeCount, Choice{INFINITE_COST, INFINITE_COST, INVERTER_CHOICE, -1});
+
+    auto trivialCut = [](int node) {
+        Cut cut;
+        cut.leaves[0] = node;
+        cut.size = 1;
+        cut.truth = VARIABLE_TRUTH[0];
+        cut.signature = 1ULL << (node % 64);
+        return cut;
+    };
+    auto relaxInverters = [&](int node) {
+        Choice& direct = choices[2 * node];
+        Choice& inverse = choices[2 * node + 1];
+        const Choice viaInverse{inverse.arrival + inverterDelay, inverse.flow + inverterArea, INVERTER_CHOICE, -1};
+        const Choice viaDirect{direct.arrival + inverterDelay, direct.flow + inverterArea, INVERTER_CHOICE, -1};
+        if (inverse.arrival < INFINITE_COST && better(viaInverse, direct))
+            direct = viaInverse;
+        else if (direct.arrival < INFINITE_COST && better(viaDirect, inverse))
+            inverse = viaDirect;
+    };
+
+    for (int node = 1; node <= inputCount; ++node) {
+        choices[2 * node] = Choice{0, 0, INPUT_CHOICE, -1};
+        relaxInverters(node);
+    }
+
+    struct Candidate
+    {
+        Cut cut;
+        Choice phases[2];
+        Choice rank;
+    };
+    std::vector<Candidate> candidates;
+    std::vector<int> order;
+    std::vector<Cut> faninCuts[2];
+
+    for (int node = 0; node < nodeCount; ++node) {
+        cutStart[node] = static_cast<int>(cutStore.size());
+        if (node <= inputCount)
+            continue;
+
+        // Разрезы входа — он сам и его сохранённые разрезы.
+        const int literals[2] = {fanin0[node], fanin1[node]};
+        for (int side = 0; side < 2; ++side) {
+            const int fanin = literals[side] >> 1;
+            std::vector<Cut>& list = faninCuts[side];
+            list.assign(1, trivialCut(fanin));
+            if (fanin > inputCount)
+                list.insert(list.end(), cutStore.begin() + cutStart[fanin], cutStore.begin() + cutStart[fanin + 1]);
+        }
+
+        candidates.clear();
+        for (const Cut& a : faninCuts[0]) {
+            for (const Cut& b : faninCuts[1]) {
+                if (qPopulationCount(a.signature | b.signature) > maxLeaves)
+                    continue;
+
+                Candidate candidate;
+                Cut& cut = candidate.cut;
+                int i = 0;
+                int j = 0;
+                bool fits = true;
+                while (i < a.size || j < b.size) {
+                    if (cut.size == maxLeaves) {
+                        fits = false;
+                        break;
+                    }
+                    if (j == b.size || (i < a.size && a.leaves[i] < b.leaves[j]))
+                        cut.leaves[cut.size++] = a.leaves[i++];
+                    else if (i == a.size || b.leaves[j] < a.leaves[i])
+                        cut.leaves[cut.size++] = b.leaves[j++];
+                    else
+                        cut.leaves[cut.size++] = a.leaves[i++], ++j;
+                }
+                if (!fits)
+                    continue;
+
+                const quint64 truthA = stretch(a.truth, a.leaves, a.size, cut.leaves, cut.size)
+                                       ^ ((literals[0] & 1) ? ~0ULL : 0);
+                const quint64 truthB = stretch(b.truth, b.leaves, b.size, cut.leaves, cut.size)
+                                       ^ ((literals[1] & 1) ? ~0ULL : 0);
+                cut.truth = truthA & truthB;
+                shrink(cut.leaves, cut.size, cut.truth);
+                for (int leaf = 0; leaf < cut.size; ++leaf)
+                    cut.signature |= 1ULL << (cut.leaves[leaf] % 64);
+
+                const bool found0 = evaluateCut(cut, 0, candidate.phases[0]);
+                const bool found1 = evaluateCut(cut, 1, candidate.phases[1]);
+                const bool faninCut = candidates.empty();
+                if (!found0 && !found1 && !faninCut)
+                    continue;
+                candidate.rank = better(candidate.phases[1], candidate.phases[0])
+                                     ? candidate.phases[1] : candidate.phases[0];
+                candidates.push_back(candidate);
+            }
+        }
+
+        // Разрез из входов узла идёт первым всегда, остальные — по рангу;
+        // разрез, содержащий уже принятый, не нужен.
+        order.resize(candidates.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin() + 1, order.end(), [&](int x, int y) {
+            return better(candidates[x].rank, candidates[y].rank);
+        });
+
+        const int first = static_cast<int>(cutStore.size());
+        for (int index : order) {
+            if (static_cast<int>(cutStore.size()) - first >= cutLimit)
+                break;
+            const Cut& cut = candidates[index].cut;
+            const bool dominated = std::any_of(cutStore.begin() + first, cutStore.end(), [&](const Cut& kept) {
+                if ((kept.signature & cut.signature) != kept.signature || kept.size > cut.size)
+                    return false;
+                return std::includes(cut.leaves, cut.leaves + cut.size, kept.leaves, kept.leaves + kept.size);
+            });
+            if (dominated)
+                continue;
+
+            const int cutIndex = static_cast<int>(cutStore.size());
+            cutStore.push_back(cut);
+            for (int phase = 0; phase < 2; ++phase) {
+                Choice choice = candidates[index].phases[phase];
+                choice.cut = cutIndex;
+                if (choice.arrival < INFINITE_COST
+                    && (choices[2 * node + phase].arrival >= INFINITE_COST
+                        || better(choice, choices[2 * node + phase])))
+                    choices[2 * node + phase] = choice;
+            }
+        }
+
+        relaxInverters(node);
+        if (choices[2 * node].arrival >= INFINITE_COST && choices[2 * node + 1].arrival >= INFINITE_COST
+            && references[node] > 0)
+            return false;
+    }
+    cutStart[nodeCount] = static_cast<int>(cutStore.size());
+    return true;
+}
+
+// Лучшая реализация функции разреза в заданной фазе.
+bool TechMapper::evaluateCut(const Cut& cut, int phase, Choice& choice) const
+{
+    choice = Choice{INFINITE_COST, INFINITE_COST, INVERTER_CHOICE, -1};
+    const quint64 target = (phase ? ~cut.truth : cut.truth) & truthMask(cut.size);
+
+    // Константа и повтор листа ничего не стоят.
+    if (cut.size == 0) {
+        choice.arrival = 0;
+        choice.flow = 0;
+        return true;
+    }
+    if (cut.size == 1) {
+        const Choice& leaf = choices[2 * cut.leaves[0] + (target == 0x1 ? 1 : 0)];
+        choice.arrival = leaf.arrival;
+        choice.flow = leaf.flow;
+        return leaf.arrival < INFINITE_COST;
+    }
+
+    auto leafCost = [&](int leaf, int leafPhase, float& arrival, float& flow) {
+        const int node = cut.leaves[leaf];
+        const Choice& implementation = choices[2 * node + leafPhase];
+        arrival = std::max(arrival, implementation.arrival);
+        flow += implementation.flow / std::max(1, references[node]);
+    };
+
+    if (lutSize > 0) {
+        float arrival = 0;
+        float flow = 1;
+        for (int leaf = 0; leaf < cut.size; ++leaf)
+            leafCost(leaf, 0, arrival, flow);
+        choice.arrival = arrival + 1;
+        choice.flow = flow;
+        return true;
+    }
+
+    const auto found = matches[cut.size].find(target);
+    if (found == matches[cut.size].end())
+        return false;
+    for (int index : found->second) {
+        const Match& match = matchList[index];
+        const CellLibrary::Cell& cell = library.cells()[match.cell];
+        float arrival = 0;
+        float flow = static_cast<float>(cell.area);
+        for (int leaf = 0; leaf < cut.size; ++leaf)
+            leafCost(leaf, (match.inverted >> leaf) & 1, arrival, flow);
+
+        const Choice candidate{arrival + static_cast<float>(cell.delay), flow, INVERTER_CHOICE, index};
+        if (choice.match < 0 || better(candidate, choice))
+            choice = candidate;
+    }
+    return choice.arrival < INFINITE_COST;
+}
+
+// Лучше ли реализация a реализации b по выбранному критерию.
+bool TechMapper::better(const Choice& a, const Choice& b) const
+{
+    const float primaryA = goal == Goal::DELAY ? a.arrival : a.flow;
+    const float primaryB = goal == Goal::DELAY ? b.arrival : b.flow;
+    if (primaryA < primaryB - COST_EPSILON)
+        return true;
+    if (primaryA > primaryB + COST_EPSILON)
+        return false;
+    const float secondaryA = goal == Goal::DELAY ? a.flow : a.arrival;
+    const float secondaryB = goal == Goal::DELAY ? b.flow : b.arrival;
+    return secondaryA < secondaryB - COST_EPSILON;
+}
+
+// Построить покрытие от выходов.
+void TechMapper::cover(const LogicGraph& graph, const std::vector<int>& outputs)
+{
+    for (int input : graph.inputs())
+        result.inputs << graph.inputName(input);
+    result.lutSize = lutSize;
+    if (lutSize == 0)
+        result.cells = library.cells();
+    const int inverterCell = lutSize == 0 ? library.inverter() : -1;
+
+    // Сигнал каждой пары (узел, фаза) создаётся один раз; обход
+    // идёт явным стеком, пока все входы пары не получат сигналы.
+    std::vector<int> signalOf(choices.size(), UNMAPPED_SIGNAL);
+    for (int i = 0; i < inputCount; ++i)
+        signalOf[2 * (1 + i)] = i;
+
+    auto leafKey = [this](int node, int phase) {
+        return 2 * node + phase;
+    };
+    std::vector<int> stack;
+    std::vector<int> keys;
+    auto dependencies = [&](int key) {
+        keys.clear();
+        const Choice& choice = choices[key];
+        if (choice.cut == INVERTER_CHOICE) {
+            keys.push_back(key ^ 1);
+            return;
+        }
+        const Cut& cut = cutStore[choice.cut];
+        if (cut.size == 1) {
+            const quint64 target = ((key & 1) ? ~cut.truth : cut.truth) & 0x3;
+            keys.push_back(leafKey(cut.leaves[0], target == 0x1 ? 1 : 0));
+        } else if (cut.size > 1 && choice.match < 0) {
+            for (int leaf = 0; leaf < cut.size; ++leaf)
+                keys.push_back(leafKey(cut.leaves[leaf], 0));
+        } else if (cut.size > 1) {
+            const Match& match = matchList[choice.match];
+            for (int pin = 0; pin < cut.size; ++pin) {
+                const int leaf = match.pins[pin];
+                keys.push_back(leafKey(cut.leaves[leaf], (match.inverted >> leaf) & 1));
+            }
+        }
+    };
+    auto addInstance = [&](int cell, quint64 function) {
+        Instance instance;
+        instance.cell = cell;
+        instance.function = function;
+        for (int key : keys)
+            instance.inputs.push_back(signalOf[key]);
+        result.instances.push_back(std::move(instance));
+        return static_cast<int>(result.inputs.size() + result.instances.size()) - 1;
+    };
+
+    for (int output : outputs) {
+        if (output > 1)
+            stack.push_back(output);
+        while (!stack.empty()) {
+            const int key = stack.back();
+            if (signalOf[key] != UNMAPPED_SIGNAL) {
+                stack.pop_back();
+                continue;
+            }
+            dependencies(key);
+            bool ready = true;
+            for (int dependency : keys) {
+                if (signalOf[dependency] == UNMAPPED_SIGNAL) {
+                    stack.push_back(dependency);
+                    ready = false;
+                }
+            }
+            if (!ready)
+                continue;
+            stack.pop_back();
+
+            const Choice& choice = choices[key];
+            if (choice.cut == INVERTER_CHOICE) {
+                signalOf[key] = addInstance(inverterCell, ~VARIABLE_TRUTH[0] & 0x3);
+                continue;
+            }
+            const Cut& cut = cutStore[choice.cut];
+            const quint64 target = ((key & 1) ? ~cut.truth : cut.truth) & truthMask(cut.size);
+            if (cut.size == 0)
+                signalOf[key] = target ? Netlist::CONST1 : Netlist::CONST0;
+            else if (cut.size == 1)
+                signalOf[key] = signalOf[keys.front()];
+            else if (choice.match < 0)
+                signalOf[key] = addInstance(-1, target);
+            else
+                signalOf[key] = addInstance(matchList[choice.match].cell,
+                                            library.cells()[matchList[choice.match].cell].function
+                                                & truthMask(cut.size));
+        }
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        const int literal = outputs[i];
+        const int signal = literal == 0 ? Netlist::CONST0 : literal == 1 ? Netlist::CONST1 : signalOf[literal];
+        result.outputs.push_back(Netlist::Output{graph.outputs()[i].name, signal});
+    }
+
+    // Площадь и задержка по готовой схеме.
+    std::vector<double> arrival(result.inputs.size() + result.instances.size(), 0.0);
+    for (size_t index = 0; index < result.instances.size(); ++index) {
+        const Instance& instance = result.instances[index];
+        double latest = 0.0;
+        for (int input : instance.inputs)
+            latest = std::max(latest, input >= 0 ? arrival[input] : 0.0);
+        const bool isCell = instance.cell >= 0;
+        arrival[result.inputs.size() + index] = latest + (isCell ? result.cells[instance.cell].delay : 1.0);
+        stats.area += isCell ? result.cells[instance.cell].area : 1.0;
+    }
+    for (const Netlist::Output& output : result.outputs)
+        stats.delay = std::max(stats.delay, output.signal >= 0 ? arrival[output.signal] : 0.0);
+    stats.instances = static_cast<int>(result.instances.size());
+}
@@ -0,0 +1,326 @@
+#ifndef TECHMAPPER_H
+#define TECHMAPPER_H
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "CellLibrary.h"
+#include "LogicGraph.h"
+#include "SchemaTree.h"
+
+/**
+ * @class TechMapper
+ * @brief Отображение сети на библиотеку ячеек или на k-входовые LUT
+ *
+ * Сеть LogicGraph раскладывается в граф из двухвходовых AND
+ * с инверсиями на рёбрах (AIG), после чего каждый узел покрывается
+ * ячейкой библиотеки CellLibrary или таблицей LUT, реализующей
+ * функцию одного из его разрезов.
+ *
+ * @details
+ * - Разрез узла — набор узлов (листьев), через которые проходят
+ *   все пути от входов к узлу; его функция хранится 64-битной
+ *   таблицей истинности, поэтому листьев не больше шести.
+ * - Разрезы перебираются с приоритетом (priority cuts): у каждого
+ *   узла остаются не больше cutLimit лучших разрезов, собранных
+ *   из разрезов двух его входов. Разрез из самих входов узла
+ *   сохраняется всегда, поэтому покрытие существует всегда.
+ * - При отображении на библиотеку каждый узел получает две
+ *   реализации — прямую и инверсную: ячейка подбирается по функции
+ *   разреза с точностью до перестановки и инверсий входов, инверсия
+ *   выхода стоит одного инвертора.
+ * - Цель DELAY упорядочивает разрезы по времени прихода, затем по
+ *   площади; цель AREA — по потоку площади (area flow: площадь
+ *   ячейки плюс доли площадей листьев, поделённые между их
+ *   потребителями), затем по времени.
+ * - Покрытие строится от выходов обходом без рекурсии; общие узлы
+ *   реализуются один раз.
+ */
+class TechMapper {
+public:
+    /**
+     * @enum Goal
+     * @brief Критерий выбора разрезов
+     */
+    enum class Goal {
+        DELAY,   ///< Сначала время прихода, затем площадь
+        AREA     ///< Сначала поток площади, затем время
+    };
+
+    /**
+     * @struct Instance
+     * @brief Экземпляр ячейки или LUT в отображённой схеме
+     */
+    struct Instance
+    {
+        int cell = -1;            ///< Номер ячейки библиотеки; -1 — LUT
+        quint64 function = 0;     ///< Таблица истинности по входам inputs (вход 0 — младший бит)
+        std::vector<int> inputs;  ///< Сигналы входов
+    };
+
+    /**
+     * @struct Netlist
+     * @brief Отображённая схема
+     *
+     * Сигналы 0 … inputs.size()−1 — первичные входы, далее по одному
+     * сигналу на экземпляр в порядке instances; экземпляр ссылается
+     * только на сигналы с меньшими номерами.
+     */
+    struct Netlist
+    {
+        /// Сигнал константы 0.
+        static constexpr int CONST0 = -1;
+        /// Сигнал константы 1.
+        static constexpr int CONST1 = -2;
+
+        /**
+         * @struct Output
+         * @brief Именованный выход
+         */
+        struct Output
+        {
+            QString name;   ///< Имя выхода
+            int signal;     ///< Сигнал, CONST0 или CONST1
+        };
+
+        QStringList inputs;                      ///< Имена первичных входов
+        std::vector<Output> outputs;             ///< Выходы
+        std::vector<Instance> instances;         ///< Экземпляры в топологическом порядке
+        std::vector<CellLibrary::Cell> cells;    ///< Ячейки библиотеки (пусто для LUT)
+        int lutSize = 0;                         ///< Число входов LUT; 0 — отображение на ячейки
+
+        /**
+         * @brief Имя типа экземпляра
+         * @param index Номер экземпляра
+         * @return Имя ячейки или "LUT<k>"
+         */
+        QString typeName(int index) const;
+
+        /**
+         * @brief Является ли экземпляр инвертором
+         * @param index Номер экземпляра
+         * @return true для одновходового экземпляра с функцией !a
+         */
+        bool isInverter(int index) const;
+
+        /**
+         * @brief Вычислить выходы сразу для 64 наборов входов
+         * @param inputWords Слово на каждый вход: бит k — значение в наборе k
+         * @return Слово на каждый выход
+         */
+        std::vector<quint64> evaluate(const std::vector<quint64>& inputWords) const;
+
+        /**
+         * @brief Развернуть выход в дерево для DrawingDiagram
+         * @param outputIndex Номер выхода
+         * @param maxNodes Предельное число узлов дерева
+         * @param error Сюда записывается описание ошибки (может быть nullptr)
+         * @return Корень дерева или nullptr при ошибке
+         *
+         * Экземпляр становится оператором с именем ячейки или LUT,
+         * инвертор — узлом NOT. Общие экземпляры копируются в каждую
+         * ветвь, поэтому maxNodes ограничивает рост дерева.
+         */
+        std::unique_ptr<SchemaTree::Node> toTree(int outputIndex, int maxNodes, QString* error = nullptr) const;
+    };
+
+    /**
+     * @struct Statistics
+     * @brief Размер, качество и время последнего отображения
+     */
+    struct Statistics
+    {
+        int aigNodes = 0;         ///< Узлов AND в AIG
+        int cutLimit = 0;         ///< Разрезов на узел
+        qint64 cuts = 0;          ///< Сохранено разрезов
+        qint64 cutBytes = 0;      ///< Память под разрезы, байт
+        int instances = 0;        ///< Экземпляров в покрытии
+        double area = 0.0;        ///< Суммарная площадь (для LUT — их число)
+        double delay = 0.0;       ///< Задержка самого медленного выхода (для LUT — число уровней)
+        qint64 aigUs = 0;         ///< Построение AIG, мкс
+        qint64 cutUs = 0;         ///< Перебор и выбор разрезов, мкс
+        qint64 coverUs = 0;       ///< Построение покрытия, мкс
+        qint64 vectors = 0;       ///< Наборов, проверенных verify()
+    };
+
+    /**
+     * @brief Задать библиотеку и отображать на ячейки
+     * @param library Непустая библиотека
+     */
+    void setLibrary(const CellLibrary& library);
+
+    /**
+     * @brief Отображать на LUT
+     * @param inputs Число входов LUT (2 … CellLibrary::MAX_INPUTS)
+     */
+    void setLutSize(int inputs);
+
+    /**
+     * @brief Задать критерий выбора разрезов
+     * @param goal Критерий
+     */
+    void setGoal(Goal goal);
+
+    /**
+     * @brief Задать число разрезов, сохраняемых на узел
+     * @param limit Число разрезов (не меньше 1)
+     */
+    void setCutLimit(int limit);
+
+    /**
+     * @brief Отобразить сеть
+     * @param graph Сеть с хотя бы одним выходом
+     * @return true при успехе; иначе см. errorString()
+     */
+    bool map(const LogicGraph& graph);
+
+    /**
+     * @brief Сравнить отображённую схему с исходной сетью
+     * @param graph Сеть, переданная в map()
+     * @return true, если выходы совпали на всех наборах; иначе см. errorString()
+     *
+     * Обе схемы вычисляются на одних и тех же случайных наборах
+     * по 64 за проход.
+     */
+    bool verify(const LogicGraph& graph);
+
+    /**
+     * @brief Результат последнего отображения
+     * @return Отображённая схема
+     */
+    const Netlist& netlist() const;
+
+    /**
+     * @brief Число экземпляров каждого типа
+     * @return Строка вида "NAND2×12, INV×3" по убыванию числа
+     */
+    QString cellSummary() const;
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки или пустая строка
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Размер, качество и время последнего отображения
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+private:
+    /// Choice::cut: реализация инвертором другой фазы.
+    static constexpr int INVERTER_CHOICE = -1;
+    /// Choice::cut: первичный вход в прямой фазе.
+    static constexpr int INPUT_CHOICE = -2;
+
+    /**
+     * @struct Cut
+     * @brief Разрез узла AIG
+     */
+    struct Cut
+    {
+        int leaves[CellLibrary::MAX_INPUTS];  ///< Листья по возрастанию
+        int size = 0;                         ///< Число листьев
+        quint64 truth = 0;                    ///< Функция узла от листьев (лист 0 — младшая переменная)
+        quint64 signature = 0;                ///< Битовая маска листьев для быстрой проверки вложенности
+    };
+
+    /**
+     * @struct Match
+     * @brief Ячейка, реализующая функцию с точностью до перестановки и инверсий входов
+     */
+    struct Match
+    {
+        int cell = 0;         ///< Номер ячейки
+        quint8 pins[CellLibrary::MAX_INPUTS];  ///< Лист, подключаемый к входу ячейки
+        quint8 inverted = 0;  ///< Листья, нужные в инверсной фазе (бит на лист)
+    };
+
+    /**
+     * @struct Choice
+     * @brief Лучшая реализация узла в одной фазе
+     */
+    struct Choice
+    {
+        float arrival = 0;   ///< Время прихода
+        float flow = 0;      ///< Поток площади
+        int cut = -1;        ///< Номер разреза в cutStore; INVERTER_CHOICE или INPUT_CHOICE
+        int match = -1;      ///< Номер соответствия в matchList (для LUT — -1)
+    };
+
+    /**
+     * @brief Построить AIG по сети
+     * @param graph Сеть
+     * @return Литералы выходов (узел * 2 + инверсия)
+     */
+    std::vector<int> buildAig(const LogicGraph& graph);
+
+    /**
+     * @brief Добавить узел AND с упрощением и структурным хэшированием
+     * @param a Литерал первого входа
+     * @param b Литерал второго входа
+     * @return Литерал результата
+     */
+    int addAnd(int a, int b);
+
+    /**
+     * @brief Собрать таблицу соответствий функций ячейкам
+     */
+    void buildMatches();
+
+    /**
+     * @brief Перебрать разрезы и выбрать реализации всех узлов
+     * @return true, если каждый нужный узел реализуем
+     */
+    bool enumerateCuts();
+
+    /**
+     * @brief Лучшая реализация функции разреза в заданной фазе
+     * @param cut Разрез
+     * @param phase 0 — прямая функция, 1 — инверсная
+     * @param choice Сюда записывается реализация (arrival, flow, match)
+     * @return true, если реализация найдена
+     */
+    bool evaluateCut(const Cut& cut, int phase, Choice& choice) const;
+
+    /**
+     * @brief Лучше ли реализация a реализации b по выбранному критерию
+     * @param a Первая реализация
+     * @param b Вторая реализация
+     * @return true, если a лучше
+     */
+    bool better(const Choice& a, const Choice& b) const;
+
+    /**
+     * @brief Построить покрытие от выходов
+     * @param graph Исходная сеть (имена входов и выходов)
+     * @param outputs Литералы выходов
+     */
+    void cover(const LogicGraph& graph, const std::vector<int>& outputs);
+
+    CellLibrary library;                  ///< Библиотека ячеек
+    int lutSize = 0;                      ///< Число входов LUT; 0 — отображение на ячейки
+    Goal goal = Goal::DELAY;              ///< Критерий выбора разрезов
+    int cutLimit = 8;                     ///< Разрезов на узел
+
+    int inputCount = 0;                   ///< Первичных входов (узлы AIG 1 … inputCount)
+    std::vector<int> fanin0;              ///< Литерал первого входа узла AND
+    std::vector<int> fanin1;              ///< Литерал второго входа узла AND
+    std::vector<int> references;          ///< Число потребителей узла
+    std::unordered_map<quint64, int> strash;        ///< Пара литералов → узел AND
+    std::vector<Match> matchList;         ///< Соответствия функций ячейкам
+    std::vector<std::unordered_map<quint64, std::vector<int>>> matches;  ///< По числу листьев: функция → номера в matchList
+    std::vector<Cut> cutStore;            ///< Разрезы всех узлов подряд
+    std::vector<int> cutStart;            ///< Первый разрез узла в cutStore
+    std::vector<Choice> choices;          ///< Лучшая реализация: узел * 2 + фаза
+
+    Netlist result;                       ///< Отображённая схема
+    QString error;                        ///< Текст последней ошибки
+    Statistics stats;                     ///< Статистика
+};
+
+#endif // TECHMAPPER_H
@@ -0,0 +1,481 @@
+#include "TiledGraphicsView.h"
+#include <QFontMetricsF>
+#include <QMutexLocker>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QThread>
+#include <QTransform>
+#include <algorithm>
+#include <cmath>
+
+// Константы.
+static constexpr int TILE_SIZE = 256;
+static constexpr int LEVELS_PER_OCTAVE = 2;
+static constexpr int MIN_LEVEL = -16;
+static constexpr int MAX_LEVEL = 16;
+static constexpr int DEFAULT_TILING_THRESHOLD = 2000;
+static constexpr int MAX_CACHED_TILES = 768;
+static constexpr int MAX_PENDING_PER_THREAD = 4;
+static constexpr int FALLBACK_LEVELS = 3;
+static constexpr int MAX_DIRTY_REGIONS = 64;
+static constexpr qreal MIN_INDEX_CELL = 64.0;
+static constexpr qreal INDEX_CELL_FACTOR = 2.0;
+static constexpr qreal TEXT_MARGIN = 4.0;
+static constexpr qreal TILE_BLEED = 1.0;
+static constexpr quint64 KEY_OFFSET = quint64(1) << 27;
+static constexpr quint64 KEY_MASK = (quint64(1) << 28) - 1;
+
+// Диапазон плиток (или ячеек) стороны side, покрывающих region.
+static void cellRange(const QRectF& region, const QPointF& origin, qreal side,
+                      int& left, int& top, int& right, int& bottom)
+{
+    left = static_cast<int>(std::floor((region.left() - origin.x()) / side));
+    top = static_cast<int>(std::floor((region.top() - origin.y()) / side));
+    right = std::max(left, static_cast<int>(std::ceil((region.right() - origin.x()) / side)) - 1);
+    bottom = std::max(top, static_cast<int>(std::ceil((region.bottom() - origin.y()) / side)) - 1);
+}
+
+// Прямоугольник viewport с округлёнными краями, чтобы соседние плитки не расходились.
+static QRectF snapped(const QRectF& rect)
+{
+    return QRectF(QPointF(std::round(rect.left()), std::round(rect.top())),
+                  QPointF(std::round(rect.right()), std::round(rect.bottom())));
+}
+
+// Конструктор.
+TiledGraphicsView::TiledGraphicsView(QWidget* parent)
+    : QGraphicsView(parent)
+    , threshold(DEFAULT_TILING_THRESHOLD)
+{
+    // Один поток остаётся потоку GUI.
+    pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+}
+
+// Деструктор.
+TiledGraphicsView::~TiledGraphicsView()
+{
+    pool.clear();
+    pool.waitForDone();
+}
+
+// Задать порог числа элементов.
+void TiledGraphicsView::setTilingThreshold(int items)
+{
+    threshold = std::max(0, items);
+    viewport()->update();
+}
+
+// Порог числа элементов.
+int TiledGraphicsView::tilingThreshold() const
+{
+    return threshold;
+}
+
+// Отрисовка видимой области плитками.
+void TiledGraphicsView::paintEvent(QPaintEvent* event)
+{
+    trackScene();
+
+    const QTransform transform = viewportTransform();
+    const bool plainScale = transform.type() <= QTransform::TxScale
+                            && transform.m11() > 0 && qFuzzyCompare(transform.m11(), transform.m22());
+    if (trackedScene && plainScale && snapshotDirty) {
+        snapshot = takeSnapshot(trackedScene, logicalDpiY());
+        snapshotDirty = false;
+    }
+
+    if (!trackedScene || !plainScale || !snapshot || !snapshot->complete
+        || static_cast<int>(snapshot->layout.primitives.size()) < threshold) {
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+
+    const int level = levelFor(transform.m11());
+    const QRectF exposed = mapToScene(event->rect()).boundingRect();
+
+    QPainter painter(viewport());
+    painter.setTransform(transform);
+    drawBackground(&painter, exposed);
+
+    // Плитки выводятся в координатах viewport без масштабирования
+    // самого рисовальщика, чтобы края соседних плиток совпадали.
+    painter.resetTransform();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    int left, top, right, bottom;
+    cellRange(exposed, QPointF(), TILE_SIZE / levelScale(level), left, top, right, bottom);
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            auto it = tiles.find(tileKey(level, x, y));
+            if (it == tiles.end()) {
+                drawFallback(painter, transform, level, tileRect(level, x, y));
+                continue;
+            }
+            it->lastUse = ++useClock;
+            if (!it->image.isNull())
+                painter.drawImage(snapped(transform.mapRect(tileRect(level, x, y))), it->image);
+        }
+    }
+
+    painter.setTransform(transform);
+    drawForeground(&painter, exposed);
+    painter.end();
+
+    // Сначала заказывается весь видимый экран, затем экран вперёд
+    // по направлению последней прокрутки.
+    const QRectF visible = mapToScene(viewport()->rect()).boundingRect();
+    const QPointF delta = visible.center() - lastCenter;
+    if (!delta.isNull()) {
+        scrollDirection = QPointF((delta.x() > 0) - (delta.x() < 0), (delta.y() > 0) - (delta.y() < 0));
+        lastCenter = visible.center();
+    }
+
+    requestTiles(level, visible, 1);
+    if (!scrollDirection.isNull())
+        requestTiles(level, visible.translated(scrollDirection.x() * visible.width(),
+                                               scrollDirection.y() * visible.height()), 0);
+}
+
+// Снять снимок сцены и построить индекс.
+std::shared_ptr<const TiledGraphicsView::Snapshot> TiledGraphicsView::takeSnapshot(const QGraphicsScene* scene, int dpi)
+{
+    auto result = std::make_shared<Snapshot>();
+    result->layout = DiagramLayout::fromScene(scene);
+    result->dpi = dpi;
+
+    const std::vector<DiagramLayout::Primitive>& primitives = result->layout.primitives;
+    const int count = static_cast<int>(primitives.size());
+    result->complete = count == scene->items().size();
+
+    // Границы примитивов с запасом на толщину пера и сглаживание.
+    result->bounds.reserve(count);
+    for (const DiagramLayout::Primitive& p : primitives) {
+        QRectF rect;
+        qreal margin = TILE_BLEED;
+        switch (p.kind) {
+        case DiagramLayout::PrimitiveKind::RECT:
+        case DiagramLayout::PrimitiveKind::ELLIPSE:
+            rect = p.rect.normalized();
+            margin += p.pen.widthF() / 2.0;
+            break;
+        case DiagramLayout::PrimitiveKind::LINE:
+            rect = QRectF(p.line.p1(), p.line.p2()).normalized();
+            margin += p.pen.widthF() / 2.0;
+            break;
+        case DiagramLayout::PrimitiveKind::TEXT:
+            rect = QRectF(QPointF(0, 0), QFontMetricsF(p.font).size(0, p.text))
+                       .adjusted(0, 0, 2 * TEXT_MARGIN, 2 * TEXT_MARGIN);
+            break;
+        }
+        rect = rect.translated(p.pos).adjusted(-margin, -margin, margin, margin);
+        result->bounds.push_back(rect);
+        result->area = result->area.united(rect);
+    }
+    if (count == 0 || result->area.isEmpty())
+        return result;
+
+    // Сеточный индекс в формате CSR: примерно четыре примитива на ячейку.
+    const QRectF& area = result->area;
+    result->cellSize = std::max(MIN_INDEX_CELL, std::sqrt(area.width() * area.height() / count) * INDEX_CELL_FACTOR);
+    result->columns = std::max(1, static_cast<int>(std::ceil(area.width() / result->cellSize)));
+    result->rows = std::max(1, static_cast<int>(std::ceil(area.height() / result->cellSize)));
+
+    auto forEachCell = [&result](const QRectF& rect, const auto& visit) {
+        int left, top, right, bottom;
+        cellRange(rect, result->area.topLeft(), result->cellSize, left, top, right, bottom);
+        left = std::max(left, 0);
+        top = std::max(top, 0);
+        right = std::min(right, result->columns - 1);
+        bottom = std::min(bottom, result->rows - 1);
+        for (int y = top; y <= bottom; ++y)
+            for (int x = left; x <= right; ++x)
+                visit(y * result->columns + x);
+    };
+
+    result->cellStart.assign(result->columns * result->rows + 1, 0);
+    for (const QRectF& rect : result->bounds)
+        forEachCell(rect, [&result](int cell) { ++result->cellStart[cell + 1]; });
+    for (size_t cell = 1; cell < result->cellStart.size(); ++cell)
+        result->cellStart[cell] += result->cellStart[cell - 1];
+
+    result->cellItems.resize(result->cellStart.back());
+    std::vector<int> fill(result->cellStart.begin(), result->cellStart.end() - 1);
+    for (int i = 0; i < count; ++i)
+        forEachCell(result->bounds[i], [&result, &fill, i](int cell) { result->cellItems[fill[cell]++] = i; });
+
+    return result;
+}
+
+// Нарисовать плитку по снимку.
+QImage TiledGraphicsView::renderTile(const Snapshot& snapshot, const QRectF& rect, qreal scale)
+{
+    std::vector<int> indices;
+    if (snapshot.columns > 0 && rect.intersects(snapshot.area)) {
+        int left, top, right, bottom;
+        cellRange(rect.intersected(snapshot.area), snapshot.area.topLeft(), snapshot.cellSize,
+                  left, top, right, bottom);
+        for (int y = std::max(top, 0); y <= std::min(bottom, snapshot.rows - 1); ++y) {
+            for (int x = std::max(left, 0); x <= std::min(right, snapshot.columns - 1); ++x) {
+                const int cell = y * snapshot.columns + x;
+                for (int k = snapshot.cellStart[cell]; k < snapshot.cellStart[cell + 1]; ++k) {
+                    const int i = snapshot.cellItems[k];
+                    if (snapshot.bounds[i].intersects(rect))
+                        indices.push_back(i);
+                }
+            }
+        }
+    }
+    if (indices.empty())
+        return QImage();
+
+    // Индексы примитивов совпадают с z-порядком сцены.
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    QImage image(TILE_SIZE, TILE_SIZE, QImage::Format_ARGB32_Premultiplied);
+    const int dotsPerMeter = qRound(snapshot.dpi / 0.0254);
+    image.setDotsPerMeterX(dotsPerMeter);
+    image.setDotsPerMeterY(dotsPerMeter);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.scale(scale, scale);
+    painter.translate(-rect.topLeft());
+
+    for (int i : indices) {
+        const DiagramLayout::Primitive& p = snapshot.layout.primitives[i];
+        switch (p.kind) {
+        case DiagramLayout::PrimitiveKind::RECT:
+            painter.setPen(p.pen);
+            painter.setBrush(p.brush);
+            painter.drawRect(p.rect.translated(p.pos));
+            break;
+        case DiagramLayout::PrimitiveKind::ELLIPSE:
+            painter.setPen(p.pen);
+            painter.setBrush(p.brush);
+            painter.drawEllipse(p.rect.translated(p.pos));
+            break;
+        case DiagramLayout::PrimitiveKind::LINE:
+            painter.setPen(p.pen);
+            painter.drawLine(p.line.translated(p.pos));
+            break;
+        case DiagramLayout::PrimitiveKind::TEXT:
+            // QGraphicsTextItem отступает от позиции на поле документа.
+            painter.setPen(p.color);
+            painter.setFont(p.font);
+            painter.drawText(QRectF(p.pos + QPointF(TEXT_MARGIN, TEXT_MARGIN), snapshot.bounds[i].size()),
+                             Qt::AlignLeft | Qt::AlignTop | Qt::TextDontClip, p.text);
+            break;
+        }
+    }
+    return image;
+}
+
+// Ключ плитки.
+quint64 TiledGraphicsView::tileKey(int level, int x, int y)
+{
+    // 8 бит уровня и по 28 бит на столбец и строку со смещением.
+    return (quint64(quint8(level)) << 56)
+           | ((quint64(x + KEY_OFFSET) & KEY_MASK) << 28)
+           | (quint64(y + KEY_OFFSET) & KEY_MASK);
+}
+
+// Уровень масштаба для масштаба вида.
+int TiledGraphicsView::levelFor(qreal scale)
+{
+    const int level = static_cast<int>(std::ceil(std::log2(scale) * LEVELS_PER_OCTAVE - 1e-6));
+    return std::clamp(level, MIN_LEVEL, MAX_LEVEL);
+}
+
+// Масштаб уровня.
+qreal TiledGraphicsView::levelScale(int level)
+{
+    return std::pow(2.0, static_cast<qreal>(level) / LEVELS_PER_OCTAVE);
+}
+
+// Область сцены плитки.
+QRectF TiledGraphicsView::tileRect(int level, int x, int y)
+{
+    const qreal side = TILE_SIZE / levelScale(level);
+    return QRectF(x * side, y * side, side, side);
+}
+
+// Следить за сценой, если она сменилась.
+void TiledGraphicsView::trackScene()
+{
+    QGraphicsScene* current = scene();
+    if (current == trackedScene)
+        return;
+
+    if (trackedScene)
+        disconnect(trackedScene, nullptr, this, nullptr);
+    trackedScene = current;
+    tiles.clear();
+    pending.clear();
+    snapshot.reset();
+    snapshotDirty = true;
+
+    if (trackedScene)
+        connect(trackedScene, &QGraphicsScene::changed, this, &TiledGraphicsView::invalidate);
+}
+
+// Удалить плитки изменившихся областей.
+void TiledGraphicsView::invalidate(const QList<QRectF>& regions)
+{
+    if (regions.isEmpty())
+        return;
+    snapshotDirty = true;
+
+    // Много мелких областей (например, при заполнении сцены)
+    // заменяются их общей границей.
+    QList<QRectF> dirty;
+    if (regions.size() > MAX_DIRTY_REGIONS) {
+        QRectF united;
+        for (const QRectF& region : regions)
+            united = united.united(region);
+        dirty.append(united);
+    } else {
+        dirty = regions;
+    }
+    for (QRectF& region : dirty)
+        region.adjust(-TILE_BLEED, -TILE_BLEED, TILE_BLEED, TILE_BLEED);
+
+    auto touched = [&dirty](int level, int x, int y) {
+        const QRectF rect = tileRect(level, x, y);
+        for (const QRectF& region : dirty)
+            if (region.intersects(rect))
+                return true;
+        return false;
+    };
+
+    for (auto it = tiles.begin(); it != tiles.end();) {
+        if (touched(it->level, it->x, it->y))
+            it = tiles.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (touched(it->level, it->x, it->y))
+            it = pending.erase(it);
+        else
+            ++it;
+    }
+
+    viewport()->update();
+}
+
+// Заказать недостающие плитки области.
+void TiledGraphicsView::requestTiles(int level, const QRectF& region, int priority)
+{
+    const int limit = MAX_PENDING_PER_THREAD * pool.maxThreadCount();
+    int left, top, right, bottom;
+    cellRange(region, QPointF(), TILE_SIZE / levelScale(level), left, top, right, bottom);
+
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            if (pending.size() >= limit)
+                return;
+
+            const quint64 key = tileKey(level, x, y);
+            if (tiles.contains(key) || pending.contains(key))
+                continue;
+
+            // Плитка вне схемы пуста и рисовать её не нужно.
+            const QRectF rect = tileRect(level, x, y);
+            if (!rect.intersects(snapshot->area)) {
+                tiles.insert(key, Tile{QImage(), ++useClock, level, x, y});
+                continue;
+            }
+
+            const quint64 job = ++jobCounter;
+            pending.insert(key, Pending{job, level, x, y});
+
+            const std::shared_ptr<const Snapshot> source = snapshot;
+            const qreal scale = levelScale(level);
+            pool.start([this, source, key, job, rect, scale]() {
+                QImage image = renderTile(*source, rect, scale);
+                {
+                    QMutexLocker locker(&resultMutex);
+                    results.push_back(Result{key, job, std::move(image)});
+                }
+                QMetaObject::invokeMethod(this, [this]() { collectTiles(); }, Qt::QueuedConnection);
+            }, priority);
+        }
+    }
+}
+
+// Забрать нарисованные плитки.
+void TiledGraphicsView::collectTiles()
+{
+    std::vector<Result> ready;
+    {
+        QMutexLocker locker(&resultMutex);
+        ready.swap(results);
+    }
+    if (ready.empty())
+        return;
+
+    // Ответы на заказы, отменённые сменой сцены или изменением области,
+    // отбрасываются по номеру заказа.
+    for (Result& result : ready) {
+        auto it = pending.find(result.key);
+        if (it == pending.end() || it->job != result.job)
+            continue;
+        tiles.insert(result.key, Tile{std::move(result.image), ++useClock, it->level, it->x, it->y});
+        pending.erase(it);
+    }
+
+    evictTiles();
+    viewport()->update();
+}
+
+// Нарисовать на месте отсутствующей плитки плитки соседних уровней.
+void TiledGraphicsView::drawFallback(QPainter& painter, const QTransform& transform, int level, const QRectF& rect)
+{
+    painter.save();
+    painter.setClipRect(snapped(transform.mapRect(rect)));
+
+    for (int distance = 1; distance <= FALLBACK_LEVELS; ++distance) {
+        for (int other : {level - distance, level + distance}) {
+            if (other < MIN_LEVEL || other > MAX_LEVEL)
+                continue;
+
+            bool found = false;
+            int left, top, right, bottom;
+            cellRange(rect, QPointF(), TILE_SIZE / levelScale(other), left, top, right, bottom);
+            for (int y = top; y <= bottom; ++y) {
+                for (int x = left; x <= right; ++x) {
+                    auto it = tiles.constFind(tileKey(other, x, y));
+                    if (it == tiles.constEnd())
+                        continue;
+                    found = true;
+                    if (!it->image.isNull())
+                        painter.drawImage(snapped(transform.mapRect(tileRect(other, x, y))), it->image);
+                }
+            }
+            if (found) {
+                painter.restore();
+                return;
+            }
+        }
+    }
+    painter.restore();
+}
+
+// Вытеснить давно не показанные плитки.
+void TiledGraphicsView::evictTiles()
+{
+    if (tiles.size() <= MAX_CACHED_TILES)
+        return;
+
+    std::vector<std::pair<quint64, quint64>> ages;
+    ages.reserve(tiles.size());
+    for (auto it = tiles.cbegin(); it != tiles.cend(); ++it)
+        ages.emplace_back(it->lastUse, it.key());
+
+    const size_t excess = tiles.size() - MAX_CACHED_TILES * 3 / 4;
+    std::nth_element(ages.begin(), ages.begin() + excess, ages.end());
+    for (size_t i = 0; i < excess; ++i)
+        tiles.remove(ages[i].second);
+}
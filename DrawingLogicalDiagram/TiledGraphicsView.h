@@ -0,0 +1,230 @@
+#ifndef TILEDGRAPHICSVIEW_H
+#define TILEDGRAPHICSVIEW_H
+
+#include <QGraphicsView>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QPointer>
+#include <QThreadPool>
+#include <memory>
+#include <vector>
+#include "DiagramLayout.h"
+
+/**
+ * @class TiledGraphicsView
+ * @brief Просмотр большой схемы через кэш растровых плиток
+ *
+ * Обычный QGraphicsView при каждой прокрутке перерисовывает в потоке GUI
+ * все видимые элементы сцены, и на больших схемах панорамирование
+ * дёргается. Этот вид рисует сцену готовыми плитками TILE_SIZE×TILE_SIZE,
+ * поэтому стоимость кадра зависит от числа плиток, а не элементов.
+ *
+ * @details
+ * - Плитки хранятся отдельно для каждого уровня масштаба (шаг — полоктавы).
+ *   Пока плитки текущего уровня нет, на её месте показывается плитка
+ *   соседнего уровня, если она есть в кэше.
+ * - Плитки рисуются в QThreadPool по снимку сцены (DiagramLayout
+ *   с сеточным индексом примитивов), поэтому рабочие потоки не касаются
+ *   элементов сцены. Сначала заказываются видимые плитки, затем
+ *   плитки на экран вперёд по направлению прокрутки.
+ * - По сигналу QGraphicsScene::changed удаляются только плитки,
+ *   пересекающие изменившиеся области; снимок пересоздаётся при
+ *   следующей отрисовке.
+ * - Небольшие сцены, сцены с элементами, которых нет в DiagramLayout,
+ *   и преобразования с поворотом рисуются обычным QGraphicsView.
+ */
+class TiledGraphicsView : public QGraphicsView
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Конструктор
+     * @param parent Родительский виджет
+     */
+    explicit TiledGraphicsView(QWidget* parent = nullptr);
+
+    /**
+     * @brief Деструктор; дожидается рабочих потоков
+     */
+    ~TiledGraphicsView() override;
+
+    /**
+     * @brief Задать наименьшее число элементов сцены для режима плиток
+     * @param items Порог; 0 — плитки всегда
+     */
+    void setTilingThreshold(int items);
+
+    /**
+     * @brief Наименьшее число элементов сцены для режима плиток
+     * @return Порог
+     */
+    int tilingThreshold() const;
+
+protected:
+    /**
+     * @brief Отрисовка видимой области плитками
+     * @param event Событие отрисовки
+     */
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    /**
+     * @struct Snapshot
+     * @brief Неизменяемый снимок сцены для рабочих потоков
+     */
+    struct Snapshot
+    {
+        DiagramLayout layout;         ///< Примитивы сцены
+        std::vector<QRectF> bounds;   ///< Границы примитивов на сцене
+        QRectF area;                  ///< Объединение границ
+        qreal cellSize = 0;           ///< Сторона ячейки индекса
+        int columns = 0;              ///< Столбцов индекса
+        int rows = 0;                 ///< Строк индекса
+        std::vector<int> cellStart;   ///< CSR: начало списка ячейки
+        std::vector<int> cellItems;   ///< CSR: примитивы ячеек по возрастанию z
+        int dpi = 96;                 ///< Разрешение плиток для шрифтов
+        bool complete = false;        ///< Все элементы сцены попали в снимок
+    };
+
+    /**
+     * @struct Tile
+     * @brief Готовая плитка
+     */
+    struct Tile
+    {
+        QImage image;         ///< Изображение с прозрачным фоном
+        quint64 lastUse = 0;  ///< Момент последнего показа (для вытеснения)
+        int level = 0;        ///< Уровень масштаба
+        int x = 0;            ///< Столбец плитки
+        int y = 0;            ///< Строка плитки
+    };
+
+    /**
+     * @struct Pending
+     * @brief Плитка, заказанная рабочему потоку
+     */
+    struct Pending
+    {
+        quint64 job = 0;  ///< Номер заказа; ответ старого заказа отбрасывается
+        int level = 0;    ///< Уровень масштаба
+        int x = 0;        ///< Столбец плитки
+        int y = 0;        ///< Строка плитки
+    };
+
+    /**
+     * @struct Result
+     * @brief Плитка, нарисованная рабочим потоком
+     */
+    struct Result
+    {
+        quint64 key;   ///< Ключ плитки
+        quint64 job;   ///< Номер заказа
+        QImage image;  ///< Изображение
+    };
+
+    /**
+     * @brief Снять снимок сцены и построить индекс
+     * @param scene Сцена
+     * @param dpi Логическое разрешение экрана (для размеров шрифтов)
+     * @return Снимок
+     */
+    static std::shared_ptr<const Snapshot> takeSnapshot(const QGraphicsScene* scene, int dpi);
+
+    /**
+     * @brief Нарисовать плитку по снимку
+     * @param snapshot Снимок сцены
+     * @param rect Область сцены плитки
+     * @param scale Масштаб уровня
+     * @return Изображение TILE_SIZE×TILE_SIZE
+     */
+    static QImage renderTile(const Snapshot& snapshot, const QRectF& rect, qreal scale);
+
+    /**
+     * @brief Ключ плитки
+     * @param level Уровень масштаба
+     * @param x Столбец
+     * @param y Строка
+     * @return Ключ для кэша
+     */
+    static quint64 tileKey(int level, int x, int y);
+
+    /**
+     * @brief Уровень масштаба для масштаба вида
+     * @param scale Масштаб вида
+     * @return Наименьший уровень, масштаб которого не меньше scale
+     */
+    static int levelFor(qreal scale);
+
+    /**
+     * @brief Масштаб уровня
+     * @param level Уровень
+     * @return 2 в степени level / LEVELS_PER_OCTAVE
+     */
+    static qreal levelScale(int level);
+
+    /**
+     * @brief Область сцены плитки
+     * @param level Уровень масштаба
+     * @param x Столбец
+     * @param y Строка
+     * @return Прямоугольник на сцене
+     */
+    static QRectF tileRect(int level, int x, int y);
+
+    /**
+     * @brief Следить за сценой, если она сменилась
+     */
+    void trackScene();
+
+    /**
+     * @brief Удалить плитки изменившихся областей
+     * @param regions Области сцены
+     */
+    void invalidate(const QList<QRectF>& regions);
+
+    /**
+     * @brief Заказать недостающие плитки области
+     * @param level Уровень масштаба
+     * @param region Область сцены
+     * @param priority Приоритет в пуле
+     */
+    void requestTiles(int level, const QRectF& region, int priority);
+
+    /**
+     * @brief Забрать нарисованные плитки (в потоке GUI)
+     */
+    void collectTiles();
+
+    /**
+     * @brief Нарисовать на месте отсутствующей плитки плитки соседних уровней
+     * @param painter Рисовальщик в координатах viewport
+     * @param transform Преобразование сцены в координаты viewport
+     * @param level Текущий уровень
+     * @param rect Область сцены отсутствующей плитки
+     */
+    void drawFallback(QPainter& painter, const QTransform& transform, int level, const QRectF& rect);
+
+    /**
+     * @brief Вытеснить давно не показанные плитки
+     */
+    void evictTiles();
+
+    int threshold;                               ///< Порог числа элементов
+    QPointer<QGraphicsScene> trackedScene;       ///< Сцена, за которой следим
+    std::shared_ptr<const Snapshot> snapshot;    ///< Текущий снимок
+    bool snapshotDirty = true;                   ///< Снимок устарел
+    QHash<quint64, Tile> tiles;                  ///< Кэш плиток
+    QHash<quint64, Pending> pending;             ///< Заказанные плитки
+    quint64 jobCounter = 0;                      ///< Счётчик заказов
+    quint64 useClock = 0;                        ///< Счётчик показов
+    QPointF lastCenter;                          ///< Центр вида в прошлом кадре
+    QPointF scrollDirection;                     ///< Знак последнего смещения по X и Y
+    QThreadPool pool;                            ///< Рабочие потоки
+    QMutex resultMutex;                          ///< Защищает results
+    std::vector<Result> results;                 ///< Готовые, но не забранные плитки
+};
+
+#endif // TILEDGRAPHICSVIEW_H
@@ -0,0 +1,244 @@
+#include "TimingAnalyzer.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <algorithm>
+
+// Задать задержки элементов.
+void TimingAnalyzer::setDelayModel(const DelayModel& model)
+{
+    this->model = model;
+}
+
+// Разобрать задержки из строки.
+bool TimingAnalyzer::parseDelayModel(const QString& text, DelayModel& model, QString* error)
+{
+    DelayModel parsed = model;
+    const QStringList pairs = QString(text).replace(',', ' ').simplified().split(' ', Qt::SkipEmptyParts);
+    for (const QString& pair : pairs) {
+        const int equals = pair.indexOf('=');
+        bool ok = equals > 0;
+        const double value = ok ? pair.mid(equals + 1).toDouble(&ok) : 0.0;
+        const QString name = pair.left(equals).toLower();
+        double* target = nullptr;
+        if (name == "not") target = &parsed.notDelay;
+        else if (name == "and") target = &parsed.andDelay;
+        else if (name == "or") target = &parsed.orDelay;
+        else if (name == "xor") target = &parsed.xorDelay;
+        else if (name == "fanin") target = &parsed.faninDelay;
+        else if (name == "input") target = &parsed.inputArrival;
+
+        if (!ok || !target || value < 0.0) {
+            if (error)
+                *error = QString("Неверная задержка \"%1\": ожидается not, and, or, xor, fanin "
+                                 "или input = неотрицательное число").arg(pair);
+            return false;
+        }
+        *target = value;
+    }
+    model = parsed;
+    return true;
+}
+
+// Задержки элементов.
+TimingAnalyzer::DelayModel TimingAnalyzer::delayModel() const
+{
+    return model;
+}
+
+// Задать период.
+void TimingAnalyzer::setPeriod(double period)
+{
+    this->period = period;
+}
+
+// Выполнить полный анализ дерева.
+void TimingAnalyzer::analyze(const SchemaTree::Node* root)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    this->root = root;
+    entries.clear();
+    stats = Statistics();
+    if (root)
+        stats.recomputed = analyzeSubtree(root, nullptr, 0.0);
+    stats.nodes = static_cast<int>(entries.size());
+    stats.elapsedUs = timer.nsecsElapsed() / 1000;
+}
+
+// Обновить анализ после правки поддерева.
+void TimingAnalyzer::update(const SchemaTree::Node* node)
+{
+    auto it = entries.find(node);
+    if (it == entries.end()) {
+        analyze(root);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Прежние потомки удаляются до пересчёта: он перезаписывает
+    // ссылку на первого ребёнка.
+    const Entry old = it->second;
+    stats.removed = eraseDescendants(old);
+    stats.recomputed = analyzeSubtree(node, old.parent, old.downstream);
+
+    // Предки: время прихода меняется только вдоль пути к корню.
+    const SchemaTree::Node* current = old.parent;
+    while (current) {
+        Entry& entry = entries[current];
+        const double arrival = arrivalFromChildren(current);
+        ++stats.recomputed;
+        if (arrival == entry.arrival)
+            break;
+        entry.arrival = arrival;
+        current = entry.parent;
+    }
+    stats.nodes = static_cast<int>(entries.size());
+    stats.elapsedUs = timer.nsecsElapsed() / 1000;
+}
+
+// Объём последнего анализа.
+TimingAnalyzer::Statistics TimingAnalyzer::statistics() const
+{
+    return stats;
+}
+
+// Временные характеристики узла.
+TimingAnalyzer::NodeTiming TimingAnalyzer::timing(const SchemaTree::Node* node) const
+{
+    NodeTiming result;
+    auto it = entries.find(node);
+    if (it == entries.end())
+        return result;
+
+    const double target = period > 0.0 ? period : criticalDelay();
+    result.arrival = it->second.arrival;
+    result.required = target - it->second.downstream;
+    result.slack = result.required - result.arrival;
+    return result;
+}
+
+// Задержка критического пути.
+double TimingAnalyzer::criticalDelay() const
+{
+    auto it = entries.find(root);
+    return it == entries.end() ? 0.0 : it->second.arrival;
+}
+
+// Критический путь от выхода Y к входу.
+std::vector<const SchemaTree::Node*> TimingAnalyzer::criticalPath() const
+{
+    std::vector<const SchemaTree::Node*> path;
+    const SchemaTree::Node* node = root;
+    while (node) {
+        path.push_back(node);
+
+        const SchemaTree::Node* next = nullptr;
+        double latest = 0.0;
+        for (const auto& child : node->children) {
+            const double arrival = entries.at(child.get()).arrival;
+            if (!next || arrival > latest) {
+                next = child.get();
+                latest = arrival;
+            }
+        }
+        node = next;
+    }
+    return path;
+}
+
+// Узлы критического пути в виде множества для подсветки.
+QSet<const SchemaTree::Node*> TimingAnalyzer::criticalNodes() const
+{
+    QSet<const SchemaTree::Node*> nodes;
+    for (const SchemaTree::Node* node : criticalPath())
+        nodes.insert(node);
+    return nodes;
+}
+
+// Задержка самого узла.
+double TimingAnalyzer::nodeDelay(const SchemaTree::Node* node) const
+{
+    switch (node->type) {
+    case NodeType::VAR:
+        return 0.0;
+    case NodeType::NOT:
+        return model.notDelay;
+    case NodeType::OP:
+        break;
+    }
+
+    double delay = model.andDelay;
+    if (node->value == "|") delay = model.orDelay;
+    else if (node->value == "^") delay = model.xorDelay;
+
+    const int extra = static_cast<int>(node->children.size()) - 2;
+    return delay + std::max(0, extra) * model.faninDelay;
+}
+
+// Удалить записи потомков узла, сохранённые при анализе.
+int TimingAnalyzer::eraseDescendants(const Entry& entry)
+{
+    int removed = 0;
+    std::vector<const SchemaTree::Node*> stack;
+    if (entry.firstChild)
+        stack.push_back(entry.firstChild);
+    while (!stack.empty()) {
+        auto it = entries.find(stack.back());
+        stack.pop_back();
+        if (it == entries.end())
+            continue;
+        if (it->second.firstChild)
+            stack.push_back(it->second.firstChild);
+        if (it->second.nextSibling)
+            stack.push_back(it->second.nextSibling);
+        entries.erase(it);
+        ++removed;
+    }
+    return removed;
+}
+
+// Время прихода узла по временам прихода детей.
+double TimingAnalyzer::arrivalFromChildren(const SchemaTree::Node* node) const
+{
+    if (node->type == NodeType::VAR)
+        return model.inputArrival;
+
+    double latest = model.inputArrival;
+    for (const auto& child : node->children)
+        latest = std::max(latest, entries.at(child.get()).arrival);
+    return latest + nodeDelay(node);
+}
+
+// Пересчитать поддерево без рекурсии.
+int TimingAnalyzer::analyzeSubtree(const SchemaTree::Node* node,
+                                   const SchemaTree::Node* parent,
+                                   double downstream)
+{
+    // Прямой проход сверху вниз задаёт родителей, downstream и ссылки
+    // на детей, обратный проход по тому же списку вычисляет время прихода.
+    // Ссылка на следующего брата у корня поддерева сохраняется.
+    std::vector<const SchemaTree::Node*> order{node};
+    Entry& top = entries[node];
+    top.downstream = downstream;
+    top.parent = parent;
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        const SchemaTree::Node* current = order[i];
+        Entry& entry = entries[current];
+        const double below = entry.downstream + nodeDelay(current);
+        entry.firstChild = current->children.empty() ? nullptr : current->children.front().get();
+        for (size_t c = 0; c < current->children.size(); ++c) {
+            const SchemaTree::Node* child = current->children[c].get();
+            const SchemaTree::Node* next = c + 1 < current->children.size() ? current->children[c + 1].get() : nullptr;
+            entries[child] = Entry{0.0, below, current, nullptr, next};
+            order.push_back(child);
+        }
+    }
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+        entries[*it].arrival = arrivalFromChildren(*it);
+    return static_cast<int>(order.size());
+}
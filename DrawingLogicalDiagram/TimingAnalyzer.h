@@ -0,0 +1,203 @@
+#ifndef TIMINGANALYZER_H
+#define TIMINGANALYZER_H
+
+#include <QSet>
+#include <QString>
+#include <unordered_map>
+#include <vector>
+#include "SchemaTree.h"
+
+/**
+ * @class TimingAnalyzer
+ * @brief Статический временной анализ дерева схемы
+ *
+ * Для каждого узла вычисляются время прихода сигнала (arrival),
+ * требуемое время (required) и запас (slack) при заданных задержках
+ * элементов. Критический путь — цепочка узлов с наибольшим временем
+ * прихода от входа до выхода Y.
+ *
+ * @details
+ * - Задержка узла зависит от типа оператора и числа его входов.
+ * - Анализ выполняется за линейное время одним обходом дерева.
+ * - В дереве у каждого узла единственный путь до выхода, поэтому
+ *   для узла хранится суммарная задержка элементов ниже по этому пути
+ *   (downstream). Требуемое время равно T − downstream, где T — период
+ *   (по умолчанию задержка критического пути), и не хранится явно.
+ * - После правки поддерева update() пересчитывает только это поддерево
+ *   и время прихода его предков; запасы остальных узлов получаются
+ *   из сохранённых величин без полного пересчёта. Записи прежних
+ *   потомков удаляются по сохранённым ссылкам на первого ребёнка
+ *   и следующего брата: указатели служат только ключами и не
+ *   разыменовываются, поэтому потомки могут быть уже освобождены.
+ */
+class TimingAnalyzer {
+public:
+    /**
+     * @struct DelayModel
+     * @brief Задержки элементов
+     */
+    struct DelayModel
+    {
+        double inputArrival = 0.0;   ///< Время прихода сигналов на входы
+        double notDelay = 1.0;       ///< Задержка инвертора
+        double andDelay = 2.0;       ///< Задержка двухвходового AND
+        double orDelay = 2.0;        ///< Задержка двухвходового OR
+        double xorDelay = 3.0;       ///< Задержка двухвходового XOR
+        double faninDelay = 0.5;     ///< Добавка за каждый вход сверх двух
+    };
+
+    /**
+     * @struct Statistics
+     * @brief Объём последнего анализа
+     */
+    struct Statistics
+    {
+        int nodes = 0;         ///< Узлов в анализе
+        int recomputed = 0;    ///< Узлов, пересчитанных последним analyze() или update()
+        int removed = 0;       ///< Записей прежних потомков, удалённых update()
+        qint64 elapsedUs = 0;  ///< Время последнего analyze() или update(), мкс
+    };
+
+    /**
+     * @struct NodeTiming
+     * @brief Временные характеристики узла
+     */
+    struct NodeTiming
+    {
+        double arrival = 0.0;   ///< Время прихода сигнала на выход узла
+        double required = 0.0; ///< Требуемое время
+        double slack = 0.0;     ///< Запас: required − arrival
+    };
+
+    /**
+     * @brief Задать задержки элементов (до analyze())
+     * @param model Модель задержек
+     */
+    void setDelayModel(const DelayModel& model);
+
+    /**
+     * @brief Разобрать задержки из строки
+     * @param text Пары вида "not=1 and=2 or=2 xor=3 fanin=0.5 input=0"
+     *             через пробелы или запятые; неуказанные берутся из model
+     * @param model Сюда записываются задержки
+     * @param error Сюда записывается описание ошибки (может быть nullptr)
+     * @return true при успехе
+     */
+    static bool parseDelayModel(const QString& text, DelayModel& model, QString* error = nullptr);
+
+    /**
+     * @brief Задержки элементов
+     * @return Модель задержек
+     */
+    DelayModel delayModel() const;
+
+    /**
+     * @brief Задать период; 0 — период равен задержке критического пути
+     * @param period Требуемое время на выходе Y
+     */
+    void setPeriod(double period);
+
+    /**
+     * @brief Выполнить полный анализ дерева
+     * @param root Корень дерева (должен жить дольше анализатора)
+     */
+    void analyze(const SchemaTree::Node* root);
+
+    /**
+     * @brief Обновить анализ после правки поддерева
+     * @param node Ранее проанализированный узел, потомки которого изменились
+     *
+     * Пересчитывает поддерево node и время прихода его предков;
+     * подъём прекращается, как только время прихода не изменилось.
+     * Тип, значение и дети node могут быть заменены на месте; записи
+     * прежних потомков удаляются. Если node нет в анализе (например,
+     * на его месте новый объект), выполняется полный анализ от корня,
+     * переданного в analyze().
+     */
+    void update(const SchemaTree::Node* node);
+
+    /**
+     * @brief Объём последнего анализа
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief Временные характеристики узла
+     * @param node Узел дерева
+     * @return Время прихода, требуемое время и запас
+     */
+    NodeTiming timing(const SchemaTree::Node* node) const;
+
+    /**
+     * @brief Задержка критического пути (время прихода на выход Y)
+     * @return Задержка
+     */
+    double criticalDelay() const;
+
+    /**
+     * @brief Критический путь от выхода Y к входу
+     * @return Узлы пути, начиная с корня
+     */
+    std::vector<const SchemaTree::Node*> criticalPath() const;
+
+    /**
+     * @brief Узлы критического пути в виде множества для подсветки
+     * @return Множество узлов
+     */
+    QSet<const SchemaTree::Node*> criticalNodes() const;
+
+private:
+    /**
+     * @struct Entry
+     * @brief Сохраняемые величины узла
+     */
+    struct Entry
+    {
+        double arrival = 0.0;                     ///< Время прихода
+        double downstream = 0.0;                  ///< Сумма задержек от выхода узла до Y
+        const SchemaTree::Node* parent = nullptr; ///< Родитель
+        const SchemaTree::Node* firstChild = nullptr;   ///< Первый ребёнок при анализе (только ключ)
+        const SchemaTree::Node* nextSibling = nullptr;  ///< Следующий брат при анализе (только ключ)
+    };
+
+    /**
+     * @brief Задержка самого узла
+     * @param node Узел
+     * @return Задержка по модели
+     */
+    double nodeDelay(const SchemaTree::Node* node) const;
+
+    /**
+     * @brief Пересчитать поддерево без рекурсии
+     * @param node Корень поддерева
+     * @param parent Родитель корня
+     * @param downstream Сумма задержек от выхода корня до Y
+     * @return Число пересчитанных узлов
+     */
+    int analyzeSubtree(const SchemaTree::Node* node,
+                        const SchemaTree::Node* parent,
+                        double downstream);
+
+    /**
+     * @brief Удалить записи потомков узла, сохранённые при анализе
+     * @param entry Запись узла
+     * @return Число удалённых записей
+     */
+    int eraseDescendants(const Entry& entry);
+
+    /**
+     * @brief Время прихода узла по временам прихода детей
+     * @param node Узел
+     * @return Время прихода
+     */
+    double arrivalFromChildren(const SchemaTree::Node* node) const;
+
+    DelayModel model;                                            ///< Задержки элементов
+    double period = 0.0;                                         ///< Заданный период
+    const SchemaTree::Node* root = nullptr;                      ///< Корень дерева
+    std::unordered_map<const SchemaTree::Node*, Entry> entries;  ///< Величины узлов
+    Statistics stats;                                            ///< Объём последнего анализа
+};
+
+#endif // TIMINGANALYZER_H
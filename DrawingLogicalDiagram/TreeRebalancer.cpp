@@ -0,0 +1,179 @@
+#include "TreeRebalancer.h"
+#include "TimingAnalyzer.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Узлы дерева в прямом порядке обхода (родитель раньше потомков).
+static std::vector<SchemaTree::Node*> preorder(SchemaTree::Node* root)
+{
+    std::vector<SchemaTree::Node*> order;
+    std::vector<SchemaTree::Node*> stack{root};
+    while (!stack.empty()) {
+        SchemaTree::Node* node = stack.back();
+        stack.pop_back();
+        order.push_back(node);
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+            stack.push_back(it->get());
+    }
+    return order;
+}
+
+// Задать наибольшее число входов оператора.
+void TreeRebalancer::setMaxFanin(int maxFanin)
+{
+    fanin = (maxFanin == 1) ? 2 : std::max(0, maxFanin);
+}
+
+// Наибольшее число входов оператора.
+int TreeRebalancer::maxFanin() const
+{
+    return fanin;
+}
+
+// Преобразовать дерево.
+std::unique_ptr<SchemaTree::Node> TreeRebalancer::rebalance(std::unique_ptr<SchemaTree::Node> root)
+{
+    stats = Report();
+    if (!root)
+        return root;
+
+    measure(root.get(), stats.depthBefore, stats.layoutColumnsBefore, stats.nodesBefore, stats.delayBefore);
+
+    QElapsedTimer timer;
+    timer.start();
+    flatten(root.get());
+    if (fanin >= 2)
+        balance(root.get());
+    stats.elapsedUs = timer.nsecsElapsed() / 1000;
+
+    measure(root.get(), stats.depthAfter, stats.layoutColumnsAfter, stats.nodesAfter, stats.delayAfter);
+    return root;
+}
+
+// Отчёт о последнем преобразовании.
+TreeRebalancer::Report TreeRebalancer::report() const
+{
+    return stats;
+}
+
+// Слить цепочки одинаковых операторов.
+bool TreeRebalancer::flatten(SchemaTree::Node* root)
+{
+    bool changed = false;
+    // В обратном прямом порядке дети обрабатываются раньше родителя,
+    // поэтому к моменту слияния дочерняя цепочка уже плоская.
+    const std::vector<SchemaTree::Node*> order = preorder(root);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        SchemaTree::Node* node = *it;
+        if (node->type != NodeType::OP)
+            continue;
+
+        bool hasChain = false;
+        for (const auto& child : node->children)
+            hasChain |= child->type == NodeType::OP && child->value == node->value;
+        if (!hasChain)
+            continue;
+
+        std::vector<std::unique_ptr<SchemaTree::Node>> merged;
+        for (auto& child : node->children) {
+            if (child->type == NodeType::OP && child->value == node->value) {
+                for (auto& grandChild : child->children)
+                    merged.push_back(std::move(grandChild));
+            } else {
+                merged.push_back(std::move(child));
+            }
+        }
+        node->children = std::move(merged);
+        changed = true;
+    }
+    return changed;
+}
+
+// Пересобрать многовходовые узлы с ограничением числа входов.
+void TreeRebalancer::balance(SchemaTree::Node* root) const
+{
+    struct Operand
+    {
+        int height;                              ///< Глубина поддерева
+        int order;                               ///< Порядок появления (для устойчивости)
+        std::unique_ptr<SchemaTree::Node> node;  ///< Поддерево
+
+        bool operator>(const Operand& other) const
+        {
+            return height != other.height ? height > other.height : order > other.order;
+        }
+    };
+
+    std::unordered_map<const SchemaTree::Node*, int> heights;
+    auto heightOf = [&heights](const SchemaTree::Node* node) {
+        int height = 0;
+        for (const auto& child : node->children)
+            height = std::max(height, heights[child.get()]);
+        return height + 1;
+    };
+
+    const std::vector<SchemaTree::Node*> order = preorder(root);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        SchemaTree::Node* node = *it;
+        if (node->type == NodeType::OP && static_cast<int>(node->children.size()) > fanin) {
+            // Каждый раз объединяются fanin самых неглубоких операндов.
+            std::vector<Operand> operands;
+            int sequence = 0;
+            for (auto& child : node->children) {
+                const int height = heights[child.get()];
+                operands.push_back(Operand{height, sequence++, std::move(child)});
+            }
+            std::make_heap(operands.begin(), operands.end(), std::greater<Operand>());
+
+            while (static_cast<int>(operands.size()) > fanin) {
+                auto group = std::make_unique<SchemaTree::Node>(NodeType::OP, node->value);
+                int height = 0;
+                for (int i = 0; i < fanin; ++i) {
+                    std::pop_heap(operands.begin(), operands.end(), std::greater<Operand>());
+                    height = std::max(height, operands.back().height);
+                    group->children.push_back(std::move(operands.back().node));
+                    operands.pop_back();
+                }
+                heights[group.get()] = height + 1;
+                operands.push_back(Operand{height + 1, sequence++, std::move(group)});
+                std::push_heap(operands.begin(), operands.end(), std::greater<Operand>());
+            }
+
+            node->children.clear();
+            std::sort_heap(operands.begin(), operands.end(), std::greater<Operand>());
+            for (auto& operand : operands)
+                node->children.push_back(std::move(operand.node));
+        }
+        heights[node] = heightOf(node);
+    }
+}
+
+// Собрать метрики дерева.
+void TreeRebalancer::measure(const SchemaTree::Node* root, int& depth, int& columns, int& nodes, double& delay)
+{
+    // Глубина считается по всем узлам, столбцы компоновки — как
+    // в DrawingDiagram, где NOT рисуется кружком и столбца не занимает.
+    std::unordered_map<const SchemaTree::Node*, std::pair<int, int>> sizes;
+    const std::vector<SchemaTree::Node*> order = preorder(const_cast<SchemaTree::Node*>(root));
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        const SchemaTree::Node* node = *it;
+        int height = 0;
+        int width = 0;
+        for (const auto& child : node->children) {
+            height = std::max(height, sizes[child.get()].first);
+            width = std::max(width, sizes[child.get()].second);
+        }
+        sizes[node] = {height + 1, node->type == NodeType::NOT ? width : width + 1};
+    }
+
+    depth = sizes[root].first;
+    columns = sizes[root].second;
+    nodes = static_cast<int>(order.size());
+
+    TimingAnalyzer analyzer;
+    analyzer.analyze(root);
+    delay = analyzer.criticalDelay();
+}
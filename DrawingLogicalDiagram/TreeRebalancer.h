@@ -0,0 +1,101 @@
+#ifndef TREEREBALANCER_H
+#define TREEREBALANCER_H
+
+#include <QtGlobal>
+#include <memory>
+#include "SchemaTree.h"
+
+/**
+ * @class TreeRebalancer
+ * @brief Уменьшение глубины цепочек ассоциативных операторов
+ *
+ * SchemaTree разбирает операторы слева направо, и вложенные скобки
+ * дают перекошенные деревья, глубина которых линейна по числу
+ * операндов. Класс переписывает дерево, сохраняя его функцию:
+ *
+ * 1. Цепочки одинаковых операторов (&, |, ^), не разделённые NOT,
+ *    сливаются в один многовходовый узел.
+ * 2. Если задано ограничение числа входов, многовходовый узел
+ *    собирается заново из поддеревьев: каждый раз объединяются
+ *    самые неглубокие операнды, поэтому глубина результата
+ *    логарифмическая, а глубокие операнды оказываются ближе к выходу.
+ *
+ * Обход выполняется без рекурсии. Отчёт содержит глубину, число
+ * столбцов компоновки DrawingDiagram, число узлов и задержку
+ * критического пути (TimingAnalyzer) до и после преобразования.
+ */
+class TreeRebalancer {
+public:
+    /**
+     * @struct Report
+     * @brief Результаты последнего преобразования
+     */
+    struct Report
+    {
+        int depthBefore = 0;          ///< Глубина дерева до
+        int depthAfter = 0;           ///< Глубина дерева после
+        int layoutColumnsBefore = 0;  ///< Столбцы компоновки (NOT не считается) до
+        int layoutColumnsAfter = 0;   ///< Столбцы компоновки после
+        int nodesBefore = 0;          ///< Число узлов до
+        int nodesAfter = 0;           ///< Число узлов после
+        double delayBefore = 0.0;     ///< Задержка критического пути до
+        double delayAfter = 0.0;      ///< Задержка критического пути после
+        qint64 elapsedUs = 0;         ///< Время преобразования, мкс
+    };
+
+    /**
+     * @brief Задать наибольшее число входов оператора
+     * @param maxFanin Предел (2 и более); 0 — без ограничения, только слияние цепочек
+     */
+    void setMaxFanin(int maxFanin);
+
+    /**
+     * @brief Наибольшее число входов оператора
+     * @return Заданный предел
+     */
+    int maxFanin() const;
+
+    /**
+     * @brief Преобразовать дерево
+     * @param root Корень исходного дерева
+     * @return Корень эквивалентного дерева меньшей глубины
+     */
+    std::unique_ptr<SchemaTree::Node> rebalance(std::unique_ptr<SchemaTree::Node> root);
+
+    /**
+     * @brief Отчёт о последнем преобразовании
+     * @return Метрики до и после
+     */
+    Report report() const;
+
+    /**
+     * @brief Слить цепочки одинаковых операторов
+     * @param root Корень дерева
+     * @return true, если дерево изменилось
+     *
+     * Используется также проходом flatten в PassManager.
+     */
+    static bool flatten(SchemaTree::Node* root);
+
+private:
+    /**
+     * @brief Пересобрать многовходовые узлы с ограничением числа входов
+     * @param root Корень дерева
+     */
+    void balance(SchemaTree::Node* root) const;
+
+    /**
+     * @brief Собрать метрики дерева
+     * @param root Корень дерева
+     * @param depth Сюда записывается глубина
+     * @param columns Сюда записывается число столбцов компоновки
+     * @param nodes Сюда записывается число узлов
+     * @param delay Сюда записывается задержка критического пути
+     */
+    static void measure(const SchemaTree::Node* root, int& depth, int& columns, int& nodes, double& delay);
+
+    int fanin = 2;     ///< Наибольшее число входов оператора
+    Report stats;      ///< Отчёт о последнем преобразовании
+};
+
+#endif // TREEREBALANCER_H
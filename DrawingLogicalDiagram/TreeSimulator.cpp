@@ -0,0 +1,183 @@
+#include "TreeSimulator.h"
+#include <QElapsedTimer>
+
+// Конструктор.
+TreeSimulator::TreeSimulator(const SchemaTree::Node* root)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (root) {
+        std::vector<std::pair<const SchemaTree::Node*, int>> stack{{root, -1}};
+        while (!stack.empty()) {
+            const auto [node, parent] = stack.back();
+            stack.pop_back();
+
+            const int id = static_cast<int>(nodes.size());
+            nodes.push_back(node);
+            parents.push_back(parent);
+            arity.push_back(static_cast<int>(node->children.size()));
+            ids[node] = id;
+
+            Kind kind = Kind::AND;
+            if (node->type == NodeType::VAR) {
+                const bool constant = node->value == "0" || node->value == "1";
+                kind = constant ? Kind::CONSTANT : Kind::VARIABLE;
+                if (!constant) {
+                    std::vector<int>& list = leaves[node->value];
+                    if (list.empty())
+                        names << node->value;
+                    list.push_back(id);
+                }
+            } else if (node->type == NodeType::NOT) {
+                kind = Kind::NOT;
+            } else if (node->value == "|") {
+                kind = Kind::OR;
+            } else if (node->value == "^") {
+                kind = Kind::XOR;
+            }
+            kinds.push_back(kind);
+
+            for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+                stack.emplace_back(it->get(), id);
+        }
+    }
+
+    // В обратном прямом порядке дети вычисляются раньше родителя.
+    ones.assign(nodes.size(), 0);
+    values.assign(nodes.size(), 0);
+    marks.assign(nodes.size(), 0);
+    for (int id = static_cast<int>(nodes.size()) - 1; id >= 0; --id) {
+        if (kinds[id] == Kind::CONSTANT)
+            values[id] = nodes[id]->value == "1";
+        else if (kinds[id] != Kind::VARIABLE)
+            values[id] = evaluate(id);
+        if (values[id] && parents[id] >= 0)
+            ++ones[parents[id]];
+    }
+    for (const QString& name : names)
+        inputs[name] = false;
+
+    stats.nodes = static_cast<int>(nodes.size());
+    stats.buildUs = timer.nsecsElapsed() / 1000;
+}
+
+// Переменные дерева.
+QStringList TreeSimulator::variables() const
+{
+    return names;
+}
+
+// Задать значение переменной и распространить изменение.
+int TreeSimulator::setVariable(const QString& name, bool value)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    changed.clear();
+    const int nodeCount = stats.nodes;
+    const qint64 buildUs = stats.buildUs;
+    stats = Statistics();
+    stats.nodes = nodeCount;
+    stats.buildUs = buildUs;
+
+    const auto found = leaves.constFind(name);
+    if (found == leaves.constEnd() || inputs.value(name) == value) {
+        stats.elapsedNs = timer.nsecsElapsed();
+        return 0;
+    }
+    inputs[name] = value;
+    stats.leaves = static_cast<int>(found->size());
+
+    // Узел может измениться от нескольких листьев (A ^ A), поэтому
+    // в changed он попадает один раз, а цвет берётся по итоговому значению.
+    ++toggles;
+    auto note = [this](int id) {
+        if (marks[id] != toggles) {
+            marks[id] = toggles;
+            changed.push_back(nodes[id]);
+        }
+    };
+
+    for (int leaf : *found) {
+        values[leaf] = value;
+        note(leaf);
+
+        int id = leaf;
+        for (int parent = parents[id]; parent >= 0; id = parent, parent = parents[parent]) {
+            ++stats.visited;
+            ones[parent] += values[id] ? 1 : -1;
+            const bool next = evaluate(parent);
+            if (next == bool(values[parent]))
+                break;
+            values[parent] = next;
+            note(parent);
+        }
+    }
+
+    stats.changed = static_cast<int>(changed.size());
+    stats.elapsedNs = timer.nsecsElapsed();
+    return stats.changed;
+}
+
+// Переключить переменную.
+int TreeSimulator::toggle(const QString& name)
+{
+    return setVariable(name, !variable(name));
+}
+
+// Значение переменной.
+bool TreeSimulator::variable(const QString& name) const
+{
+    return inputs.value(name, false);
+}
+
+// Значение узла.
+bool TreeSimulator::value(const SchemaTree::Node* node) const
+{
+    const auto found = ids.find(node);
+    return found != ids.end() && values[found->second];
+}
+
+// Значение выхода Y.
+bool TreeSimulator::output() const
+{
+    return !values.empty() && values.front();
+}
+
+// Все узлы дерева.
+const std::vector<const SchemaTree::Node*>& TreeSimulator::treeNodes() const
+{
+    return nodes;
+}
+
+// Узлы, изменившие значение при последнем переключении.
+const std::vector<const SchemaTree::Node*>& TreeSimulator::changedNodes() const
+{
+    return changed;
+}
+
+// Объём работы последнего переключения.
+TreeSimulator::Statistics TreeSimulator::statistics() const
+{
+    return stats;
+}
+
+// Значение оператора по числу входов, равных 1.
+bool TreeSimulator::evaluate(int id) const
+{
+    switch (kinds[id]) {
+    case Kind::NOT:
+        return ones[id] == 0;
+    case Kind::AND:
+        return ones[id] == arity[id];
+    case Kind::OR:
+        return ones[id] > 0;
+    case Kind::XOR:
+        return ones[id] % 2 == 1;
+    case Kind::VARIABLE:
+    case Kind::CONSTANT:
+        break;
+    }
+    return values[id];
+}
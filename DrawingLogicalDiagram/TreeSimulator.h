@@ -0,0 +1,151 @@
+#ifndef TREESIMULATOR_H
+#define TREESIMULATOR_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <unordered_map>
+#include <vector>
+#include "SchemaTree.h"
+
+/**
+ * @class TreeSimulator
+ * @brief Интерактивное моделирование дерева схемы
+ *
+ * Значения всех узлов вычисляются один раз и хранятся; переключение
+ * переменной пересчитывает только пути от её листьев к выходу Y.
+ *
+ * @details
+ * - В дереве у каждого узла единственный путь до выхода, поэтому
+ *   изменение листа поднимается по родителям и останавливается
+ *   на первом узле, значение которого не изменилось.
+ * - Для оператора хранится число входов, равных 1: AND равен 1,
+ *   когда единицы на всех входах, OR — хотя бы на одном, XOR —
+ *   на нечётном числе. Изменение одного входа пересчитывает
+ *   оператор за O(1) независимо от числа его входов.
+ * - Узлы, изменившие значение, возвращает changedNodes(): по ним
+ *   перекрашиваются только затронутые элементы сцены.
+ * - Переменные "0" и "1" — константы и не переключаются.
+ */
+class TreeSimulator {
+public:
+    /**
+     * @struct Statistics
+     * @brief Объём работы последнего переключения
+     */
+    struct Statistics
+    {
+        int nodes = 0;          ///< Узлов дерева
+        int leaves = 0;         ///< Листьев переключённой переменной
+        int visited = 0;        ///< Пересчитано узлов
+        int changed = 0;        ///< Из них изменили значение
+        qint64 buildUs = 0;     ///< Время начального вычисления, мкс
+        qint64 elapsedNs = 0;   ///< Время последнего переключения, нс
+    };
+
+    /**
+     * @brief Конструктор
+     * @param root Корень дерева (должен жить дольше симулятора)
+     *
+     * Все переменные равны 0.
+     */
+    explicit TreeSimulator(const SchemaTree::Node* root);
+
+    /**
+     * @brief Переменные дерева
+     * @return Имена в порядке первого появления, без констант
+     */
+    QStringList variables() const;
+
+    /**
+     * @brief Задать значение переменной и распространить изменение
+     * @param name Имя переменной
+     * @param value Новое значение
+     * @return Число узлов, изменивших значение
+     */
+    int setVariable(const QString& name, bool value);
+
+    /**
+     * @brief Переключить переменную
+     * @param name Имя переменной
+     * @return Число узлов, изменивших значение
+     */
+    int toggle(const QString& name);
+
+    /**
+     * @brief Значение переменной
+     * @param name Имя переменной
+     * @return Текущее значение; false для неизвестного имени
+     */
+    bool variable(const QString& name) const;
+
+    /**
+     * @brief Значение узла
+     * @param node Узел дерева
+     * @return Текущее значение; false для чужого узла
+     */
+    bool value(const SchemaTree::Node* node) const;
+
+    /**
+     * @brief Значение выхода Y
+     * @return Значение корня
+     */
+    bool output() const;
+
+    /**
+     * @brief Все узлы дерева
+     * @return Узлы в прямом порядке обхода
+     */
+    const std::vector<const SchemaTree::Node*>& treeNodes() const;
+
+    /**
+     * @brief Узлы, изменившие значение при последнем переключении
+     * @return Узлы снизу вверх, включая листья
+     */
+    const std::vector<const SchemaTree::Node*>& changedNodes() const;
+
+    /**
+     * @brief Объём работы последнего переключения
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+private:
+    /**
+     * @enum Kind
+     * @brief Вид узла в плоском представлении
+     */
+    enum class Kind : char {
+        VARIABLE,   ///< Переменная
+        CONSTANT,   ///< Константа 0 или 1
+        NOT,        ///< Инверсия
+        AND,        ///< И
+        OR,         ///< ИЛИ
+        XOR         ///< Исключающее ИЛИ
+    };
+
+    /**
+     * @brief Значение оператора по числу входов, равных 1
+     * @param id Узел
+     * @return Значение
+     */
+    bool evaluate(int id) const;
+
+    std::vector<const SchemaTree::Node*> nodes;   ///< Узлы в прямом порядке обхода
+    std::vector<int> parents;                     ///< Родитель узла; -1 у корня
+    std::vector<Kind> kinds;                      ///< Вид узла
+    std::vector<int> arity;                       ///< Число входов
+    std::vector<int> ones;                        ///< Число входов, равных 1
+    std::vector<char> values;                     ///< Значения узлов
+    std::unordered_map<const SchemaTree::Node*, int> ids;  ///< Узел → номер
+    QHash<QString, std::vector<int>> leaves;      ///< Переменная → её листья
+    QStringList names;                            ///< Переменные в порядке появления
+    QHash<QString, bool> inputs;                  ///< Значения переменных
+    std::vector<int> marks;                       ///< Номер переключения, в котором узел записан в changed
+    int toggles = 0;                              ///< Число переключений
+    std::vector<const SchemaTree::Node*> changed; ///< Изменения последнего переключения
+    Statistics stats;                             ///< Статистика
+};
+
+#endif // TREESIMULATOR_H
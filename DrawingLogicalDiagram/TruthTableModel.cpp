@@ -0,0 +1,345 @@
+#include "TruthTableModel.h"
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QtAlgorithms>
+#include <algorithm>
+
+// Константы.
+static constexpr int MAX_INPUTS = 62;
+static constexpr int FETCH_ROWS = 1024;
+static constexpr int MAX_WINDOW_ROWS = 1 << 20;
+static constexpr int CACHE_BLOCKS = 1024;
+static constexpr int PREFETCH_BLOCKS = 8;
+static constexpr qint64 SCAN_SLICE_NS = 20 * 1000 * 1000;
+static constexpr quint64 SCAN_CHECK_BLOCKS = 64;
+static constexpr quint64 MAX_IDLE_SCAN_WORDS = 1ULL << 32;
+static constexpr quint64 ROW_MASKS[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL,
+};
+
+// Конструктор.
+TruthTableModel::TruthTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{}
+
+// Задать сеть.
+bool TruthTableModel::setGraph(const LogicGraph& graph)
+{
+    beginResetModel();
+
+    kinds.clear();
+    faninStart.clear();
+    fanins.clear();
+    inputColumn.clear();
+    outputGates.clear();
+    headers.clear();
+    inputCount = 0;
+    outputCount = 0;
+    total = 0;
+    filter = -1;
+    error.clear();
+
+    const bool ok = static_cast<int>(graph.inputs().size()) <= MAX_INPUTS;
+    if (!ok) {
+        error = QString("Таблица истинности строится для сетей не более чем с %1 входами, в сети %2")
+                    .arg(MAX_INPUTS).arg(graph.inputs().size());
+    } else {
+        // Сеть переписывается в плоские массивы, чтобы вычисление
+        // блока шло одним проходом по вентилям в топологическом порядке.
+        const int size = graph.size();
+        kinds.resize(size);
+        faninStart.resize(size + 1);
+        inputColumn.assign(size, -1);
+        for (int id = 0; id < size; ++id) {
+            const LogicGraph::Gate& gate = graph.gate(id);
+            kinds[id] = static_cast<quint8>(gate.kind);
+            faninStart[id] = static_cast<int>(fanins.size());
+            fanins.insert(fanins.end(), gate.fanins.begin(), gate.fanins.end());
+        }
+        faninStart[size] = static_cast<int>(fanins.size());
+
+        for (int id : graph.inputs()) {
+            inputColumn[id] = inputCount++;
+            headers.push_back(graph.inputName(id));
+        }
+        for (const LogicGraph::Output& output : graph.outputs()) {
+            outputGates.push_back(output.gate);
+            headers.push_back(output.name);
+            ++outputCount;
+        }
+        total = 1ULL << inputCount;
+    }
+
+    values.assign(kinds.size(), 0);
+    cacheWords.assign(static_cast<size_t>(CACHE_BLOCKS) * outputCount, 0);
+    resetWindow(0);
+    endResetModel();
+    return ok;
+}
+
+// Описание последней ошибки.
+QString TruthTableModel::errorString() const
+{
+    return error;
+}
+
+// Показывать только строки, где выход равен 1.
+void TruthTableModel::setFilterOutput(int output)
+{
+    if (output < -1 || output >= outputCount || output == filter)
+        return;
+
+    beginResetModel();
+    filter = output;
+    resetWindow(windowStart);
+    endResetModel();
+}
+
+// Выход фильтра.
+int TruthTableModel::filterOutput() const
+{
+    return filter;
+}
+
+// Начать окно со строки таблицы.
+void TruthTableModel::jumpTo(quint64 row)
+{
+    beginResetModel();
+    resetWindow(total ? std::min(row, total - 1) : 0);
+    endResetModel();
+}
+
+// Номер строки полной таблицы.
+quint64 TruthTableModel::truthRow(int row) const
+{
+    return filter >= 0 ? matches[row] : windowStart + row;
+}
+
+// Размер таблицы и объём вычислений.
+TruthTableModel::Statistics TruthTableModel::statistics() const
+{
+    Statistics stats;
+    stats.inputs = inputCount;
+    stats.outputs = outputCount;
+    stats.gates = static_cast<int>(kinds.size());
+    stats.totalRows = total;
+    stats.windowStart = windowStart;
+    stats.evaluatedBlocks = evaluatedBlocks;
+    stats.scannedRows = scannedRows;
+    stats.scanStopped = scanStopped;
+    stats.fetchUs = fetchUs;
+    return stats;
+}
+
+// Число строк окна.
+int TruthTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : windowRows;
+}
+
+// Число столбцов: входы и выходы.
+int TruthTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : inputCount + outputCount;
+}
+
+// Значение ячейки.
+QVariant TruthTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= windowRows)
+        return QVariant();
+    if (role == Qt::TextAlignmentRole)
+        return static_cast<int>(Qt::AlignCenter);
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    const quint64 row = truthRow(index.row());
+    const int column = index.column();
+    if (column < inputCount)
+        return static_cast<int>((row >> (inputCount - 1 - column)) & 1);
+
+    const quint64* outputs = cachedBlock(row / 64);
+    return static_cast<int>((outputs[column - inputCount] >> (row % 64)) & 1);
+}
+
+// Заголовки: имена входов и выходов, номера строк.
+QVariant TruthTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole)
+        return QVariant();
+    if (orientation == Qt::Horizontal)
+        return section < static_cast<int>(headers.size()) ? headers[section] : QVariant();
+    return section < windowRows ? QString::number(truthRow(section)) : QVariant();
+}
+
+// Можно ли расширить окно.
+bool TruthTableModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (parent.isValid() || windowRows >= MAX_WINDOW_ROWS)
+        return false;
+    if (filter >= 0)
+        return scanRow < total && !scanStopped;
+    return windowStart + windowRows < total;
+}
+
+// Расширить окно.
+void TruthTableModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    // Строки добавляются только после просмотра, поэтому
+    // представление получает их одним вызовом beginInsertRows.
+    const int first = windowRows;
+    const int added = loadRows();
+    if (added == 0) {
+        // Представление больше не спросит модель, пока не появятся
+        // строки, поэтому просмотр продолжается из цикла событий.
+        if (canFetchMore(parent))
+            QTimer::singleShot(0, this, [this]() { fetchMore(QModelIndex()); });
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), first, first + added - 1);
+    windowRows += added;
+    endInsertRows();
+}
+
+// Вычислить выходы для 64 строк.
+void TruthTableModel::evaluateBlock(quint64 block, quint64* outputs) const
+{
+    using Kind = LogicGraph::GateKind;
+
+    // Вход столбца c задаётся битом inputCount - 1 - c номера строки:
+    // младшие 6 битов меняются внутри слова, старшие — от блока к блоку.
+    const size_t count = kinds.size();
+    for (size_t id = 0; id < count; ++id) {
+        const int* in = fanins.data() + faninStart[id];
+        const int fanin = faninStart[id + 1] - faninStart[id];
+        quint64 value = 0;
+        switch (static_cast<Kind>(kinds[id])) {
+        case Kind::CONST0:
+            value = 0;
+            break;
+        case Kind::CONST1:
+            value = ~0ULL;
+            break;
+        case Kind::INPUT: {
+            const int bit = inputCount - 1 - inputColumn[id];
+            value = bit < 6 ? ROW_MASKS[bit] : (((block >> (bit - 6)) & 1) ? ~0ULL : 0);
+            break;
+        }
+        case Kind::NOT:
+            value = ~values[in[0]];
+            break;
+        case Kind::AND:
+            value = ~0ULL;
+            for (int k = 0; k < fanin; ++k)
+                value &= values[in[k]];
+            break;
+        case Kind::OR:
+            for (int k = 0; k < fanin; ++k)
+                value |= values[in[k]];
+            break;
+        case Kind::XOR:
+            for (int k = 0; k < fanin; ++k)
+                value ^= values[in[k]];
+            break;
+        }
+        values[id] = value;
+    }
+
+    for (int o = 0; o < outputCount; ++o)
+        outputs[o] = values[outputGates[o]];
+    ++evaluatedBlocks;
+}
+
+// Слова выходов блока из кэша.
+const quint64* TruthTableModel::cachedBlock(quint64 block) const
+{
+    quint64* words = cacheWords.data() + static_cast<size_t>(block % CACHE_BLOCKS) * outputCount;
+    if (cacheTags[block % CACHE_BLOCKS] == block + 1)
+        return words;
+
+    // Промах вычисляет и несколько следующих блоков: представление
+    // запрашивает строки подряд при прокрутке вниз.
+    const quint64 lastBlock = (total - 1) / 64;
+    for (quint64 b = block; b <= std::min(block + PREFETCH_BLOCKS - 1, lastBlock); ++b) {
+        if (cacheTags[b % CACHE_BLOCKS] == b + 1)
+            continue;
+        evaluateBlock(b, cacheWords.data() + static_cast<size_t>(b % CACHE_BLOCKS) * outputCount);
+        cacheTags[b % CACHE_BLOCKS] = b + 1;
+    }
+    return words;
+}
+
+// Подгрузить следующую порцию окна.
+int TruthTableModel::loadRows()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const int room = std::min(FETCH_ROWS, MAX_WINDOW_ROWS - windowRows);
+    int added = 0;
+    if (filter < 0) {
+        added = static_cast<int>(std::min<quint64>(room, total - windowStart - windowRows));
+    } else {
+        // Совпадения ищутся в тех же словах, что и при показе строк,
+        // но мимо кэша: просмотренные блоки обычно не показываются.
+        // Просмотр ограничен по времени, чтобы редкие единицы
+        // не останавливали поток GUI; остаток продолжает fetchMore.
+        std::vector<quint64> outputs(outputCount);
+        for (quint64 blocks = 0; scanRow < total && added < room; ++blocks) {
+            if (blocks % SCAN_CHECK_BLOCKS == SCAN_CHECK_BLOCKS - 1 && timer.nsecsElapsed() > SCAN_SLICE_NS)
+                break;
+            if (idleRows / 64 * kinds.size() >= MAX_IDLE_SCAN_WORDS) {
+                scanStopped = true;
+                break;
+            }
+
+            const quint64 block = scanRow / 64;
+            const quint64 firstRow = block * 64;
+            evaluateBlock(block, outputs.data());
+            quint64 word = outputs[filter] & (~0ULL << (scanRow - firstRow));
+            if (total - firstRow < 64)
+                word &= (1ULL << (total - firstRow)) - 1;
+
+            // Порция обрывается на найденной строке, если окно заполнено;
+            // следующий просмотр начнётся со строки после неё.
+            quint64 next = std::min(firstRow + 64, total);
+            const bool found = word != 0;
+            for (; word; word &= word - 1) {
+                if (added == room) {
+                    next = firstRow + qCountTrailingZeroBits(word);
+                    break;
+                }
+                matches.push_back(firstRow + qCountTrailingZeroBits(word));
+                ++added;
+            }
+            scannedRows += next - scanRow;
+            idleRows = found ? 0 : idleRows + (next - scanRow);
+            scanRow = next;
+        }
+    }
+
+    fetchUs = timer.nsecsElapsed() / 1000;
+    return added;
+}
+
+// Сбросить окно и кэш и подгрузить первую порцию.
+void TruthTableModel::resetWindow(quint64 start)
+{
+    windowStart = start;
+    windowRows = 0;
+    matches.clear();
+    scanRow = start;
+    scannedRows = 0;
+    idleRows = 0;
+    scanStopped = false;
+    cacheTags.assign(CACHE_BLOCKS, 0);
+    if (total > 0)
+        windowRows = loadRows();
+    if (windowRows == 0 && canFetchMore(QModelIndex()))
+        QTimer::singleShot(0, this, [this]() { fetchMore(QModelIndex()); });
+}
@@ -0,0 +1,176 @@
+#ifndef TRUTHTABLEMODEL_H
+#define TRUTHTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+#include "LogicGraph.h"
+
+/**
+ * @class TruthTableModel
+ * @brief Таблица истинности сети, строки которой вычисляются по запросу
+ *
+ * Таблица из 2^n строк не хранится: модель показывает окно строк,
+ * начинающееся с заданной строки, и вычисляет значения выходов только
+ * для строк, которые запрашивает представление. Сеть вычисляется сразу
+ * для 64 соседних строк — по строке на бит машинного слова.
+ *
+ * @details
+ * - Строка k задаёт значения входов битами k: первый столбец — старший
+ *   бит, последний входной столбец меняется чаще всех.
+ * - Окно растёт порциями через fetchMore по мере прокрутки и ограничено
+ *   MAX_WINDOW_ROWS строками; к дальним строкам переходят через jumpTo.
+ * - Значения выходов хранятся в кэше с прямым отображением на
+ *   CACHE_BLOCKS блоков по 64 строки; промах вычисляет блок и несколько
+ *   следующих, которые понадобятся при прокрутке вниз.
+ * - Фильтр «выход = 1» просматривает строки по 64 за раз и запоминает
+ *   номера подходящих строк только для текущего окна. Просмотр идёт
+ *   отрезками по времени; если отрезок ничего не нашёл, следующий
+ *   запускается из цикла событий, и окно не замирает.
+ * - Порция фильтра не больше свободного места окна: просмотр
+ *   останавливается на найденной строке и продолжается со следующей.
+ * - Если просмотр без единого совпадения вычислил MAX_IDLE_SCAN_WORDS
+ *   слов вентилей (десятки секунд работы при любом размере сети), он
+ *   останавливается (statistics().scanStopped); дальше таблицу можно
+ *   смотреть переходом jumpTo.
+ * - Память зависит от числа вентилей и размера окна, но не от числа входов.
+ */
+class TruthTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @struct Statistics
+     * @brief Размер таблицы и объём вычислений
+     */
+    struct Statistics
+    {
+        int inputs = 0;               ///< Число входов
+        int outputs = 0;              ///< Число выходов
+        int gates = 0;                ///< Число вентилей сети
+        quint64 totalRows = 0;        ///< Строк в полной таблице
+        quint64 windowStart = 0;      ///< Первая строка окна
+        qint64 evaluatedBlocks = 0;   ///< Вычислено блоков по 64 строки
+        quint64 scannedRows = 0;      ///< Просмотрено строк фильтром
+        bool scanStopped = false;     ///< Просмотр остановлен: долго нет совпадений
+        qint64 fetchUs = 0;           ///< Время последней подгрузки, мкс
+    };
+
+    /**
+     * @brief Конструктор
+     * @param parent Родительский объект
+     */
+    explicit TruthTableModel(QObject* parent = nullptr);
+
+    /**
+     * @brief Задать сеть
+     * @param graph Сеть с одним или несколькими выходами
+     * @return false, если входов больше MAX_INPUTS (модель очищается)
+     */
+    bool setGraph(const LogicGraph& graph);
+
+    /**
+     * @brief Описание последней ошибки
+     * @return Текст ошибки
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Показывать только строки, где выход равен 1
+     * @param output Номер выхода; -1 — все строки
+     */
+    void setFilterOutput(int output);
+
+    /**
+     * @brief Выход фильтра
+     * @return Номер выхода или -1
+     */
+    int filterOutput() const;
+
+    /**
+     * @brief Начать окно со строки таблицы
+     * @param row Номер строки; с фильтром — первая подходящая строка не меньше row
+     */
+    void jumpTo(quint64 row);
+
+    /**
+     * @brief Номер строки полной таблицы
+     * @param row Строка модели
+     * @return Номер строки таблицы истинности
+     */
+    quint64 truthRow(int row) const;
+
+    /**
+     * @brief Размер таблицы и объём вычислений
+     * @return Статистика
+     */
+    Statistics statistics() const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    /**
+     * @brief Вычислить выходы для 64 строк
+     * @param block Номер блока (строки 64·block … 64·block + 63)
+     * @param outputs Сюда записываются слова выходов
+     */
+    void evaluateBlock(quint64 block, quint64* outputs) const;
+
+    /**
+     * @brief Слова выходов блока из кэша (с вычислением при промахе)
+     * @param block Номер блока
+     * @return Указатель на слова выходов блока
+     */
+    const quint64* cachedBlock(quint64 block) const;
+
+    /**
+     * @brief Подгрузить следующую порцию окна
+     * @return Число добавленных строк
+     *
+     * Без фильтра только увеличивает окно; с фильтром просматривает
+     * таблицу дальше и запоминает не больше свободного места окна
+     * подходящих строк.
+     */
+    int loadRows();
+
+    /**
+     * @brief Сбросить окно и кэш и подгрузить первую порцию
+     * @param start Первая строка окна
+     */
+    void resetWindow(quint64 start);
+
+    int inputCount = 0;                   ///< Число входов
+    int outputCount = 0;                  ///< Число выходов
+    std::vector<QString> headers;         ///< Заголовки столбцов: входы, затем выходы
+    std::vector<quint8> kinds;            ///< Тип вентиля (LogicGraph::GateKind)
+    std::vector<int> faninStart;          ///< CSR: начало списка входов вентиля
+    std::vector<int> fanins;              ///< CSR: входы вентилей
+    std::vector<int> inputColumn;         ///< Столбец входа для вентиля INPUT
+    std::vector<int> outputGates;         ///< Вентили выходов
+    quint64 total = 0;                    ///< Строк в полной таблице
+    int filter = -1;                      ///< Выход фильтра
+
+    quint64 windowStart = 0;              ///< Первая строка окна
+    int windowRows = 0;                   ///< Строк в окне
+    std::vector<quint64> matches;         ///< Строки окна при включённом фильтре
+    quint64 scanRow = 0;                  ///< Следующая строка для просмотра фильтром
+    quint64 scannedRows = 0;              ///< Просмотрено строк фильтром
+    quint64 idleRows = 0;                 ///< Просмотрено строк после последнего совпадения
+    bool scanStopped = false;             ///< Просмотр остановлен: долго нет совпадений
+    qint64 fetchUs = 0;                   ///< Время последней подгрузки, мкс
+    QString error;                        ///< Описание последней ошибки
+
+    mutable std::vector<quint64> values;      ///< Слова вентилей при вычислении блока
+    mutable std::vector<quint64> cacheWords;  ///< Кэш: слова выходов блоков
+    mutable std::vector<quint64> cacheTags;   ///< Кэш: номер блока в слоте + 1 (0 — пусто)
+    mutable qint64 evaluatedBlocks = 0;       ///< Вычислено блоков
+};
+
+#endif // TRUTHTABLEMODEL_H
@@ -0,0 +1,84 @@
+#include "VcdWriter.h"
+
+// Константы.
+static constexpr int BUFFER_SIZE = 64 * 1024;
+static constexpr char FIRST_CODE_CHAR = '!';
+static constexpr int CODE_BASE = 94;
+
+// Конструктор.
+VcdWriter::VcdWriter(QIODevice* device, const QString& moduleName)
+    : device(device)
+    , moduleName(moduleName)
+{
+    buffer.reserve(BUFFER_SIZE + 256);
+}
+
+// Деструктор.
+VcdWriter::~VcdWriter()
+{
+    finish();
+}
+
+// Добавить сигнал.
+int VcdWriter::addSignal(const QString& name)
+{
+    // Идентификатор — число в системе счисления из печатных символов '!'..'~'.
+    int index = static_cast<int>(names.size());
+    QByteArray code;
+    int n = index;
+    do {
+        code.append(static_cast<char>(FIRST_CODE_CHAR + n % CODE_BASE));
+        n /= CODE_BASE;
+    } while (n > 0);
+
+    names.push_back(name);
+    codes.push_back(code);
+    return index;
+}
+
+// Записать заголовок и объявления сигналов.
+void VcdWriter::writeHeader()
+{
+    buffer.append("$timescale 1ns $end\n");
+    buffer.append("$scope module " + moduleName.toUtf8() + " $end\n");
+    for (size_t i = 0; i < names.size(); ++i) {
+        QByteArray name = names[i].toUtf8();
+        name.replace(' ', '_');
+        buffer.append("$var wire 1 " + codes[i] + ' ' + name + " $end\n");
+    }
+    buffer.append("$upscope $end\n$enddefinitions $end\n");
+    flushIfFull();
+}
+
+// Записать изменение значения сигнала.
+void VcdWriter::change(qint64 time, int signal, bool value)
+{
+    if (time != currentTime) {
+        buffer.append('#');
+        buffer.append(QByteArray::number(time));
+        buffer.append('\n');
+        currentTime = time;
+    }
+    buffer.append(value ? '1' : '0');
+    buffer.append(codes[signal]);
+    buffer.append('\n');
+    flushIfFull();
+}
+
+// Сбросить буфер в устройство.
+bool VcdWriter::finish()
+{
+    if (!buffer.isEmpty()) {
+        if (device->write(buffer) != buffer.size())
+            ok = false;
+        buffer.resize(0);
+    }
+    return ok;
+}
+
+// Записать буфер в устройство, если он заполнен.
+void VcdWriter::flushIfFull()
+{
+    if (buffer.size() >= BUFFER_SIZE)
+        finish();
+}
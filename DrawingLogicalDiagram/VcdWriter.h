@@ -0,0 +1,83 @@
+#ifndef VCDWRITER_H
+#define VCDWRITER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <vector>
+
+/**
+ * @class VcdWriter
+ * @brief Потоковая запись временных диаграмм в формате VCD
+ *
+ * Класс записывает заголовок Value Change Dump со списком
+ * однобитных сигналов и затем только изменения их значений.
+ * Вывод буферизуется и сбрасывается в устройство блоками,
+ * поэтому длинные моделирования не держат файл в памяти.
+ *
+ * Пример:
+ * @code
+ * VcdWriter vcd(&file);
+ * int a = vcd.addSignal("A");
+ * vcd.writeHeader();
+ * vcd.change(0, a, false);
+ * vcd.change(10, a, true);
+ * vcd.finish();
+ * @endcode
+ */
+class VcdWriter {
+public:
+    /**
+     * @brief Конструктор
+     * @param device Открытое на запись устройство
+     * @param moduleName Имя области ($scope) в заголовке
+     */
+    explicit VcdWriter(QIODevice* device, const QString& moduleName = "schema");
+
+    /**
+     * @brief Деструктор; сбрасывает буфер
+     */
+    ~VcdWriter();
+
+    /**
+     * @brief Добавить сигнал (до writeHeader())
+     * @param name Имя сигнала
+     * @return Номер сигнала для change()
+     */
+    int addSignal(const QString& name);
+
+    /**
+     * @brief Записать заголовок и объявления сигналов
+     */
+    void writeHeader();
+
+    /**
+     * @brief Записать изменение значения сигнала
+     * @param time Момент времени (не убывает между вызовами)
+     * @param signal Номер сигнала
+     * @param value Новое значение
+     */
+    void change(qint64 time, int signal, bool value);
+
+    /**
+     * @brief Сбросить буфер в устройство
+     * @return false при ошибке записи
+     */
+    bool finish();
+
+private:
+    /**
+     * @brief Записать буфер в устройство, если он заполнен
+     */
+    void flushIfFull();
+
+    QIODevice* device;                ///< Устройство вывода
+    QString moduleName;               ///< Имя области
+    std::vector<QString> names;       ///< Имена сигналов
+    std::vector<QByteArray> codes;    ///< Короткие идентификаторы сигналов
+    QByteArray buffer;                ///< Буфер вывода
+    qint64 currentTime = -1;          ///< Последний записанный момент времени
+    bool ok = true;                   ///< Признак успешной записи
+};
+
+#endif // VCDWRITER_H
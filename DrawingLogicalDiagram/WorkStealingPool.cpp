@@ -0,0 +1,131 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+// Конструктор.
+WorkStealingPool::WorkStealingPool(int threads)
+{
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 0; i < threads; ++i)
+        workers.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < threads; ++i)
+        this->threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+// Деструктор.
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+// Число рабочих потоков.
+int WorkStealingPool::threadCount() const
+{
+    return static_cast<int>(workers.size());
+}
+
+// Выполнить body(index, worker) для index из [0, count).
+void WorkStealingPool::parallelFor(int count, const std::function<void(int index, int worker)>& body)
+{
+    if (count <= 0)
+        return;
+
+    // Новый цикл начинается, когда все потоки вышли из предыдущего.
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return active == 0; });
+
+    // Задачи раздаются потокам непрерывными отрезками: соседние индексы
+    // обычно обращаются к соседним данным.
+    const int threadsNumber = threadCount();
+    for (int w = 0; w < threadsNumber; ++w) {
+        const int begin = static_cast<int>(static_cast<qint64>(count) * w / threadsNumber);
+        const int end = static_cast<int>(static_cast<qint64>(count) * (w + 1) / threadsNumber);
+        std::lock_guard<std::mutex> workerLock(workers[w]->mutex);
+        for (int index = begin; index < end; ++index)
+            workers[w]->tasks.push_back(index);
+    }
+
+    this->body = &body;
+    remaining = count;
+    ++generation;
+    wake.notify_all();
+    done.wait(lock, [this] { return remaining == 0 && active == 0; });
+    this->body = nullptr;
+}
+
+// Статистика выполненных задач.
+WorkStealingPool::Statistics WorkStealingPool::statistics() const
+{
+    Statistics stats;
+    stats.tasks = taskCount.load();
+    stats.steals = stealCount.load();
+    return stats;
+}
+
+// Основной цикл рабочего потока.
+void WorkStealingPool::workerLoop(int worker)
+{
+    quint64 seen = 0;
+    for (;;) {
+        const std::function<void(int, int)>* current = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            current = body;
+            if (!current)
+                continue;
+            ++active;
+        }
+
+        int executed = 0;
+        int index = 0;
+        while (takeTask(worker, index)) {
+            (*current)(index, worker);
+            ++executed;
+        }
+
+        taskCount += executed;
+        std::lock_guard<std::mutex> lock(mutex);
+        remaining -= executed;
+        --active;
+        if (remaining == 0 && active == 0)
+            done.notify_all();
+    }
+}
+
+// Взять задачу из своей очереди или украсть у соседа.
+bool WorkStealingPool::takeTask(int worker, int& index)
+{
+    {
+        Worker& own = *workers[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            index = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    const int threadsNumber = threadCount();
+    for (int offset = 1; offset < threadsNumber; ++offset) {
+        Worker& victim = *workers[(worker + offset) % threadsNumber];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            index = victim.tasks.back();
+            victim.tasks.pop_back();
+            ++stealCount;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,117 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkStealingPool
+ * @brief Пул потоков с захватом работы для параллельных циклов
+ *
+ * У каждого рабочего потока своя очередь задач. Поток берёт задачи
+ * с начала своей очереди, а опустев, забирает задачи с конца
+ * очередей соседей. Так неравные по времени задачи (например,
+ * неисправности с разной длиной пути распространения) равномерно
+ * распределяются между ядрами без общей блокировки на каждую задачу.
+ *
+ * Пример:
+ * @code
+ * WorkStealingPool pool;
+ * pool.parallelFor(count, [&](int index, int worker) { process(index); });
+ * @endcode
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @struct Statistics
+     * @brief Статистика пула за всё время жизни
+     */
+    struct Statistics
+    {
+        qint64 tasks = 0;   ///< Число выполненных задач
+        qint64 steals = 0;  ///< Число задач, взятых из чужих очередей
+    };
+
+    /**
+     * @brief Конструктор
+     * @param threads Число рабочих потоков (0 — по числу ядер)
+     */
+    explicit WorkStealingPool(int threads = 0);
+
+    /**
+     * @brief Деструктор; дожидается завершения потоков
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Число рабочих потоков
+     * @return Число потоков
+     */
+    int threadCount() const;
+
+    /**
+     * @brief Выполнить body(index, worker) для index из [0, count)
+     * @param count Число задач
+     * @param body Тело задачи; worker — номер потока из [0, threadCount())
+     *
+     * Возвращает управление после выполнения всех задач.
+     * Вызовы parallelFor из разных потоков не допускаются.
+     */
+    void parallelFor(int count, const std::function<void(int index, int worker)>& body);
+
+    /**
+     * @brief Статистика выполненных задач
+     * @return Число задач и захватов
+     */
+    Statistics statistics() const;
+
+private:
+    /**
+     * @struct Worker
+     * @brief Очередь задач одного потока
+     */
+    struct Worker
+    {
+        std::mutex mutex;        ///< Защита очереди
+        std::deque<int> tasks;   ///< Индексы задач
+    };
+
+    /**
+     * @brief Основной цикл рабочего потока
+     * @param worker Номер потока
+     */
+    void workerLoop(int worker);
+
+    /**
+     * @brief Взять задачу из своей очереди или украсть у соседа
+     * @param worker Номер потока
+     * @param index Сюда записывается индекс задачи
+     * @return false, если задач не осталось
+     */
+    bool takeTask(int worker, int& index);
+
+    std::vector<std::unique_ptr<Worker>> workers;                 ///< Очереди потоков
+    std::vector<std::thread> threads;                             ///< Рабочие потоки
+    const std::function<void(int, int)>* body = nullptr;          ///< Текущее тело цикла
+    std::mutex mutex;                                             ///< Защита состояния пула
+    std::condition_variable wake;                                 ///< Сигнал о новом цикле
+    std::condition_variable done;                                 ///< Сигнал о завершении цикла
+    quint64 generation = 0;                                       ///< Номер текущего цикла
+    int remaining = 0;                                            ///< Невыполненные задачи цикла
+    int active = 0;                                               ///< Потоки, занятые текущим циклом
+    bool stopping = false;                                        ///< Признак остановки пула
+    std::atomic<qint64> taskCount{0};                             ///< Выполнено задач
+    std::atomic<qint64> stealCount{0};                            ///< Украдено задач
+};
+
+#endif // WORKSTEALINGPOOL_H
@@ -1,11 +1,388 @@
 #include "mainwindow.h"
+#include "DiagramServer.h"
+#include "EventSimulator.h"
+#include "FaultSimulator.h"
+#include "LoadTester.h"
+#include "ModelCounter.h"
+#include "NetlistReader.h"
+#include "NetlistWriter.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Константы.
+static constexpr qint64 DEFAULT_LOAD_REQUESTS = 10000;
+static constexpr int DEFAULT_LOAD_CONNECTIONS = 4;
+static constexpr int DEFAULT_BENCHMARK_REPEATS = 5;
+static constexpr qint64 DEFAULT_SIM_STEPS = 1000000;
+static constexpr int DEFAULT_SIM_TOGGLES = 1;
+static constexpr int MAX_FAULT_TREE_NODES = 2000000;
+static constexpr int ROUND_TRIP_INPUTS = 16;
+static constexpr int ROUND_TRIP_GATES = 2000;
+static constexpr int ROUND_TRIP_OUTPUTS = 8;
+static const std::vector<int> COUNT_BENCHMARK_VARIABLES = {100, 200, 400, 800};
+static const char* const CONSOLE_OPTIONS[] = {"--load-test", "--count-benchmark", "--read-benchmark", "--round-trip",
+                                            "--sim-benchmark", "--fault-benchmark"};
+static const NetlistFormat ROUND_TRIP_FORMATS[] = {NetlistFormat::BLIF, NetlistFormat::VERILOG,
+                                                   NetlistFormat::AIGER_ASCII, NetlistFormat::AIGER_BINARY};
+static const char* const ROUND_TRIP_FORMAT_NAMES[] = {"BLIF", "Verilog", "aag", "aig"};
+
+// Нагрузочный прогон службы: строки запросов берутся из файла.
+static int runLoadTest(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QFile file(parser.value("requests"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        err << "Не удалось открыть файл запросов " << file.fileName() << '\n';
+        return 1;
+    }
+
+    QList<QByteArray> lines;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (!line.isEmpty())
+            lines.append(line);
+    }
+
+    LoadTester tester(parser.value("load-test"));
+    tester.setRequests(lines);
+    tester.setConnections(parser.value("connections").toInt());
+    tester.setBatchSize(parser.value("batch").toInt());
+    const bool ok = tester.run(parser.value("count").toLongLong());
+
+    out << tester.summary();
+    if (!ok)
+        err << tester.errorString() << '\n';
+    return ok ? 0 : 1;
+}
+
+// Замер подсчёта наборов на сгенерированных сетях.
+static int runCountBenchmark()
+{
+    QTextStream out(stdout);
+    out << "вид          входов  цифр  разложением  BDD-вентилей  узлов BDD  мс\n";
+    bool ok = true;
+    for (const ModelCounter::BenchmarkResult& result : ModelCounter::benchmark(COUNT_BENCHMARK_VARIABLES)) {
+        out << result.family.leftJustified(12) << ' '
+            << QString::number(result.variables).rightJustified(6) << ' ';
+        if (!result.ok) {
+            out << "превышен лимит узлов BDD\n";
+            ok = false;
+            continue;
+        }
+        out << QString::number(result.digits).rightJustified(5) << ' '
+            << QString::number(result.stats.decomposed).rightJustified(12) << ' '
+            << QString::number(result.stats.bddGates).rightJustified(13) << ' '
+            << QString::number(result.stats.bddNodes).rightJustified(10) << ' '
+            << QString::number(result.stats.elapsedUs / 1000.0, 'f', 1) << '\n';
+    }
+    return ok ? 0 : 1;
+}
+
+// Замер чтения нетлиста: файл читается с отображением в память и из буфера.
+static int runReadBenchmark(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const QString path = parser.value("read-benchmark");
+    const int repeats = std::max(1, parser.value("repeat").toInt());
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        err << "Не удалось открыть файл " << path << '\n';
+        return 1;
+    }
+    const QByteArray data = file.readAll();
+    const NetlistFormat format = NetlistReader::detectFormat(path, data.constData(), data.size());
+
+    // Берётся медиана повторов: первый прогон прогревает кэш страниц.
+    out << "источник   мс (медиана)  мс (лучшее)    МБ/с  вентилей/с\n";
+    NetlistReader reader;
+    for (int mapped = 1; mapped >= 0; --mapped) {
+        std::vector<qint64> times;
+        for (int i = 0; i < repeats; ++i) {
+            LogicGraph graph;
+            QElapsedTimer timer;
+            timer.start();
+            const bool ok = mapped ? reader.read(path, graph, format)
+                                   : reader.readData(data.constData(), data.size(), format, graph);
+            times.push_back(timer.nsecsElapsed());
+            if (!ok) {
+                err << reader.errorString() << '\n';
+                return 1;
+            }
+        }
+        std::sort(times.begin(), times.end());
+        const double median = times[times.size() / 2] / 1e6;
+        const double seconds = std::max(median / 1000.0, 1e-9);
+        out << QString(mapped ? "файл" : "буфер").leftJustified(10) << ' '
+            << QString::number(median, 'f', 1).rightJustified(13) << ' '
+            << QString::number(times.front() / 1e6, 'f', 1).rightJustified(12) << ' '
+            << QString::number(data.size() / (1024.0 * 1024.0) / seconds, 'f', 1).rightJustified(7) << ' '
+            << QString::number(reader.statistics().gates / seconds, 'f', 0).rightJustified(11) << '\n';
+    }
+
+    const NetlistReader::Statistics stats = reader.statistics();
+    out << stats.bytes << " байт, " << stats.gates << " вентилей, " << stats.inputs << " входов, "
+        << stats.outputs << " выходов\n";
+    return 0;
+}
+
+// Сети проверки записи: случайная сеть и имена, совпадающие с именами внутренних сетей.
+static std::vector<std::pair<QString, LogicGraph>> roundTripCircuits()
+{
+    using Kind = LogicGraph::GateKind;
+    std::vector<std::pair<QString, LogicGraph>> circuits;
+    std::mt19937 random(1);
+
+    LogicGraph graph;
+    std::vector<int> wires;
+    for (int i = 0; i < ROUND_TRIP_INPUTS; ++i)
+        wires.push_back(graph.addInput(QString("x%1").arg(i)));
+    for (int i = 0; i < ROUND_TRIP_GATES; ++i) {
+        std::vector<int> fanins;
+        for (int k = 2 + random() % 3; k > 0; --k)
+            fanins.push_back(wires[random() % wires.size()]);
+        const Kind kind = random() % 3 == 0 ? Kind::XOR : (random() % 2 ? Kind::AND : Kind::OR);
+        int gate = graph.addGate(kind, fanins);
+        if (random() % 4 == 0)
+            gate = graph.addGate(Kind::NOT, {gate});
+        wires.push_back(gate);
+    }
+    for (int i = 0; i < ROUND_TRIP_OUTPUTS; ++i)
+        graph.addOutput(QString("y%1").arg(i), wires[wires.size() - 1 - i]);
+    circuits.emplace_back("случайная", std::move(graph));
+
+    // Выходы с именами внутренних сетей, выход-вход, выход с именем
+    // входа, два выхода одного вентиля и выходы-константы.
+    graph = LogicGraph();
+    const int a = graph.addInput("a");
+    const int n0 = graph.addInput("n0");
+    const int sum = graph.addGate(Kind::XOR, {a, n0});
+    graph.addOutput("n1", graph.addGate(Kind::AND, {a, graph.addGate(Kind::NOT, {n0})}));
+    graph.addOutput("n_2", sum);
+    graph.addOutput("n__3", sum);
+    graph.addOutput("a", n0);
+    graph.addOutput("n", graph.addConstant(false));
+    graph.addOutput("one", graph.addConstant(true));
+    circuits.emplace_back("имена", std::move(graph));
+    return circuits;
+}
+
+// Проверка записи чтением: сеть пишется в каждый формат, читается и сравнивается.
+static int runRoundTrip(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    std::vector<std::pair<QString, LogicGraph>> circuits = roundTripCircuits();
+    for (const QString& path : parser.positionalArguments()) {
+        NetlistReader reader;
+        LogicGraph graph;
+        if (!reader.read(path, graph)) {
+            err << reader.errorString() << '\n';
+            return 1;
+        }
+        circuits.emplace_back(path, std::move(graph));
+    }
+
+    bool ok = true;
+    for (const auto& circuit : circuits) {
+        for (size_t i = 0; i < std::size(ROUND_TRIP_FORMATS); ++i) {
+            NetlistWriter writer;
+            QElapsedTimer timer;
+            timer.start();
+            const bool same = writer.verifyRoundTrip(circuit.second, ROUND_TRIP_FORMATS[i]);
+            out << circuit.first.leftJustified(12) << ' ' << QString(ROUND_TRIP_FORMAT_NAMES[i]).leftJustified(8) << ' '
+                << (same ? QString("совпадает, %1 мс").arg(timer.elapsed()) : writer.errorString()) << '\n';
+            ok = ok && same;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+// Замер моделирования: событийный режим против полного пересчёта на одних воздействиях.
+static int runSimBenchmark(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const QString path = parser.value("sim-benchmark");
+    const qint64 steps = std::max<qint64>(1, parser.value("steps").toLongLong());
+    const int toggles = std::max(1, parser.value("toggles").toInt());
+
+    NetlistReader reader;
+    LogicGraph graph;
+    if (!reader.read(path, graph)) {
+        err << reader.errorString() << '\n';
+        return 1;
+    }
+    if (graph.inputs().empty()) {
+        err << "В сети нет входов\n";
+        return 1;
+    }
+    out << graph.size() << " вентилей, " << graph.inputs().size() << " входов, " << steps
+        << " шагов, входов на шаг: " << toggles << '\n';
+
+    const std::vector<EventSimulator::BenchmarkResult> results = EventSimulator::benchmark(graph, steps, toggles);
+    out << QString("режим").leftJustified(15) << ' ' << QString("мс").rightJustified(8) << ' '
+        << QString("шагов/с").rightJustified(9) << ' ' << QString("вычислений").rightJustified(12) << ' '
+        << QString("вычислений/шаг").rightJustified(15) << '\n';
+    for (const EventSimulator::BenchmarkResult& result : results) {
+        const double seconds = std::max(result.elapsedUs / 1e6, 1e-9);
+        out << QString(result.mode == EventSimulator::Mode::EVENT_DRIVEN ? "событийный" : "полный пересчёт").leftJustified(15) << ' '
+            << QString::number(result.elapsedUs / 1000.0, 'f', 1).rightJustified(8) << ' '
+            << QString::number(result.steps / seconds, 'f', 0).rightJustified(9) << ' '
+            << QString::number(result.evaluations).rightJustified(12) << ' '
+            << QString::number(double(result.evaluations) / result.steps, 'f', 1).rightJustified(15) << '\n';
+    }
+
+    const EventSimulator::BenchmarkResult& event = results.front();
+    const EventSimulator::BenchmarkResult& full = results.back();
+    if (event.checksum != full.checksum) {
+        err << "Выходы режимов не совпали\n";
+        return 1;
+    }
+    out << "Выходы совпали; ускорение " << QString::number(double(full.elapsedUs) / std::max<qint64>(1, event.elapsedUs), 'f', 1)
+        << "×, вычислений меньше в " << QString::number(double(full.evaluations) / std::max<qint64>(1, event.evaluations), 'f', 1)
+        << " раз\n";
+    return 0;
+}
+
+// Замер моделирования неисправностей: выходы нетлиста разворачиваются в деревья,
+// моделирование повторяется на 1, 2, 4, ... потоках.
+static int runFaultBenchmark(const QCommandLineParser& parser)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const QString path = parser.value("fault-benchmark");
+
+    NetlistReader reader;
+    LogicGraph graph;
+    if (!reader.read(path, graph)) {
+        err << reader.errorString() << '\n';
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<SchemaTree::Node>> roots;
+    FaultSimulator simulator;
+    for (int i = 0; i < static_cast<int>(graph.outputs().size()); ++i) {
+        QString error;
+        roots.push_back(graph.toTree(i, MAX_FAULT_TREE_NODES, &error));
+        if (!roots.back()) {
+            err << error << '\n';
+            return 1;
+        }
+        simulator.addTree(roots.back().get());
+    }
+    simulator.setPatternCount(parser.value("patterns").toLongLong());
+
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < QThread::idealThreadCount(); threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(std::max(1, QThread::idealThreadCount()));
+
+    const std::vector<FaultSimulator::Statistics> results = simulator.benchmark(threadCounts);
+    const FaultSimulator::Statistics& first = results.front();
+    out << first.faults << " неисправностей (" << first.collapsedFaults << " после свёртки), "
+        << first.patterns << (first.exhaustive ? " шаблонов (полный перебор)\n" : " шаблонов\n");
+    out << "потоков        мс  обнаружено  покрытие, %  ускорение\n";
+    bool same = true;
+    for (const FaultSimulator::Statistics& stats : results) {
+        const double speedup = stats.elapsedMs > 0 ? double(first.elapsedMs) / stats.elapsedMs : 1.0;
+        out << QString::number(stats.threads).rightJustified(7) << ' '
+            << QString::number(stats.elapsedMs).rightJustified(9) << ' '
+            << QString::number(stats.detected).rightJustified(11) << ' '
+            << QString::number(stats.coverage(), 'f', 1).rightJustified(12) << ' '
+            << QString::number(speedup, 'f', 2).rightJustified(10) << '\n';
+        same = same && stats.detected == first.detected;
+    }
+    if (!same) {
+        err << "Число обнаруженных неисправностей зависит от числа потоков\n";
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    // Нагрузочному клиенту и замерам не нужны ни окна, ни шрифты.
+    bool console = false;
+    for (int i = 1; i < argc; ++i) {
+        for (const char* option : CONSOLE_OPTIONS)
+            console = console || std::strncmp(argv[i], option, std::strlen(option)) == 0;
+    }
+    std::unique_ptr<QCoreApplication> app(console ? new QCoreApplication(argc, argv)
+                                                  : new QApplication(argc, argv));
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOptions({
+        {"serve", "Работать службой на локальном сокете <name>.", "name"},
+        {"cache-entries", "Лимит записей кэша службы.", "count",
+         QString::number(DiagramServer::DEFAULT_MAX_ENTRIES)},
+        {"cache-mb", "Лимит памяти кэша службы, МБ.", "megabytes",
+         QString::number(DiagramServer::DEFAULT_MAX_BYTES / (1024 * 1024))},
+        {"load-test", "Нагрузочный прогон службы на сокете <name>.", "name"},
+        {"requests", "Файл строк запросов для прогона.", "file"},
+        {"count", "Число запросов прогона.", "count", QString::number(DEFAULT_LOAD_REQUESTS)},
+        {"connections", "Число соединений прогона.", "count", QString::number(DEFAULT_LOAD_CONNECTIONS)},
+        {"batch", "Запросов в одной записи.", "count", "1"},
+        {"count-benchmark", "Замер подсчёта наборов на сетях со 100–800 входами."},
+        {"read-benchmark", "Замер чтения нетлиста <file>.", "file"},
+        {"repeat", "Повторов замера.", "count", QString::number(DEFAULT_BENCHMARK_REPEATS)},
+        {"sim-benchmark", "Замер событийного моделирования нетлиста <file> против полного пересчёта.", "file"},
+        {"steps", "Шагов моделирования.", "count", QString::number(DEFAULT_SIM_STEPS)},
+        {"toggles", "Входов, переключаемых на шаге.", "count", QString::number(DEFAULT_SIM_TOGGLES)},
+        {"fault-benchmark", "Замер моделирования неисправностей нетлиста <file> по числу потоков.", "file"},
+        {"patterns", "Шаблонов моделирования неисправностей (0 — полный перебор или 65536 случайных).", "count", "0"},
+        {"round-trip", "Проверить запись нетлистов чтением на тестовых сетях и нетлистах [file ...]."},
+    });
+    parser.addPositionalArgument("file", "Нетлисты для --round-trip.", "[file ...]");
+    parser.process(*app);
+
+    if (parser.isSet("count-benchmark"))
+        return runCountBenchmark();
+
+    if (parser.isSet("read-benchmark"))
+        return runReadBenchmark(parser);
+
+    if (parser.isSet("round-trip"))
+        return runRoundTrip(parser);
+
+    if (parser.isSet("sim-benchmark"))
+        return runSimBenchmark(parser);
+
+    if (parser.isSet("fault-benchmark"))
+        return runFaultBenchmark(parser);
+
+    if (parser.isSet("load-test"))
+        return runLoadTest(parser);
+
+    if (parser.isSet("serve")) {
+        DiagramServer server(parser.value("cache-entries").toInt(),
+                             parser.value("cache-mb").toLongLong() * 1024 * 1024);
+        if (!server.listen(parser.value("serve"))) {
+            QTextStream(stderr) << server.errorString() << '\n';
+            return 1;
+        }
+        QTextStream(stdout) << "Служба слушает " << server.serverName() << '\n';
+        return app->exec();
+    }
+
     MainWindow w;
     w.show();
-    return a.exec();
+    return app->exec();
 }
@@ -2,16 +2,50 @@
 #include "ui_mainwindow.h"
 #include <SchemaTree.h>
 #include <SchemaProgram.h>
+#include <CodeGenerator.h>
+#include <ExpressionReader.h>
+#include <NetlistReader.h>
+#include <NetlistWriter.h>
+#include <ParallelParser.h>
+#include <PassManager.h>
+#include <SatChecker.h>
+#include <EventSimulator.h>
+#include <FaultSimulator.h>
+#include <ModelCounter.h>
+#include <TechMapper.h>
+#include <TimingAnalyzer.h>
+#include <TreeRebalancer.h>
+#include <TreeSimulator.h>
+#include <QElapsedTimer>
 #include <QFileDialog>
-#include <QImage>
-#include <QPainter>
+#include <QMessageBox>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QSignalBlocker>
+#include <QThread>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <algorithm>
+
+// Константы.
+static constexpr int MAX_IMPORT_TREE_NODES = 2000000;
+static constexpr size_t MAX_REPORTED_FAULTS = 50;
+static constexpr int MAX_VERIFIED_GATES = 100000;
+static constexpr double RARE_SIGNAL_PROBABILITY = 0.01;
+static constexpr qreal ZOOM_STEP = 1.25;
+static const QColor LIVE_ONE_COLOR(0, 170, 0);
+static const QColor LIVE_ZERO_COLOR(150, 150, 150);
 
 // Конструктор главного окна.
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , document(&cache)
 {
     ui->setupUi(this);
+    ui->graphicsView->viewport()->installEventFilter(this);
+    ui->truthTableView->setModel(&truthTable);
+    ui->truthTableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
 }
 
 // Деструктор главного окна.
@@ -20,32 +54,1108 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+// Масштабирование, вписывание, сворачивание двойным щелчком, переключение входа щелчком.
+bool MainWindow::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == ui->graphicsView->viewport() && event->type() == QEvent::Wheel) {
+        auto* wheel = static_cast<QWheelEvent*>(event);
+        if (wheel->modifiers() & Qt::ControlModifier) {
+            const qreal factor = wheel->angleDelta().y() > 0 ? ZOOM_STEP : 1.0 / ZOOM_STEP;
+            ui->graphicsView->scale(factor, factor);
+            viewZoomed = true;
+            return true;
+        }
+    }
+    // Компоновка не зависит от размера окна: схема только вписывается заново.
+    if (watched == ui->graphicsView->viewport() && event->type() == QEvent::Resize && !viewZoomed)
+        document.fit(ui->graphicsView);
+    if (watched == ui->graphicsView->viewport() && event->type() == QEvent::MouseButtonPress
+        && ui->liveButton->isChecked()) {
+        auto* mouse = static_cast<QMouseEvent*>(event);
+        if (mouse->button() == Qt::LeftButton && toggleInputAt(mouse->pos()))
+            return true;
+    }
+    if (watched == ui->graphicsView->viewport() && event->type() == QEvent::MouseButtonDblClick) {
+        auto* mouse = static_cast<QMouseEvent*>(event);
+        if (mouse->button() == Qt::LeftButton && toggleSubtreeAt(mouse->pos()))
+            return true;
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
 // Обработчик нажатия кнопки "Выполнить".
 void MainWindow::on_executeButton_clicked()
 {
     QString text = ui->inputEdit->text();
-    SchemaTree tree = SchemaTree(text);
-    tree.printTree();
-    SchemaProgram program(text, ui->graphicsView);
+    importedGraph = LogicGraph();
+    importedTree.reset();
+
+    // Выражение с одним выходом становится новой версией истории
+    // и строится по тексту версии, чтобы при возврате к ней ключ
+    // кэша компоновок совпал.
+    if (LogicGraph::isEquationList(text)) {
+        ui->statusBar->showMessage(drawExpression(text));
+        updateTruthTable();
+        return;
+    }
+
+    // Дерево разбора записывается в историю и передаётся документу,
+    // поэтому выражение разбирается один раз.
+    std::unique_ptr<SchemaTree> tree = ParallelParser::makeTree(text);
+    if (tree->getRoot()) {
+        history.commit(tree->getRoot());
+        text = EditHistory::toExpression(history.current());
+    }
+    ui->undoButton->setEnabled(history.canUndo());
+    ui->redoButton->setEnabled(history.canRedo());
+
+    const QString summary = drawExpression(text, std::move(tree));
+    QStringList parts{summary, historySummary(), updateTiming()};
+    parts.removeAll(QString());
+    ui->statusBar->showMessage(parts.join("; "));
+    updateTruthTable();
+    if (ui->liveButton->isChecked())
+        startLiveSimulation();
+}
+
+// Построить схему выражения.
+QString MainWindow::drawExpression(const QString& text, std::unique_ptr<SchemaTree> parsed)
+{
+    // Неизвестное имя прохода не мешает построить схему без проходов.
+    PassManager passes;
+    const bool optimize = ui->optimizeCheckBox->isChecked();
+    const bool pipelineOk = !optimize || passes.setPipeline(ui->passesEdit->text());
+    PassManager* pipeline = optimize && pipelineOk ? &passes : nullptr;
+
+    TreeRebalancer rebalancer;
+    rebalancer.setMaxFanin(ui->faninSpinBox->value());
+    TreeRebalancer* balance = ui->rebalanceCheckBox->isChecked() ? &rebalancer : nullptr;
+
+    const bool rebuilt = document.open(text, balance, pipeline, ui->levelsSpinBox->value(), std::move(parsed));
+    document.show(ui->graphicsView);
+    viewZoomed = false;
+
+    // При попадании в кэш и при повторном открытии дерево
+    // не обрабатывается и отчёты пустые.
+    QStringList parts;
+    if (!pipelineOk)
+        parts << passes.errorString();
+    if (pipeline && passes.report().nodesBefore > 0)
+        parts << passes.summary();
+
+    const TreeRebalancer::Report report = rebalancer.report();
+    if (balance && report.nodesBefore > 0) {
+        parts << tr("Глубина %1 → %2, столбцов %3 → %4, узлов %5 → %6, "
+                    "задержка %7 → %8, %9 мкс")
+                     .arg(report.depthBefore).arg(report.depthAfter)
+                     .arg(report.layoutColumnsBefore).arg(report.layoutColumnsAfter)
+                     .arg(report.nodesBefore).arg(report.nodesAfter)
+                     .arg(report.delayBefore).arg(report.delayAfter)
+                     .arg(report.elapsedUs);
+    }
+    if (document.treeStatistics().collapsed > 0)
+        parts << expansionSummary(document.treeStatistics());
+    if (!rebuilt)
+        parts << tr("Схема показана без повторного разбора и компоновки");
+    const QString summary = parts.isEmpty() ? layoutSummary(document.graphStatistics()) : parts.join("; ");
+
+    // Ошибка в уравнениях не мешает показать разобранную часть схемы.
+    if (!rebuilt || document.errorString().isEmpty())
+        return summary;
+    return summary.isEmpty() ? document.errorString() : document.errorString() + "; " + summary;
+}
+
+// Обработчик нажатия кнопки "Отменить".
+void MainWindow::on_undoButton_clicked()
+{
+    if (history.undo())
+        showVersion();
+}
+
+// Обработчик нажатия кнопки "Повторить".
+void MainWindow::on_redoButton_clicked()
+{
+    if (history.redo())
+        showVersion();
+}
+
+// Показать текущую версию истории.
+void MainWindow::showVersion()
+{
+    const QString text = EditHistory::toExpression(history.current());
+    ui->inputEdit->setText(text);
+    importedGraph = LogicGraph();
+    importedTree.reset();
+    ui->undoButton->setEnabled(history.canUndo());
+    ui->redoButton->setEnabled(history.canRedo());
+
+    const QString summary = drawExpression(text);
+    QStringList parts{summary, historySummary(), updateTiming()};
+    parts.removeAll(QString());
+    ui->statusBar->showMessage(parts.join("; "));
+    updateTruthTable();
+}
+
+// Совпадает ли схема с текущей версией истории.
+bool MainWindow::timingFollowsHistory() const
+{
+    return history.current() && importedGraph.outputs().empty()
+           && !ui->optimizeCheckBox->isChecked() && !ui->rebalanceCheckBox->isChecked()
+           && document.text() == EditHistory::toExpression(history.current());
+}
+
+// Перенести смену версии в сохранённый анализ задержек.
+QString MainWindow::updateTiming()
+{
+    if (!timedRoot)
+        return QString();
+    if (!timingFollowsHistory()) {
+        timedRoot.reset();
+        timedVersion.reset();
+        timing.analyze(nullptr);
+        return QString();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    int replaced = 0;
+    int recomputed = 0;
+    const EditHistory::NodePtr version = history.current();
+    EditHistory::patch(timedRoot.get(), timedVersion, version, [&](SchemaTree::Node* node) {
+        timing.update(node);
+        ++replaced;
+        recomputed += timing.statistics().recomputed;
+    });
+    timedVersion = version;
+
+    return tr("Задержка %1: заменено поддеревьев %2, пересчитано %3 из %4 узлов за %5 мкс")
+        .arg(timing.criticalDelay())
+        .arg(replaced)
+        .arg(recomputed)
+        .arg(timing.statistics().nodes)
+        .arg(timer.nsecsElapsed() / 1000);
+}
+
+// Описание состояния истории для строки состояния.
+QString MainWindow::historySummary() const
+{
+    const EditHistory::Statistics stats = history.statistics();
+    if (stats.versions == 0)
+        return QString();
+
+    return tr("Версия %1 из %2: в памяти %3 узлов вместо %4, новых %5 за %6 мкс")
+        .arg(stats.current).arg(stats.versions)
+        .arg(stats.storedNodes).arg(stats.treeNodes)
+        .arg(stats.addedNodes).arg(stats.commitUs);
 }
 
 // Обработчик нажатия кнопки "Сохранить".
 void MainWindow::on_saveButton_clicked()
 {
-    QString fileName = QFileDialog::getSaveFileName(this, tr("Сохранить схему"), "", tr("Изображения (*.png *.jpg *.bmp)"));
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Сохранить схему"), "",
+                                                    tr("Изображения (*.png *.jpg *.bmp *.svg);;"
+                                                       "Нетлисты (*.blif *.v *.aag *.aig);;"
+                                                       "Код C/C++ (*.c *.h *.cpp)"));
     if (fileName.isEmpty()) {
         return;
     }
 
+    if (CodeGenerator::isSourcePath(fileName)) {
+        saveCode(fileName);
+        return;
+    }
+
+    if (NetlistWriter::formatForPath(fileName) != NetlistFormat::AUTO) {
+        saveNetlist(fileName);
+        return;
+    }
+
     QGraphicsScene* scene = ui->graphicsView->scene();
     if (!scene) {
         return;
     }
 
-    QImage image(scene->sceneRect().size().toSize(), QImage::Format_ARGB32);
-    image.fill(Qt::transparent);
+    // Схема выражения сохраняется из документа: SVG — из готовой
+    // компоновки, изображение — с готовой сцены.
+    QString error;
+    const bool saved = document.isShownIn(ui->graphicsView) ? document.save(fileName)
+                                                           : SchemaDocument::save(scene, fileName, &error);
+    if (!saved) {
+        QMessageBox::warning(this, tr("Ошибка сохранения"),
+                             document.isShownIn(ui->graphicsView) ? document.errorString() : error);
+        return;
+    }
+    ui->statusBar->showMessage(tr("Сохранено: %1").arg(QFileInfo(fileName).fileName()));
+}
+
+// Получить сеть текущей схемы.
+const LogicGraph* MainWindow::currentGraph()
+{
+    if (!importedGraph.outputs().empty())
+        return &importedGraph;
+
+    const LogicGraph* graph = ensureDocument() ? document.graph() : nullptr;
+    if (!graph) {
+        QMessageBox::warning(this, tr("Ошибка"),
+                             document.errorString().isEmpty() ? tr("Схема не построена") : document.errorString());
+    }
+    return graph;
+}
+
+// Сохранить текущую схему как нетлист.
+void MainWindow::saveNetlist(const QString& fileName)
+{
+    const LogicGraph* current = currentGraph();
+    if (!current)
+        return;
+    const LogicGraph& graph = *current;
+
+    // Отображённая схема сохраняется из ячеек, если она на экране
+    // и формат её поддерживает.
+    const NetlistFormat format = NetlistWriter::formatForPath(fileName);
+    const bool mapped = mappedScene && mappedScene == ui->graphicsView->scene()
+                        && (format == NetlistFormat::BLIF || format == NetlistFormat::VERILOG);
+
+    NetlistWriter writer;
+    if (!(mapped ? writer.write(fileName, mappedNetlist, format) : writer.write(fileName, graph, format))) {
+        QMessageBox::warning(this, tr("Ошибка экспорта"), writer.errorString());
+        return;
+    }
+
+    ui->statusBar->showMessage(tr("Сохранено: %1").arg(QFileInfo(fileName).fileName()));
+}
+
+// Сохранить текущую схему как код C/C++.
+void MainWindow::saveCode(const QString& fileName)
+{
+    const LogicGraph* current = currentGraph();
+    if (!current)
+        return;
+    const LogicGraph& graph = *current;
+
+    CodeGenerator generator;
+    generator.setFunctionName(QFileInfo(fileName).completeBaseName());
+    if (!generator.write(fileName, graph)) {
+        QMessageBox::warning(this, tr("Ошибка экспорта"), generator.errorString());
+        return;
+    }
+
+    // Проверка компилирует код локально в отдельных процессах и сообщает
+    // результат из цикла событий; для очень больших сетей она пропускается.
+    // Без компилятора файл всё равно сохранён, причина видна в строке состояния.
+    const QString saved = tr("Сохранено: %1").arg(QFileInfo(fileName).fileName());
+    if (generator.statistics().gates > MAX_VERIFIED_GATES) {
+        ui->statusBar->showMessage(saved + tr("; проверка пропущена: более %1 вентилей").arg(MAX_VERIFIED_GATES));
+        return;
+    }
+
+    ui->statusBar->showMessage(saved + tr("; код проверяется компилятором..."));
+    generator.verifyAsync(graph, this, [this, saved](bool passed, const CodeGenerator::Statistics& stats,
+                                                     const QString& error) {
+        if (!passed) {
+            ui->statusBar->showMessage(saved + tr("; проверка не выполнена: %1").arg(error.section('\n', 0, 0)));
+            return;
+        }
+        ui->statusBar->showMessage(saved + tr("; %1 вентилей, %2 в локальных переменных; проверено %3 наборов "
+                                              "(компиляция %4 мс)")
+                                               .arg(stats.gates)
+                                               .arg(stats.locals)
+                                               .arg(stats.vectors)
+                                               .arg(stats.compileMs));
+    });
+}
+
+// Обработчик нажатия кнопки "Открыть".
+void MainWindow::on_openButton_clicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Открыть нетлист"), "",
+                                                    tr("Нетлисты (*.blif *.aag *.aig *.v);;Выражения (*.txt *.expr)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+    if (ExpressionReader::isExpressionFile(fileName)) {
+        openExpression(fileName);
+        return;
+    }
+
+    NetlistReader reader;
+    LogicGraph graph;
+    if (!reader.read(fileName, graph)) {
+        QMessageBox::warning(this, tr("Ошибка импорта"), reader.errorString());
+        return;
+    }
+
+    QString summary;
+    if (graph.outputs().size() > 1) {
+        SchemaProgram program(graph, ui->graphicsView);
+        summary = layoutSummary(program.graphStatistics());
+        importedTree.reset();
+    } else {
+        QString error;
+        std::unique_ptr<SchemaTree::Node> root = graph.toTree(0, MAX_IMPORT_TREE_NODES, &error);
+        if (!root) {
+            QMessageBox::warning(this, tr("Ошибка импорта"), error);
+            return;
+        }
+
+        importedTree = std::make_unique<SchemaTree>(std::move(root));
+        SchemaProgram program(*importedTree, ui->graphicsView, {}, nullptr, defaultExpansion());
+        if (program.treeStatistics().collapsed > 0)
+            summary = expansionSummary(program.treeStatistics());
+    }
+    importedGraph = std::move(graph);
+    updateTruthTable();
+
+    const NetlistReader::Statistics stats = reader.statistics();
+    ui->statusBar->showMessage(tr("%1: %2 вентилей, %3 входов, %4 выходов за %5 мс (%6 КБ)")
+                                   .arg(QFileInfo(fileName).fileName())
+                                   .arg(stats.gates)
+                                   .arg(stats.inputs)
+                                   .arg(stats.outputs)
+                                   .arg(stats.elapsedMs)
+                                   .arg(stats.bytes / 1024)
+                               + (summary.isEmpty() ? QString() : "; " + summary));
+}
+
+// Открыть файл с одним выражением.
+void MainWindow::openExpression(const QString& fileName)
+{
+    ExpressionReader reader;
+    std::unique_ptr<SchemaTree::Node> root;
+    if (!reader.read(fileName, root)) {
+        QMessageBox::warning(this, tr("Ошибка импорта"), reader.errorString());
+        return;
+    }
+
+    importedTree = std::make_unique<SchemaTree>(std::move(root));
+    SchemaProgram program(*importedTree, ui->graphicsView, {}, nullptr, defaultExpansion());
+    importedGraph = LogicGraph::fromTree(importedTree->getRoot());
+    updateTruthTable();
+
+    const ExpressionReader::Statistics stats = reader.statistics();
+    const DrawingDiagram::Statistics drawn = program.treeStatistics();
+    ui->statusBar->showMessage(tr("%1: %2 узлов за %3 мс (%4 КБ%5)")
+                                   .arg(QFileInfo(fileName).fileName())
+                                   .arg(stats.nodes)
+                                   .arg(stats.elapsedMs)
+                                   .arg(stats.bytes / 1024)
+                                   .arg(stats.mapped ? tr(", отображён в память") : QString())
+                               + (drawn.collapsed > 0 ? "; " + expansionSummary(drawn) : QString()));
+}
+
+// Описание этапов послойной компоновки для строки состояния.
+QString MainWindow::layoutSummary(const GraphDiagram::Statistics& stats) const
+{
+    const LayeredLayout::Statistics& layout = stats.layout;
+    if (layout.nodes == 0)
+        return QString();
+
+    return tr("Компоновка: %1 слоёв, %2 узлов, %3 фиктивных, пересечений %4 → %5; "
+              "слои %6 мс, порядок %7 мс, координаты %8 мс, трассировка %9 мс, рисование %10 мс")
+        .arg(layout.layers).arg(layout.nodes).arg(layout.dummies)
+        .arg(layout.crossingsBefore).arg(layout.crossingsAfter)
+        .arg(layout.layeringUs / 1000.0, 0, 'f', 1)
+        .arg(layout.orderingUs / 1000.0, 0, 'f', 1)
+        .arg(layout.coordinatesUs / 1000.0, 0, 'f', 1)
+        .arg(layout.routingUs / 1000.0, 0, 'f', 1)
+        .arg(stats.drawingUs / 1000.0, 0, 'f', 1);
+}
+
+// Описание свёрнутой схемы для строки состояния.
+QString MainWindow::expansionSummary(const DrawingDiagram::Statistics& stats) const
+{
+    return tr("Показано %1 элементов, свёрнуто поддеревьев %2 (двойной щелчок раскрывает), построено за %3 мс")
+        .arg(stats.cells)
+        .arg(stats.collapsed)
+        .arg(stats.elapsedUs / 1000.0, 0, 'f', 1);
+}
+
+// Состояние раскрытия для новой схемы дерева.
+DrawingDiagram::Expansion MainWindow::defaultExpansion() const
+{
+    DrawingDiagram::Expansion expansion;
+    expansion.depth = ui->levelsSpinBox->value();
+    return expansion;
+}
+
+// Свернуть или раскрыть поддерево оператора под курсором.
+bool MainWindow::toggleSubtreeAt(const QPoint& position)
+{
+    QGraphicsView* view = ui->graphicsView;
+    if (!view->scene())
+        return false;
+
+    // Для схемы нескольких выходов дерева нет, и ensureSearchIndex
+    // показал бы предупреждение.
+    if (indexedScene != view->scene() && !hasSingleTree())
+        return false;
+
+    const QTransform transform = view->transform();
+    const QPointF center = view->mapToScene(view->viewport()->rect().center());
+    const QPointF point = view->mapToScene(position);
+
+    // Компоновка детерминирована, поэтому после перестроения вместе
+    // с индексом точка щелчка попадает в тот же элемент.
+    if (!ensureSearchIndex())
+        return false;
+
+    const SchemaTree::Node* node = nullptr;
+    for (QGraphicsItem* item : view->scene()->items(point)) {
+        const SchemaTree::Node* owner = searchIndex.nodeOf(item);
+        if (owner && owner->type == NodeType::OP) {
+            node = owner;
+            break;
+        }
+    }
+    if (!node) {
+        view->setTransform(transform);
+        view->centerOn(center);
+        return false;
+    }
+
+    const QRectF before = searchIndex.boundingRect(node);
+    if (!toggledNodes.remove(node))
+        toggledNodes.insert(node);
+
+    DrawingDiagram::Expansion expansion = defaultExpansion();
+    expansion.toggled = toggledNodes;
+    const DrawingDiagram::Statistics drawn = drawIndexed(expansion);
+    searchMatches.clear();
+    searchPosition = -1;
+    ui->prevButton->setEnabled(false);
+    ui->nextButton->setEnabled(false);
 
-    QPainter painter(&image);
-    scene->render(&painter);
+    // Масштаб сохраняется, а схема сдвигается вместе с блоком,
+    // чтобы он остался под курсором.
+    const QRectF after = searchIndex.boundingRect(node);
+    view->setTransform(transform);
+    view->centerOn(center + (after.topRight() - before.topRight()));
+    if (liveSimulator)
+        showLiveValues(liveSimulator->treeNodes());
+    ui->statusBar->showMessage(expansionSummary(drawn));
+    return true;
 }
 
+// Начать живое моделирование текущей схемы.
+bool MainWindow::startLiveSimulation()
+{
+    liveSimulator.reset();
+    if (!ensureSearchIndex())
+        return false;
+
+    liveSimulator = std::make_unique<TreeSimulator>(searchTree->getRoot());
+    showLiveValues(liveSimulator->treeNodes());
+
+    const TreeSimulator::Statistics stats = liveSimulator->statistics();
+    ui->statusBar->showMessage(tr("Щёлкните по входу, чтобы переключить переменную; "
+                                  "узлов %1, переменных %2, начальное вычисление %3 мкс")
+                                   .arg(stats.nodes).arg(liveSimulator->variables().size())
+                                   .arg(stats.buildUs));
+    return true;
+}
+
+// Переключить переменную, вход которой под курсором.
+bool MainWindow::toggleInputAt(const QPoint& position)
+{
+    QGraphicsView* view = ui->graphicsView;
+    if (!view->scene())
+        return false;
+
+    // Схема могла смениться другой командой: моделирование начинается
+    // заново на дереве индекса, масштаб и положение сохраняются.
+    const QPointF point = view->mapToScene(position);
+    if (!liveSimulator || indexedScene != view->scene()) {
+        if (!hasSingleTree())
+            return false;
+        const QTransform transform = view->transform();
+        const QPointF center = view->mapToScene(view->viewport()->rect().center());
+        const bool started = startLiveSimulation();
+        view->setTransform(transform);
+        view->centerOn(center);
+        if (!started)
+            return false;
+    }
+
+    const SchemaTree::Node* leaf = nullptr;
+    for (QGraphicsItem* item : view->scene()->items(point)) {
+        const SchemaTree::Node* owner = searchIndex.nodeOf(item);
+        if (owner && owner->type == NodeType::VAR && owner->value != "0" && owner->value != "1") {
+            leaf = owner;
+            break;
+        }
+    }
+    if (!leaf)
+        return false;
+
+    liveSimulator->toggle(leaf->value);
+    QElapsedTimer timer;
+    timer.start();
+    showLiveValues(liveSimulator->changedNodes());
+    const qint64 recolorUs = timer.nsecsElapsed() / 1000;
+
+    const TreeSimulator::Statistics stats = liveSimulator->statistics();
+    ui->statusBar->showMessage(tr("%1 = %2, Y = %3; пересчитано узлов %4, изменилось %5 из %6; "
+                                  "распространение %7 нс, перекраска %8 мкс")
+                                   .arg(leaf->value).arg(liveSimulator->variable(leaf->value) ? 1 : 0)
+                                   .arg(liveSimulator->output() ? 1 : 0)
+                                   .arg(stats.visited).arg(stats.changed).arg(stats.nodes)
+                                   .arg(stats.elapsedNs).arg(recolorUs));
+    return true;
+}
+
+// Окрасить элементы узлов по их значениям.
+void MainWindow::showLiveValues(const std::vector<const SchemaTree::Node*>& nodes)
+{
+    for (const SchemaTree::Node* node : nodes)
+        searchIndex.setColor(node, liveSimulator->value(node) ? LIVE_ONE_COLOR : LIVE_ZERO_COLOR);
+}
+
+// Обработчик кнопки "Живое моделирование".
+void MainWindow::on_liveButton_toggled(bool checked)
+{
+    if (checked) {
+        if (!startLiveSimulation()) {
+            const QSignalBlocker blocker(ui->liveButton);
+            ui->liveButton->setChecked(false);
+        }
+        return;
+    }
+
+    // Обычные цвета возвращаются из индекса без перестроения схемы.
+    liveSimulator.reset();
+    if (indexedScene && indexedScene == ui->graphicsView->scene())
+        searchIndex.resetColors();
+    ui->statusBar->clearMessage();
+}
+
+// Обработчик нажатия кнопки "Моделировать".
+void MainWindow::on_simulateButton_clicked()
+{
+    const LogicGraph* current = currentGraph();
+    if (!current)
+        return;
+    const LogicGraph& graph = *current;
+
+    QString stimulusName = QFileDialog::getOpenFileName(this, tr("Файл воздействий"), "", tr("Воздействия (*.stim *.txt);;Все файлы (*)"));
+    if (stimulusName.isEmpty()) {
+        return;
+    }
+
+    QString vcdName = QFileDialog::getSaveFileName(this, tr("Сохранить временную диаграмму"), "", tr("VCD (*.vcd)"));
+    if (vcdName.isEmpty()) {
+        return;
+    }
+
+    EventSimulator simulator(graph);
+    if (!simulator.run(stimulusName, vcdName)) {
+        QMessageBox::warning(this, tr("Ошибка моделирования"), simulator.errorString());
+        return;
+    }
+
+    const EventSimulator::Statistics stats = simulator.statistics();
+    ui->statusBar->showMessage(tr("Моделирование: %1 шагов, %2 событий на входах, %3 вычислений вентилей за %4 мс")
+                                   .arg(stats.steps)
+                                   .arg(stats.inputEvents)
+                                   .arg(stats.evaluations)
+                                   .arg(stats.elapsedMs));
+}
+
+// Обработчик нажатия кнопки "Неисправности".
+void MainWindow::on_faultsButton_clicked()
+{
+    // Схема с одним выходом моделируется по дереву, по которому она
+    // нарисована, несколько выходов — по деревьям, развёрнутым из общей сети.
+    std::vector<std::unique_ptr<SchemaTree>> expanded;
+    std::vector<const SchemaTree::Node*> roots;
+    if (hasSingleTree()) {
+        const SchemaTree* tree = currentTree(tr("Поиск неисправностей"));
+        if (!tree || !tree->getRoot())
+            return;
+        roots.push_back(tree->getRoot());
+    } else {
+        const LogicGraph* graph = currentGraph();
+        if (!graph)
+            return;
+        for (int i = 0; i < static_cast<int>(graph->outputs().size()); ++i) {
+            QString error;
+            std::unique_ptr<SchemaTree::Node> root = graph->toTree(i, MAX_IMPORT_TREE_NODES, &error);
+            if (!root) {
+                QMessageBox::warning(this, tr("Ошибка"), error);
+                return;
+            }
+            expanded.push_back(std::make_unique<SchemaTree>(std::move(root)));
+            roots.push_back(expanded.back()->getRoot());
+        }
+    }
+
+    FaultSimulator simulator;
+    for (const SchemaTree::Node* root : roots)
+        simulator.addTree(root);
+
+    const FaultSimulator::Statistics stats = simulator.run();
+    ui->statusBar->showMessage(tr("Неисправности: %1 (%2 после свёртки), обнаружено %3 (%4%) на %5 шаблонах, %6 потоков за %7 мс")
+                                   .arg(stats.faults)
+                                   .arg(stats.collapsedFaults)
+                                   .arg(stats.detected)
+                                   .arg(stats.coverage(), 0, 'f', 1)
+                                   .arg(stats.patterns)
+                                   .arg(stats.threads)
+                                   .arg(stats.elapsedMs));
+
+    const std::vector<FaultSimulator::Fault> undetected = simulator.undetectedFaults();
+    if (undetected.empty())
+        return;
+
+    QStringList lines;
+    for (size_t i = 0; i < undetected.size() && i < MAX_REPORTED_FAULTS; ++i)
+        lines << simulator.describe(undetected[i]);
+    if (undetected.size() > MAX_REPORTED_FAULTS)
+        lines << tr("... и ещё %1").arg(undetected.size() - MAX_REPORTED_FAULTS);
+    QMessageBox::information(this, tr("Необнаруженные неисправности"), lines.join('\n'));
+}
+
+// Обработчик нажатия кнопки "Задержки".
+void MainWindow::on_timingButton_clicked()
+{
+    TimingAnalyzer::DelayModel model;
+    QString error;
+    if (!TimingAnalyzer::parseDelayModel(ui->delaysEdit->text(), model, &error)) {
+        QMessageBox::warning(this, tr("Анализ задержек"), error);
+        return;
+    }
+
+    // Схема версии истории анализируется один раз, дальше анализ
+    // обновляется правками; остальные схемы — полным анализом.
+    std::unique_ptr<SchemaTree> versionTree;
+    const SchemaTree* tree = nullptr;
+    QString summary;
+    if (timingFollowsHistory()) {
+        if (timedRoot) {
+            summary = updateTiming();
+        } else {
+            timedVersion = history.current();
+            timedRoot = EditHistory::toTree(timedVersion);
+            timing.setDelayModel(model);
+            timing.analyze(timedRoot.get());
+        }
+        versionTree = std::make_unique<SchemaTree>(std::move(timedRoot));
+        tree = versionTree.get();
+    } else {
+        timedRoot.reset();
+        timedVersion.reset();
+        tree = currentTree(tr("Анализ задержек"));
+        if (!tree)
+            return;
+        timing.setDelayModel(model);
+        timing.analyze(tree->getRoot());
+    }
+
+    const std::vector<const SchemaTree::Node*> path = timing.criticalPath();
+    SchemaProgram program(*tree, ui->graphicsView, timing.criticalNodes(), nullptr, defaultExpansion());
+    ui->statusBar->showMessage(tr("Критический путь: задержка %1, %2 элементов; %3")
+                                   .arg(timing.criticalDelay())
+                                   .arg(static_cast<int>(path.size()))
+                                   .arg(summary.isEmpty() ? tr("полный анализ %1 узлов за %2 мкс")
+                                                                .arg(timing.statistics().nodes)
+                                                                .arg(timing.statistics().elapsedUs)
+                                                          : summary));
+
+    // Дерево версии остаётся у окна для следующих обновлений;
+    // объекты узлов при этом не меняются.
+    if (timedVersion)
+        timedRoot = versionTree->takeRoot();
+    else
+        timing.analyze(nullptr);
+}
+
+// Обработчик изменения задержек элементов.
+void MainWindow::on_delaysEdit_textChanged(const QString&)
+{
+    timedRoot.reset();
+    timedVersion.reset();
+    timing.analyze(nullptr);
+}
+
+// Обработчик нажатия кнопки "Замер разбора".
+void MainWindow::on_benchmarkButton_clicked()
+{
+    const QString text = ui->inputEdit->text();
+    if (text.trimmed().isEmpty() || LogicGraph::isEquationList(text)) {
+        QMessageBox::warning(this, tr("Замер разбора"), tr("Замер выполняется для одного выражения"));
+        return;
+    }
+
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < QThread::idealThreadCount(); threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(std::max(1, QThread::idealThreadCount()));
+
+    const std::vector<ParallelParser::Statistics> results = ParallelParser::benchmark(text, threadCounts);
+    const ParallelParser::Statistics& first = results.front();
+    QStringList lines;
+    lines << tr("%1 символов, %2 операторов, %3 узлов").arg(first.chars).arg(first.operators).arg(first.nodes);
+    for (const ParallelParser::Statistics& stats : results) {
+        const double speedup = stats.totalUs > 0 ? double(first.totalUs) / stats.totalUs : 1.0;
+        lines << tr("%1 потоков: %2 мс (просмотр %3, индекс %4, разбор %5 мс, %6 задач), ускорение %7")
+                     .arg(stats.threads)
+                     .arg(stats.totalUs / 1000.0, 0, 'f', 1)
+                     .arg(stats.scanUs / 1000.0, 0, 'f', 1)
+                     .arg(stats.indexUs / 1000.0, 0, 'f', 1)
+                     .arg(stats.parseUs / 1000.0, 0, 'f', 1)
+                     .arg(stats.tasks)
+                     .arg(speedup, 0, 'f', 2);
+    }
+    QMessageBox::information(this, tr("Замер разбора"), lines.join('\n'));
+}
+
+// Обработчик нажатия кнопки "Число наборов".
+void MainWindow::on_countButton_clicked()
+{
+    const LogicGraph* current = currentGraph();
+    if (!current)
+        return;
+    const LogicGraph& graph = *current;
+
+    ModelCounter counter;
+    if (!counter.count(graph)) {
+        QMessageBox::warning(this, tr("Число наборов"), counter.errorString());
+        return;
+    }
+
+    const ModelCounter::Statistics stats = counter.statistics();
+    QStringList lines;
+    for (int i = 0; i < static_cast<int>(graph.outputs().size()); ++i) {
+        lines << tr("%1: %2 наборов из 2^%3, вероятность единицы %4")
+                     .arg(graph.outputs()[i].name)
+                     .arg(counter.modelCount(i).toString())
+                     .arg(stats.inputs)
+                     .arg(counter.outputProbability(i), 0, 'g', 6);
+    }
+
+    // Вентили, почти не меняющие значение, плохо проверяются
+    // случайными шаблонами.
+    int rare = 0;
+    for (int id = 0; id < graph.size(); ++id) {
+        const LogicGraph::GateKind kind = graph.gate(id).kind;
+        if (kind == LogicGraph::GateKind::CONST0 || kind == LogicGraph::GateKind::CONST1
+            || kind == LogicGraph::GateKind::INPUT)
+            continue;
+        const double p = counter.probability(id);
+        if (p < RARE_SIGNAL_PROBABILITY || p > 1.0 - RARE_SIGNAL_PROBABILITY)
+            ++rare;
+    }
+    lines << tr("Вентилей с вероятностью единицы меньше %1% или больше %2%: %3")
+                 .arg(RARE_SIGNAL_PROBABILITY * 100)
+                 .arg(100 - RARE_SIGNAL_PROBABILITY * 100)
+                 .arg(rare);
+    lines << tr("%1 входов, %2 вентилей: разложением %3, через BDD %4 (%5 узлов) за %6 мс")
+                 .arg(stats.inputs)
+                 .arg(stats.gates)
+                 .arg(stats.decomposed)
+                 .arg(stats.bddGates)
+                 .arg(stats.bddNodes)
+                 .arg(stats.elapsedUs / 1000.0, 0, 'f', 1);
+    QMessageBox::information(this, tr("Число наборов"), lines.join('\n'));
+}
+
+// Обработчик нажатия кнопки "Проверить".
+void MainWindow::on_satButton_clicked()
+{
+    const LogicGraph* current = currentGraph();
+    if (!current)
+        return;
+    const LogicGraph& graph = *current;
+
+    SatChecker checker;
+    QStringList lines;
+    for (int i = 0; i < static_cast<int>(graph.outputs().size()); ++i) {
+        const QString name = graph.outputs()[i].name;
+        SatChecker::Result whenTrue;
+        SatChecker::Result whenFalse;
+        switch (checker.classify(graph, i, &whenTrue, &whenFalse)) {
+        case SatChecker::Verdict::TAUTOLOGY:
+            lines << tr("%1: тождественно равен 1").arg(name);
+            break;
+        case SatChecker::Verdict::CONTRADICTION:
+            lines << tr("%1: тождественно равен 0").arg(name);
+            break;
+        case SatChecker::Verdict::CONTINGENT:
+            lines << tr("%1 = 1 при %2").arg(name, SatChecker::formatWitness(graph, whenTrue.witness));
+            lines << tr("%1 = 0 при %2").arg(name, SatChecker::formatWitness(graph, whenFalse.witness));
+            break;
+        case SatChecker::Verdict::UNKNOWN:
+            lines << tr("%1: проверка прервана").arg(name);
+            break;
+        }
+
+        // Статистика последнего выполненного запроса.
+        const SatChecker::Result& last = whenFalse.winner >= 0 ? whenFalse : whenTrue;
+        if (last.winner >= 0) {
+            lines << tr("    КНФ: %1 переменных, %2 дизъюнктов; первым ответил решатель %3 из %4 "
+                        "(%5 конфликтов) за %6 мс")
+                         .arg(last.variables)
+                         .arg(last.clauses)
+                         .arg(last.winner + 1)
+                         .arg(checker.solverCount())
+                         .arg(last.solvers[last.winner].conflicts)
+                         .arg((whenTrue.elapsedUs + whenFalse.elapsedUs) / 1000.0, 0, 'f', 1);
+        }
+    }
+    QMessageBox::information(this, tr("Проверка"), lines.join('\n'));
+}
+
+// Обработчик нажатия кнопки "Отобразить".
+void MainWindow::on_mapButton_clicked()
+{
+    const LogicGraph* current = currentGraph();
+    if (!current)
+        return;
+    const LogicGraph& graph = *current;
+
+    // Пункты mapComboBox: NAND2/NOR2, AOI, LUT-4, LUT-6.
+    TechMapper mapper;
+    const int target = ui->mapComboBox->currentIndex();
+    if (target == 0)
+        mapper.setLibrary(CellLibrary::nandNor());
+    else if (target == 1)
+        mapper.setLibrary(CellLibrary::aoi());
+    else
+        mapper.setLutSize(target == 2 ? 4 : 6);
+    mapper.setGoal(ui->goalComboBox->currentIndex() == 0 ? TechMapper::Goal::DELAY : TechMapper::Goal::AREA);
+
+    if (!mapper.map(graph) || !mapper.verify(graph)) {
+        QMessageBox::warning(this, tr("Отображение"), mapper.errorString());
+        return;
+    }
+
+    // Ячейки рисуются блоками DrawingDiagram с именем ячейки;
+    // общие экземпляры в дереве повторяются.
+    QString error;
+    std::unique_ptr<SchemaTree::Node> root = mapper.netlist().toTree(0, MAX_IMPORT_TREE_NODES, &error);
+    if (!root) {
+        QMessageBox::warning(this, tr("Отображение"), error);
+        return;
+    }
+    SchemaTree tree(std::move(root));
+    SchemaProgram program(tree, ui->graphicsView, {}, nullptr, defaultExpansion());
+    mappedNetlist = mapper.netlist();
+    mappedScene = ui->graphicsView->scene();
+
+    const TechMapper::Statistics stats = mapper.statistics();
+    QString summary = tr("%1: площадь %2, задержка %3; AIG %4 узлов, разрезов %5 (до %6 на узел, %7 КБ); "
+                         "AIG %8 мс, разрезы %9 мс, покрытие %10 мс; проверено %11 наборов")
+                          .arg(mapper.cellSummary())
+                          .arg(stats.area)
+                          .arg(stats.delay)
+                          .arg(stats.aigNodes)
+                          .arg(stats.cuts)
+                          .arg(stats.cutLimit)
+                          .arg(stats.cutBytes / 1024)
+                          .arg(stats.aigUs / 1000.0, 0, 'f', 1)
+                          .arg(stats.cutUs / 1000.0, 0, 'f', 1)
+                          .arg(stats.coverUs / 1000.0, 0, 'f', 1)
+                          .arg(stats.vectors);
+    if (graph.outputs().size() > 1)
+        summary += tr("; показан выход %1 из %2")
+                       .arg(graph.outputs().front().name)
+                       .arg(static_cast<int>(graph.outputs().size()));
+    if (program.treeStatistics().collapsed > 0)
+        summary += "; " + expansionSummary(program.treeStatistics());
+    ui->statusBar->showMessage(summary);
+}
+
+// Дерево текущей схемы с одним выходом.
+const SchemaTree* MainWindow::currentTree(const QString& title)
+{
+    if (importedTree)
+        return importedTree.get();
+
+    // Дерево документа уже прошло проходы и балансировку, с которыми
+    // нарисована схема.
+    const SchemaTree* tree = importedGraph.outputs().empty() && ensureDocument() ? document.tree() : nullptr;
+    if (!tree)
+        QMessageBox::warning(this, title, tr("%1 выполняется для схемы с одним выходом").arg(title));
+    return tree;
+}
+
+// Построить схему выражения из поля ввода, если документ пуст.
+bool MainWindow::ensureDocument()
+{
+    // Открытый документ — схема, которую видит пользователь; его текст
+    // после "Выполнить" нормализован историей и может отличаться от поля ввода.
+    if (!document.scene())
+        ui->statusBar->showMessage(drawExpression(ui->inputEdit->text()));
+    return document.scene() != nullptr;
+}
+
+// Строится ли текущая схема по одному дереву.
+bool MainWindow::hasSingleTree() const
+{
+    if (importedGraph.outputs().empty())
+        return !LogicGraph::isEquationList(document.scene() ? document.text() : ui->inputEdit->text());
+    return importedGraph.outputs().size() == 1;
+}
+
+// Обработчик нажатия кнопки "Найти".
+void MainWindow::on_findButton_clicked()
+{
+    const QString query = ui->searchEdit->text().trimmed();
+    if (query.isEmpty() || !ensureSearchIndex())
+        return;
+
+    searchMatches = searchIndex.find(query);
+    searchIndex.highlight(searchMatches);
+    ui->prevButton->setEnabled(searchMatches.size() > 1);
+    ui->nextButton->setEnabled(searchMatches.size() > 1);
+
+    if (searchMatches.empty()) {
+        searchPosition = -1;
+        ui->statusBar->showMessage(tr("«%1» не найдено, поиск %2 мкс")
+                                       .arg(query).arg(searchIndex.statistics().queryUs));
+        return;
+    }
+    showMatch(0);
+}
+
+// Обработчик нажатия Enter в поле поиска.
+void MainWindow::on_searchEdit_returnPressed()
+{
+    on_findButton_clicked();
+}
+
+// Обработчик нажатия кнопки "Следующее".
+void MainWindow::on_nextButton_clicked()
+{
+    if (!searchMatches.empty() && indexedScene == ui->graphicsView->scene())
+        showMatch(searchPosition + 1);
+}
+
+// Обработчик нажатия кнопки "Предыдущее".
+void MainWindow::on_prevButton_clicked()
+{
+    if (!searchMatches.empty() && indexedScene == ui->graphicsView->scene())
+        showMatch(searchPosition - 1);
+}
+
+// Проиндексировать текущую схему, если индекс устарел.
+bool MainWindow::ensureSearchIndex()
+{
+    if (indexedScene && indexedScene == ui->graphicsView->scene() && !searchIndex.isEmpty())
+        return true;
+
+    const SchemaTree* tree = currentTree(tr("Поиск"));
+    if (!tree || !tree->getRoot())
+        return false;
+
+    // Схема из кэша не связана с узлами дерева, поэтому она
+    // перерисовывается по тому же дереву вместе с индексом.
+    liveSimulator.reset();
+    searchTree = tree;
+    searchIndex.clear();
+    toggledNodes.clear();
+    drawIndexed(defaultExpansion());
+    return true;
+}
+
+// Перестроить схему searchTree вместе с индексом.
+DrawingDiagram::Statistics MainWindow::drawIndexed(const DrawingDiagram::Expansion& expansion)
+{
+    DrawingDiagram::Statistics stats;
+    if (searchTree == importedTree.get()) {
+        SchemaProgram program(*searchTree, ui->graphicsView, {}, &searchIndex, expansion);
+        stats = program.treeStatistics();
+    } else {
+        document.redraw(expansion, &searchIndex);
+        document.show(ui->graphicsView);
+        stats = document.treeStatistics();
+    }
+    indexedScene = ui->graphicsView->scene();
+    return stats;
+}
+
+// Показать совпадение поиска.
+void MainWindow::showMatch(int position)
+{
+    const int count = static_cast<int>(searchMatches.size());
+    searchPosition = (position % count + count) % count;
+
+    const QRectF rect = searchIndex.boundingRect(searchMatches[searchPosition]);
+    if (!rect.isNull())
+        ui->graphicsView->centerOn(rect.center());
+
+    const SearchIndex::Statistics stats = searchIndex.statistics();
+    ui->statusBar->showMessage(tr("Совпадение %1 из %2, поиск %3 мкс; индекс: %4 узлов, "
+                                  "%5 переменных, %6 обозначений, построен за %7 мкс")
+                                   .arg(searchPosition + 1).arg(count).arg(stats.queryUs)
+                                   .arg(stats.nodes).arg(stats.variables).arg(stats.names)
+                                   .arg(stats.buildUs));
+}
+
+// Обработчик кнопки "Таблица истинности".
+void MainWindow::on_truthTableButton_toggled(bool checked)
+{
+    ui->truthTablePanel->setVisible(checked);
+    if (checked)
+        updateTruthTable();
+}
+
+// Пересчитать таблицу истинности текущей схемы, если панель открыта.
+void MainWindow::updateTruthTable()
+{
+    if (!ui->truthTableButton->isChecked())
+        return;
+
+    const LogicGraph* current = currentGraph();
+    if (!current)
+        return;
+    const LogicGraph& graph = *current;
+    if (!truthTable.setGraph(graph))
+        QMessageBox::warning(this, tr("Таблица истинности"), truthTable.errorString());
+
+    // Новая сеть сбрасывает фильтр, поэтому список выходов
+    // заполняется без вызова обработчика.
+    const QSignalBlocker blocker(ui->filterComboBox);
+    ui->filterComboBox->clear();
+    ui->filterComboBox->addItem(tr("All rows"));
+    for (const LogicGraph::Output& output : graph.outputs())
+        ui->filterComboBox->addItem(QString("%1 = 1").arg(output.name));
+    ui->statusBar->showMessage(truthTableSummary());
+}
+
+// Обработчик нажатия Enter в поле номера строки.
+void MainWindow::on_rowEdit_returnPressed()
+{
+    bool ok = false;
+    const quint64 row = ui->rowEdit->text().trimmed().toULongLong(&ok);
+    if (!ok) {
+        ui->statusBar->showMessage(tr("Номер строки должен быть неотрицательным числом"));
+        return;
+    }
+
+    truthTable.jumpTo(row);
+    ui->truthTableView->scrollToTop();
+    ui->statusBar->showMessage(truthTableSummary());
+}
+
+// Обработчик выбора фильтра строк таблицы истинности.
+void MainWindow::on_filterComboBox_currentIndexChanged(int index)
+{
+    truthTable.setFilterOutput(index - 1);
+    ui->truthTableView->scrollToTop();
+    ui->statusBar->showMessage(truthTableSummary());
+}
+
+// Описание таблицы истинности для строки состояния.
+QString MainWindow::truthTableSummary() const
+{
+    const TruthTableModel::Statistics stats = truthTable.statistics();
+    QString text = tr("Таблица истинности: %1 входов, %2 выходов, 2^%1 строк, окно с %3; "
+                      "вычислено блоков по 64 строки: %4, %5 мкс")
+                       .arg(stats.inputs).arg(stats.outputs).arg(stats.windowStart)
+                       .arg(stats.evaluatedBlocks).arg(stats.fetchUs);
+    if (truthTable.filterOutput() >= 0)
+        text += tr("; просмотрено %1 строк, найдено %2").arg(stats.scannedRows).arg(truthTable.rowCount());
+    if (stats.scanStopped)
+        text += tr("; совпадений долго нет, просмотр остановлен — перейдите к строке дальше");
+    return text;
+}
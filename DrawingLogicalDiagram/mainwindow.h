@@ -1,7 +1,24 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QGraphicsScene>
 #include <QMainWindow>
+#include <QPointer>
+#include <QSet>
+#include <memory>
+#include <vector>
+#include "DiagramCache.h"
+#include "DrawingDiagram.h"
+#include "EditHistory.h"
+#include "GraphDiagram.h"
+#include "LogicGraph.h"
+#include "SchemaDocument.h"
+#include "SchemaTree.h"
+#include "SearchIndex.h"
+#include "TechMapper.h"
+#include "TimingAnalyzer.h"
+#include "TreeSimulator.h"
+#include "TruthTableModel.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -49,20 +66,389 @@ private slots:
     /**
      * @brief Обработчик нажатия кнопки "Выполнить"
      *
-     * Получает текст из inputEdit, строит SchemaTree,
-     * выводит дерево в консоль и создаёт схему через SchemaProgram.
+     * Получает текст из inputEdit и открывает его в SchemaDocument,
+     * используя дисковый кэш компоновок.
      */
     void on_executeButton_clicked();
 
     /**
      * @brief Обработчик нажатия кнопки "Сохранить"
      *
-     * Открывает диалог сохранения файла, рендерит сцену graphicsView
-     * в QImage и сохраняет как изображение (PNG, JPG, BMP).
+     * Открывает диалог сохранения файла и сохраняет схему через
+     * SchemaDocument как изображение (PNG, JPG, BMP) или SVG,
+     * либо экспортирует схему как нетлист (BLIF, Verilog, AIGER).
      */
     void on_saveButton_clicked();
 
+    /**
+     * @brief Обработчик нажатия кнопки "Открыть"
+     *
+     * Открывает диалог выбора нетлиста (BLIF, AIGER, Verilog) или файла
+     * выражения, читает его через NetlistReader или ExpressionReader
+     * и строит схему первого выхода.
+     */
+    void on_openButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Моделировать"
+     *
+     * Запрашивает файл воздействий и путь к VCD, выполняет событийное
+     * моделирование текущей схемы и показывает статистику в statusBar.
+     */
+    void on_simulateButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Неисправности"
+     *
+     * Моделирует константные неисправности на всех рёбрах дерева
+     * текущей схемы, показывает покрытие в statusBar и список
+     * необнаруженных неисправностей.
+     */
+    void on_faultsButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Задержки"
+     *
+     * Выполняет статический временной анализ текущего выражения
+     * с задержками из delaysEdit, перестраивает схему с подсвеченным
+     * критическим путём и показывает его задержку в statusBar.
+     * Анализ версии истории сохраняется и дальше обновляется
+     * при правках, отмене и повторе (updateTiming()).
+     */
+    void on_timingButton_clicked();
+
+    /**
+     * @brief Обработчик изменения задержек элементов
+     *
+     * Сбрасывает сохранённый анализ: следующий анализ полный.
+     */
+    void on_delaysEdit_textChanged(const QString&);
+
+    /**
+     * @brief Обработчик нажатия кнопки "Замер разбора"
+     *
+     * Разбирает текущее выражение ParallelParser на 1, 2, 4, …
+     * потоках и показывает время этапов и ускорение.
+     */
+    void on_benchmarkButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Число наборов"
+     *
+     * Считает ModelCounter точное число наборов, на которых каждый
+     * выход равен 1, и вероятности сигналов при равновероятных входах.
+     */
+    void on_countButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Проверить"
+     *
+     * Определяет SatChecker для каждого выхода, равен ли он 1 на всех
+     * наборах, ни на одном или принимает оба значения, и показывает
+     * наборы-свидетели и решатель портфеля, ответивший первым.
+     */
+    void on_satButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Отобразить"
+     *
+     * Отображает текущую схему TechMapper на библиотеку или LUT,
+     * выбранные в mapComboBox, с критерием из goalComboBox, проверяет
+     * результат на случайных наборах и показывает первый выход
+     * из ячеек; площадь, задержка и затраты видны в statusBar.
+     */
+    void on_mapButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Отменить"
+     *
+     * Возвращает предыдущую версию выражения из истории
+     * и перестраивает схему.
+     */
+    void on_undoButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Повторить"
+     *
+     * Возвращает следующую версию выражения из истории
+     * и перестраивает схему.
+     */
+    void on_redoButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Найти"
+     *
+     * Ищет в текущей схеме обозначение, переменную или подвыражение
+     * из searchEdit, подсвечивает совпадения и переходит к первому.
+     */
+    void on_findButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия Enter в поле поиска
+     */
+    void on_searchEdit_returnPressed();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Следующее"
+     */
+    void on_nextButton_clicked();
+
+    /**
+     * @brief Обработчик нажатия кнопки "Предыдущее"
+     */
+    void on_prevButton_clicked();
+
+    /**
+     * @brief Обработчик кнопки "Живое моделирование"
+     * @param checked Включить режим: щелчок по входу переключает переменную
+     *
+     * Провода и вентили текущей схемы окрашиваются по значениям;
+     * при выключении индекс возвращает им исходные цвета без перестроения схемы.
+     */
+    void on_liveButton_toggled(bool checked);
+
+    /**
+     * @brief Обработчик кнопки "Таблица истинности"
+     * @param checked Показать панель таблицы
+     */
+    void on_truthTableButton_toggled(bool checked);
+
+    /**
+     * @brief Обработчик нажатия Enter в поле номера строки
+     *
+     * Начинает окно таблицы истинности с введённой строки.
+     */
+    void on_rowEdit_returnPressed();
+
+    /**
+     * @brief Обработчик выбора фильтра строк таблицы истинности
+     * @param index 0 — все строки, иначе номер выхода + 1
+     */
+    void on_filterComboBox_currentIndexChanged(int index);
+
+protected:
+    /**
+     * @brief Масштабирование схемы колесом мыши с нажатым Ctrl, вписывание при изменении размера,
+     *        сворачивание двойным щелчком, переключение входа щелчком в режиме "Live"
+     * @param watched Объект, получивший событие (viewport схемы)
+     * @param event Событие
+     * @return true, если событие обработано
+     */
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
 private:
+    /**
+     * @brief Получить сеть текущей схемы
+     * @return Сеть или nullptr; при ошибке показывается сообщение
+     *
+     * Возвращает импортированную сеть, если схема была открыта из файла,
+     * иначе сеть документа, по которой нарисована схема; поле ввода
+     * заново не разбирается.
+     */
+    const LogicGraph* currentGraph();
+
+    /**
+     * @brief Сохранить текущую схему как нетлист
+     * @param fileName Путь к файлу; формат определяется по расширению
+     *
+     * Показанная отображённая схема записывается из ячеек (BLIF, Verilog).
+     */
+    void saveNetlist(const QString& fileName);
+
+    /**
+     * @brief Сохранить текущую схему как код C/C++
+     * @param fileName Путь к файлу; имя файла задаёт префикс функций
+     *
+     * После записи код проверяется локальным компилятором
+     * по эталонному вычислению сети; проверка идёт в отдельных
+     * процессах, результат появляется в statusBar по её окончании.
+     */
+    void saveCode(const QString& fileName);
+
+    /**
+     * @brief Открыть файл с одним выражением
+     * @param fileName Путь к файлу (*.txt, *.expr)
+     *
+     * Выражение не попадает в inputEdit: схема строится по дереву,
+     * а сеть сохраняется как импортированная.
+     */
+    void openExpression(const QString& fileName);
+
+    /**
+     * @brief Описание этапов послойной компоновки для строки состояния
+     * @param stats Статистика GraphDiagram
+     * @return Пустая строка, если послойная компоновка не выполнялась
+     */
+    QString layoutSummary(const GraphDiagram::Statistics& stats) const;
+
+    /**
+     * @brief Описание свёрнутой схемы для строки состояния
+     * @param stats Статистика DrawingDiagram
+     * @return Число показанных элементов, свёрнутых поддеревьев и время
+     */
+    QString expansionSummary(const DrawingDiagram::Statistics& stats) const;
+
+    /**
+     * @brief Состояние раскрытия для новой схемы дерева
+     * @return Число раскрытых уровней из levelsSpinBox, без ручных переключений
+     */
+    DrawingDiagram::Expansion defaultExpansion() const;
+
+    /**
+     * @brief Свернуть или раскрыть поддерево оператора под курсором
+     * @param position Точка в координатах viewport
+     * @return true, если поддерево переключено
+     *
+     * Схема перестраивается по дереву индекса поиска с тем же
+     * масштабом; переключённые узлы хранятся в toggledNodes.
+     */
+    bool toggleSubtreeAt(const QPoint& position);
+
+    /**
+     * @brief Начать живое моделирование текущей схемы
+     * @return true, если схема проиндексирована и значения показаны
+     *
+     * Все переменные получают значение 0, схема окрашивается целиком.
+     */
+    bool startLiveSimulation();
+
+    /**
+     * @brief Переключить переменную, вход которой под курсором
+     * @param position Точка в координатах viewport
+     * @return true, если переменная переключена
+     *
+     * Пересчитываются только пути от листьев переменной к выходу,
+     * перекрашиваются только элементы изменившихся узлов.
+     */
+    bool toggleInputAt(const QPoint& position);
+
+    /**
+     * @brief Окрасить элементы узлов по их значениям
+     * @param nodes Узлы дерева живого моделирования
+     */
+    void showLiveValues(const std::vector<const SchemaTree::Node*>& nodes);
+
+    /**
+     * @brief Построить схему выражения
+     * @param text Выражение или список уравнений
+     * @param parsed Уже разобранное дерево text (nullptr — разобрать при необходимости)
+     * @return Сообщение для строки состояния (может быть пустым)
+     *
+     * Схема строится документом document; тот же текст с теми же
+     * параметрами показывается без повторного разбора и компоновки.
+     */
+    QString drawExpression(const QString& text, std::unique_ptr<SchemaTree> parsed = nullptr);
+
+    /**
+     * @brief Показать текущую версию истории
+     *
+     * Записывает текст версии в inputEdit и строит схему.
+     */
+    void showVersion();
+
+    /**
+     * @brief Совпадает ли схема с текущей версией истории
+     * @return true, если показано выражение текущей версии без проходов
+     *         и балансировки, то есть его дерево — дерево версии
+     */
+    bool timingFollowsHistory() const;
+
+    /**
+     * @brief Перенести смену версии в сохранённый анализ задержек
+     * @return Задержка и объём пересчёта для строки состояния;
+     *         пустая строка, если анализ не ведётся
+     *
+     * Отличия версий переносятся в timedRoot (EditHistory::patch),
+     * для каждого заменённого узла вызывается TimingAnalyzer::update().
+     * Если схема перестала совпадать с версией истории, анализ сбрасывается.
+     */
+    QString updateTiming();
+
+    /**
+     * @brief Описание состояния истории для строки состояния
+     * @return Номер версии и расход памяти
+     */
+    QString historySummary() const;
+
+    /**
+     * @brief Дерево текущей схемы с одним выходом
+     * @param title Заголовок сообщения об ошибке
+     * @return Дерево импортированной сети или дерево документа, по которому
+     *         нарисована схема; nullptr, если выходов несколько
+     *         (показывается сообщение)
+     */
+    const SchemaTree* currentTree(const QString& title);
+
+    /**
+     * @brief Построить схему выражения из inputEdit, если документ пуст
+     * @return true, если документ построен
+     *
+     * Построенный документ не перестраивается и не показывается заново:
+     * команды работают со схемой, нарисованной последней.
+     */
+    bool ensureDocument();
+
+    /**
+     * @brief Строится ли текущая схема по одному дереву
+     * @return false для списка уравнений и сети с несколькими выходами
+     */
+    bool hasSingleTree() const;
+
+    /**
+     * @brief Проиндексировать текущую схему, если индекс устарел
+     * @return true, если индекс готов
+     *
+     * Схема перестраивается один раз вместе с индексом; следующие
+     * запросы к той же сцене используют готовый индекс.
+     */
+    bool ensureSearchIndex();
+
+    /**
+     * @brief Перестроить схему searchTree вместе с индексом
+     * @param expansion Свёрнутые и раскрытые поддеревья
+     * @return Статистика построения схемы
+     *
+     * Дерево документа перерисовывается самим документом, импортированное
+     * дерево — SchemaProgram.
+     */
+    DrawingDiagram::Statistics drawIndexed(const DrawingDiagram::Expansion& expansion);
+
+    /**
+     * @brief Показать совпадение поиска
+     * @param position Номер совпадения (берётся по модулю их числа)
+     */
+    void showMatch(int position);
+
+    /**
+     * @brief Пересчитать таблицу истинности текущей схемы, если панель открыта
+     */
+    void updateTruthTable();
+
+    /**
+     * @brief Описание таблицы истинности для строки состояния
+     * @return Размер таблицы, окно и объём вычислений
+     */
+    QString truthTableSummary() const;
+
     Ui::MainWindow *ui;   ///< Указатель на UI, сгенерированный Qt Designer
+    DiagramCache cache;   ///< Дисковый кэш компоновок схем
+    SchemaDocument document;   ///< Схема выражения: дерево, компоновка и сцена
+    bool viewZoomed = false;   ///< Масштаб изменён вручную: не вписывать схему при изменении размера
+    LogicGraph importedGraph;  ///< Сеть последнего импортированного нетлиста
+    std::unique_ptr<SchemaTree> importedTree;  ///< Дерево импортированной схемы с одним выходом
+    EditHistory history;       ///< Версии выражения для отмены и повтора
+    SearchIndex searchIndex;   ///< Индекс поиска по текущей схеме
+    const SchemaTree* searchTree = nullptr;         ///< Дерево, по которому построен индекс (document или importedTree)
+    QSet<const SchemaTree::Node*> toggledNodes;     ///< Узлы searchTree, свёрнутые или раскрытые вручную
+    QPointer<QGraphicsScene> indexedScene;          ///< Сцена, по которой построен индекс
+    std::unique_ptr<TreeSimulator> liveSimulator;   ///< Живое моделирование searchTree
+    std::vector<const SchemaTree::Node*> searchMatches;  ///< Совпадения последнего запроса
+    int searchPosition = -1;                        ///< Текущее совпадение
+    TruthTableModel truthTable;                     ///< Таблица истинности текущей схемы
+    TimingAnalyzer timing;                          ///< Анализ задержек timedRoot
+    std::unique_ptr<SchemaTree::Node> timedRoot;    ///< Дерево версии истории, по которому ведётся анализ
+    EditHistory::NodePtr timedVersion;              ///< Версия, которой соответствует timedRoot
+    TechMapper::Netlist mappedNetlist;              ///< Последняя отображённая схема
+    QPointer<QGraphicsScene> mappedScene;           ///< Сцена, на которой она показана
 };
 #endif // MAINWINDOW_H